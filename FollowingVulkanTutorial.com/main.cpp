@@ -39,6 +39,39 @@
 #include <streambuf>    // for loading shader binaries
 #include <string>       // for loading shader binaries
 #include <cerrno>       // for loading shader binaries
+#include <thread>       // for frame pacing sleeps
+#include <atomic>       // for the render command queue and the task scheduler
+#include <mutex>        // for the task scheduler
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <filesystem>   // for replacing the pipeline cache file atomically
+#include <cmath>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX        // or else windows.h breaks std::min/max
+#include <windows.h>    // for memory-mapping shader binaries
+#else
+#include <sys/mman.h>   // for memory-mapping shader binaries
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>    // for noticing shader edits
+#endif
+#include <map>
+#include <cstdlib>      // std::getenv(...), std::system(...)
+
+// runtime GLSL compiling uses shaderc if asked to (define USE_SHADERC and link 
+// shaderc_combined), or else runs glslangValidator
+// Note: Opt-in because the Vulkan SDK always has the headers, but only a release build of the 
+// library.
+#if defined(USE_SHADERC) && __has_include(<shaderc/shaderc.hpp>)
+#include <shaderc/shaderc.hpp>
+#define HAVE_SHADERC
+#endif
 
 
 /*-------------------------------------------------------------------------------------------------
@@ -118,16 +151,149 @@ namespace std {
 
 /*-------------------------------------------------------------------------------------------------
 Description:
-    Rather than specify three separate uniforms to bring the transform matrices into the shaders,
-    load them all at one time.
+    The per-frame uniforms (descriptor set 0). View and projection are the same for every object
+    drawn in a frame, so they are multiplied together once on the CPU instead of once per vertex
+    in the shader.
+
+    Note: The per-object model transform used to live here as well, which meant that every object
+    would have needed its own uniform buffer and its own descriptor set. It now goes through push
+    constants instead (see PushConstantObject).
 
-    ??why three separate matrices? is it just normal practice to separate them??
+    Also Note: The previous frame's view-projection is only read by the cluster culling shader,
+    which tests against a Hi-Z pyramid that was built from the previous frame's depth (see
+    cluster_cull.comp).
 Creator:    John Cox, 01/2019
 -------------------------------------------------------------------------------------------------*/
 struct UniformBufferObject {
+    glm::mat4 viewProj;
+    glm::mat4 prevViewProj;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Per-object data that is pushed straight into the command buffer with vkCmdPushConstants(...).
+    Must match the "push_constant" block in the vertex shader.
+
+    Note: The spec only guarantees 128 bytes of push constant space (maxPushConstantsSize).
+
+    Also Note: The model transform is read by the vertex shader (bytes 0-63) and the material ID
+    is read by the bindless fragment shader (bytes 64-67). The non-bindless fragment shader
+    doesn't declare any push constants, which is fine.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct PushConstantObject {
+    glm::mat4 model;
+    uint32_t materialId;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    What the fragment shader does, as a bit mask. Must match the FEATURE_* constants in
+    triangle.frag and triangle_bindless.frag.
+
+    The mask is a specialization constant (constant_id = 0) rather than a uniform, so the driver
+    compiles each combination as its own pipeline with the unused features stripped out, and no
+    fragment pays for a branch on them (see HelloTriangleApplication::GetPipelineVariant(...)).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+enum ShaderFeature : uint32_t {
+    SHADER_FEATURE_TEXTURED = 1 << 0,
+    SHADER_FEATURE_VERTEX_COLOR = 1 << 1,   // multiply by the vertex color
+    SHADER_FEATURE_ALPHA_TEST = 1 << 2,     // discard below 0.5 alpha
+    SHADER_FEATURE_DEBUG_UV = 1 << 3,       // show texture coordinates instead
+    SHADER_FEATURE_DEBUG_DEPTH = 1 << 4,    // show depth instead
+};
+const uint32_t SHADER_FEATURE_MASK_CONSTANT_ID = 0;
+
+// for the command line and for reports
+const std::vector<std::pair<std::string, uint32_t>> SHADER_FEATURE_NAMES{
+    { "textured", SHADER_FEATURE_TEXTURED },
+    { "vertex-color", SHADER_FEATURE_VERTEX_COLOR },
+    { "alpha-test", SHADER_FEATURE_ALPHA_TEST },
+    { "debug-uv", SHADER_FEATURE_DEBUG_UV },
+    { "debug-depth", SHADER_FEATURE_DEBUG_DEPTH },
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    "textured+vertex-color", or "none" for 0.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+std::string ShaderFeaturesToString(uint32_t features) {
+    std::string result;
+    for (const auto &feature : SHADER_FEATURE_NAMES) {
+        if (features & feature.second) {
+            result += (result.empty() ? "" : "+") + feature.first;
+        }
+    }
+    return result.empty() ? "none" : result;
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A run of consecutive triangles in the index buffer and a sphere around them, which is what
+    occlusion culling culls (see cluster_cull.comp). Must match the "Cluster" struct there
+    (std430: 32 bytes).
+
+    Note: Each submesh (see HelloTriangleApplication::BuildSceneGeometry()) is cut into
+    fixed-size clusters in index buffer order, so that a cluster has only one material. An
+    OBJ's triangles are roughly in modelling order, so neighbours in the buffer tend to be
+    neighbours in space, and the spheres come out reasonably tight.
+
+    Also Note: The clusters are per mesh, not per instance. Each instance culls its mesh's
+    clusters with its own transform (see ClusterCullInstance).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct MeshCluster {
+    glm::vec4 sphere;   // model space; xyz = center, w = radius
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t pad[2];
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Push constants for the compute shaders. Must match the "push_constant" blocks in
+    hiz_build.comp, spd_downsample.comp, and cluster_cull.comp.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct HiZBuildPushConstants {
+    glm::ivec2 srcSize;
+    glm::ivec2 dstSize;
+};
+
+struct DownsamplePushConstants {
+    glm::ivec2 srcSize;
+    uint32_t mipCount;      // 1 to DOWNSAMPLE_MAX_MIPS
+    uint32_t numGroups;
+};
+
+// spd_downsample.comp's MAX_MIPS; longer mip chains take more than one dispatch
+const uint32_t DOWNSAMPLE_MAX_MIPS = 12;
+
+struct ClusterCullPushConstants {
+    glm::ivec2 depthSize;   // of the depth buffer that the Hi-Z was built from
+    uint32_t hiZMipCount;   // 0 => no Hi-Z (frustum culling only)
+    uint32_t numDrawCommands;   // every instance's clusters; one thread each
+    uint32_t numInstances;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    One instance as cluster culling sees it: where it is, which of the clusters are its mesh's,
+    and where its run of draw commands starts. Must match the "CullInstance" struct in
+    cluster_cull.comp (std430: 80 bytes).
+
+    Note: All of them go to the GPU at once, so that every cluster of every instance is culled
+    in a single dispatch, however many instances there are.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct ClusterCullInstance {
     glm::mat4 model;
-    glm::mat4 view;
-    glm::mat4 proj;
+    uint32_t firstCluster;
+    uint32_t numClusters;
+    uint32_t firstDrawCommand;  // sorted; the instance's draws are the next numClusters commands
+    uint32_t pad;
 };
 
 /*-------------------------------------------------------------------------------------------------
@@ -172,2623 +338,11268 @@ void DestroyDebugUtilsMessengEXT(
 
 /*-------------------------------------------------------------------------------------------------
 Description:
-    Reads an entire file into a string and returns it.
+    A read-only view of a whole file, mapped into memory by the OS instead of read into a
+    buffer. Nothing is copied: pages are brought in as they are touched, and the view starts on
+    a page boundary, so it is safe to hand to anything that wants uint32_t-aligned data (ex:
+    SPIR-V in VkShaderModuleCreateInfo::pCode).
 
-    Source: http://insanecoding.blogspot.com/2011/11/how-to-read-in-file-in-c.html
-Creator:    John Cox, 11/2018
+    Move-only; the mapping is released when this goes away.
+Creator:    John Cox, 10/2026
 -------------------------------------------------------------------------------------------------*/
-std::string ReadFileIntoString(const std::string &file_path) {
-    std::ifstream in(file_path.c_str(), std::ios::in | std::ios::binary);
-    if (in) {
-        return(std::string(
-            std::istreambuf_iterator<char>(in),
-            std::istreambuf_iterator<char>()));
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            Close();
+            std::swap(mData, other.mData);
+            std::swap(mSize, other.mSize);
+        }
+        return *this;
+    }
+    ~MappedFile() {
+        Close();
     }
 
-    std::stringstream ss;
-    ss << errno;
-
-    throw std::runtime_error(ss.str());
-}
-
-/*-------------------------------------------------------------------------------------------------
-Description:
-    The class for this tutorial series.
-Creator:    John Cox, 10/2018
--------------------------------------------------------------------------------------------------*/
-class HelloTriangleApplication {
-private:
-    GLFWwindow *mWindow = nullptr;
-    uint32_t mWindowWidth = 800;
-    uint32_t mWindowHeight = 600;
-    static const size_t MAX_FRAMES_IN_FLIGHT = 2;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Returns false if the file doesn't exist, is empty, or can't be mapped.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool Open(const std::string &filePath) {
+        Close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
 
-#ifdef NDEBUG
-    const bool mEnableValidationLayers = false;
+        // Note: The view keeps the mapping (and the mapping keeps the file) alive, so both 
+        // handles can be closed right away.
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            return false;
+        }
+        mData = view;
+        mSize = static_cast<size_t>(fileSize.QuadPart);
 #else
-    const bool mEnableValidationLayers = true;
-#endif // NDEBUG
-
+        int file = open(filePath.c_str(), O_RDONLY);
+        if (file < 0) {
+            return false;
+        }
+        struct stat fileStat{};
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+            close(file);
+            return false;
+        }
 
-    VkInstance mInstance = VK_NULL_HANDLE;
-    VkDebugUtilsMessengerEXT mCallback = VK_NULL_HANDLE;
-    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
-    VkDevice mLogicalDevice = VK_NULL_HANDLE;
-    VkQueue mGraphicsQueue = VK_NULL_HANDLE;
-    VkSurfaceKHR mSurface = VK_NULL_HANDLE;
-    VkQueue mPresentationQueue = VK_NULL_HANDLE;
-    VkSwapchainKHR mSwapChain = VK_NULL_HANDLE;
-    VkFormat mSwapChainImageFormat = VkFormat::VK_FORMAT_UNDEFINED;
-    VkExtent2D mSwapChainExtent{};
-    std::vector<VkImageView> mSwapChainImageViews;
-    std::vector<VkFramebuffer> mSwapChainFramebuffers;
-    VkRenderPass mRenderPass = VK_NULL_HANDLE;
-    VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
-    VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
-    VkPipeline mGraphicsPipeline = VK_NULL_HANDLE;
-    VkCommandPool mCommandPool = VK_NULL_HANDLE;
-    std::vector<VkCommandBuffer> mCommandBuffers;
-    std::vector<VkSemaphore> mSemaphoresImageAvailable;
-    std::vector<VkSemaphore> mSemaphoresRenderFinished;
-    std::vector<VkFence> mInFlightFences;
-    size_t mCurrentFrame = 0;
-    bool mFrameBufferResized = false;   // not all drivers properly handle window resize notifications in Vulkan
+        // Note: The mapping keeps the file alive, so it can be closed right away.
+        void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        mData = view;
+        mSize = static_cast<size_t>(fileStat.st_size);
+#endif
+        return true;
+    }
 
-    std::vector<Vertex> mVertexes;
-    std::vector<uint32_t> mVertexIndices;
-    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory mVertexBufferMemory = VK_NULL_HANDLE;
-    VkBuffer mVertexIndexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory mVertexIndexBufferMemory = VK_NULL_HANDLE;
+    void Close() {
+        if (mData == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(mData);
+#else
+        munmap(mData, mSize);
+#endif
+        mData = nullptr;
+        mSize = 0;
+    }
 
-    std::vector<VkBuffer> mUniformBuffers;
-    std::vector<VkDeviceMemory> mUniformBuffersMemory;
+    const void *GetData() const {
+        return mData;
+    }
 
-    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
-    std::vector<VkDescriptorSet> mDescriptorSets;
+    size_t GetSize() const {
+        return mSize;
+    }
 
-    uint32_t mTextureMipLevels = 0;
-    VkImage mTextureImage = VK_NULL_HANDLE;
-    VkImageView mTextureImageView = VK_NULL_HANDLE;
-    VkDeviceMemory mTextureImageMemory = VK_NULL_HANDLE;
-    VkSampler mTextureSampler = VK_NULL_HANDLE;
+private:
+    void *mData = nullptr;
+    size_t mSize = 0;
+};
 
-    VkImage mDepthImage = VK_NULL_HANDLE;
-    VkDeviceMemory mDepthImageMemory = VK_NULL_HANDLE;
-    VkImageView mDepthImageView = VK_NULL_HANDLE;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    SPIR-V compiled into the executable. shaders/compile_shaders.cmd writes each shader out as
+    a C array header too (glslangValidator's --vn), and whichever of those exist at build time
+    are used instead of the .spv files, so that there is no file I/O at all.
 
+    Returns false if the given .spv file wasn't embedded.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+#if __has_include("shaders/vert_spv.h")
+#include "shaders/vert_spv.h"
+#define HAVE_EMBEDDED_VERT_SPV
+#endif
+#if __has_include("shaders/frag_spv.h")
+#include "shaders/frag_spv.h"
+#define HAVE_EMBEDDED_FRAG_SPV
+#endif
+#if __has_include("shaders/frag_bindless_spv.h")
+#include "shaders/frag_bindless_spv.h"
+#define HAVE_EMBEDDED_FRAG_BINDLESS_SPV
+#endif
+#if __has_include("shaders/depth_prepass_vert_spv.h")
+#include "shaders/depth_prepass_vert_spv.h"
+#define HAVE_EMBEDDED_DEPTH_PREPASS_VERT_SPV
+#endif
+#if __has_include("shaders/hiz_build_comp_spv.h")
+#include "shaders/hiz_build_comp_spv.h"
+#define HAVE_EMBEDDED_HIZ_BUILD_COMP_SPV
+#endif
+#if __has_include("shaders/cluster_cull_comp_spv.h")
+#include "shaders/cluster_cull_comp_spv.h"
+#define HAVE_EMBEDDED_CLUSTER_CULL_COMP_SPV
+#endif
+#if __has_include("shaders/spd_downsample_comp_spv.h")
+#include "shaders/spd_downsample_comp_spv.h"
+#define HAVE_EMBEDDED_SPD_DOWNSAMPLE_COMP_SPV
+#endif
+bool FindEmbeddedShader(const std::string &filePath, const uint32_t *&code, size_t &codeSize) {
+#ifdef HAVE_EMBEDDED_VERT_SPV
+    if (filePath == "shaders/vert.spv") {
+        code = vert_spv;
+        codeSize = sizeof(vert_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_FRAG_SPV
+    if (filePath == "shaders/frag.spv") {
+        code = frag_spv;
+        codeSize = sizeof(frag_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_FRAG_BINDLESS_SPV
+    if (filePath == "shaders/frag_bindless.spv") {
+        code = frag_bindless_spv;
+        codeSize = sizeof(frag_bindless_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_DEPTH_PREPASS_VERT_SPV
+    if (filePath == "shaders/depth_prepass_vert.spv") {
+        code = depth_prepass_vert_spv;
+        codeSize = sizeof(depth_prepass_vert_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_HIZ_BUILD_COMP_SPV
+    if (filePath == "shaders/hiz_build_comp.spv") {
+        code = hiz_build_comp_spv;
+        codeSize = sizeof(hiz_build_comp_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_CLUSTER_CULL_COMP_SPV
+    if (filePath == "shaders/cluster_cull_comp.spv") {
+        code = cluster_cull_comp_spv;
+        codeSize = sizeof(cluster_cull_comp_spv);
+        return true;
+    }
+#endif
+#ifdef HAVE_EMBEDDED_SPD_DOWNSAMPLE_COMP_SPV
+    if (filePath == "shaders/spd_downsample_comp.spv") {
+        code = spd_downsample_comp_spv;
+        codeSize = sizeof(spd_downsample_comp_spv);
+        return true;
+    }
+#endif
+    (void)filePath;
+    (void)code;
+    (void)codeSize;
+    return false;
+}
 
-    const std::vector<const char *> mRequiredDeviceExtensions{
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Hands out VkShaderModules, creating each one only once. Modules are keyed by a hash of the
+    SPIR-V itself rather than by file path, so two paths with the same code share a module, and
+    rebuilding a pipeline (ex: after a swap chain format change) reuses the modules that it was
+    built from the first time.
+
+    The SPIR-V comes from the embedded arrays if they're there (see FindEmbeddedShader(...)),
+    otherwise from memory-mapping the .spv file (see MappedFile). Either way, the code is handed
+    to the driver from where it already sits. Code compiled at runtime (see ShaderCompiler)
+    replaces either one through SetSpirv(...).
+
+    Safe to call from several threads at once (ex: background pipeline compiles).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class ShaderModuleCache {
+public:
+    void Init(VkDevice device) {
+        mDevice = device;
+    }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Encapsulates info about whether or not the necessary command queue indexes
-        (driver-specific-but-won't-change-at-runtime locations) have been acquired.
-    Creator:    John Cox, 10/2018
+        Maps the file (unless it is embedded) without creating a module. No Vulkan needed, so
+        this can happen while the device is still being created. Returns false if the file
+        isn't there.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    struct QueueFamilyIndices {
-        // can the GPU draw graphics?
-        std::optional<uint32_t> graphicsFamily;
+    bool Preload(const std::string &filePath) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return FindSource(filePath) != nullptr;
+    }
 
-        // can the GPU's driver draw to the surface that we're using?
-        std::optional<uint32_t> presentationFamily; //??"present family"??
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Uses the given code for the given path from now on, instead of the embedded or .spv
+        file version. Returns false if it is the same code as before.
 
-        bool IsComplete() {
-            return graphicsFamily.has_value() && presentationFamily.has_value();
+        Note: Modules made from the old code stay in the cache (pipelines built from them may
+        still be in use, and a change that is undone finds its module again).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool SetSpirv(const std::string &filePath, std::vector<uint32_t> spirv) {
+        Source source{};
+        source.compiled = std::move(spirv);
+        source.code = source.compiled.data();
+        source.codeSize = source.compiled.size() * sizeof(uint32_t);
+        source.hash = HashSpirv(source.code, source.codeSize);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto itr = mSources.find(filePath);
+        if (itr != mSources.end() && itr->second.hash == source.hash) {
+            return false;
         }
-    };
+
+        // Note: Moving the vector doesn't move its data, so "code" stays valid.
+        mSources[filePath] = std::move(source);
+        return true;
+    }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Windows are containers. We don't draw to windows. Window managers provide a "surface" that
-        is displayed on top of the window (and that usually encompasses less than the whole thing
-        so that we can have a border, etc.). We draw to these surfaces. To use it properly, we
-        must understand what our chosen window manager's surface support is capable of doing.
-
-        Those details are stored here.
-    Creator:    John Cox, 11/2018
+        Owned by the cache; do not destroy.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    struct SwapChainSupportDetails {
-        // min/max image count, min/max image width, min/max image height, others
-        VkSurfaceCapabilitiesKHR capabilities;
+    VkShaderModule Get(const std::string &filePath) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const Source *source = FindSource(filePath);
+        if (source == nullptr) {
+            throw std::runtime_error("failed to read shader '" + filePath + "'");
+        }
 
-        // pixel format and color space for each image
-        std::vector<VkSurfaceFormatKHR> formats;
+        auto itr = mModules.find(source->hash);
+        if (itr != mModules.end()) {
+            mNumHits++;
+            return itr->second;
+        }
 
-        // ??presentation modes?? for each image
-        std::vector<VkPresentModeKHR> presentModes;
-    };
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = source->codeSize;
+        createInfo.pCode = source->code;
 
-public:
-    void Run() {
-        InitWindow();
-        InitVulkan();
-        MainLoop();
-        Cleanup();
+        VkShaderModule shaderModule = VK_NULL_HANDLE;
+        if (vkCreateShaderModule(mDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module for '" + filePath + "'");
+        }
+        mModules[source->hash] = shaderModule;
+        return shaderModule;
     }
 
-private:
+    size_t GetNumModules() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mModules.size();
+    }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Support function for CreateInstance(). It checks ever string in the argument against the
-        extension list provided by the driver. If there is something in the required list that
-        isn't in the driver's list, an error is thrown.
-    Creator:    John Cox, 10/2018
-    ---------------------------------------------------------------------------------------------*/
-    void CheckRequiredExtensionsSupportedByDriver(const std::vector<const char *> &requiredExtensions) const {
-        uint32_t instanceExtensionCount = 0;
-        vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr);
-        std::vector<VkExtensionProperties> instanceExtensions(instanceExtensionCount);
-        vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, instanceExtensions.data());
+    uint64_t GetNumHits() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumHits;
+    }
 
-#define PRINT_EXTENSIONS
-#ifndef PRINT_EXTENSIONS
-        // carry on
-#else
-        std::stringstream ss;
-        std::string name("    Name: ");
-        std::string spec("Spec Version: ");
+    void Cleanup() {
+        for (auto &entry : mModules) {
+            vkDestroyShaderModule(mDevice, entry.second, nullptr);
+        }
+        mModules.clear();
+        mSources.clear();
+    }
 
-        //std::cout << "Instance extensions (GLFW) required:" << std::endl;
-        //ss << std::setfill(' ') << std::left;
-        //for (uint32_t i = 0; i < instanceExtensionCount; i++) {
-        //    ss << std::setw(name.length()) << name
-        //        << std::setw(40) << instanceExtensions[i].extensionName << std::endl;
-        //}
-        //std::cout << ss.str();
+private:
+    struct Source {
+        MappedFile file;    // empty if embedded or compiled
+        std::vector<uint32_t> compiled;
+        const uint32_t *code = nullptr;
+        size_t codeSize = 0;
+        uint64_t hash = 0;
+    };
 
-        ss.clear();
-        std::cout << "Instance extensions (driver) available:" << std::endl;
-        ss << std::setfill(' ') << std::left;
-        for (auto &ext : instanceExtensions) {
-            ss << std::setw(name.length()) << name
-                << std::setw(40) << ext.extensionName
-                << std::setw(spec.length()) << spec
-                << std::setw(3) << ext.specVersion << std::endl;
+    // mMutex must be held
+    const Source *FindSource(const std::string &filePath) {
+        auto itr = mSources.find(filePath);
+        if (itr != mSources.end()) {
+            return &itr->second;
         }
-        std::cout << ss.str();
-#undef PRINT_EXTENSIONS
-#endif // NDEBUG
 
-        for (auto &reqExt : requiredExtensions) {
-            bool found = false;
-            for (auto &prop : instanceExtensions) {
-                if (strcmp(reqExt, prop.extensionName) == 0) {
-                    found = true;
-                    break;
-                }
+        Source source{};
+        if (!FindEmbeddedShader(filePath, source.code, source.codeSize)) {
+            if (!source.file.Open(filePath)) {
+                return nullptr;
             }
+            source.code = static_cast<const uint32_t *>(source.file.GetData());
+            source.codeSize = source.file.GetSize();
+        }
+        if (source.codeSize % sizeof(uint32_t) != 0) {
+            throw std::runtime_error("shader '" + filePath + "' is not SPIR-V (size is not a multiple of 4)");
+        }
 
-            if (!found) {
-                std::stringstream ss;
-                ss << "Required extension '" << reqExt << "' not found in the available driver extensions";
-                throw std::runtime_error(ss.str());
-            }
+        source.hash = HashSpirv(source.code, source.codeSize);
 
+        // Note: Moving the MappedFile doesn't move the mapping, so "code" stays valid.
+        return &(mSources[filePath] = std::move(source));
+    }
+
+    // 64-bit FNV-1a, a word at a time
+    // Note: Shaders are a few KB, so this is nothing next to what the driver does with them.
+    static uint64_t HashSpirv(const uint32_t *code, size_t codeSize) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < codeSize / sizeof(uint32_t); i++) {
+            hash ^= code[i];
+            hash *= 1099511628211ull;
         }
+        return hash;
+    }
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Source> mSources;
+    std::unordered_map<uint64_t, VkShaderModule> mModules;
+    uint64_t mNumHits = 0;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Compiles GLSL to SPIR-V at runtime, so that shader edits don't need a trip through
+    shaders/compile_shaders.cmd.
+
+    The compiler is shaderc if built with USE_SHADERC (in-process, no temporary files),
+    otherwise the SDK's glslangValidator run as a separate process (found through the
+    VULKAN_SDK environment variable, or on the PATH).
+
+    Results are kept on disk, named by a hash of the source text, the stage, and the compiler,
+    so unchanged shaders are never compiled twice, even across runs.
+    Note: #include isn't followed, so an included file changing won't change the hash. None of
+    these shaders use it.
+
+    Compiling can happen right away (Compile(...)) or on this object's own thread
+    (CompileAsync(...) and then TakeFinished() every so often).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class ShaderCompiler {
+public:
+    struct Result {
+        std::string sourcePath;
+        std::vector<uint32_t> spirv;    // empty if it failed
+        std::string error;
+    };
+
+    void Init(const std::string &cacheDirectory) {
+        mCacheDirectory = cacheDirectory;
+        std::error_code error;
+        std::filesystem::create_directories(mCacheDirectory, error);
+    }
+
+    static const char *GetCompilerName() {
+#ifdef HAVE_SHADERC
+        return "shaderc";
+#else
+        return "glslangValidator";
+#endif
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Support function for CreateInstance(). Like CheckRequiredExtensionsSupportedByDriver(...),
-        but for validation layers.
-    Creator:    John Cox, 10/2018
+        Compiles (or finds in the cache) the given .vert/.frag/.comp file. Returns false and
+        says why in "error" if it doesn't compile.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CheckValidationLayersSupportedByDriver(const std::vector<const char *> &requiredLayers) const {
-        uint32_t layerCount;
-        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
-        std::vector<VkLayerProperties> availableLayers(layerCount);
-        vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
-
-#define PRINT_EXTENSIONS
-#ifndef PRINT_EXTENSIONS
-        // carry on
-#else
-        std::stringstream ss;
-        std::string name("    Name: ");
-        std::string spec("Spec Version: ");
-
-        ss.clear();
-        std::cout << "Instance validation layers (driver) available:" << std::endl;
-        ss << std::setfill(' ') << std::left;
-        for (auto &layer : availableLayers) {
-            ss << std::setw(name.length()) << name
-                << std::setw(40) << layer.layerName
-                << std::setw(spec.length()) << spec
-                << std::setw(3) << layer.specVersion << std::endl;
+    bool Compile(const std::string &sourcePath, std::vector<uint32_t> &spirv, std::string &error) {
+        std::ifstream inFile(sourcePath, std::ios::in | std::ios::binary);
+        if (!inFile.is_open()) {
+            error = "failed to open '" + sourcePath + "'";
+            return false;
         }
-        std::cout << ss.str();
-#undef PRINT_EXTENSIONS
-#endif // NDEBUG
+        std::string source((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
 
+        std::string extension = std::filesystem::path(sourcePath).extension().string();
+        if (extension != ".vert" && extension != ".frag" && extension != ".comp") {
+            error = "can't tell the shader stage of '" + sourcePath + "'";
+            return false;
+        }
 
-        for (auto reqLayer : requiredLayers) {
-            bool found = false;
-            for (auto &availableLayer : availableLayers) {
-                if (strcmp(reqLayer, availableLayer.layerName) == 0) {
-                    found = true;
-                    break;
-                }
+        // 64-bit FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (const std::string &part : { std::string(GetCompilerName()), extension, source }) {
+            for (char c : part) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 1099511628211ull;
             }
+        }
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+        std::string cachePath = (std::filesystem::path(mCacheDirectory) / (ss.str() + ".spv")).string();
 
-            if (!found) {
-                std::stringstream ss;
-                ss << "Required layer '" << reqLayer << "' not found in the available layers";
-                throw std::runtime_error(ss.str());
-            }
+        if (ReadSpirv(cachePath, spirv)) {
+            mNumCacheHits++;
+            return true;
+        }
+        if (!CompileUncached(sourcePath, source, extension, cachePath, spirv, error)) {
+            return false;
         }
+        mNumCompiled++;
+        return true;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        The function called by VK_EXT_debug_utils callback object.
-    Creator:    John Cox, 10/2018
+        Queues the file for the compile thread, which is started the first time.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
-        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-        VkDebugUtilsMessageTypeFlagsEXT messageType,
-        const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
-        void *pUserData) {
+    void CompileAsync(const std::string &sourcePath) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (std::find(mQueue.begin(), mQueue.end(), sourcePath) != mQueue.end()) {
+            return;
+        }
+        mQueue.push_back(sourcePath);
+        if (!mThread.joinable()) {
+            mThread = std::thread(&ShaderCompiler::WorkerMain, this);
+        }
+        mCondition.notify_one();
+    }
 
-        std::cerr << "validation layer [" << pCallbackData->pMessageIdName << "]: " << pCallbackData->pMessage << std::endl << std::flush;
-        return VK_FALSE;
+    std::vector<Result> TakeFinished() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<Result> finished;
+        finished.swap(mFinished);
+        return finished;
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Creates the VkInstance class member. Includes checking for extension and layer support.
-    Creator:    John Cox, 10/2018
-    ---------------------------------------------------------------------------------------------*/
-    void CreateInstance() {
-        // general info about the application
-        VkApplicationInfo appInfo{};
-        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-        appInfo.pApplicationName = "Hello Triangle";
-        appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.pEngineName = "No Engine";
-        appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    uint64_t GetNumCompiled() const {
+        return mNumCompiled;
+    }
 
-        // have to ask GLFW for info about the required extensions
-        uint32_t glfwExtensionCount = 0;
-        const char ** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-        std::vector<const char *> requiredExtensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
-        if (mEnableValidationLayers) {
-            requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-        }
+    uint64_t GetNumCacheHits() const {
+        return mNumCacheHits;
+    }
 
-        // for debugging
-        const std::vector<const char *> requiredValidationLayers{
-            "VK_LAYER_LUNARG_core_validation",
-            "VK_LAYER_LUNARG_standard_validation",
-        };
-        if (mEnableValidationLayers) {
-            CheckValidationLayersSupportedByDriver(requiredValidationLayers);
-            CheckRequiredExtensionsSupportedByDriver(requiredExtensions);
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
         }
-
-        // for printing debug info with the "debug utils" callback messenger object
-        // https://www.lunarg.com/wp-content/uploads/2018/05/Vulkan-Debug-Utils_05_18_v1.pdf
-        VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};   // default null
-        if (mEnableValidationLayers) {
-            debugCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-            debugCreateInfo.messageSeverity =
-                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-                //VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-            debugCreateInfo.messageType =
-                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-            debugCreateInfo.pfnUserCallback = DebugCallback;    // global function
-            debugCreateInfo.pUserData = nullptr;
+        mCondition.notify_all();
+        if (mThread.joinable()) {
+            mThread.join();
         }
+    }
 
-        // finally, pull all that info together to create the instance
-        VkInstanceCreateInfo instanceCreateInfo{};
-        instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-        instanceCreateInfo.pApplicationInfo = &appInfo;
-        instanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
-        instanceCreateInfo.ppEnabledExtensionNames = requiredExtensions.data();
+    ~ShaderCompiler() {
+        Shutdown();
+    }
 
-        if (mEnableValidationLayers) {
-            instanceCreateInfo.enabledLayerCount = static_cast<uint32_t>(requiredValidationLayers.size());
-            instanceCreateInfo.ppEnabledLayerNames = requiredValidationLayers.data();
-        }
+private:
+    void WorkerMain() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mCondition.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+            if (mStopping) {
+                break;
+            }
+            Result result{};
+            result.sourcePath = mQueue.front();
+            mQueue.pop_front();
+            lock.unlock();
 
-        instanceCreateInfo.pNext = &debugCreateInfo;
+            Compile(result.sourcePath, result.spirv, result.error);
 
-        if (vkCreateInstance(&instanceCreateInfo, nullptr, &mInstance) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create instance");
+            lock.lock();
+            mFinished.push_back(std::move(result));
         }
+    }
 
-        // and create the debug messenger itself
-        if (CreateDebugUtilsMessengerEXT(mInstance, &debugCreateInfo, nullptr, &mCallback) != VK_SUCCESS) {
-            throw std::runtime_error("failed to set up debug callback");
+    static bool ReadSpirv(const std::string &filePath, std::vector<uint32_t> &spirv) {
+        std::ifstream inFile(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!inFile.is_open()) {
+            return false;
         }
+        std::streamoff fileSize = inFile.tellg();
+        if (fileSize <= 0 || (fileSize % sizeof(uint32_t)) != 0) {
+            return false;
+        }
+        spirv.resize(static_cast<size_t>(fileSize) / sizeof(uint32_t));
+        inFile.seekg(0);
+        inFile.read(reinterpret_cast<char *>(spirv.data()), fileSize);
+        return inFile.good();
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        The window in an OS-specific container. You can't draw to a "window" object as designed in modern OS'. It's become a graphical paradigm that a window will have a "surface" object instead, a ??what is it??
-    Creator:    John Cox, 10/2018
-    ---------------------------------------------------------------------------------------------*/
-    void CreateSurface() {
-        if (glfwCreateWindowSurface(mInstance, mWindow, nullptr, &mSurface) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create window surface");
+    bool CompileUncached(const std::string &sourcePath, const std::string &source, const std::string &extension,
+        const std::string &cachePath, std::vector<uint32_t> &spirv, std::string &error) {
+        std::string tempPath = cachePath + ".tmp";
+#ifdef HAVE_SHADERC
+        shaderc_shader_kind kind = shaderc_glsl_vertex_shader;
+        if (extension == ".frag") {
+            kind = shaderc_glsl_fragment_shader;
+        }
+        else if (extension == ".comp") {
+            kind = shaderc_glsl_compute_shader;
         }
+        shaderc::Compiler compiler;
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+        shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, sourcePath.c_str(), options);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+            error = result.GetErrorMessage();
+            return false;
+        }
+        spirv.assign(result.cbegin(), result.cend());
+
+        std::ofstream outFile(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        outFile.write(reinterpret_cast<const char *>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        outFile.close();
+#else
+        (void)source;
+        (void)extension;
+        std::string sdkPath;
+#ifdef _WIN32
+        // Note: MSVC calls std::getenv(...) unsafe (and warnings are errors).
+        char *value = nullptr;
+        size_t valueLength = 0;
+        if (_dupenv_s(&value, &valueLength, "VULKAN_SDK") == 0 && value != nullptr) {
+            sdkPath = value;
+            free(value);
+        }
+#else
+        if (const char *value = std::getenv("VULKAN_SDK")) {
+            sdkPath = value;
+        }
+#endif
+        std::string compilerPath = "glslangValidator";
+        if (!sdkPath.empty()) {
+            compilerPath = (std::filesystem::path(sdkPath) / "bin" / "glslangValidator").string();
+        }
+        std::string logPath = cachePath + ".log";
+        std::string command = "\"" + compilerPath + "\" -V \"" + sourcePath + "\" -o \"" + tempPath + "\" > \"" + logPath + "\" 2>&1";
+#ifdef _WIN32
+        // cmd.exe strips the first and last quote off of the whole line
+        command = "\"" + command + "\"";
+#endif
+        int exitCode = std::system(command.c_str());
+        if (exitCode != 0 || !ReadSpirv(tempPath, spirv)) {
+            std::ifstream logFile(logPath);
+            error = std::string((std::istreambuf_iterator<char>(logFile)), std::istreambuf_iterator<char>());
+            if (error.empty()) {
+                error = "'" + compilerPath + "' failed (exit code " + std::to_string(exitCode) + ")";
+            }
+            std::error_code removeError;
+            std::filesystem::remove(tempPath, removeError);
+            std::filesystem::remove(logPath, removeError);
+            return false;
+        }
+        std::error_code removeError;
+        std::filesystem::remove(logPath, removeError);
+#endif
+
+        // same as the pipeline cache: write then rename, so a half-written file is never used
+        // Note: The result is good either way; not caching only costs time later.
+        std::error_code renameError;
+        std::filesystem::rename(tempPath, cachePath, renameError);
+        return true;
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Queries the provided device and checks the properties to see if it supports graphics
-        command queues. (??is there a GPU that doesn't??)
-    Creator:    John Cox, 10/2018
-    ---------------------------------------------------------------------------------------------*/
-    QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device) {
-        QueueFamilyIndices indices;
+    std::string mCacheDirectory;
+    std::atomic<uint64_t> mNumCompiled{ 0 };
+    std::atomic<uint64_t> mNumCacheHits{ 0 };
 
-        uint32_t queueFamilyCount = 0;
-        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
-        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
-        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyProperties.data());
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::string> mQueue;
+    std::vector<Result> mFinished;
+    bool mStopping = false;
+    std::thread mThread;
+};
 
-        for (uint32_t index = 0; index < queueFamilyCount; index++) {
-            const auto &queueFamilyProp = queueFamilyProperties.at(index);
-            bool queueExists = queueFamilyProp.queueCount > 0;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Tells which of a set of files have been written to since the last Poll().
 
-            bool supportsGraphics = (queueFamilyProp.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
-            if (queueExists && supportsGraphics) {
-                indices.graphicsFamily = index;
-            }
+    On Linux this is inotify on the files' directories (editors often save by writing a new
+    file and renaming it over the old one, which a watch on the file itself would lose track
+    of). Everywhere else, or if inotify isn't available, it compares modification times a few
+    times per second.
 
-            VkBool32 surfaceSupported = false;    //??"present support"? what does that mean??
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, index, mSurface, &surfaceSupported);
-            if (queueExists && surfaceSupported) {
-                indices.presentationFamily = index;
+    Poll() never blocks, so it can be called every frame.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class FileWatcher {
+public:
+    void Start(const std::vector<std::string> &filePaths) {
+        for (const auto &filePath : filePaths) {
+            std::string normalPath = std::filesystem::path(filePath).lexically_normal().string();
+            std::error_code error;
+            mLastWriteTimes[normalPath] = std::filesystem::last_write_time(normalPath, error);
+        }
+
+#ifdef __linux__
+        mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mInotifyFd >= 0) {
+            for (const auto &entry : mLastWriteTimes) {
+                std::string directory = std::filesystem::path(entry.first).parent_path().string();
+                if (directory.empty()) {
+                    directory = ".";
+                }
+                bool alreadyWatched = false;
+                for (const auto &watch : mWatchedDirectories) {
+                    alreadyWatched |= (watch.second == directory);
+                }
+                if (alreadyWatched) {
+                    continue;
+                }
+                int watch = inotify_add_watch(mInotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (watch < 0) {
+                    // fall back to polling for everything
+                    close(mInotifyFd);
+                    mInotifyFd = -1;
+                    mWatchedDirectories.clear();
+                    break;
+                }
+                mWatchedDirectories[watch] = directory;
             }
+        }
+#endif
+    }
 
-            if (indices.IsComplete()) {
-                break;
+    bool IsUsingInotify() const {
+        return mInotifyFd >= 0;
+    }
+
+    std::vector<std::string> Poll() {
+        std::set<std::string> changed;
+#ifdef __linux__
+        if (mInotifyFd >= 0) {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length = 0;
+            while ((length = read(mInotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t offset = 0; offset < length; ) {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                    offset += sizeof(inotify_event) + event->len;
+                    auto directory = mWatchedDirectories.find(event->wd);
+                    if (event->len == 0 || directory == mWatchedDirectories.end()) {
+                        continue;
+                    }
+                    std::string filePath = (std::filesystem::path(directory->second) / event->name).lexically_normal().string();
+                    if (mLastWriteTimes.count(filePath) > 0) {
+                        changed.insert(filePath);
+                    }
+                }
             }
+            return std::vector<std::string>(changed.begin(), changed.end());
         }
-        return indices;
+#endif
+        auto now = std::chrono::steady_clock::now();
+        if (now - mLastPollTime < std::chrono::milliseconds(250)) {
+            return {};
+        }
+        mLastPollTime = now;
+        for (auto &entry : mLastWriteTimes) {
+            std::error_code error;
+            auto writeTime = std::filesystem::last_write_time(entry.first, error);
+            if (!error && writeTime != entry.second) {
+                entry.second = writeTime;
+                changed.insert(entry.first);
+            }
+        }
+        return std::vector<std::string>(changed.begin(), changed.end());
+    }
+
+    void Stop() {
+#ifdef __linux__
+        if (mInotifyFd >= 0) {
+            close(mInotifyFd);
+            mInotifyFd = -1;
+        }
+#endif
+        mWatchedDirectories.clear();
+    }
+
+    ~FileWatcher() {
+        Stop();
+    }
+
+private:
+    std::map<std::string, std::filesystem::file_time_type> mLastWriteTimes;
+    std::chrono::steady_clock::time_point mLastPollTime;
+    int mInotifyFd = -1;
+    std::map<int, std::string> mWatchedDirectories;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Hands out descriptor sets from a chain of descriptor pools. When the current pool runs out of
+    space, a new (bigger) pool is created (or a previously reset one is recycled) and allocation
+    carries on from there, so the renderer is never stuck with the exact number of sets that it
+    guessed at startup.
+
+    Pools are never freed individually. Instead, ResetPools() hands every set back at once via
+    vkResetDescriptorPool(...), which is much cheaper than freeing sets one at a time. This is
+    meant for per-frame allocators: reset at the start of the frame, allocate as needed during it.
+
+    Note: Pool sizes are described as a ratio of "descriptors of this type per set", so a pool
+    made for N sets has room for (ratio * N) descriptors of each type.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class DescriptorAllocator {
+public:
+    struct PoolSizeRatio {
+        VkDescriptorType type;
+        float ratio;
+    };
+
+    void Init(VkDevice device, uint32_t initialSetsPerPool, const std::vector<PoolSizeRatio> &ratios) {
+        mDevice = device;
+        mSetsPerPool = initialSetsPerPool;
+        mRatios = ratios;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Self-explanatory.
-        TODO: ??make into a "Get" function instead? shove "Required" items into a namespace or another file??
-    Creator:    John Cox, 11/2018
+        Allocates a single descriptor set with the given layout. If the current pool is full or
+        fragmented, moves on to another pool and tries again.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    bool CheckDeviceExtensionsSupport(VkPhysicalDevice device) {
-        uint32_t extensionCount = 0;
-        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
-
-        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
-        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout) {
+        if (mCurrentPool == VK_NULL_HANDLE) {
+            mCurrentPool = GrabPool();
+        }
 
-        std::set<std::string> requiredExtensions(mRequiredDeviceExtensions.begin(), mRequiredDeviceExtensions.end());
-        for (const auto &ext : availableExtensions) {
-            requiredExtensions.erase(ext.extensionName);
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = mCurrentPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkResult result = vkAllocateDescriptorSets(mDevice, &allocateInfo, &descriptorSet);
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            // this pool is done; retire it and try once more with a fresh one
+            mFullPools.push_back(mCurrentPool);
+            mCurrentPool = GrabPool();
+            allocateInfo.descriptorPool = mCurrentPool;
+            result = vkAllocateDescriptorSets(mDevice, &allocateInfo, &descriptorSet);
         }
 
-        // if empty, all required extensions have been found
-        return requiredExtensions.empty();
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor set");
+        }
+        return descriptorSet;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        If the preferred format sRGB (B8G8R8A8 nonlinear) is available, return that. Else return
-        the first available supported image format.
+        Returns every set from every pool in one go. All descriptor sets that came out of this
+        allocator are invalid afterwards.
 
-        More on non-linear color space:
-        https://stackoverflow.com/questions/12524623/what-are-the-practical-differences-when-working-with-colors-in-a-linear-vs-a-no
-    Creator:    John Cox, 11/2018
+        Note: The caller must make sure that the GPU is no longer using any of these sets.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats) {
-        if (availableFormats.size() == 1 && availableFormats.front().format == VK_FORMAT_UNDEFINED) {
-            return {
-                VK_FORMAT_B8G8R8A8_UNORM,
-                VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
-            };
+    void ResetPools() {
+        VkDescriptorPoolResetFlags flags = 0;
+        for (auto pool : mFullPools) {
+            vkResetDescriptorPool(mDevice, pool, flags);
+            mFreePools.push_back(pool);
         }
+        mFullPools.clear();
 
-        for (const auto &available : availableFormats) {
-            if (available.format == VK_FORMAT_B8G8R8A8_UNORM &&
-                available.colorSpace == VK_COLORSPACE_SRGB_NONLINEAR_KHR) {
-                return available;
-            }
+        if (mCurrentPool != VK_NULL_HANDLE) {
+            vkResetDescriptorPool(mDevice, mCurrentPool, flags);
+            mFreePools.push_back(mCurrentPool);
+            mCurrentPool = VK_NULL_HANDLE;
         }
+    }
 
-        // preferred format not available, so just use the first supported; should be good enough
-        return availableFormats.front();
+    void Cleanup() {
+        ResetPools();
+        for (auto pool : mFreePools) {
+            vkDestroyDescriptorPool(mDevice, pool, nullptr);
+        }
+        mFreePools.clear();
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Rankings:
-        (1) Mailbox
-        (2) Immediate
-        (3) FIFO
+private:
+    // don't let pools grow without bound; past this, just keep making pools of this size
+    static const uint32_t MAX_SETS_PER_POOL = 4096;
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    uint32_t mSetsPerPool = 0;
+    std::vector<PoolSizeRatio> mRatios;
+
+    VkDescriptorPool mCurrentPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> mFullPools;
+    std::vector<VkDescriptorPool> mFreePools;
+
+    VkDescriptorPool GrabPool() {
+        if (!mFreePools.empty()) {
+            VkDescriptorPool pool = mFreePools.back();
+            mFreePools.pop_back();
+            return pool;
+        }
 
-        Note: The tutorial places "Immediate" above "FIFO", saying "Unfortunately some drivers
-        currently don't properly support VK_PRESENT_MODE_FIFO_KHR, so we should prefer
-        VK_PRESENT_MODE_IMMEDIATE_KHR if VK_PRESENT_MODE_MAILBOX_KHR is not available".
+        VkDescriptorPool pool = CreatePool(mSetsPerPool);
 
-        Mailbox can be used to implement a triple buffer => first choice.
+        // if we ran out once, we'll probably run out again, so make the next one bigger
+        mSetsPerPool = std::min(mSetsPerPool + (mSetsPerPool / 2) + 1, MAX_SETS_PER_POOL);
+        return pool;
+    }
 
-        FIFO is a simple double buffer, reminiscient of OpenGL's size 2 framebuffer. It is
-        guaranteed to be an option.
+    VkDescriptorPool CreatePool(uint32_t setCount) {
+        std::vector<VkDescriptorPoolSize> poolSizes;
+        for (const auto &r : mRatios) {
+            VkDescriptorPoolSize poolSize{};
+            poolSize.type = r.type;
+            poolSize.descriptorCount = std::max(1u, static_cast<uint32_t>(r.ratio * setCount));
+            poolSizes.push_back(poolSize);
+        }
 
-        Immediate shoves finished images to screen without waiting for screen refresh. This can
-        cause tearing => last choice.
-    Creator:    John Cox, 11/2018
-    ---------------------------------------------------------------------------------------------*/
-    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) {
-        bool immediateAvailable = false;
+        // Note: No VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT. Sets are only ever given 
+        // back wholesale via vkResetDescriptorPool(...), which lets the driver use a simple 
+        // linear allocator under the hood.
+        VkDescriptorPoolCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        createInfo.flags = 0;
+        createInfo.maxSets = setCount;
+        createInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        createInfo.pPoolSizes = poolSizes.data();
 
-        for (const auto &available : availablePresentModes) {
-            if (available == VK_PRESENT_MODE_MAILBOX_KHR) {
-                // found most preferred option; don't bother with the rest of the loop
-                return available;
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        if (vkCreateDescriptorPool(mDevice, &createInfo, nullptr, &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool");
+        }
+        return pool;
+    }
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Descriptor set layouts that describe the same bindings are interchangeable, so there's no
+    reason to create more than one of each. This cache hands back the existing layout if one with
+    the same bindings was already made, and destroys them all at cleanup.
+
+    Note: Layouts with extension structures chained onto pNext (ex: binding flags) are not
+    cached because there is no generic way to compare them. They are still created and owned by
+    the cache.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class DescriptorLayoutCache {
+public:
+    void Init(VkDevice device) {
+        mDevice = device;
+    }
+
+    VkDescriptorSetLayout CreateDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo &createInfo) {
+        if (createInfo.pNext != nullptr) {
+            VkDescriptorSetLayout layout = CreateUncached(createInfo);
+            mUncachedLayouts.push_back(layout);
+            return layout;
+        }
+
+        LayoutKey key{};
+        key.flags = createInfo.flags;
+        key.bindings.assign(createInfo.pBindings, createInfo.pBindings + createInfo.bindingCount);
+
+        // binding order in the create info doesn't matter to Vulkan, so don't let it matter here
+        std::sort(key.bindings.begin(), key.bindings.end(),
+            [](const VkDescriptorSetLayoutBinding &a, const VkDescriptorSetLayoutBinding &b) {
+            return a.binding < b.binding;
+        });
+
+        auto it = mLayoutCache.find(key);
+        if (it != mLayoutCache.end()) {
+            return it->second;
+        }
+
+        VkDescriptorSetLayout layout = CreateUncached(createInfo);
+        mLayoutCache[key] = layout;
+        return layout;
+    }
+
+    void Cleanup() {
+        for (auto &pair : mLayoutCache) {
+            vkDestroyDescriptorSetLayout(mDevice, pair.second, nullptr);
+        }
+        mLayoutCache.clear();
+        for (auto layout : mUncachedLayouts) {
+            vkDestroyDescriptorSetLayout(mDevice, layout, nullptr);
+        }
+        mUncachedLayouts.clear();
+    }
+
+private:
+    struct LayoutKey {
+        VkDescriptorSetLayoutCreateFlags flags;
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+        bool operator==(const LayoutKey &other) const {
+            if (flags != other.flags || bindings.size() != other.bindings.size()) {
+                return false;
             }
-            else if (available == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-                immediateAvailable = true;
+            for (size_t i = 0; i < bindings.size(); i++) {
+                const auto &a = bindings.at(i);
+                const auto &b = other.bindings.at(i);
+                if (a.binding != b.binding ||
+                    a.descriptorType != b.descriptorType ||
+                    a.descriptorCount != b.descriptorCount ||
+                    a.stageFlags != b.stageFlags ||
+                    a.pImmutableSamplers != b.pImmutableSamplers) {
+                    return false;
+                }
             }
+            return true;
         }
+    };
 
-        if (immediateAvailable) {
-            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey &key) const {
+            size_t result = std::hash<uint32_t>()(key.flags);
+            for (const auto &b : key.bindings) {
+                // pack the interesting parts of the binding into one 64bit value and mix it in
+                uint64_t packed =
+                    static_cast<uint64_t>(b.binding) |
+                    (static_cast<uint64_t>(b.descriptorType) << 8) |
+                    (static_cast<uint64_t>(b.descriptorCount) << 16) |
+                    (static_cast<uint64_t>(b.stageFlags) << 40);
+                result ^= std::hash<uint64_t>()(packed) + 0x9e3779b9 + (result << 6) + (result >> 2);
+            }
+            return result;
         }
-        return VK_PRESENT_MODE_FIFO_KHR;
+    };
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> mLayoutCache;
+    std::vector<VkDescriptorSetLayout> mUncachedLayouts;
+
+    VkDescriptorSetLayout CreateUncached(const VkDescriptorSetLayoutCreateInfo &createInfo) {
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        if (vkCreateDescriptorSetLayout(mDevice, &createInfo, nullptr, &layout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor set layout!");
+        }
+        return layout;
     }
+};
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        "Extent" is the resolution (width, height) of the images that are put into the swap chain.
-        This is either slightly smaller than the window's resolution (windowed mode) or equal to
-        it (usually full screen mode).
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Depth-only formats (the stencil isn't used), for the command line and for reports. Roughly 
+    cheapest first.
 
-        Note: Some window managers (GLFW included) allow the extent of the image to be
-        automatically selected by the window manager. If the window manager did not automatically
-        select the resolution (either because it couldn't or for some reason it just didn't), then
-        the "extent" is set to maximum uint32. In that case, manually clamp the resolution to the
-        size of the window.
-    Creator:    John Cox, 11/2018
-    ---------------------------------------------------------------------------------------------*/
-    VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) {
-        if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
-            // window manager will select image extent for us
-            return capabilities.currentExtent;
+    Note: There are also the formats with stencil (ex: D24_UNORM_S8_UINT), which are only used 
+    if a device has none of these (see HelloTriangleApplication::FindDepthFormat()).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+const std::vector<std::pair<std::string, VkFormat>> DEPTH_FORMAT_NAMES{
+    { "d16", VK_FORMAT_D16_UNORM },
+    { "d24", VK_FORMAT_X8_D24_UNORM_PACK32 },
+    { "d32", VK_FORMAT_D32_SFLOAT },
+};
+
+std::string DepthFormatToString(VkFormat format) {
+    for (const auto &depthFormat : DEPTH_FORMAT_NAMES) {
+        if (depthFormat.second == format) {
+            return depthFormat.first;
         }
+    }
+    if (format == VK_FORMAT_D24_UNORM_S8_UINT) {
+        return "d24s8";
+    }
+    if (format == VK_FORMAT_D32_SFLOAT_S8_UINT) {
+        return "d32s8";
+    }
+    return "unknown";
+}
 
-        int width = 0;
-        int height = 0;
-        glfwGetFramebufferSize(mWindow, &width, &height);
-        VkExtent2D actualExtent = {
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height)
-        };
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Makes a string safe to put between the quotes of a JSON string value. Quotes and
+    backslashes get a backslash, and control characters become \u00XX.
 
-        std::cout << "Extent2D width: " << width << ", height: " << height << ", window width: " << mWindowWidth << ", height: " << mWindowHeight << std::endl;
+    Note: For strings that didn't come from this program (ex: the driver's device name). Names
+    that are string literals in here don't need it.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+std::string EscapeJsonString(const std::string &str) {
+    std::stringstream ss;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            ss << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        }
+        else {
+            ss << c;
+        }
+    }
+    return ss.str();
+}
 
-        // manually clamp to window size
-        actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
-        actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
-        return actualExtent;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    The camera->clip transform.
+    - Standard: depth goes from 0 at the near plane to 1 at the far plane.
+    - Reversed-Z: depth goes from 1 at the near plane to 0 infinitely far away, so there is no
+        far plane at all (farPlaneDist is ignored).
+
+    Why? Perspective depth is proportional to 1/distance, so most of the 0-1 range is used up
+    close to the near plane and everything far away is squeezed into the bit near 1. Floats
+    are the other way around: they have the most precision close to 0. Reversed-Z puts the far
+    away stuff near 0, and the two roughly cancel out, which with a D32_SFLOAT depth buffer
+    gives about the same *relative* precision at every distance. UNORM formats are evenly
+    spaced, so it does little for them (see RunDepthPrecisionTest(...)).
+
+    Note: Like glm::perspective(...), this is right-handed (looking down -Z) with depth 0-1 (see
+    GLM_FORCE_DEPTH_ZERO_TO_ONE). The Y flip is still up to the caller.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+glm::mat4 MakeProjection(float fovY, float aspectRatio, float nearPlaneDist, float farPlaneDist, bool reversedZ) {
+    if (!reversedZ) {
+        return glm::perspective(fovY, aspectRatio, nearPlaneDist, farPlaneDist);
+    }
+
+    // [column][row]; a point at distance d ends up with clip z = near and w = d, so after the 
+    // divide, depth = near / d
+    float focalLength = 1.0f / tanf(fovY / 2.0f);
+    glm::mat4 proj(0.0f);
+    proj[0][0] = focalLength / aspectRatio;
+    proj[1][1] = focalLength;
+    proj[2][3] = -1.0f;
+    proj[3][2] = nearPlaneDist;
+    return proj;
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Settings that can be changed at startup from the command line without recompiling. See
+    ParseRuntimeOptions(...) for the argument names.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct RuntimeOptions {
+    // how many frames the CPU may get ahead of the GPU (1-4)
+    uint32_t framesInFlight = 2;
+
+    // window size, or the size of the offscreen images when headless
+    uint32_t width = 800;
+    uint32_t height = 600;
+
+    // no window, no surface, no swap chain; renders a fixed number of frames offscreen and 
+    // reports FPS (for benchmarking on machines without a display, ex: lavapipe/SwiftShader CI)
+    bool headless = false;
+    uint32_t headlessFrames = 1000;
+
+    // deterministic benchmark: camera follows a scripted path by frame number, a few warm-up 
+    // frames are thrown away, then the measured frames are written out as a JSON report
+    bool benchmark = false;
+    uint32_t benchmarkWarmupFrames = 100;
+    uint32_t benchmarkFrames = 1000;
+    std::string benchmarkReportPath = "benchmark.json";
+    std::string cameraPathFile;     // empty => built-in path
+
+    // what to load (see SceneManifest); empty => the chalet
+    std::string scenePath;
+
+    // what the fragment shader does (see ShaderFeature)
+    uint32_t shaderFeatures = SHADER_FEATURE_TEXTURED;
+
+    // headless: measure the GPU cost of every shader feature variant, N frames each
+    bool variantBenchmark = false;
+    uint32_t variantBenchmarkFrames = 300;
+    std::string variantBenchmarkReportPath = "variant_benchmark.json";
+
+    // if not set, prefer mailbox -> immediate -> FIFO
+    std::optional<VkPresentModeKHR> presentMode;
+
+    // 0 => let CreateSwapChain() pick (min + 1)
+    uint32_t swapChainImages = 0;
+
+    // low-latency pacing; a target FPS of 0 means "use the monitor's refresh rate"
+    bool lowLatency = false;
+    double targetFps = 0.0;
+
+    // render the scene at a lower resolution and upscale it whenever the GPU can't keep up; a 
+    // target of 0 means "the frame pacing target, or 60 FPS if there isn't one"
+    bool dynamicResolution = false;
+    double dynamicResolutionTargetMs = 0.0;
+    double dynamicResolutionMinScale = 0.5;
+
+    // GPU timing report every N frames (0 => only at exit) and optional per-frame CSV
+    uint32_t gpuStatsInterval = 0;
+    std::string gpuStatsCsvPath;
+
+    // CPU frame time stats; summarized every N frames, dumped as JSON on exit (empty => not 
+    // dumped)
+    uint32_t frameStatsWindow = 600;
+    std::string frameStatsJsonPath = "frame_stats.json";
+
+    // windowed mode renders on its own thread so that event handling and rendering don't 
+    // hold each other up; this turns that off for comparison
+    bool singleThreaded = false;
+
+    // startup runs as a task graph across all cores unless told to run it step by step; 
+    // either way, the per-task timings are written out as a Chrome trace (empty => not written)
+    bool serialInit = false;
+    std::string initTracePath = "init_trace.json";
+
+    // compiled pipelines are kept between runs here; empty => no cache (always cold)
+    std::string pipelineCachePath = "pipeline_cache.bin";
+
+    // every pipeline variant used in a run is listed here at exit and compiled in the 
+    // background at the next startup; empty => don't prewarm
+    std::string pipelinePrewarmPath = "pipeline_prewarm.txt";
+
+    // compile the GLSL at startup (instead of using the prebuilt .spv files) and recompile 
+    // whenever it is edited; compiled SPIR-V is kept in the cache directory
+    bool hotReload = false;
+    std::string shaderCacheDirectory = "shader_cache";
+
+    // lay down depth first with a position-only pass so that the main pass only shades what 
+    // is visible (depth test EQUAL)
+    bool depthPrepass = false;
+
+    // cull the model's clusters on the GPU against the frustum and a Hi-Z pyramid of the last 
+    // frame's depth, then draw what's left with indirect draws
+    bool hiZCulling = false;
+
+    // headless: measure each combination of the two above, N frames each
+    bool occlusionBenchmark = false;
+    uint32_t occlusionBenchmarkFrames = 300;
+    std::string occlusionBenchmarkReportPath = "occlusion_benchmark.json";
+
+    // make mip maps the old way (one blit per level, and one Hi-Z dispatch per level) instead of 
+    // with the single-pass downsampler, for comparison
+    bool blitMipMaps = false;
+
+    // depth from 1 (near) to 0 (infinitely far) instead of 0 (near) to 1 (far plane) (see 
+    // MakeProjection(...)); the far plane only applies to standard depth
+    bool reversedZ = true;
+    float nearPlane = 0.1f;
+    float farPlane = 10.0f;
+
+    // if not set, the most precise depth-only format that the device supports (see 
+    // HelloTriangleApplication::FindDepthFormat())
+    std::optional<VkFormat> depthFormat;
+
+    // no rendering: how far apart two surfaces must be at various distances to get different 
+    // depth values, for each projection and depth format (see RunDepthPrecisionTest(...))
+    bool depthPrecisionTest = false;
+    std::string depthPrecisionReportPath = "depth_precision.json";
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Low-latency frame pacing. Rather than rendering as fast as possible and letting frames pile
+    up in the swap chain (every queued frame is another frame of latency between the user moving
+    the mouse and seeing the result), the CPU is put to sleep just before it acquires the next
+    image, and is woken up as late as it can be while still making the next frame's deadline.
+
+    How late is "as late as it can be" is predicted from how long recent frames took to go from
+    wake-up to present (average plus a couple of deviations of slack). The bulk of the wait is
+    a regular sleep, but OS sleeps are coarse (1ms+ on Windows), so the last bit is a spin.
+
+    Also measures input-to-present latency: the time from when input was sampled (right after
+    waking up) until vkQueuePresentKHR(...) returned. This does not include the time that the
+    presentation engine holds on to the image afterwards (that would need something like
+    VK_GOOGLE_display_timing), but it is the part that the app controls.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void Init(bool enabled, double targetFrameMs) {
+        mEnabled = enabled && (targetFrameMs > 0.0);
+        mTargetPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(targetFrameMs));
+        mHaveDeadline = false;
+    }
+
+    bool IsEnabled() const {
+        return mEnabled;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Unlike OpenGL, which has a default framebuffer, we have to set one up manually. In Vulkan,
-        the buffer of images that the surface will pull from to swap out the current image is
-        called a "swap chain". Need to make sure that the surface can pull from a buffer created
-        by this device.
-
-        Note: Not all GPUs can do this. Computers made for blade PCs in a server rack may not even
-        have an output, and so it is unlikely that the creator of that GPU's driver would have
-        even bothered to set it up to talk with the OS' window surfaces. (??is this right??)
-    Creator:    John Cox, 11/2018
+        Blocks until it is time to start building the next frame. Returns immediately if pacing
+        is disabled.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device) {
-        SwapChainSupportDetails details;
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, mSurface, &details.capabilities);
+    void WaitForFrameStart() {
+        auto now = Clock::now();
+        auto predictedWork = PredictedWorkTime();
+        if (!mEnabled) {
+            mWakeTime = now;
+            return;
+        }
 
-        uint32_t formatCount = 0;
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, mSurface, &formatCount, nullptr);
-        if (formatCount != 0) {
-            details.formats.resize(formatCount);
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device, mSurface, &formatCount, details.formats.data());
+        if (!mHaveDeadline) {
+            mNextDeadline = now + predictedWork;
+            mHaveDeadline = true;
+        }
+        else {
+            mNextDeadline += mTargetPeriod;
         }
 
-        uint32_t presentModeCount = 0;
-        vkGetPhysicalDeviceSurfacePresentModesKHR(device, mSurface, &presentModeCount, nullptr);
-        if (presentModeCount != 0) {
-            details.presentModes.resize(presentModeCount);
-            vkGetPhysicalDeviceSurfacePresentModesKHR(device, mSurface, &presentModeCount, details.presentModes.data());
+        auto wakeTime = mNextDeadline - predictedWork;
+        if (wakeTime < now) {
+            // already late (a hitch, or the prediction was too optimistic); don't try to catch up 
+            // by rushing several frames, just re-anchor the deadlines from here
+            mNumLateFrames++;
+            mNextDeadline = now + predictedWork;
+            mWakeTime = now;
+            return;
         }
 
-        return details;
+        // sleep for most of it, then spin for the rest
+        auto spinThreshold = std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(SPIN_THRESHOLD_US));
+        if (wakeTime - now > spinThreshold) {
+            std::this_thread::sleep_until(wakeTime - spinThreshold);
+        }
+        while (Clock::now() < wakeTime) {
+            std::this_thread::yield();
+        }
+        mWakeTime = Clock::now();
+        mTotalSleepMs += std::chrono::duration<double, std::milli>(mWakeTime - now).count();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Checks if the necessary features to run this program are available on the provided GPU.
-    Creator:    John Cox, 10/2018
+        Call once input has been sampled for the frame.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    bool IsDeviceSuitable(VkPhysicalDevice device) {
-        VkPhysicalDeviceProperties deviceProperties;
-        vkGetPhysicalDeviceProperties(device, &deviceProperties);
-        bool isDiscreteGpu = (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
+    void OnInputSampled() {
+        mInputSampleTime = Clock::now();
+    }
 
-        VkPhysicalDeviceFeatures deviceFeatures;
-        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-        bool supportsGeometryShader = deviceFeatures.geometryShader;
-        bool supportsSamplerAnisotropy = deviceFeatures.samplerAnisotropy;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Call right after vkQueuePresentKHR(...) returns. Feeds the work time prediction and the
+        latency stats.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void OnFramePresented() {
+        auto now = Clock::now();
+
+        // exponential moving average of the work time and of its absolute deviation
+        double workMs = std::chrono::duration<double, std::milli>(now - mWakeTime).count();
+        if (mNumFrames == 0) {
+            mAvgWorkMs = workMs;
+            mAvgDeviationMs = 0.0;
+        }
+        else {
+            const double alpha = 0.1;
+            mAvgDeviationMs += alpha * (std::abs(workMs - mAvgWorkMs) - mAvgDeviationMs);
+            mAvgWorkMs += alpha * (workMs - mAvgWorkMs);
+        }
 
-        QueueFamilyIndices indices = FindQueueFamilies(device);
-        bool hasAllRequiredQueueFamilyIndices = indices.IsComplete();
+        double latencyMs = std::chrono::duration<double, std::milli>(now - mInputSampleTime).count();
+        mTotalLatencyMs += latencyMs;
+        mMaxLatencyMs = std::max(mMaxLatencyMs, latencyMs);
+        mNumFrames++;
+    }
 
-        bool deviceExtensionsSupported = CheckDeviceExtensionsSupport(device);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Prints what the pacer did over the life of the program.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Report() const {
+        if (mNumFrames == 0) {
+            return;
+        }
 
-        bool swapChainAdequate = false;
-        if (deviceExtensionsSupported) {
-            SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
-            swapChainAdequate =
-                !swapChainSupport.formats.empty() &&
-                !swapChainSupport.presentModes.empty();
+        double numFrames = static_cast<double>(mNumFrames);
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "Frame pacing: " << (mEnabled ? "low latency" : "off") << std::endl;
+        if (mEnabled) {
+            ss << "    Target frame:    " << std::chrono::duration<double, std::milli>(mTargetPeriod).count() << " ms" << std::endl;
+            ss << "    Avg sleep:       " << mTotalSleepMs / numFrames << " ms" << std::endl;
+            ss << "    Late frames:     " << mNumLateFrames << std::endl;
         }
+        ss << "    Predicted work:  " << std::chrono::duration<double, std::milli>(PredictedWorkTime()).count() << " ms" << std::endl;
+        ss << "    Input->present:  avg " << mTotalLatencyMs / numFrames << " ms, max " << mMaxLatencyMs << " ms" << std::endl;
+        std::cout << ss.str();
+    }
 
-        bool suitable =
-            isDiscreteGpu &&
-            supportsGeometryShader &&
-            supportsSamplerAnisotropy &&
-            hasAllRequiredQueueFamilyIndices &&
-            deviceExtensionsSupported &&
-            swapChainAdequate;
-        return suitable;
+private:
+    Clock::duration PredictedWorkTime() const {
+        // a couple of deviations of slack so that an ordinary slow frame doesn't miss
+        double predictedMs = mAvgWorkMs + 2.0 * mAvgDeviationMs;
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(predictedMs));
     }
 
+    // below this, sleep is too coarse to trust
+    static constexpr int SPIN_THRESHOLD_US = 2000;
+
+    bool mEnabled = false;
+    Clock::duration mTargetPeriod{};
+    bool mHaveDeadline = false;
+    Clock::time_point mNextDeadline;
+    Clock::time_point mWakeTime;
+    Clock::time_point mInputSampleTime;
+
+    double mAvgWorkMs = 0.0;
+    double mAvgDeviationMs = 0.0;
+
+    uint64_t mNumFrames = 0;
+    uint64_t mNumLateFrames = 0;
+    double mTotalSleepMs = 0.0;
+    double mTotalLatencyMs = 0.0;
+    double mMaxLatencyMs = 0.0;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    GPU-side timing and counters. Every frame slot (one per frame context) gets its own query
+    pools:
+    - timestamps: a pair (begin/end) for each named pass that is recorded into the frame
+    - pipeline statistics: vertex shader invocations, clipping primitives, and fragment shader
+        invocations over the frame's drawing
+
+    Results are never waited on. A frame slot's queries are read back when that slot comes
+    around again, which is after the CPU has already waited for the GPU to finish with it (that
+    is, N frames later, where N is the frame ring depth), so the results are always ready and
+    reading them doesn't stall anything.
+
+    The latest results can be had through GetLatestResults() or GetAveragePassMs(...), and
+    there is an optional rolling console report and a per-frame CSV dump.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class GpuQueryProfiler {
+public:
+    // max begin/end pairs per frame
+    static const uint32_t MAX_PASSES = 16;
+
+    struct PassResult {
+        std::string name;
+        double ms = 0.0;
+    };
+
+    struct FrameResults {
+        uint64_t frameNumber = 0;
+        std::vector<PassResult> passes;
+
+        bool hasPipelineStatistics = false;
+        uint64_t vertexShaderInvocations = 0;
+        uint64_t clippingPrimitives = 0;
+        uint64_t fragmentShaderInvocations = 0;
+    };
+
     /*---------------------------------------------------------------------------------------------
     Description:
-        Sets the GPU that will be used for the rest of the program.
-    Creator:    John Cox, 10/2018
+        Creates the query pools for every frame slot. If the queue family can't do timestamps
+        or the device can't do pipeline statistics, those parts are quietly skipped.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void PickPhysicalDevice() {
-        uint32_t deviceCount = 0;
-        vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
-        if (deviceCount == 0) {
-            throw std::runtime_error("failed to find GPUs with Vulkan support");
-        }
+    void Init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t numFrameSlots, bool pipelineStatisticsEnabled) {
+        mDevice = device;
 
-        std::vector<VkPhysicalDevice> devices(deviceCount);
-        vkEnumeratePhysicalDevices(mInstance, &deviceCount, devices.data());
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+        mTimestampPeriodNs = deviceProperties.limits.timestampPeriod;
 
-        // take the first one that Vulkan can use
-        for (const auto &dev : devices) {
-            if (IsDeviceSuitable(dev)) {
-                mPhysicalDevice = dev;
-                break;
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        uint32_t validBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+        mTimestampsSupported = (validBits > 0);
+        mTimestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+        mPipelineStatisticsSupported = pipelineStatisticsEnabled;
+
+        mFrameSlots.resize(numFrameSlots);
+        for (auto &slot : mFrameSlots) {
+            if (mTimestampsSupported) {
+                VkQueryPoolCreateInfo createInfo{};
+                createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                createInfo.queryCount = MAX_PASSES * 2;
+                if (vkCreateQueryPool(mDevice, &createInfo, nullptr, &slot.timestampPool) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create timestamp query pool");
+                }
+            }
+
+            if (mPipelineStatisticsSupported) {
+                VkQueryPoolCreateInfo createInfo{};
+                createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                createInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+                createInfo.queryCount = 1;
+                createInfo.pipelineStatistics = PIPELINE_STATISTICS_FLAGS;
+                if (vkCreateQueryPool(mDevice, &createInfo, nullptr, &slot.statisticsPool) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create pipeline statistics query pool");
+                }
             }
         }
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        A logical device seems to be the C-based Vulkan's version of a "base class" that
-        implements common functions regardless of the physical device.
-    Creator:    John Cox, 10/2018
+        Rolling console report every "reportInterval" frames (0 => never) and/or a CSV file with
+        one line per frame (empty path => none).
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateLogicalDevice() {
-        float queuePriority = 1.0f;
-        QueueFamilyIndices indices = FindQueueFamilies(mPhysicalDevice);
+    void SetReporting(uint32_t reportInterval, const std::string &csvPath) {
+        mReportInterval = reportInterval;
+        if (!csvPath.empty()) {
+            mCsvFile.open(csvPath, std::ios::out | std::ios::trunc);
+            if (!mCsvFile.is_open()) {
+                throw std::runtime_error("failed to open '" + csvPath + "' for GPU stats");
+            }
+        }
+    }
 
-        std::vector<VkDeviceQueueCreateInfo> deviceCommandQueuesCreateInfo;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Reads back whatever the given frame slot recorded the last time that it was used.
+        Returns true if there was something to read (see GetLatestResults()).
 
-        // Note: Graphics command queues on dedicated graphics cards will also be accepted by the 
-        // OS as being able to draw to a surface. This is not always the case across all graphics 
-        // devices and all OSs. This tutorial is being done on an NVidia GTX 980 TI, who's 
-        // graphics commands queue can put out results to a surface. For design reasons, we are 
-        // keeping the "graphics queue" and the "presentation queue" two queues in separate 
-        // structures, but they are actually the same thing. When creating a logical device, we 
-        // need to tell it how many *unique* command queues it has, hence std::set(...). I could 
-        // certainly hard-code the use of one of them and move one, but this verbose approach is 
-        // better for a tutorial.
-        std::set<uint32_t> uniqueQueueFamiliesIndices{
-            indices.graphicsFamily.value(),
-            indices.presentationFamily.value()
-        };
-        for (const auto &queueFamilyIndex : uniqueQueueFamiliesIndices) {
-            VkDeviceQueueCreateInfo createInfo{};
-            createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-            createInfo.queueFamilyIndex = queueFamilyIndex;
-            createInfo.queueCount = 1;
-            createInfo.pQueuePriorities = &queuePriority;   //??same priority??
-            deviceCommandQueuesCreateInfo.push_back(createInfo);
+        Note: Call only after the GPU is known to be done with the slot (ex: after waiting on the
+        frame context's timeline value). The results are then guaranteed to be available, so this
+        does not pass VK_QUERY_RESULT_WAIT_BIT.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool CollectResults(uint32_t frameSlot) {
+        FrameSlot &slot = mFrameSlots.at(frameSlot);
+        if (!slot.recorded) {
+            return false;
+        }
+        slot.recorded = false;
+
+        FrameResults results{};
+        results.frameNumber = slot.frameNumber;
+
+        uint32_t numPasses = static_cast<uint32_t>(slot.passNames.size());
+        if (mTimestampsSupported && numPasses > 0) {
+            std::vector<uint64_t> timestamps(numPasses * 2, 0);
+            VkResult result = vkGetQueryPoolResults(mDevice, slot.timestampPool, 0, numPasses * 2,
+                timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_SUCCESS) {
+                for (uint32_t i = 0; i < numPasses; i++) {
+                    uint64_t ticks = (timestamps.at(i * 2 + 1) - timestamps.at(i * 2)) & mTimestampMask;
+                    PassResult pass{};
+                    pass.name = slot.passNames.at(i);
+                    pass.ms = static_cast<double>(ticks) * mTimestampPeriodNs / 1000000.0;
+                    results.passes.push_back(pass);
+                }
+            }
         }
 
-        // don't need any features yet, so leave it blank for now
-        VkPhysicalDeviceFeatures deviceFeatures{};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
-        //deviceFeatures.fillModeNonSolid = VK_TRUE;
+        if (mPipelineStatisticsSupported && slot.statisticsRecorded) {
+            // one value per enabled statistic, in bit order
+            std::array<uint64_t, 3> counters{};
+            VkResult result = vkGetQueryPoolResults(mDevice, slot.statisticsPool, 0, 1,
+                sizeof(counters), counters.data(), sizeof(counters), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_SUCCESS) {
+                results.hasPipelineStatistics = true;
+                results.vertexShaderInvocations = counters.at(0);
+                results.clippingPrimitives = counters.at(1);
+                results.fragmentShaderInvocations = counters.at(2);
+            }
+        }
 
-        VkDeviceCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        createInfo.queueCreateInfoCount = static_cast<uint32_t>(deviceCommandQueuesCreateInfo.size());
-        createInfo.pQueueCreateInfos = deviceCommandQueuesCreateInfo.data();
-        createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(mRequiredDeviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = mRequiredDeviceExtensions.data();
+        mLatestResults = results;
+        Accumulate(results);
+        WriteCsvLine(results);
+        mNumCollectedFrames++;
+        if (mReportInterval > 0 && (mNumCollectedFrames % mReportInterval) == 0) {
+            Report(std::cout);
+            mRollingPassTotals.clear();
+            mNumRollingFrames = 0;
+        }
+        return true;
+    }
 
-        if (vkCreateDevice(mPhysicalDevice, &createInfo, nullptr, &mLogicalDevice) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create logical device");
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Resets the slot's queries. Must be recorded outside of a render pass and before any
+        BeginPass(...) in the same command buffer.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameNumber) {
+        mCurrentSlot = frameSlot;
+        FrameSlot &slot = mFrameSlots.at(frameSlot);
+        slot.frameNumber = frameNumber;
+        slot.passNames.clear();
+        slot.statisticsRecorded = false;
+        if (mTimestampsSupported) {
+            vkCmdResetQueryPool(commandBuffer, slot.timestampPool, 0, MAX_PASSES * 2);
+        }
+        if (mPipelineStatisticsSupported) {
+            vkCmdResetQueryPool(commandBuffer, slot.statisticsPool, 0, 1);
         }
+    }
 
-        // and retrieve the command queue that was created with it (based on createInfo)
-        // Note: Only created one command queue with the device, so use index 0.
-        // Also Note: Not to be confused with queueFamilyIndex, which is physical-device-specific.
-        // Gah.
-        uint32_t queueIndex = 0;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Starts timing a pass. Returns a handle for EndPass(...).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint32_t BeginPass(VkCommandBuffer commandBuffer, const std::string &name) {
+        FrameSlot &slot = mFrameSlots.at(mCurrentSlot);
+        if (slot.passNames.size() >= MAX_PASSES) {
+            throw std::runtime_error("too many GPU profiler passes in one frame");
+        }
 
-        // if the graphics queue's family also supported surface drawing, then both queues will have the same handle now (??isn't that a bad thing??)
-        vkGetDeviceQueue(mLogicalDevice, indices.graphicsFamily.value(), queueIndex, &mGraphicsQueue);
-        vkGetDeviceQueue(mLogicalDevice, indices.presentationFamily.value(), queueIndex, &mPresentationQueue);
+        uint32_t passIndex = static_cast<uint32_t>(slot.passNames.size());
+        slot.passNames.push_back(name);
+        if (mTimestampsSupported) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.timestampPool, passIndex * 2);
+        }
+        return passIndex;
+    }
+
+    void EndPass(VkCommandBuffer commandBuffer, uint32_t passIndex) {
+        FrameSlot &slot = mFrameSlots.at(mCurrentSlot);
+        if (mTimestampsSupported) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, slot.timestampPool, passIndex * 2 + 1);
+        }
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Rather than the simple "swap" functionality of OpenGL, which had a default "framebuffer"
-        with "front" and "back" buffers (where "buffer" means "a pixel array"), Vulkan's
-        framebuffer requires more setup and puts in place a "swap chain", which is a set of image
-        buffers that can be swapped out as desired. This "chain" (??is it a linked list??) has more flexibility than OpenGL's framebuffer.
+        Pipeline statistics over everything in between. One pair per frame.
 
-        There is a minimum and maximum size to this swap chain. When the window manager's creators
-        implemented Vulkan support on the window's drawing surface, they determined these values.
-        We just need to query them.
-    Creator:    John Cox, 11/2018
+        Note: If begun inside a render pass, it must also end inside the same subpass, so the
+        simplest thing is to wrap the whole render pass.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateSwapChain() {
-        SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(mPhysicalDevice);
-        VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.formats);
-        VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes);
-        VkExtent2D extent = ChooseSwapExtent(swapChainSupport.capabilities);
+    void BeginStatistics(VkCommandBuffer commandBuffer) {
+        if (mPipelineStatisticsSupported) {
+            VkQueryControlFlags flags = 0;
+            vkCmdBeginQuery(commandBuffer, mFrameSlots.at(mCurrentSlot).statisticsPool, 0, flags);
+        }
+    }
 
-        // attempt to allocate enough images for a triple buffer
-        // Note: Min image count should always be 2 (minimum required for present mode FIFO 
-        // (simple double buffer), which is always available). For a triple buffer, we want the 
-        // min image count to be 3.
-        uint32_t createMinImageCount = swapChainSupport.capabilities.minImageCount + 1;
-        if (swapChainSupport.capabilities.maxImageCount == 0) {
-            // indicates no limit for swap chain size aside from memory
+    void EndStatistics(VkCommandBuffer commandBuffer) {
+        if (mPipelineStatisticsSupported) {
+            vkCmdEndQuery(commandBuffer, mFrameSlots.at(mCurrentSlot).statisticsPool, 0);
+            mFrameSlots.at(mCurrentSlot).statisticsRecorded = true;
         }
-        else {
-            // there is a constraint aside from memory
-            // Note: The count is unsigned, so implicitly this means "> 0".
-            if (createMinImageCount > swapChainSupport.capabilities.maxImageCount) {
-                // it seems that max image count == min image count; clamp "min" to prevent errors
-                createMinImageCount = swapChainSupport.capabilities.maxImageCount;
-            }
-            else {
-                // no problem with minimum 3 images
+    }
+
+    // call after the frame's command buffer is done recording
+    void EndFrame() {
+        mFrameSlots.at(mCurrentSlot).recorded = true;
+    }
+
+    const FrameResults &GetLatestResults() const {
+        return mLatestResults;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Average GPU time of the named pass over the whole run (0 if never seen).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    double GetAveragePassMs(const std::string &name) const {
+        auto itr = mTotalPassMs.find(name);
+        if (itr == mTotalPassMs.end() || mNumCollectedFrames == 0) {
+            return 0.0;
+        }
+        return itr->second / static_cast<double>(mNumCollectedFrames);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Prints the average of each pass since the last report along with the latest counters.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Report(std::ostream &out) const {
+        if (mNumRollingFrames == 0) {
+            return;
+        }
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "GPU (avg of " << mNumRollingFrames << " frames):";
+        for (const auto &passName : mPassOrder) {
+            auto itr = mRollingPassTotals.find(passName);
+            if (itr != mRollingPassTotals.end()) {
+                ss << " " << passName << " " << itr->second / static_cast<double>(mNumRollingFrames) << " ms;";
             }
         }
+        if (mLatestResults.hasPipelineStatistics) {
+            ss << " VS " << mLatestResults.vertexShaderInvocations
+                << ", clip prims " << mLatestResults.clippingPrimitives
+                << ", FS " << mLatestResults.fragmentShaderInvocations;
+        }
+        out << ss.str() << std::endl;
+    }
 
-        // 1 layer per image in the swapchain unless doing stereoscopic 3D, in which case there 
-        // will be 2 layers, one for each eye, that get pushed out the swap chain simultaneously
-        uint32_t numImageLayers = 1;
+    void Cleanup() {
+        for (auto &slot : mFrameSlots) {
+            if (slot.timestampPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(mDevice, slot.timestampPool, nullptr);
+            }
+            if (slot.statisticsPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(mDevice, slot.statisticsPool, nullptr);
+            }
+        }
+        mFrameSlots.clear();
+        if (mCsvFile.is_open()) {
+            mCsvFile.close();
+        }
+    }
 
-        // will draw directly to an image in the swap chain
-        // Note: If doing post-processing, will need to create one swap chain with 
-        // VK_IMAGE_USAGE_TRANSFER_SRC_BIT, create another swap chain with 
-        // VK_IMAGE_USAGE_TRANSFER_DST_BIT, and use a memory operation to transfer the rendered 
-        // image from the "source" swap chain to the "destination" swap chain.
-        VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+private:
+    void Accumulate(const FrameResults &results) {
+        for (const auto &pass : results.passes) {
+            if (mTotalPassMs.find(pass.name) == mTotalPassMs.end()) {
+                mPassOrder.push_back(pass.name);
+            }
+            mTotalPassMs[pass.name] += pass.ms;
+            mRollingPassTotals[pass.name] += pass.ms;
+        }
+        mNumRollingFrames++;
+    }
 
-        VkSwapchainCreateInfoKHR createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-        createInfo.surface = mSurface;
-        createInfo.minImageCount = createMinImageCount;
-        createInfo.imageFormat = surfaceFormat.format;
-        createInfo.imageColorSpace = surfaceFormat.colorSpace;
-        createInfo.imageExtent = extent;
-        createInfo.imageArrayLayers = numImageLayers;
-        createInfo.imageUsage = imageUsage;
+    void WriteCsvLine(const FrameResults &results) {
+        if (!mCsvFile.is_open()) {
+            return;
+        }
 
-        //???what does this sentence mean: "we need to specify how to handle swap chain images that will be used across multiple queue families"??
-        QueueFamilyIndices indices = FindQueueFamilies(mPhysicalDevice);
-        if (indices.graphicsFamily == indices.presentationFamily) {
-            // Note: Default "exclusive", meaning that only one queue family can access the swap 
-            // chain at a time. This allows Vulkan to optimize and is thus the most efficient.
+        // Note: The header is written lazily because the pass names aren't known until the 
+        // first frame comes back.
+        if (!mCsvHeaderWritten) {
+            mCsvFile << "frame";
+            for (const auto &pass : results.passes) {
+                mCsvFile << "," << pass.name << "_ms";
+            }
+            mCsvFile << ",vs_invocations,clipping_primitives,fs_invocations" << std::endl;
+            mCsvHeaderWritten = true;
         }
-        else {
-            // both the graphics queue family and the presentation queue family need to use this 
-            // swap chain; this is the tutorial's way of handling it for now, saying that it will 
-            // do something more latter
-            uint32_t queueFamilyIndices[]{
-                indices.graphicsFamily.value(),
-                indices.presentationFamily.value()
-            };
-            createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-            createInfo.queueFamilyIndexCount = 2;
-            createInfo.pQueueFamilyIndices = queueFamilyIndices;
+
+        mCsvFile << results.frameNumber;
+        for (const auto &pass : results.passes) {
+            mCsvFile << "," << pass.ms;
         }
+        mCsvFile << "," << results.vertexShaderInvocations
+            << "," << results.clippingPrimitives
+            << "," << results.fragmentShaderInvocations << "\n";
+    }
 
-        // Note: We can bake a transform (90 degree clockwise rotation, horizontal flip, etc.) 
-        // into the swap chain. For example, a fish-eye transform can be run on the image before 
-        // the image gets sent to a VR headset.
-        createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
+    static const VkQueryPipelineStatisticFlags PIPELINE_STATISTICS_FLAGS =
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+    struct FrameSlot {
+        VkQueryPool timestampPool = VK_NULL_HANDLE;
+        VkQueryPool statisticsPool = VK_NULL_HANDLE;
+        std::vector<std::string> passNames;
+        bool statisticsRecorded = false;
+        bool recorded = false;
+        uint64_t frameNumber = 0;
+    };
 
-        // set to opaque unless you want to make the window surface transluscent (might want to do 
-        // this in mobile GUIs)
-        createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    VkDevice mDevice = VK_NULL_HANDLE;
+    bool mTimestampsSupported = false;
+    bool mPipelineStatisticsSupported = false;
+    float mTimestampPeriodNs = 1.0f;
+    uint64_t mTimestampMask = ~0ull;
+    std::vector<FrameSlot> mFrameSlots;
+    uint32_t mCurrentSlot = 0;
+
+    FrameResults mLatestResults;
+    uint64_t mNumCollectedFrames = 0;
+    std::vector<std::string> mPassOrder;
+    std::unordered_map<std::string, double> mTotalPassMs;
+    std::unordered_map<std::string, double> mRollingPassTotals;
+    uint32_t mNumRollingFrames = 0;
+
+    uint32_t mReportInterval = 0;
+    std::ofstream mCsvFile;
+    bool mCsvHeaderWritten = false;
+};
 
-        // retrieved earlier
-        createInfo.presentMode = presentMode;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    CPU-side frame timing. DrawFrame() marks the end of each of its phases (wait for the frame
+    context, pacing/input, acquire, update, record, submit, present) and the timestamps land in
+    a fixed-size ring of records. Recording is a handful of clock reads and stores, with no locks
+    and no allocation.
 
-        // if a region of the surface is not visible (ex: another window is in front of this one), 
-        // discard the obscured pixels
-        createInfo.clipped = VK_TRUE;
+    Note: Only the thread that records frames reads the ring. Copying records out from another
+    thread while they're being written would need a sequence number per record (a seqlock).
 
-        // Note: If a swap chain becomes invalid at runtime (ex: window resized, so image extents 
-        // are no longer valid), then need to recreate the swap chain from scratch. We'll deal 
-        // with that later. For now (11/3/2018), our GLFW window size is fixed.
-        createInfo.oldSwapchain = VK_NULL_HANDLE;
+    Every "window" frames, the last window's frame times are summarized (p50/p95/p99/max, hitch
+    count, per-phase averages). The whole run also goes into a histogram so that percentiles
+    for the entire run can be had without keeping every frame. All of it is dumped as JSON on
+    exit.
 
-        // all that leads up to this
-        if (vkCreateSwapchainKHR(mLogicalDevice, &createInfo, nullptr, &mSwapChain) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create swap chain");
-        }
+    A "hitch" is a frame that took more than twice as long as the window's median.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Phase : uint32_t {
+        PHASE_WAIT = 0,     // waiting on the GPU to retire the frame context
+        PHASE_PACE,         // frame pacing sleep and input polling
+        PHASE_ACQUIRE,
+        PHASE_UPDATE,       // command pool/descriptor reset, UBO update
+        PHASE_RECORD,
+        PHASE_SUBMIT,
+        PHASE_PRESENT,
+        NUM_PHASES
+    };
 
-        // Note: Cannot create space for the images in the swap chain prior to creating it because 
-        // the create info only specifies "minimum" image count. Vulkan is allowed to create more 
-        // than that (I don't know why it would, but it can, and need to account for it).
-        uint32_t imageCount = 0;
-        vkGetSwapchainImagesKHR(mLogicalDevice, mSwapChain, &imageCount, nullptr);
-        std::vector<VkImage> swapChainImages(imageCount, VK_NULL_HANDLE);
-        vkGetSwapchainImagesKHR(mLogicalDevice, mSwapChain, &imageCount, swapChainImages.data());
+    struct FrameRecord {
+        uint64_t frameNumber = 0;
+        int64_t startNs = 0;
+        int64_t intervalNs = 0;     // start of previous frame -> start of this one
+        std::array<int64_t, NUM_PHASES> phaseEndNs{};
+    };
 
-        // store these for later
-        mSwapChainImageFormat = surfaceFormat.format;
-        mSwapChainExtent = extent;
+    // must be a power of 2
+    static constexpr uint32_t RING_SIZE = 4096;
+
+    struct WindowSummary {
+        uint64_t firstFrame = 0;
+        uint32_t numFrames = 0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        uint32_t numHitches = 0;
+        std::array<double, NUM_PHASES> avgPhaseMs{};
+    };
 
-        // create a "view" for each image
-        // Note: A "view" tells Vulkan how to handle the array of data that we generically call 
-        // "image". Not every "image" is a finished drawing. It may be a rendering from a 
-        // particular point of view and will be used as a texture, or it may be a lighting map 
-        // with simple intensity values, or it could simply be a finished array of pixel colors.
-        mSwapChainImageViews.resize(swapChainImages.size());
-        for (size_t i = 0; i < swapChainImages.size(); i++) {
-            uint32_t mipLevels = 1;
-            mSwapChainImageViews.at(i) = CreateImageView(swapChainImages.at(i), mSwapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    FrameProfiler() :
+        mRecords(RING_SIZE) {
+    }
+
+    void Init(uint32_t windowSize) {
+        mWindowSize = std::max(1u, std::min(windowSize, RING_SIZE));
+        mRecordingOverheadNs = MeasureRecordingOverhead();
+    }
+
+    void BeginFrame(uint64_t frameNumber) {
+        uint64_t count = mWriteCount;
+        FrameRecord &record = mRecords[count & (RING_SIZE - 1)];
+        record.frameNumber = frameNumber;
+        record.startNs = NowNs();
+        record.intervalNs = (mLastStartNs == 0) ? 0 : (record.startNs - mLastStartNs);
+        mLastStartNs = record.startNs;
+        mLastPhase = 0;
+    }
+
+    void EndPhase(Phase phase) {
+        uint64_t count = mWriteCount;
+        FrameRecord &record = mRecords[count & (RING_SIZE - 1)];
+        int64_t now = NowNs();
+
+        // phases that were skipped (ex: early out on an out-of-date swap chain) take 0 time
+        for (uint32_t i = mLastPhase; i < phase; i++) {
+            record.phaseEndNs[i] = (i == 0) ? record.startNs : record.phaseEndNs[i - 1];
         }
+        record.phaseEndNs[phase] = now;
+        mLastPhase = phase + 1;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        This code is used during swap chain recreation, so it was moved from program-end Cleanup()
-        to here.
-    Creator:    John Cox, 12/2018
+        Publishes the frame's record, feeds the whole-run histogram, and summarizes the window
+        if this frame completed one.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CleanupSwapChain() {
-        // not necessary to destroy in reverse order of creation since they are all created off 
-        // the logical device and will not complain when destroyed out of order unless the logical 
-        // device is destroyed first, but I'm doing it anyway because it looks orderly
-        vkFreeCommandBuffers(mLogicalDevice, mCommandPool, static_cast<uint32_t>(mCommandBuffers.size()), mCommandBuffers.data());
-        for (auto &framebuffer : mSwapChainFramebuffers) {
-            vkDestroyFramebuffer(mLogicalDevice, framebuffer, nullptr);
+    void EndFrame() {
+        uint64_t count = mWriteCount;
+        FrameRecord &record = mRecords[count & (RING_SIZE - 1)];
+        for (uint32_t i = mLastPhase; i < NUM_PHASES; i++) {
+            record.phaseEndNs[i] = (i == 0) ? record.startNs : record.phaseEndNs[i - 1];
         }
-        vkDestroyImageView(mLogicalDevice, mDepthImageView, nullptr);
-        vkDestroyImage(mLogicalDevice, mDepthImage, nullptr);
-        vkFreeMemory(mLogicalDevice, mDepthImageMemory, nullptr);
-        vkDestroyPipeline(mLogicalDevice, mGraphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(mLogicalDevice, mPipelineLayout, nullptr);
-        vkDestroyRenderPass(mLogicalDevice, mRenderPass, nullptr);
-        for (auto &imageView : mSwapChainImageViews) {
-            vkDestroyImageView(mLogicalDevice, imageView, nullptr);
+        mWriteCount = count + 1;
+
+        // the very first frame has no interval
+        if (record.intervalNs > 0) {
+            double ms = static_cast<double>(record.intervalNs) / 1000000.0;
+            size_t bucket = std::min(static_cast<size_t>(ms / HISTOGRAM_BUCKET_MS), mHistogram.size() - 1);
+            mHistogram[bucket]++;
+            mNumHistogramFrames++;
+            mRunMaxMs = std::max(mRunMaxMs, ms);
+        }
+
+        if (((count + 1) % mWindowSize) == 0) {
+            SummarizeWindow(count + 1);
+        }
+    }
+
+    const std::vector<WindowSummary> &GetWindowSummaries() const {
+        return mWindowSummaries;
+    }
+
+    double GetRunPercentileMs(double percentile) const {
+        if (mNumHistogramFrames == 0) {
+            return 0.0;
+        }
+
+        uint64_t target = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(mNumHistogramFrames)));
+        uint64_t runningTotal = 0;
+        for (size_t i = 0; i < mHistogram.size(); i++) {
+            runningTotal += mHistogram[i];
+            if (runningTotal >= target) {
+                // report the top of the bucket; pessimistic by at most one bucket
+                return std::min((i + 1) * HISTOGRAM_BUCKET_MS, mRunMaxMs);
+            }
         }
-        vkDestroySwapchainKHR(mLogicalDevice, mSwapChain, nullptr);
+        return mRunMaxMs;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        During window resizing, image extent is no longer valid, and therefore the swap chain
-        create info is no longer valid, and neither are the image views, or the render pass, or
-        anything downstream that depended upon image extent.
-    Creator:    John Cox, 12/2018
+        One-line console summary of the whole run.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void RecreateSwapChain() {
-        int width = 0;
-        int height = 0;
-        while (width == 0 || height == 0) {
-            std::cout << "Waiting on frame buffer" << std::endl;
-            glfwGetFramebufferSize(mWindow, &width, &height);
-            glfwWaitEvents();
+    void Report() const {
+        uint32_t numHitches = 0;
+        for (const auto &window : mWindowSummaries) {
+            numHitches += window.numHitches;
         }
-        vkDeviceWaitIdle(mLogicalDevice);
 
-        CleanupSwapChain();
-
-        CreateSwapChain();
-        CreateRenderPass();
-        // Note: Not recreating the descriptor set layout because those are independent of image.
-        CreateGraphicsPipeline();
-        CreateDepthResources();
-        CreateFramebuffers();
-        CreateCommandBuffers();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "Frame times: p50 " << GetRunPercentileMs(0.50)
+            << " ms, p95 " << GetRunPercentileMs(0.95)
+            << " ms, p99 " << GetRunPercentileMs(0.99)
+            << " ms, max " << mRunMaxMs
+            << " ms, " << numHitches << " hitches"
+            << " (recording overhead ~" << mRecordingOverheadNs << " ns/frame)" << std::endl;
+        std::cout << ss.str();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        At this time (1/12/2019) in the tutorial (Texture Mapping: Image view and sampler), the
-        image view create is mostly the same, so while image creation is special, image view
-        creation is not. We are not using images for depth, which require a different type of
-        image view.
-    Creator:    John Cox, 11/2018
-    ---------------------------------------------------------------------------------------------*/
-    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
-        VkImageViewCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        createInfo.image = image;
-        createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        createInfo.format = format;
+        Dumps the run summary and every window summary to a JSON file.
 
-        // we could mess with the mappings of components.r, components.g, etc. and set all 
-        // color components in the view to be "red" (VK_COMPONENT_SWIZZLE_R), thus giving us a 
-        // monochrome red shade, or we could leave them at their default values 
-        // (VK_COMPONENT_SWIZZLE_IDENTITY = 0), which is what we're going to do here 
-        // Note: I could ignore this completely since structure creation with {} makes them all 0, 
-        // but for the sake fo the tutorial, I will be explicit.
-        createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-        createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-        createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-        createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+        Note: Failing to write it is reported, not thrown. The run itself went fine, and it's
+        only a report.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void WriteJson(const std::string &filePath) const {
+        std::ofstream outFile(filePath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cout << "Frame stats: failed to open '" << filePath << "'; not saved" << std::endl;
+            return;
+        }
 
-        // no mip mapping, and 1 layer (stereoscopic 3D needs 2 layers (??I think??))
-        createInfo.subresourceRange.aspectMask = aspectFlags;
-        createInfo.subresourceRange.baseMipLevel = 0;
-        createInfo.subresourceRange.levelCount = mipLevels;
-        createInfo.subresourceRange.baseArrayLayer = 0;
-        createInfo.subresourceRange.layerCount = 1;
-
-        VkImageView view = VK_NULL_HANDLE;
-        if (vkCreateImageView(mLogicalDevice, &createInfo, nullptr, &view) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create image views");
+        outFile << std::fixed << std::setprecision(4);
+        outFile << "{\n";
+        outFile << "  \"recordingOverheadNs\": " << mRecordingOverheadNs << ",\n";
+        outFile << "  \"windowSize\": " << mWindowSize << ",\n";
+        outFile << "  \"run\": { \"frames\": " << mNumHistogramFrames
+            << ", \"p50Ms\": " << GetRunPercentileMs(0.50)
+            << ", \"p95Ms\": " << GetRunPercentileMs(0.95)
+            << ", \"p99Ms\": " << GetRunPercentileMs(0.99)
+            << ", \"maxMs\": " << mRunMaxMs << " },\n";
+        outFile << "  \"windows\": [\n";
+        for (size_t i = 0; i < mWindowSummaries.size(); i++) {
+            const WindowSummary &window = mWindowSummaries[i];
+            outFile << "    { \"firstFrame\": " << window.firstFrame
+                << ", \"frames\": " << window.numFrames
+                << ", \"p50Ms\": " << window.p50Ms
+                << ", \"p95Ms\": " << window.p95Ms
+                << ", \"p99Ms\": " << window.p99Ms
+                << ", \"maxMs\": " << window.maxMs
+                << ", \"hitches\": " << window.numHitches
+                << ", \"phasesMs\": {";
+            for (uint32_t phase = 0; phase < NUM_PHASES; phase++) {
+                outFile << (phase == 0 ? " " : ", ") << "\"" << PHASE_NAMES[phase] << "\": " << window.avgPhaseMs[phase];
+            }
+            outFile << " } }" << (i + 1 < mWindowSummaries.size() ? "," : "") << "\n";
+        }
+        outFile << "  ]\n";
+        outFile << "}\n";
+        if (!outFile.good()) {
+            std::cout << "Frame stats: failed to write '" << filePath << "'" << std::endl;
         }
-        return view;
+    }
+
+private:
+    static int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        "Before we can finish creating the pipeline, we need to tell Vulkan about the framebuffer
-        attachments that will be used while rendering. We need to specify how many color and depth
-        buffers there will be, how many samples to use for each of them and how their contents
-        should be handled throughout the rendering operations. All of this information is wrapped
-        in a render pass object..."
-
-        Note: An "attachment" is one of the Vulkan synonyms for images. See my (mildly popular)
-        post on Reddit that asked what it is.
-        https://www.reddit.com/r/vulkan/comments/a27cid/what_is_an_attachment_in_the_render_passes/
+        Sorts the last window's frame times to get its percentiles. This happens once per window,
+        so its cost is spread thin over the frames.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void SummarizeWindow(uint64_t endCount) {
+        WindowSummary summary{};
+        std::vector<double> frameMs;
+        frameMs.reserve(mWindowSize);
+        for (uint64_t i = endCount - mWindowSize; i < endCount; i++) {
+            const FrameRecord &record = mRecords[i & (RING_SIZE - 1)];
+            if (i == endCount - mWindowSize) {
+                summary.firstFrame = record.frameNumber;
+            }
+            if (record.intervalNs > 0) {
+                frameMs.push_back(static_cast<double>(record.intervalNs) / 1000000.0);
+            }
 
-        ??what? "color and depth buffers"? "framebuffer attachments"??
+            int64_t phaseStart = record.startNs;
+            for (uint32_t phase = 0; phase < NUM_PHASES; phase++) {
+                summary.avgPhaseMs[phase] += static_cast<double>(record.phaseEndNs[phase] - phaseStart) / 1000000.0;
+                phaseStart = record.phaseEndNs[phase];
+            }
+        }
+        for (auto &phaseMs : summary.avgPhaseMs) {
+            phaseMs /= static_cast<double>(mWindowSize);
+        }
 
-        https://vulkan-tutorial.com/Drawing_a_triangle/Graphics_pipeline_basics/Render_passes
+        summary.numFrames = static_cast<uint32_t>(frameMs.size());
+        if (!frameMs.empty()) {
+            std::sort(frameMs.begin(), frameMs.end());
+            auto percentile = [&frameMs](double p) {
+                size_t index = static_cast<size_t>(std::ceil(p * static_cast<double>(frameMs.size()))) - 1;
+                return frameMs.at(std::min(index, frameMs.size() - 1));
+            };
+            summary.p50Ms = percentile(0.50);
+            summary.p95Ms = percentile(0.95);
+            summary.p99Ms = percentile(0.99);
+            summary.maxMs = frameMs.back();
+
+            double hitchThresholdMs = 2.0 * summary.p50Ms;
+            for (double ms : frameMs) {
+                if (ms > hitchThresholdMs) {
+                    summary.numHitches++;
+                }
+            }
+        }
+        mWindowSummaries.push_back(summary);
+    }
 
-        Render Passes in Vulkan
-        https://www.youtube.com/watch?v=x2SGVjlVGhE
-    Creator:    John Cox, 11/2018
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Times a few thousand fake frames' worth of recording so that the report can say how much
+        the profiler itself costs. Run once at startup, before any real frames.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateRenderPass() {
-        VkAttachmentDescription colorAttachmentDesc{};
-        colorAttachmentDesc.format = mSwapChainImageFormat;
-        colorAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;    // not doing multisampling yet, so ??one sample per texture? per pixel??
-        colorAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // don't know, don't care
-        colorAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    double MeasureRecordingOverhead() {
+        const uint32_t numTrials = 2000;
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < numTrials; i++) {
+            uint64_t count = mWriteCount;
+            FrameRecord &record = mRecords[count & (RING_SIZE - 1)];
+            record.startNs = NowNs();
+            for (uint32_t phase = 0; phase < NUM_PHASES; phase++) {
+                record.phaseEndNs[phase] = NowNs();
+            }
+            mWriteCount = count;
+        }
+        auto end = Clock::now();
+        mRecords.assign(RING_SIZE, FrameRecord{});
+        return std::chrono::duration<double, std::nano>(end - start).count() / numTrials;
+    }
 
-        VkAttachmentDescription depthAttachmentDesc{};
-        depthAttachmentDesc.format = FindDepthFormat();
-        depthAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;
-        depthAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        depthAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        depthAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    static constexpr double HISTOGRAM_BUCKET_MS = 0.05;
+    static constexpr const char *PHASE_NAMES[NUM_PHASES] = {
+        "wait", "pace", "acquire", "update", "record", "submit", "present"
+    };
 
-        std::array<VkAttachmentDescription, 2> attachments = { colorAttachmentDesc, depthAttachmentDesc };
+    std::vector<FrameRecord> mRecords;
+    uint64_t mWriteCount = 0;
+    int64_t mLastStartNs = 0;
+    uint32_t mLastPhase = 0;
 
-        // Note: The render pass' create info specifies all the attachments that will be available 
-        // during it. Each subpass description only specifies references though, and it does this 
-        // through indexing.
-        // Also Note: This index is the same as the "layout(location=0/location=1/etc.)" in the 
-        // shaders that are in use during this render pass.
-        VkAttachmentReference colorAttachmentRef{};
-        colorAttachmentRef.attachment = 0;  // index into attachment descriptions array
-        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    uint32_t mWindowSize = 600;
+    std::vector<WindowSummary> mWindowSummaries;
 
-        VkAttachmentReference depthAttachmentRef{};
-        depthAttachmentRef.attachment = 1;
-        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    // 0-100ms in 0.05ms buckets; anything slower lands in the last one
+    std::array<uint64_t, 2000> mHistogram{};
+    uint64_t mNumHistogramFrames = 0;
+    double mRunMaxMs = 0.0;
 
-        // Note: There is a "count" for the color attachments but not for the depth because a 
-        // shader that is used within a subpass may be designed to read from/write to (??I think 
-        // multiple write??) multiple color attachments, hence the need for a count, but cannot be 
-        // designed to read from/write to more than one depth attachment because it is assumed 
-        // that the depth attachment is relevant only to the current image under construction, and 
-        // so there would be no need to check any other image's depth data. (??I think??)
-        VkSubpassDescription subpass{};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pColorAttachments = &colorAttachmentRef;
-        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    double mRecordingOverheadNs = 0.0;
+};
 
-        // Note: There is an implit "subpass" that occurs at the start of the pipeline and another 
-        // at the end. There may not be an image available yet by the time the command buffer 
-        // pipeline is ready to execute. Insert a subpass dependency to make sure that this 
-        // implicit subpass doesn't begin prematurely. In other words, specify that all other 
-        // subpasses must finish before beginning subpass 0 (index 0 indicating our one (and only) 
-        // subpass).
-        VkSubpassDependency dependency{};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A camera path that is a function of the frame number rather than of wall-clock time, so that
+    two runs render exactly the same frames no matter how fast either one runs.
+
+    The path is a list of keyframes (frame number, eye, target) that is linearly interpolated
+    between and loops back to the start after the last one. The default path is the original
+    zoom in/out along the (1,1,1) diagonal (as it would have looked at 60 frames per second),
+    but a different one can be loaded from a text file with one keyframe per line:
+        frame eyeX eyeY eyeZ targetX targetY targetZ
+    Lines starting with '#' are comments.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class ScriptedCameraPath {
+public:
+    struct Keyframe {
+        uint64_t frame = 0;
+        glm::vec3 eye;
+        glm::vec3 target;
+    };
 
-        // finally, make the render pass object itself
-        VkRenderPassCreateInfo renderPassCreateInfo{};
-        renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        renderPassCreateInfo.pAttachments = attachments.data();
-        renderPassCreateInfo.subpassCount = 1;
-        renderPassCreateInfo.pSubpasses = &subpass;
-        renderPassCreateInfo.dependencyCount = 1;
-        renderPassCreateInfo.pDependencies = &dependency;
+    ScriptedCameraPath() {
+        // eye at (2,2,2) +/- sin(time / 2), sampled every 1/4 second at 60 FPS, for one full 
+        // period (4pi seconds ~= 754 frames)
+        const float framesPerSecond = 60.0f;
+        const uint64_t period = 754;
+        for (uint64_t frame = 0; frame < period; frame += 15) {
+            float time = static_cast<float>(frame) / framesPerSecond;
+            float zoomAxis = sinf(time / 2.0f);
+            mKeyframes.push_back({ frame, glm::vec3(2.0f + zoomAxis), glm::vec3(0.0f) });
+        }
+        mKeyframes.push_back({ period, glm::vec3(2.0f), glm::vec3(0.0f) });
+    }
 
-        if (vkCreateRenderPass(mLogicalDevice, &renderPassCreateInfo, nullptr, &mRenderPass) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create render pass");
+    void LoadFromFile(const std::string &filePath) {
+        std::ifstream inFile(filePath);
+        if (!inFile.is_open()) {
+            throw std::runtime_error("failed to open camera path '" + filePath + "'");
+        }
+
+        std::vector<Keyframe> keyframes;
+        std::string line;
+        while (std::getline(inFile, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            std::stringstream ss(line);
+            Keyframe keyframe{};
+            ss >> keyframe.frame >> keyframe.eye.x >> keyframe.eye.y >> keyframe.eye.z >> keyframe.target.x >> keyframe.target.y >> keyframe.target.z;
+            if (ss.fail()) {
+                throw std::runtime_error("bad camera path line '" + line + "' in '" + filePath + "'");
+            }
+            if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+                throw std::runtime_error("camera path frames must increase in '" + filePath + "'");
+            }
+            keyframes.push_back(keyframe);
+        }
+        if (keyframes.empty()) {
+            throw std::runtime_error("camera path '" + filePath + "' has no keyframes");
         }
+        mKeyframes = keyframes;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        A "descriptor" is shorthand for the general programming term "data descriptor", which is a
-        structure containing information that describes data. How helpful :/. In Vulkan, a
-        descriptor is used to provide information to shaders in a pipeline about resources that
-        are available (uniforms, texture samplers, etc.).
-
-        Note: It is possible for the shader's descriptor at a particular binding index (in this
-        case we're using 0) to specify an array of descriptor objects, such as an array of uniform
-        buffer objects, each with a set of transforms, for every "bone" in a skeletal animation.
-        We're just using a single descriptor though, so our descriptor count is only 1;
-    Creator:    John Cox, 01/2019
+        Where the camera is at the given frame.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateDescriptorSetLayout() {
-        // Note: Despite the name, this is info about a single descriptor, not a set. It is to be 
-        // understood as a single descriptor "binding" within a descriptor set.
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        uboLayoutBinding.binding = 0;   // same binding location as in the shader that uses it
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        uboLayoutBinding.pImmutableSamplers = nullptr;  // no textures yet at this time (1-1-2019)
+    void Evaluate(uint64_t frameNumber, glm::vec3 &eye, glm::vec3 &target) const {
+        const Keyframe &last = mKeyframes.back();
+        if (mKeyframes.size() == 1 || last.frame == 0) {
+            eye = last.eye;
+            target = last.target;
+            return;
+        }
 
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding = 1;
-        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
+        uint64_t frame = frameNumber % last.frame;
+        size_t next = 1;
+        while (next < mKeyframes.size() - 1 && mKeyframes[next].frame <= frame) {
+            next++;
+        }
+        const Keyframe &a = mKeyframes[next - 1];
+        const Keyframe &b = mKeyframes[next];
+        float t = static_cast<float>(frame - a.frame) / static_cast<float>(b.frame - a.frame);
+        t = std::min(std::max(t, 0.0f), 1.0f);
+        eye = glm::mix(a.eye, b.eye, t);
+        target = glm::mix(a.target, b.target, t);
+    }
+
+private:
+    std::vector<Keyframe> mKeyframes;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    What to load: textures, meshes (OBJ files), and instances of those meshes placed around the
+    world. The default is the tutorial's chalet, but a whole scene can be loaded from a text
+    file with one item per line:
+        texture <name> <image file>
+        mesh <name> <OBJ file> [<texture name>]
+        instance <mesh name> <x> <y> <z> [<rotation about Z, in degrees> [<scale>]]
+    Lines starting with '#' are comments. File paths are relative to the manifest's folder, and
+    textures and meshes have to be listed before anything uses them.
+
+    Every texture is decoded and every mesh is loaded on a startup task of its own, so the
+    manifest lists everything up front, and nothing has to be loaded to find out what else to
+    load. That is why an OBJ's own materials (its .mtl file) can only pick from the textures
+    listed here: a material's diffuse texture (map_Kd) is matched by file path. A material
+    without one (or with one that isn't listed) gets the mesh's texture, and if the mesh doesn't
+    have one either, plain white.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class SceneManifest {
+public:
+    struct Texture {
+        std::string name;
+        std::string filePath;   // empty => 1x1 white
+    };
 
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+    struct Mesh {
+        std::string name;
+        std::string filePath;
+        uint32_t texture = 0;   // for materials that don't have one of their own
+    };
+
+    struct Instance {
+        uint32_t mesh = 0;
+        glm::mat4 transform = glm::mat4(1.0f);
+    };
 
-        VkDescriptorSetLayoutCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        createInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        createInfo.pBindings = bindings.data();
+    // always texture 0
+    static constexpr uint32_t WHITE_TEXTURE = 0;
 
-        if (vkCreateDescriptorSetLayout(mLogicalDevice, &createInfo, nullptr, &mDescriptorSetLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor set layout!");
+    SceneManifest() {
+        mTextures.push_back({ "white", "" });
+        mTextures.push_back({ "chalet", "textures/chalet.jpg" });
+        mMeshes.push_back({ "chalet", "models/chalet.obj", 1 });
+        mInstances.push_back({ 0, glm::rotate(glm::mat4(1.0f), glm::radians(220.0f), glm::vec3(0.0f, 0.0f, 1.0f)) });
+    }
+
+    void LoadFromFile(const std::string &filePath) {
+        std::ifstream inFile(filePath);
+        if (!inFile.is_open()) {
+            throw std::runtime_error("failed to open scene manifest '" + filePath + "'");
+        }
+        std::filesystem::path folder = std::filesystem::path(filePath).parent_path();
+
+        std::vector<Texture> textures{ { "white", "" } };
+        std::vector<Mesh> meshes;
+        std::vector<Instance> instances;
+        std::string line;
+        while (std::getline(inFile, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            auto fail = [&line, &filePath](const std::string &reason) {
+                throw std::runtime_error(reason + " in scene manifest line '" + line + "' in '" + filePath + "'");
+            };
+
+            std::stringstream ss(line);
+            std::string kind;
+            std::string name;
+            ss >> kind >> name;
+            if (kind == "texture") {
+                std::string path;
+                ss >> path;
+                if (ss.fail()) {
+                    fail("expected 'texture <name> <image file>'");
+                }
+                if (FindByName(textures, name).has_value()) {
+                    fail("duplicate texture name");
+                }
+                textures.push_back({ name, NormalizePath(folder / path) });
+            }
+            else if (kind == "mesh") {
+                std::string path;
+                ss >> path;
+                if (ss.fail()) {
+                    fail("expected 'mesh <name> <OBJ file> [<texture name>]'");
+                }
+                if (FindByName(meshes, name).has_value()) {
+                    fail("duplicate mesh name");
+                }
+                Mesh mesh{ name, NormalizePath(folder / path), WHITE_TEXTURE };
+                std::string textureName;
+                if (ss >> textureName) {
+                    std::optional<uint32_t> texture = FindByName(textures, textureName);
+                    if (!texture.has_value()) {
+                        fail("unknown texture '" + textureName + "'");
+                    }
+                    mesh.texture = texture.value();
+                }
+                meshes.push_back(mesh);
+            }
+            else if (kind == "instance") {
+                std::optional<uint32_t> mesh = FindByName(meshes, name);
+                if (!mesh.has_value()) {
+                    fail("unknown mesh '" + name + "'");
+                }
+                glm::vec3 position(0.0f);
+                ss >> position.x >> position.y >> position.z;
+                if (ss.fail()) {
+                    fail("expected 'instance <mesh name> <x> <y> <z> [<rotation> [<scale>]]'");
+                }
+                float rotationDegrees = 0.0f;
+                float scale = 1.0f;
+                if (ss >> rotationDegrees) {
+                    ss >> scale;
+                }
+
+                Instance instance{};
+                instance.mesh = mesh.value();
+                instance.transform = glm::translate(glm::mat4(1.0f), position) *
+                    glm::rotate(glm::mat4(1.0f), glm::radians(rotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f)) *
+                    glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+                instances.push_back(instance);
+            }
+            else {
+                fail("unknown item '" + kind + "'");
+            }
         }
+        if (instances.empty()) {
+            throw std::runtime_error("scene manifest '" + filePath + "' has no instances");
+        }
+
+        mTextures = textures;
+        mMeshes = meshes;
+        mInstances = instances;
+    }
+
+    const std::vector<Texture> &GetTextures() const {
+        return mTextures;
+    }
+
+    const std::vector<Mesh> &GetMeshes() const {
+        return mMeshes;
+    }
+
+    const std::vector<Instance> &GetInstances() const {
+        return mInstances;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Given a file path to a compiled shader binary, reads the entire file and constructs a
-        VkShaderModule object out of the data, then returns it.
-
-        Note: Thge shader module requires explicit destruction since it was created with a
-        "vkCreate*(...)" call.
-    Creator:    John Cox, 11/2018
+        Which listed texture, if any, is the given image file (ex: an OBJ material's map_Kd).
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    VkShaderModule CreateShaderModule(const std::string &filePath) {
-        auto shader_binary = ReadFileIntoString(filePath);
+    std::optional<uint32_t> FindTextureByPath(const std::filesystem::path &filePath) const {
+        std::string normalized = NormalizePath(filePath);
+        for (uint32_t i = 0; i < mTextures.size(); i++) {
+            if (!mTextures[i].filePath.empty() && mTextures[i].filePath == normalized) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
 
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = shader_binary.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(shader_binary.data());
+private:
+    // so that "models/../textures/a.jpg" and "textures/a.jpg" match
+    static std::string NormalizePath(const std::filesystem::path &filePath) {
+        return filePath.lexically_normal().generic_string();
+    }
 
-        VkShaderModule shaderModule;
-        if (vkCreateShaderModule(mLogicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create shader module");
+    template<typename T>
+    static std::optional<uint32_t> FindByName(const std::vector<T> &items, const std::string &name) {
+        for (uint32_t i = 0; i < items.size(); i++) {
+            if (items[i].name == name) {
+                return i;
+            }
         }
+        return std::nullopt;
+    }
 
-        return shaderModule;
+    std::vector<Texture> mTextures;
+    std::vector<Mesh> mMeshes;
+    std::vector<Instance> mInstances;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Records how long each step of a multi-step process (ex: startup) took. Call Mark(...) after
+    each step; the time since the previous mark is charged to that step.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class PhaseTimer {
+public:
+    struct PhaseTime {
+        std::string name;
+        double ms = 0.0;
+        double startMs = 0.0;   // since Start()
+    };
+
+    void Start() {
+        mStartTime = std::chrono::high_resolution_clock::now();
+        mLastMark = mStartTime;
+        mPhases.clear();
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Governs the creation of all stages of the graphics pipeline.
+    void Mark(const std::string &name) {
+        auto now = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - mLastMark).count();
+        double startMs = std::chrono::duration<double, std::milli>(mLastMark - mStartTime).count();
+        mPhases.push_back({ name, ms, startMs });
+        mLastMark = now;
+    }
 
-        Some stages are fixed, and others are programmable.
-        - The "fixed" stages can be configured with a set number of options from the SDK.
-        - The "programmable" stages can be set up with a shader or be skipped entirely.
+    std::chrono::high_resolution_clock::time_point GetStartTime() const {
+        return mStartTime;
+    }
 
-        From the tutorial:
-        - The input assembler collects the raw vertex data from the buffers you specify and may
-            also use an index buffer to repeat certain elements without having to duplicate the
-            vertex data itself. This stage is FIXED.
-        - The vertex shader is run for every vertex and generally applies transformations to turn
-            vertex positions from model space to screen space. It also passes per-vertex data down
-            the pipeline. This stage is PROGRAMMABLE.
-        - The tessellation shaders allow you to subdivide geometry based on certain rules to
-            increase the mesh quality. This is often used to make surfaces like brick walls and
-            staircases look less flat when they are nearby. This stage is PROGRAMMABLE.
-        - The geometry shader is run on every primitive (triangle, line, point) and can discard it
-            or output more primitives than came in. This is similar to the tessellation shader,
-            but much more flexible. However, it is not used much in today's applications because
-            the performance is not that good on most graphics cards except for Intel's integrated
-            GPUs. This stage is PROGRAMMABLE.
-        - The rasterization stage discretizes the primitives into fragments. These are the pixel
-            elements that they fill on the framebuffer. Any fragments that fall outside the screen
-            are discarded and the attributes outputted by the vertex shader are interpolated
-            across the fragments, as shown in the figure. Usually the fragments that are behind
-            other primitive fragments are also discarded here because of depth testing. This stage
-            is FIXED.
-        - The fragment shader is invoked for every fragment that survives and determines which
-            framebuffer(s) the fragments are written to and with which color and depth values. It
-            can do this using the interpolated data from the vertex shader, which can include
-            things like texture coordinates and normals for lighting. This stage is PROGRAMMABLE.
-        - The color blending stage applies operations to mix different fragments that map to the
-            same pixel in the framebuffer. Fragments can simply overwrite each other, add up or be
-            mixed based upon transparency. This stage is FIXED (??is it configurable??)
-    Creator:    John Cox, 11/2018
-    ---------------------------------------------------------------------------------------------*/
-    void CreateGraphicsPipeline() {
-        VkShaderModule vertShaderModule = CreateShaderModule("shaders/vert.spv");
-        VkShaderModule fragShaderModule = CreateShaderModule("shaders/frag.spv");
+    const std::vector<PhaseTime> &GetPhases() const {
+        return mPhases;
+    }
 
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStageCreateInfos;
-        {
-            VkPipelineShaderStageCreateInfo createInfo{};
-            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            createInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-            createInfo.module = vertShaderModule;
-            createInfo.pName = "main";
-            shaderStageCreateInfos.push_back(createInfo);
-        }
-        {
-            VkPipelineShaderStageCreateInfo createInfo{};
-            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            createInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-            createInfo.module = fragShaderModule;
-            createInfo.pName = "main";
-            shaderStageCreateInfos.push_back(createInfo);
+    double GetTotalMs() const {
+        double total = 0.0;
+        for (const auto &phase : mPhases) {
+            total += phase.ms;
         }
+        return total;
+    }
 
-        auto bindingDescription = Vertex::GetBindingDescription();
-        auto attributeDescription = Vertex::GetAttributeDescription();
-        VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
-        vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
-        vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescription.data();
+private:
+    std::chrono::high_resolution_clock::time_point mStartTime;
+    std::chrono::high_resolution_clock::time_point mLastMark;
+    std::vector<PhaseTime> mPhases;
+};
 
-        // the Input Assembly State's "topology" is like OpenGL's "draw style" (GL_LINES, 
-        // GL_TRIANGLES, etc.)
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
-        inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A fixed-size, lock-free queue for exactly one producer thread and exactly one consumer
+    thread (ex: the main thread handing window events to the render thread).
 
-        // Note: Vulkan's Y values are like everyone else now, with (0,0) in the upper left. This 
-        // is unlike OpenGL, which had (0,0) in the lower left.
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(mSwapChainExtent.width);
-        viewport.height = static_cast<float>(mSwapChainExtent.height);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        // Note: Vulkan's rectangle uses "offset" and "extent" instead of "x,y" and 
-        // "width,height". They work out to the same thing though.
-        VkRect2D scissor{};
-        scissor.offset = VkOffset2D{ 0,0 };
-        scissor.extent = mSwapChainExtent;
-
-        // Vulkan wants to have the viewport and scissor in a single structure
-        // Note: There may be cases in which multiple viewports are desired, such as a flight 
-        // simulated with a viewport for each instrument, though there are likely more efficient 
-        // ways to handle that through textures. Still, multiple viewports could be a nice thing 
-        // in the toolbag, even if we're not going to be using them.
-        VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
-        viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        viewportStateCreateInfo.viewportCount = 1;
-        viewportStateCreateInfo.pViewports = &viewport;
-        viewportStateCreateInfo.scissorCount = 1;
-        viewportStateCreateInfo.pScissors = &scissor;
+    The producer only ever writes the tail and the consumer only ever writes the head, so no
+    locks or compare-exchanges are needed: each side publishes its own index with a release
+    store and reads the other side's with an acquire load. The indexes are on separate cache
+    lines so that the two threads don't keep stealing the same line from each other.
 
-        // "The rasterizer takes the geometry that is shaped by the vertices from the vertex 
-        // shader and turns it into fragments to be colored by the fragment shader. It also 
-        // performs depth testing, face culling and the scissor test, and it can be configured to 
-        // output fragments that fill entire polygons or just the edges (wireframe rendering)."
-        // Note: If depth clamping is enabled, fragments beyond near/far planes are discarded. 
-        // Disabling depth clamping could be useful if we want a render stage that considers all 
-        // depth values.
-        VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo{};
-        rasterizerCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizerCreateInfo.depthClampEnable = VK_FALSE; //??why are we using false??
-        rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE; // definitely want rasterization
-        rasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;    // or LINE or POINT
-        rasterizerCreateInfo.lineWidth = 1.0f;  //>1.0f requires enabling "wideLines" GPU feature
-        rasterizerCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    Note: CAPACITY must be a power of 2 so that wrapping is a mask. One slot is always left
+    empty to tell "full" apart from "empty".
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+template<typename T, size_t CAPACITY>
+class SpscQueue {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of 2");
 
-        // changed from `CLOCKWISE` because the GLM project matrix had to have its Y axis flipped 
-        // to bring it in line with Vulkan's NDCs
-        rasterizerCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-        //rasterizerCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
-        rasterizerCreateInfo.depthBiasEnable = VK_FALSE;    //??what is "depth bias"??
+public:
+    // producer only; returns false if full
+    bool TryPush(const T &item) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        size_t nextTail = (tail + 1) & (CAPACITY - 1);
+        if (nextTail == mHead.load(std::memory_order_acquire)) {
+            return false;
+        }
+        mItems[tail] = item;
+        mTail.store(nextTail, std::memory_order_release);
+        return true;
+    }
 
-        // multisampling is an antialiasing technique that combines fragment shader results of 
-        // multiple polygons that rasterize to the same pixel, but we won't be using this at this 
-        // time (11/24/2018)
-        // Note: Enabling this requires enabling a GPU feature (??which one??)
-        VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo{};
-        multisamplingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-        multisamplingCreateInfo.sampleShadingEnable = VK_FALSE; //VK_TRUE;
-        multisamplingCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    // consumer only; returns false if empty
+    bool TryPop(T &item) {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = mItems[head];
+        mHead.store((head + 1) & (CAPACITY - 1), std::memory_order_release);
+        return true;
+    }
 
-        // color blending requires two structures: (1) the "blending attachment state" is per 
-        // framebuffer (we only have one) and (2) the "blend state create info", which contains 
-        // global color blending settings
-        // Note: Color blending often used in conjunction with alpha values.
-        // Ex: .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; //(1-srcAlpha)
-        // Pseudocode:
-        //    if (blendEnable) {
-        //        finalColor.rgb = (srcColorBlendFactor * newColor.rgb) < colorBlendOp > (dstColorBlendFactor * oldColor.rgb);
-        //        finalColor.a = (srcAlphaBlendFactor * newColor.a) < alphaBlendOp > (dstAlphaBlendFactor * oldColor.a);
-        //    }
-        //    else {
-        //        finalColor = newColor;
-        //    }
-        //    finalColor = finalColor & colorWriteMask;
-        VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
-        colorBlendAttachmentState.colorWriteMask =
-            VK_COLOR_COMPONENT_R_BIT |
-            VK_COLOR_COMPONENT_G_BIT |
-            VK_COLOR_COMPONENT_B_BIT |
-            VK_COLOR_COMPONENT_A_BIT;
-        colorBlendAttachmentState.blendEnable = VK_FALSE;
-        //colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;    //??
-        //colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;   //??
-        //colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;               //??
-        //colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;    //??
-        //colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;   //??
-        //colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;               //??
+private:
+    alignas(64) std::atomic<size_t> mHead{ 0 };
+    alignas(64) std::atomic<size_t> mTail{ 0 };
+    std::array<T, CAPACITY> mItems{};
+};
 
-        VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo{};
-        colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-        colorBlendCreateInfo.logicOpEnable = VK_FALSE;
-        colorBlendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-        colorBlendCreateInfo.attachmentCount = 1;   // only one framebuffer
-        colorBlendCreateInfo.pAttachments = &colorBlendAttachmentState;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A small work-stealing task scheduler for running a graph of tasks (ex: startup) across
+    several threads.
 
-        //??does this 4-item array follow the RGBA order? and what does it do??
-        colorBlendCreateInfo.blendConstants[0] = 0.0f;
-        colorBlendCreateInfo.blendConstants[1] = 0.0f;
-        colorBlendCreateInfo.blendConstants[2] = 0.0f;
-        colorBlendCreateInfo.blendConstants[3] = 0.0f;
+    Tasks are added up front with the tasks that they depend on, then Run() executes the whole
+    graph and returns when everything is done. The calling thread joins in rather than sitting
+    idle. Each thread has its own queue: it pushes newly ready tasks (the dependents of whatever
+    it just finished) onto the back and takes its next task from the back too, so that related
+    work tends to stay on the same thread. A thread that runs dry steals from the front of
+    another thread's queue, where the oldest (and usually biggest) tasks are.
 
-        // pipeline layout is where we will be using uniforms, but for now (11/24/2018), we leave 
-        // it blank
-        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutCreateInfo.setLayoutCount = 1;
-        pipelineLayoutCreateInfo.pSetLayouts = &mDescriptorSetLayout;   // MUST have been created prior to this
-        if (vkCreatePipelineLayout(mLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &mPipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create pipeline layout");
-        }
+    If a task throws, nothing that has not already started is run, and the first exception is
+    rethrown from Run().
 
-        // need to tell the pipeline to use depth testing
-        // Note: Depth testing says to compare depth of a new fragment with the existing depth in 
-        // the buffer for that pixel. Depth writing means to write the new depth if the new 
-        // fragment is closer to the screen (could be altered by the "compare op", but let's not 
-        // mess with normality). The former we always want (unless we are doing something very 
-        // odd), but we don't want the latter if we are drawing a transparent object. It would 
-        // require another pipeline (all these things get baked into the pipeline, so even minor 
-        // changes require another pipeline) to perform depth writing for previously compared 
-        // fragments for opaque objects, but if the current pipeline is trying to draw transparent 
-        // objects, then we *don't* want to write new depth tests. Right now (1/20/2019) though, 
-        // for this tutorial, we do.
-        VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo{};
-        depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depthStencilCreateInfo.depthTestEnable = VK_TRUE;
-        depthStencilCreateInfo.depthWriteEnable = VK_TRUE;
-        depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-        depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;    //??what??
-        depthStencilCreateInfo.stencilTestEnable = VK_FALSE;        //??what is this??
+    Every task's start and end time and thread are recorded and can be written out as a Chrome
+    trace (load it in chrome://tracing or https://ui.perfetto.dev) to see the Gantt chart.
 
-        VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stageCount = 2;
-        pipelineCreateInfo.pStages = shaderStageCreateInfos.data();
-        pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
-        pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
-        pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
-        pipelineCreateInfo.pRasterizationState = &rasterizerCreateInfo;
-        pipelineCreateInfo.pMultisampleState = &multisamplingCreateInfo;
-        pipelineCreateInfo.pColorBlendState = &colorBlendCreateInfo;
-        pipelineCreateInfo.layout = mPipelineLayout;
-        pipelineCreateInfo.renderPass = mRenderPass;
-        pipelineCreateInfo.subpass = 0; // index of the subpass in the given render pass where this pipeline will be used (??what??)
-        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // not deriving from existing pipeline
-        pipelineCreateInfo.pDepthStencilState = &depthStencilCreateInfo;
+    Note: The graph is not meant to be added to while it is running.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class TaskScheduler {
+public:
+    using TaskId = size_t;
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct TaskTiming {
+        std::string name;
+        uint32_t threadIndex = 0;   // 0 => the thread that called Run()
+        double startMs = 0.0;       // since Run() was called
+        double endMs = 0.0;
+    };
 
-        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
-        uint32_t pipelineCreateInfoCount = 1;
-        if (vkCreateGraphicsPipelines(mLogicalDevice, pipelineCache, pipelineCreateInfoCount, &pipelineCreateInfo, nullptr, &mGraphicsPipeline) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create graphics pipeline");
-        }
+    TaskScheduler() = default;
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
 
-        // Note: Vulkan's packaged shader code is only necessary during loading, but since it was 
-        // created with a "vkCreate*(...)" call, it needs to be explicitly destroyed.
-        vkDestroyShaderModule(mLogicalDevice, vertShaderModule, nullptr);
-        vkDestroyShaderModule(mLogicalDevice, fragShaderModule, nullptr);
+    ~TaskScheduler() {
+        Shutdown();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Generates a framebuffer object for each image in the swap chain.
-        ??how is the image in the swap chain different from the framebuffer for it??
-    Creator:    John Cox, 11/2018
+        Starts the worker threads. 0 workers => Run() does everything on the calling thread, in
+        the order that tasks were added (handy for comparison).
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateFramebuffers() {
-        mSwapChainFramebuffers.resize(mSwapChainImageViews.size());
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            std::array<VkImageView, 2> attachments{
-                mSwapChainImageViews.at(i),
+    void Start(uint32_t numWorkers) {
+        mQueues.clear();
+        for (uint32_t i = 0; i < numWorkers + 1; i++) {
+            mQueues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (uint32_t i = 1; i <= numWorkers; i++) {
+            mWorkers.emplace_back(&TaskScheduler::WorkerMain, this, i);
+        }
+    }
 
-                // Note: The drawing waits for all items in the Color Attachment pipeline stage to 
-                // finish before moving on, so our semaphores may be unnecessary with this 
-                // particular design (??you sure??), and as a side effect we can use the same 
-                // depth image view for every frame instead of having to do one depth image for 
-                // each frame. Personally, I think that this is flimsly justification to avoid 
-                // creating extra images. I want a better explanation (??but how do I get one??)
-                mDepthImageView,
-            };
-            VkFramebufferCreateInfo frameBufferCreateInfo{};
-            frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            frameBufferCreateInfo.renderPass = mRenderPass;
-            frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-            frameBufferCreateInfo.pAttachments = attachments.data();
-            frameBufferCreateInfo.width = mSwapChainExtent.width;
-            frameBufferCreateInfo.height = mSwapChainExtent.height;
-            frameBufferCreateInfo.layers = 1;
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mStopping = true;
+        }
+        mWakeCondition.notify_all();
+        for (auto &worker : mWorkers) {
+            worker.join();
+        }
+        mWorkers.clear();
+    }
 
-            if (vkCreateFramebuffer(mLogicalDevice, &frameBufferCreateInfo, nullptr, &mSwapChainFramebuffers.at(i)) != VK_SUCCESS) {
-                throw std::runtime_error("failed to create framebuffer");
+    uint32_t GetNumThreads() const {
+        return static_cast<uint32_t>(mWorkers.size()) + 1;
+    }
+
+    TaskId AddTask(const std::string &name, std::function<void()> work, const std::vector<TaskId> &dependencies = {}) {
+        TaskId id = mTasks.size();
+        auto task = std::make_unique<Task>();
+        task->name = name;
+        task->work = std::move(work);
+        task->numDependencies = static_cast<uint32_t>(dependencies.size());
+        for (TaskId dependency : dependencies) {
+            if (dependency >= id) {
+                throw std::invalid_argument("task '" + name + "' depends on a task that hasn't been added yet");
             }
+            mTasks[dependency]->dependents.push_back(id);
         }
+        mTasks.push_back(std::move(task));
+        return id;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Generates the command pool object that will store the command buffers. Command pools
-        manage the memory that is used to store the buffers, and command buffers are allocated
-        from them.
-
-        Note: Each command pool can only allocate command buffers for a single type of queue.
-        This means that there cannot exist a command buffer that contains both compute and
-        graphics commands. Why? The API spec for Mantle (forerunner to Vulkan) describes the
-        "Queue submission model" in the section "Execution Model" as different CPU threads
-        submitting commands to different queues (graphics queue, compute queue), which are in turn
-        submitted to the GPU's "3D Engine" and "Compute Engine", respectively. Vulkan's queue
-        family indices are looked up with the VkPhysicalDevice, and combine this with the Mantle
-        API descriptions, and it seems that the command queues, and thus the command queue
-        families, are a software design model that accomodate's the GPU hardware design that
-        implements separate graphics and compute "engines" (??what are these??)
-    Creator:    John Cox, 11/2018
+        Runs every task that has been added, respecting dependencies, and waits for all of them.
+        Afterwards the graph is emptied (the timings stay until the next Run()).
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateCommandPool() {
-        QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(mPhysicalDevice);
-        VkCommandPoolCreateInfo commandPoolCreateInfo{};
-        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    void Run() {
+        if (mQueues.empty()) {
+            Start(0);
+        }
 
-        if (vkCreateCommandPool(mLogicalDevice, &commandPoolCreateInfo, nullptr, &mCommandPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create command pool");
+        mTimings.assign(mTasks.size(), TaskTiming{});
+        mFirstException = nullptr;
+        mFailed = false;
+        mRunStartTime = Clock::now();
+
+        if (mWorkers.empty()) {
+            // dependencies can only point backwards, so the order added is a valid order
+            for (TaskId id = 0; id < mTasks.size(); id++) {
+                Execute(id, 0);
+            }
         }
-    }
+        else {
+            // Note: All counts must be set before anything is pushed. Otherwise a worker could 
+            // finish a task and count down a dependent that then gets reset here.
+            mNumUnfinishedTasks.store(mTasks.size());
+            for (TaskId id = 0; id < mTasks.size(); id++) {
+                mTasks[id]->numRemainingDependencies.store(mTasks[id]->numDependencies);
+            }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Takes a buffer of data on the GPU and copies it into another chunk of memory that is
-        reserved for use by a particular image. This is how we get texture data into an image for
-        use as a sampler.
-    Creator:    John Cox, 01/2019
-    ---------------------------------------------------------------------------------------------*/
-    void CopyBufferToImage(VkBuffer buffer, VkImage image, VkImageLayout memLayout, uint32_t width, uint32_t height) {
-        // need to specify which parts of the buffer will be copied to this image
-        VkBufferImageCopy region{};
+            uint32_t queueIndex = 0;
+            for (TaskId id = 0; id < mTasks.size(); id++) {
+                if (mTasks[id]->numDependencies == 0) {
+                    // spread the starting tasks around
+                    Push(queueIndex, id);
+                    queueIndex = (queueIndex + 1) % static_cast<uint32_t>(mQueues.size());
+                }
+            }
 
-        // offset where pixels start
-        region.bufferOffset = 0;
+            // help out until everything is done
+            while (mNumUnfinishedTasks.load() > 0) {
+                TaskId id = 0;
+                if (TryTake(0, id)) {
+                    Execute(id, 0);
+                    continue;
+                }
 
-        // 0 for both indicates close packing (that is, no padding between rows)
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
+                std::unique_lock<std::mutex> lock(mWakeMutex);
+                mWakeCondition.wait(lock, [this]() {
+                    return mNumQueuedTasks.load() > 0 || mNumUnfinishedTasks.load() == 0;
+                });
+            }
+        }
 
-        // indicates the parts of the image that we want to copy
-        // Note: If we really wanted to, this allows us to copy one particular mipmap level.
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = { 0,0,0 };
-        region.imageExtent = { width,height,1 };
+        mTasks.clear();
+        if (mFirstException) {
+            std::rethrow_exception(mFirstException);
+        }
+    }
 
+    const std::vector<TaskTiming> &GetTimings() const {
+        return mTimings;
+    }
 
-        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, memLayout, 1, &region);
-        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    Clock::time_point GetRunStartTime() const {
+        return mRunStartTime;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Changes the usage of the texture image from ?? to ??.
+        Writes the last Run()'s task timings in the Chrome trace event format, one row per
+        thread. The task times are shifted by the given offset so that they can line up with
+        the optional extra events (ex: "first frame"), which go on their own row.
 
-        Note: We could use VK_IMAGE_LAYOUT_UNDEFINED if we didn't mind the image potentially
-        getting clobbered (implementation defined whether it does this or not), but we already
-        used the image as a copy destination and copied the JPEG's pixels to it, so we definitely
-        don't want it clobbered and therefore specify the existing layout.
-    Creator:    John Cox, 01/2019
+        Note: Failing to write it is reported, not thrown. It's only a report.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout currentLayout, VkImageLayout newLayout, uint32_t mipLevels) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = currentLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;  // exclusive to graphics queue right now (1/1/2019)
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-
-        if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    void WriteChromeTrace(const std::string &filePath, double timeOffsetMs, const std::vector<TaskTiming> &extraEvents) const {
+        std::ofstream outFile(filePath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cout << "Task trace: failed to open '" << filePath << "'; not saved" << std::endl;
+            return;
+        }
 
-            // TODO: remove "format" argument, replace with "aspect bitmask"
-            if (HasStencilComponent(format)) {
-                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-            }
+        std::vector<TaskTiming> events = mTimings;
+        for (TaskTiming &event : events) {
+            event.startMs += timeOffsetMs;
+            event.endMs += timeOffsetMs;
         }
-        else {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-
-        barrier.subresourceRange.baseMipLevel = 0;      // no mipmapping right now (1/1/2019)
-        barrier.subresourceRange.levelCount = mipLevels;
-        barrier.subresourceRange.baseArrayLayer = 0;    // not an array right now (1/1/2019)
-        barrier.subresourceRange.layerCount = 1;
-
-        // all work specified in the "source" stage must complete before any work is performed in 
-        // the "destination" stage
-        VkPipelineStageFlags srcStageMask = 0;
-        VkPipelineStageFlags dstStageMask = 0;
-        if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;  // because VkAccessFlagBits enum has no 0 value
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        }
-        else if (currentLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            // Note: Depth buffer reading occurs in the early fragment tests and writing will 
-            // occur in the late fragment tests. Of these two requirements, pick the one that 
-            // needs to be available earlier, and then you will be gauranteed that the latter 
-            // requirement will certainly be available on time.
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        for (TaskTiming event : extraEvents) {
+            event.threadIndex = GetNumThreads();
+            events.push_back(event);
         }
-        else {
-            throw std::invalid_argument("unsupported layout transition");
+
+        // timestamps and durations are in microseconds
+        outFile << std::fixed << std::setprecision(1);
+        outFile << "{ \"traceEvents\": [\n";
+        for (size_t i = 0; i < events.size(); i++) {
+            const TaskTiming &event = events[i];
+            outFile << "  { \"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << event.threadIndex
+                << ", \"ts\": " << event.startMs * 1000.0
+                << ", \"dur\": " << (event.endMs - event.startMs) * 1000.0 << " }"
+                << (i + 1 < events.size() ? "," : "") << "\n";
         }
+        outFile << "] }\n";
+        if (!outFile.good()) {
+            std::cout << "Task trace: failed to write '" << filePath << "'" << std::endl;
+        }
+    }
 
-        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> work;
+        std::vector<TaskId> dependents;
+        uint32_t numDependencies = 0;
+        std::atomic<uint32_t> numRemainingDependencies{ 0 };
+    };
 
-        VkDependencyFlags dependencies = 0; // VkDependencyFlagBits::VK_DEPENDENCY_BY_REGION_BIT (supposedly, the reading stage is allowed to do so from writes that have already finished, even though the whole write has not...nifty)
-        uint32_t memoryBarrierCount = 0;
-        VkMemoryBarrier *pMemoryBarrier = nullptr;
-        uint32_t bufferMemoryBarrierCount = 0;
-        VkBufferMemoryBarrier *pBufferMemoryBarrier = nullptr;
-        vkCmdPipelineBarrier(commandBuffer,
-            srcStageMask,
-            dstStageMask,
-            dependencies,
-            memoryBarrierCount,
-            pMemoryBarrier,
-            bufferMemoryBarrierCount,
-            pBufferMemoryBarrier,
-            1,
-            &barrier);
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<TaskId> tasks;
+    };
 
-        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
-    }
+    void WorkerMain(uint32_t threadIndex) {
+        while (true) {
+            TaskId id = 0;
+            if (TryTake(threadIndex, id)) {
+                Execute(id, threadIndex);
+                continue;
+            }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Creates an image that is not part of the swap chain.
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWakeCondition.wait(lock, [this]() {
+                return mNumQueuedTasks.load() > 0 || mStopping;
+            });
+            if (mStopping) {
+                return;
+            }
+        }
+    }
 
-        Note: When creating the swap chain, image extent was specified and applied to every image
-        that it created. We are now creating a standalone image that is the size of the texture.
-        If we have lots of textures, then we will have lots of standalone images, and many will
-        not share the same extent. Thus we need to specify the extent for each and every texture
-        image.
-
-
-        TODO: split into two functions, one that creates a VkImage, the other which allocates VkDeviceMemory, or better yet, a class that does this for you and that handles cleanup
+    void Push(uint32_t queueIndex, TaskId id) {
+        // Note: Counted before it is queued so that a thief can't take it (and count it down) 
+        // first. Counted under the lock so that a thread that is just about to wait can't miss 
+        // it.
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mNumQueuedTasks++;
+        }
+        {
+            WorkQueue &queue = *mQueues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(id);
+        }
+        mWakeCondition.notify_one();
+    }
 
+    bool TryTake(uint32_t threadIndex, TaskId &id) {
+        // own queue first, newest first
+        {
+            WorkQueue &queue = *mQueues[threadIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                id = queue.tasks.back();
+                queue.tasks.pop_back();
+                mNumQueuedTasks--;
+                return true;
+            }
+        }
 
-    Creator:    John Cox, 01/2019
-    ---------------------------------------------------------------------------------------------*/
-    void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags memProperties, VkImage &image, VkDeviceMemory &imageMemory) {
-        VkImageCreateInfo imageCreateInfo{};
-        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageCreateInfo.extent.width = static_cast<uint32_t>(width);
-        imageCreateInfo.extent.height = static_cast<uint32_t>(height);
-        imageCreateInfo.extent.depth = 1;   //??what happens at 0??
-        imageCreateInfo.mipLevels = mipLevels;
-        imageCreateInfo.arrayLayers = 1;
-        imageCreateInfo.format = format;
-        imageCreateInfo.tiling = tiling;
-        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageCreateInfo.usage = usage;
-        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        if (vkCreateImage(mLogicalDevice, &imageCreateInfo, nullptr, &image) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create image for texture");
+        // then steal, oldest first
+        for (size_t i = 1; i < mQueues.size(); i++) {
+            WorkQueue &queue = *mQueues[(threadIndex + i) % mQueues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                id = queue.tasks.front();
+                queue.tasks.pop_front();
+                mNumQueuedTasks--;
+                return true;
+            }
         }
+        return false;
+    }
 
-        // now allocate memory for the image
-        VkMemoryRequirements memRequirements{};
-        vkGetImageMemoryRequirements(mLogicalDevice, image, &memRequirements);
+    void Execute(TaskId id, uint32_t threadIndex) {
+        Task &task = *mTasks[id];
+        TaskTiming &timing = mTimings[id];
+        timing.name = task.name;
+        timing.threadIndex = threadIndex;
+        timing.startMs = std::chrono::duration<double, std::milli>(Clock::now() - mRunStartTime).count();
+        if (!mFailed.load()) {
+            try {
+                task.work();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                if (!mFailed.exchange(true)) {
+                    mFirstException = std::current_exception();
+                }
+            }
+        }
+        timing.endMs = std::chrono::duration<double, std::milli>(Clock::now() - mRunStartTime).count();
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, memProperties);
-        if (vkAllocateMemory(mLogicalDevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory");
+        if (mWorkers.empty()) {
+            return;
         }
 
-        VkDeviceSize offset = 0;
-        vkBindImageMemory(mLogicalDevice, image, imageMemory, offset);
+        // Note: Even if this one failed, its dependents are still "finished" (skipped) so that 
+        // Run() can return.
+        for (TaskId dependent : task.dependents) {
+            if (mTasks[dependent]->numRemainingDependencies.fetch_sub(1) == 1) {
+                Push(threadIndex, dependent);
+            }
+        }
+        if (mNumUnfinishedTasks.fetch_sub(1) == 1) {
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+            }
+            mWakeCondition.notify_all();
+        }
     }
 
+    std::vector<std::unique_ptr<Task>> mTasks;
+    std::vector<TaskTiming> mTimings;
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::atomic<size_t> mNumQueuedTasks{ 0 };
+    std::atomic<size_t> mNumUnfinishedTasks{ 0 };
+    bool mStopping = false;
+
+    std::atomic<bool> mFailed{ false };
+    std::exception_ptr mFirstException;
+    Clock::time_point mRunStartTime;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A VkPipelineCache that persists between runs, so that only the very first launch (or the
+    first launch after a driver update) pays for the driver's full shader compilation.
+
+    The file is just what vkGetPipelineCacheData(...) handed back last time. Its header says
+    which vendor, device, and driver build (the cache UUID) made it, and if any of those don't
+    match the current device, the data is thrown out rather than handed to the driver (drivers
+    are supposed to reject it themselves, but not all of them do so gracefully).
+
+    Threads that create pipelines on their own (ex: background compiles) can each get their own
+    cache from CreateThreadCache() so that they don't contend on the main one. Those are merged
+    into the main cache before it is saved.
+
+    Saving is atomic: the data is written to a temporary file that is then renamed over the old
+    one, so a crash mid-write can't leave a truncated cache behind.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class PipelineCacheFile {
+public:
     /*---------------------------------------------------------------------------------------------
     Description:
-        ??what??
-    Creator:    John Cox, 01/2019
+        No Vulkan needed, so this can happen while the device is still being created.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    VkFormat FindSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
-        for (const VkFormat &format : candidates) {
-            VkFormatProperties props{};
-            vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &props);
+    void ReadFile(const std::string &filePath) {
+        mFilePath = filePath;
+        mFileData.clear();
+        std::ifstream inFile(filePath, std::ios::in | std::ios::binary);
+        if (!inFile.is_open()) {
+            mStatus = "no cache file";
+            return;
+        }
+        mFileData.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+    }
 
-            if (tiling == VK_IMAGE_TILING_LINEAR &&
-                (props.linearTilingFeatures & features) == features) {
-                return format;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates the cache, seeded with the file's data if it was made by this device.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Create(VkDevice device, VkPhysicalDevice physicalDevice) {
+        mDevice = device;
+
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+        if (!mFileData.empty()) {
+            std::string reason;
+            if (IsHeaderValid(mFileData, deviceProperties, reason)) {
+                mLoadedBytes = mFileData.size();
+                mStatus = "warm";
             }
-            else if (tiling == VK_IMAGE_TILING_OPTIMAL &&
-                (props.optimalTilingFeatures & features) == features) {
-                return format;
+            else {
+                mStatus = "discarded (" + reason + ")";
             }
         }
 
-        throw std::runtime_error("failed to find supported format");    //??wat??
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = mLoadedBytes;
+        createInfo.pInitialData = (mLoadedBytes > 0) ? mFileData.data() : nullptr;
+        if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &mCache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache");
+        }
+        mFileData.clear();
+        mFileData.shrink_to_fit();
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        ??again, what??
-    Creator:    John Cox, 01/2019
-    ---------------------------------------------------------------------------------------------*/
-    VkFormat FindDepthFormat() {
-        return FindSupportedFormat(
-            { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-        );
+    VkPipelineCache Get() const {
+        return mCache;
     }
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        ??yet again, what??
-    Creator:    John Cox, 01/2019
-    ---------------------------------------------------------------------------------------------*/
-    bool HasStencilComponent(VkFormat format) {
-        return format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
-            format == VK_FORMAT_D24_UNORM_S8_UINT;
+    // "warm", "no cache file", "discarded (why)", or empty if not created
+    const std::string &GetStatus() const {
+        return mStatus;
+    }
+
+    bool IsWarm() const {
+        return mLoadedBytes > 0;
+    }
+
+    size_t GetLoadedBytes() const {
+        return mLoadedBytes;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        ??
-    Creator:    John Cox, 01/2019
+        An empty cache for one thread's exclusive use. Owned by this object, and merged into
+        the main cache when saving.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateDepthResources() {
-        uint32_t mipLevels = 1;
-        VkFormat depthFormat = FindDepthFormat();
-        CreateImage(mSwapChainExtent.width, mSwapChainExtent.height, mipLevels, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mDepthImage, mDepthImageMemory);
-        mDepthImageView = CreateImageView(mDepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, mipLevels);
-        TransitionImageLayout(mDepthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, mipLevels);
+    VkPipelineCache CreateThreadCache() {
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        VkPipelineCache cache = VK_NULL_HANDLE;
+        if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create thread pipeline cache");
+        }
+
+        std::lock_guard<std::mutex> lock(mThreadCachesMutex);
+        mThreadCaches.push_back(cache);
+        return cache;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Given an image (assuming it is used for color in 2 dimensions), generates progressively
-        more and more scaled down image resolutions for each increasing mip level (level 0 = base
-        image, and the detail decreases from there).
-
-        Note: Scaling is performed by VkCmdBlit(...). This function calculates scaling by, for
-        each axis, dividing the specified size of the source region by the specified size of the
-        destination region. The result could be >1, and Vulkan will be fine with this. We want to
-        generate lesser-detailed mip levels though, so we will make sure that our calculations
-        result in progressively more and more scaled down images.
+        Merges in the thread caches and writes everything out. Failing to save only costs the
+        next launch some time, so it is reported rather than thrown.
 
-        Also Note: Vulkan will automatically place the new texels in the appropriate memory
-        location when we tell it what mip level the destination is. Sweet.
-    Creator:    John Cox, 02/2019
+        Note: Nothing may be creating pipelines with the thread caches while this runs.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void GenerateMipMaps(VkImage image, VkFormat imageFormat, int32_t tWidth, int32_t tHeight, uint32_t mipLevels) {
-        // first check if image format supports blitting like this ("linear blitting")
-        // Note: Not all platforms support "blitting", so need to check for it's support if 
-        // planning on making this program cross-platform.
-        // (??what are "platforms"? Windows vs Linux? PC vs phone??) 
-        // Also Note: The image was created with VK_IMAGE_TILING_OPTIMAL, so we need to check if 
-        // "optimal tiling" even supports linear filtering from one image to another (it is 
-        // expected to; if it doesn't...don't know what to do).
-        VkFormatProperties formatProperties;
-        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, imageFormat, &formatProperties);
-        if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-            throw std::runtime_error("texture image format does not support linear blitting");
+    void Save() {
+        if (mCache == VK_NULL_HANDLE || mFilePath.empty()) {
+            return;
         }
 
-        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = image;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
+        {
+            std::lock_guard<std::mutex> lock(mThreadCachesMutex);
+            if (!mThreadCaches.empty()) {
+                vkMergePipelineCaches(mDevice, mCache, static_cast<uint32_t>(mThreadCaches.size()), mThreadCaches.data());
+            }
+        }
 
-        int32_t mipWidth = tWidth;
-        int32_t mipHeight = tHeight;
-        int32_t mipDepth = 1;
-        VkDependencyFlags barrierDependencyFlags = 0;
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(mDevice, mCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+            std::cout << "Pipeline cache: nothing to save" << std::endl;
+            return;
+        }
+        std::vector<char> data(dataSize);
+        if (vkGetPipelineCacheData(mDevice, mCache, &dataSize, data.data()) != VK_SUCCESS) {
+            std::cout << "Pipeline cache: failed to get data; not saved" << std::endl;
+            return;
+        }
 
-        // Note: On each loop:
-        // - transition mip level (index) i - 1 from a transfer destination to a source
-        // - wait for that level to be filled (either vkCmdBlitImage or vkCmdCopyBufferToImage)
-        // - start a blit command to create the next mip level from the previous
-        for (uint32_t mipIndex = 1; mipIndex < mipLevels; mipIndex++) {
-            // Note: Each mip level can have its own layout. The entire image (all mip levels) is 
-            // created with the same layout. The CreateTextureImage(...) function transitions 
-            // images after creation and buffer copy to being a transfer destination. As this loop 
-            // progresses, need to change the previous texture region (mip level) to a transfer 
-            // source. For the first loop, the base texture image is set to source.
-            barrier.subresourceRange.baseMipLevel = mipIndex - 1;
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        std::string tempPath = mFilePath + ".tmp";
+        {
+            std::ofstream outFile(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            outFile.write(data.data(), static_cast<std::streamsize>(dataSize));
+            if (!outFile.good()) {
+                std::cout << "Pipeline cache: failed to write '" << tempPath << "'; not saved" << std::endl;
+                return;
+            }
+        }
 
-            vkCmdPipelineBarrier(commandBuffer,
-                VK_PIPELINE_STAGE_TRANSFER_BIT,
-                VK_PIPELINE_STAGE_TRANSFER_BIT, barrierDependencyFlags,
-                0, nullptr,     // memory barrier
-                0, nullptr,     // buffer memory barrier
-                1, &barrier);   // image memory barrier
+        // Note: std::filesystem::rename(...) replaces an existing file on both Windows and 
+        // POSIX (std::rename(...) doesn't on Windows).
+        std::error_code error;
+        std::filesystem::rename(tempPath, mFilePath, error);
+        if (error) {
+            std::cout << "Pipeline cache: failed to replace '" << mFilePath << "' (" << error.message() << "); not saved" << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+        std::cout << "Pipeline cache: saved " << dataSize << " bytes to '" << mFilePath << "'" << std::endl;
+    }
 
-            // minimum mipmap size 1px x 1px
-            // Note: We are only dealing with 2D textures at this time (2/2/2019), so Z will not 
-            // have any changes.
-            // Also Note: Each mip map level must be constructed from the previous, so only one 
-            // region at a time
-            std::vector<VkImageBlit> blit(1);
+    void Cleanup() {
+        for (VkPipelineCache cache : mThreadCaches) {
+            vkDestroyPipelineCache(mDevice, cache, nullptr);
+        }
+        mThreadCaches.clear();
+        if (mCache != VK_NULL_HANDLE) {
+            vkDestroyPipelineCache(mDevice, mCache, nullptr);
+            mCache = VK_NULL_HANDLE;
+        }
+    }
 
-            // describe source region (width = x_src_1 - x_src_0, etc.)
-            blit.at(0).srcOffsets[0] = { 0, 0, 0 }; // VkOffset3D
-            blit.at(0).srcOffsets[1] = { mipWidth, mipHeight, mipDepth };
-            blit.at(0).srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.at(0).srcSubresource.mipLevel = mipIndex - 1;
-            blit.at(0).srcSubresource.baseArrayLayer = 0;
-            blit.at(0).srcSubresource.layerCount = 1;
+private:
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The header layout is fixed by the spec (VkPipelineCacheHeaderVersionOne), but read it
+        field by field rather than casting the struct over the data in case of padding.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static bool IsHeaderValid(const std::vector<char> &data, const VkPhysicalDeviceProperties &deviceProperties, std::string &reason) {
+        const size_t minHeaderSize = (4 * sizeof(uint32_t)) + VK_UUID_SIZE;
+        if (data.size() < minHeaderSize) {
+            reason = "too small";
+            return false;
+        }
 
-            // describe destination region (width = x_dst_1 - x_dst_0, etc.)
-            blit.at(0).dstOffsets[0] = { 0, 0, 0 }; // VkOffset3D;
-            blit.at(0).dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth };
-            blit.at(0).dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.at(0).dstSubresource.mipLevel = mipIndex;
-            blit.at(0).dstSubresource.baseArrayLayer = 0;
-            blit.at(0).dstSubresource.layerCount = 1;
+        uint32_t headerFields[4]{};
+        memcpy(headerFields, data.data(), sizeof(headerFields));
+        uint32_t headerSize = headerFields[0];
+        uint32_t headerVersion = headerFields[1];
+        uint32_t vendorId = headerFields[2];
+        uint32_t deviceId = headerFields[3];
+        const uint8_t *uuid = reinterpret_cast<const uint8_t *>(data.data()) + sizeof(headerFields);
+
+        if (headerSize < minHeaderSize || headerSize > data.size()) {
+            reason = "bad header size";
+            return false;
+        }
+        if (headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+            reason = "unknown header version";
+            return false;
+        }
+        if (vendorId != deviceProperties.vendorID || deviceId != deviceProperties.deviceID) {
+            reason = "made by a different device";
+            return false;
+        }
+        if (memcmp(uuid, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            reason = "made by a different driver version";
+            return false;
+        }
+        return true;
+    }
 
-            // do the actual command to scale down the previous image to make this mip level
-            vkCmdBlitImage(commandBuffer,
-                image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,    // src image == dst image
-                image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                static_cast<uint32_t>(blit.size()), blit.data(),
-                VK_FILTER_LINEAR);
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkPipelineCache mCache = VK_NULL_HANDLE;
+    std::string mFilePath;
+    std::vector<char> mFileData;
+    size_t mLoadedBytes = 0;
+    std::string mStatus;
 
-            // reuse the VkImageBarrier to transition the previous region (mip level) to be shader 
-            // read-only before moving on
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            vkCmdPipelineBarrier(commandBuffer,
-                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, barrierDependencyFlags,
-                0, nullptr,
-                0, nullptr,
-                1, &barrier);
+    std::mutex mThreadCachesMutex;
+    std::vector<VkPipelineCache> mThreadCaches;
+};
 
-            // make sure to do the ">1?" check on both dimensions in case our texture isn't square
-            mipWidth = (mipWidth > 1) ? mipWidth / 2 : 1;
-            mipHeight = (mipHeight > 1) ? mipHeight / 2 : 1;
-        }
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Everything that makes one graphics pipeline different from another. Handles (render pass,
+    vertex layout) are referred to by name so that a description means the same thing from one
+    run to the next and can be written to the prewarm list (see PipelineManager). Whoever builds
+    the pipeline looks the names up.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+struct PipelineDescription {
+    std::string vertexShader;
+    std::string fragmentShader;     // "none" => no fragment stage (ex: depth only)
+    std::string vertexLayout = "Vertex";
+    std::string renderPass = "main";
 
-        // now transition that last mip level (index) to be used by the fragment shader
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        vkCmdPipelineBarrier(commandBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, barrierDependencyFlags,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
+    // (constant_id, value), sorted by constant_id so that equal descriptions print and hash 
+    // the same
+    std::vector<std::pair<uint32_t, uint32_t>> specializationConstants;
 
-        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        One line of text: "vert frag layout pass id=value id=value ...". Also what is hashed.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::string ToString() const {
+        std::stringstream ss;
+        ss << vertexShader << " " << fragmentShader << " " << vertexLayout << " " << renderPass;
+        for (const auto &constant : specializationConstants) {
+            ss << " " << constant.first << "=" << constant.second;
+        }
+        return ss.str();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Loads a JPEG into a buffer of pixel data, creates a VkImage for it and allocates memory
-        for it, copies the pixels into it, then transitions the image for optimal use by the
-        shaders.
+        The reverse of ToString(). Returns false if the line is malformed.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static bool FromString(const std::string &line, PipelineDescription &description) {
+        std::stringstream ss(line);
+        PipelineDescription parsed{};
+        if (!(ss >> parsed.vertexShader >> parsed.fragmentShader >> parsed.vertexLayout >> parsed.renderPass)) {
+            return false;
+        }
+        std::string token;
+        while (ss >> token) {
+            size_t equalsPos = token.find('=');
+            if (equalsPos == std::string::npos) {
+                return false;
+            }
+            try {
+                uint32_t constantId = static_cast<uint32_t>(std::stoul(token.substr(0, equalsPos)));
+                uint32_t value = static_cast<uint32_t>(std::stoul(token.substr(equalsPos + 1)));
+                parsed.specializationConstants.emplace_back(constantId, value);
+            }
+            catch (const std::exception &) {
+                return false;
+            }
+        }
+        std::sort(parsed.specializationConstants.begin(), parsed.specializationConstants.end());
+        description = std::move(parsed);
+        return true;
+    }
 
-        Stock image:
-        https://pixabay.com/en/statue-sculpture-figure-1275469/
-    Creator:    John Cox, 01/2019
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        64-bit FNV-1a of ToString(). Plenty to keep a few hundred variants apart.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateTextureImage() {
-        int tWidth = 0;
-        int tHeight = 0;
-        int numActualChannels = 0;
-        int requestedComposition = STBI_rgb_alpha;
-        /*stbi_uc *pixels = stbi_load("textures/statue.jpg", &tWidth, &tHeight, &numActualChannels, STBI_rgb_alpha);*/
-        stbi_uc *pixels = stbi_load("textures/chalet.jpg", &tWidth, &tHeight, &numActualChannels, STBI_rgb_alpha);
+    uint64_t Hash() const {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : ToString()) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
 
-        // - max finds largest dimension (w or h)
-        // - log2 finds how many times that dimension can be divided by 2
-        // - floor rounds down to the nearest integer just in case the largest dimension was not a 
-        //  power of two
-        // - at least 1 (base image is mip level 0 and must exist for the texture to draw at all)
-        mTextureMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(tWidth, tHeight)))) + 1;
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Compiles graphics pipelines on background threads so that asking for a new variant never
+    stalls a frame.
+
+    Pipelines are asked for by description (see PipelineDescription). Request(...) hands back a
+    key (the description's hash) and queues the compile if this is the first time that it has
+    been seen. Get(key) then returns that pipeline if it is ready, or the fallback pipeline (one
+    that was compiled up front, see AddSynchronously(...)) until it is. Drawing with the fallback
+    for a few frames looks slightly off, but a hitch is worse.
+
+    Every description that was asked for is written to a prewarm list at exit, and replaying
+    that list at startup (Prewarm(...)) gets the compiles going before anything asks for them.
+    Together with the on-disk pipeline cache, most of those compiles are then cache hits.
+
+    The manager doesn't know how to build a pipeline; that is the build function given to
+    Init(...), which is called on the worker threads with that thread's own pipeline cache
+    (merged into the main one on save, see PipelineCacheFile).
+
+    When a shader changes (see Rebuild(...)), the variants that use it are recompiled in the
+    background too, and keep drawing with their old pipeline until the new one is ready. The
+    old ones are handed back through TakeReplaced() for the caller to destroy once the GPU is
+    done with them.
+
+    Note: The build function runs concurrently with rendering, so it must only read things that
+    don't change while pipelines are in use (the render pass can change, but only after
+    RetireAll(), which waits out any compiles in progress).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class PipelineManager {
+public:
+    using BuildFunction = std::function<VkPipeline(const PipelineDescription &, VkPipelineCache)>;
+    using ThreadCacheFunction = std::function<VkPipelineCache()>;
 
-        // Note: We requested the image with RGBA, so even if it doesn't actually have 4 channels, 
-        // we'll get a 4-channel image (alpha expected to be 0), so we should allocate space for 
-        // that.
-        VkDeviceSize imageSize = tWidth * tHeight * 4;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Starts the compile threads. Each one asks for its pipeline cache before its first
+        compile.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Init(VkDevice device, uint32_t numThreads, BuildFunction build, ThreadCacheFunction createThreadCache) {
+        mDevice = device;
+        mBuild = std::move(build);
+        mCreateThreadCache = std::move(createThreadCache);
+        mStopping = false;
+        for (uint32_t i = 0; i < std::max(numThreads, 1u); i++) {
+            mThreads.emplace_back(&PipelineManager::WorkerMain, this);
+        }
+    }
 
-        if (pixels == nullptr) {
-            throw std::runtime_error("failed to load texture image");
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Compiles on the calling thread and stores the result as ready. This is for the fallback
+        pipeline, which has to exist before anything can be drawn.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint64_t AddSynchronously(const PipelineDescription &description, VkPipelineCache cache) {
+        VkPipeline pipeline = mBuild(description, cache);
+
+        uint64_t key = description.Hash();
+        std::lock_guard<std::mutex> lock(mMutex);
+        Variant &variant = mVariants[key];
+        variant.description = description;
+        if (variant.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(mDevice, variant.pipeline, nullptr);
         }
+        variant.pipeline = pipeline;
+        variant.state = State::READY;
+        return key;
+    }
 
-        // we want this image to live in GPU memory for fast access, but as with the vertex 
-        // buffer, DEVICE_LOCAL memory is not host coherent, so we'll have to make a staging 
-        // buffer for it, copy to that, then copy that into device-only-accessible memory
-        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        VkBuffer stagingBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
-        CreateBuffer(imageSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
+    void SetFallback(uint64_t key) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto itr = mVariants.find(key);
+        if (itr == mVariants.end() || itr->second.state != State::READY) {
+            throw std::runtime_error("fallback pipeline must be compiled already");
+        }
+        mFallbackKey = key;
+    }
 
-        // copy pixels to host-coherent GPU memory
-        void *data = nullptr;
-        VkDeviceSize zeroOffset = 0;
-        VkMemoryMapFlags flags = 0;
-        vkMapMemory(mLogicalDevice, stagingBufferMemory, zeroOffset, imageSize, flags, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
-        stbi_image_free(pixels);    // done with the image now
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Returns the key for Get(...). Queues a compile unless the variant is already compiled,
+        compiling, or waiting to be.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint64_t Request(const PipelineDescription &description) {
+        uint64_t key = description.Hash();
+        std::lock_guard<std::mutex> lock(mMutex);
+        Variant &variant = mVariants[key];
+        if (variant.state == State::IDLE) {
+            variant.description = description;
+            Enqueue(key, variant);
+        }
+        return key;
+    }
 
-        // now create a Vulkan image for it
-        VkFormat imageFormat = VK_FORMAT_R8G8B8A8_UNORM;      //??what happens if it isn't? is this just JPEG??
-        VkImageTiling imageTiling = VK_IMAGE_TILING_OPTIMAL;
-        VkImageUsageFlags imageUsage =
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT;
-        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-        CreateImage(tWidth, tHeight, mTextureMipLevels,
-            imageFormat,
-            imageTiling,
-            imageUsage,
-            memProperties,
-            mTextureImage,
-            mTextureImageMemory);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The variant's pipeline if it has finished compiling, otherwise the fallback. Called
+        every frame, so this only takes the lock long enough for a lookup.
 
-        // copy staging buffer into VkImage memory
-        VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        VkImageLayout destLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        TransitionImageLayout(mTextureImage, imageFormat, currentLayout, destLayout, mTextureMipLevels);
-        CopyBufferToImage(stagingBuffer, mTextureImage, destLayout, static_cast<uint32_t>(tWidth), static_cast<uint32_t>(tHeight));
+        Note: A pipeline can only stand in for another one that is used in the same subpass, 
+        so variants for other subpasses (ex: the depth pre-pass) give their own fallback, which 
+        must also have been added synchronously. 0 => the main fallback.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkPipeline Get(uint64_t key, uint64_t fallbackKey = 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto itr = mVariants.find(key);
+        if (itr != mVariants.end() && itr->second.state == State::READY) {
+            return itr->second.pipeline;
+        }
+        mNumFallbackUses++;
+        auto fallback = mVariants.find((fallbackKey != 0) ? fallbackKey : mFallbackKey);
+        return (fallback != mVariants.end()) ? fallback->second.pipeline : VK_NULL_HANDLE;
+    }
 
-        // generate the lesser detailed textures for the non-base mip levels
-        GenerateMipMaps(mTextureImage, VK_FORMAT_R8G8B8A8_UNORM, tWidth, tHeight, mTextureMipLevels);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Blocks until the variant is done compiling (for benchmarks, which shouldn't measure the
+        fallback). Returns false if it failed.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool WaitUntilCompiled(uint64_t key) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdleCondition.wait(lock, [this, key]() {
+            State state = mVariants.at(key).state;
+            return state != State::QUEUED && state != State::COMPILING;
+        });
+        return mVariants.at(key).state == State::READY;
+    }
 
-        // lastly, create a view for the new image
-        mTextureImageView = CreateImageView(mTextureImage, imageFormat, VK_IMAGE_ASPECT_COLOR_BIT, mTextureMipLevels);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Queues everything on the list. Nothing waits on these.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Prewarm(const std::vector<PipelineDescription> &descriptions) {
+        for (const auto &description : descriptions) {
+            Request(description);
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        mNumPrewarmed += descriptions.size();
+    }
 
-        // cleanup
-        vkDestroyBuffer(mLogicalDevice, stagingBuffer, nullptr);
-        vkFreeMemory(mLogicalDevice, stagingBufferMemory, nullptr);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Reads a prewarm list written by SavePrewarmList(...). A missing file just means an
+        empty list (first run), and malformed lines are skipped.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static std::vector<PipelineDescription> LoadPrewarmList(const std::string &filePath) {
+        std::vector<PipelineDescription> descriptions;
+        std::ifstream inFile(filePath);
+        std::string line;
+        while (std::getline(inFile, line)) {
+            PipelineDescription description{};
+            if (!line.empty() && line[0] != '#' && PipelineDescription::FromString(line, description)) {
+                descriptions.push_back(std::move(description));
+            }
+        }
+        return descriptions;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        A texture sampler tells Vulkan how to access the pixels of an image ("an image" indicating
-        to any image that it is applied to; the sampler itself does not have a link to any image).
-        If the fragment density exceeds the texel density for a given triangle and texture, and
-        nothing clever is done but rather the fragment shader just takes the closest pixel, then
-        the result is blocky and pixelated as a chunk of fragments take on the same texel, and an
-        adjacent chunk of fragments take on the adjacent text. This is called "oversampling", and
-        can be seen with low-res textures up close.
+        Writes out every description that was asked for this run, whether or not it finished
+        compiling. Like the pipeline cache, failing to save is reported rather than thrown.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void SavePrewarmList(const std::string &filePath) const {
+        std::ofstream outFile(filePath, std::ios::out | std::ios::trunc);
+        outFile << "# pipelines to compile at startup; rewritten at exit" << std::endl;
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto &entry : mVariants) {
+            outFile << entry.second.description.ToString() << std::endl;
+        }
+        if (!outFile.good()) {
+            std::cout << "Pipeline prewarm list: failed to write '" << filePath << "'" << std::endl;
+        }
+    }
 
-        On the flip side (that is, the fragment density is less than the texel density), adjacent
-        fragments will take on non-adjacent texels, and the result is blurry. This is called
-        "undersampling", and can be seen with hi-res textures at a distance.
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        For when whatever the pipelines were built against is about to change (ex: the render
+        pass, after a swap chain format change). Drops anything waiting to compile, waits out
+        anything compiling, and hands back every pipeline for the caller to destroy once the GPU
+        is done with them. The descriptions are kept, so RequeueAll() can compile them again.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::vector<VkPipeline> RetireAll() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mQueue.clear();
+        mIdleCondition.wait(lock, [this]() { return mNumCompiling == 0; });
+
+        std::vector<VkPipeline> retired;
+        for (auto &entry : mVariants) {
+            if (entry.second.pipeline != VK_NULL_HANDLE) {
+                retired.push_back(entry.second.pipeline);
+            }
+            entry.second.pipeline = VK_NULL_HANDLE;
+            entry.second.state = State::IDLE;
+            entry.second.rebuildQueued = false;
+        }
+        return retired;
+    }
 
-        A sampler can specify filtering techniques and how to handle texel coordinate requests
-        that are outside the border of the texture (repeat for a tiled image, mirrored repeat,
-        clamping).
+    void RequeueAll() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto &entry : mVariants) {
+            if (entry.second.state == State::IDLE) {
+                Enqueue(entry.first, entry.second);
+            }
+        }
+    }
 
-        Note: "Minification" is the process of dealing with oversampling, and "magnification" is
-        the process of dealing with undersampling.
-    Creator:    John Cox, 01/2019
-    ---------------------------------------------------------------------------------------------*/
-    void CreateTextureSampler() {
-        VkSamplerCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-        createInfo.magFilter = VK_FILTER_LINEAR;    // more texels than fragments
-        createInfo.minFilter = VK_FILTER_LINEAR;    // more fragments than texels
-        createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-        createInfo.minLod = 0.0f;
-        //createInfo.maxLod = 0.0f;
-        createInfo.maxLod = static_cast<float>(mTextureMipLevels);
-        createInfo.mipLodBias = 0.0f;
-        createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;   // in other words, tiling
-        createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        createInfo.anisotropyEnable = VK_TRUE;
-        createInfo.maxAnisotropy = 16;
-        createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-        createInfo.unnormalizedCoordinates = VK_FALSE;  // ??maybe TRUE if using sparse textures??
-        createInfo.compareEnable = VK_FALSE;    // not using "texel compare" operations for now
-        createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Recompiles every variant that uses the given shader, for when the shader itself changed
+        (the build function has to pick up the new code on its own). Returns how many variants
+        that is.
 
-        if (vkCreateSampler(mLogicalDevice, &createInfo, nullptr, &mTextureSampler) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create texture sampler");
+        Variants that are compiling right now go again once they finish, since they may have
+        started with the old code, and variants that had failed get another chance.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    size_t Rebuild(const std::string &shaderPath) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t numAffected = 0;
+        for (auto &entry : mVariants) {
+            Variant &variant = entry.second;
+            if (variant.description.vertexShader != shaderPath && variant.description.fragmentShader != shaderPath) {
+                continue;
+            }
+            numAffected++;
+            if (variant.state == State::FAILED) {
+                Enqueue(entry.first, variant);
+            }
+            else if (variant.state == State::COMPILING || (variant.state == State::READY && variant.rebuilding)) {
+                // the worker puts it back in the queue when it's done (see WorkerMain())
+                variant.rebuildQueued = true;
+            }
+            else if (variant.state == State::READY && !variant.rebuildQueued) {
+                variant.rebuildQueued = true;
+                mQueue.push_back(entry.first);
+                mWorkCondition.notify_one();
+            }
+            // else queued already, or idle (will compile with the new code whenever it does)
         }
+        return numAffected;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Loads the vertices and vertex indexes contained in the object model into vertex storage.
-    Creator:    John Cox, 02/2019
+        The pipelines that rebuilds have replaced since the last call. The caller destroys them
+        once the GPU is done with them.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void LoadModel() {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn;
-        std::string err;
+    std::vector<VkPipeline> TakeReplaced() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<VkPipeline> replaced;
+        replaced.swap(mReplaced);
+        return replaced;
+    }
 
-        // Note: Faces can contain an arbitrary number of vertices, and we might try to load a 
-        // model that was constructed with, say, quads, but LoadObj has an optional parameter 
-        // "triangulate" and is set to true by default, so we don't need to worry about anything 
-        // except triangles.
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "models/chalet.obj")) {
-            throw std::runtime_error(warn + err);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        "N variants, N compiled in the background (avg X ms), N fallback uses"
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::string GetSummary() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << mVariants.size() << " variants (" << mNumPrewarmed << " prewarmed), ";
+        ss << mNumCompiled << " compiled in the background";
+        if (mNumCompiled > 0) {
+            ss << " (avg " << (mTotalCompileMs / mNumCompiled) << " ms)";
+        }
+        if (mNumFailed > 0) {
+            ss << ", " << mNumFailed << " failed";
         }
+        ss << ", " << mNumFallbackUses << " fallback uses";
+        if (mNumRebuilt > 0) {
+            ss << ", " << mNumRebuilt << " rebuilt after shader changes";
+        }
+        return ss.str();
+    }
 
-        for (const auto &s : shapes) {
-            std::cout << "shape name: " << s.name << std::endl;
-            std::cout << "shape mesh face count: " << s.mesh.num_face_vertices.size() << std::endl;
-
-            // there are some duplicate vertices in this mesh that we'll want to trim out
-            // Note: The whole point of using vertex indices is to avoid duplicating vertices. An 
-            // index is cheap to copy. A vertex much less so. There are 1/2 million faces in this 
-            // model, ~700k vertices extracted (but only ~260k unique ones), and 1.5 million 
-            // indices. Definitely want to avoid duplicating vertices when this much memory is at 
-            // stake.
-            std::unordered_map<Vertex, uint32_t> uniqueVertexIndices{};
-
-            for (const auto &i : s.mesh.indices) {
-                Vertex v{};
-                v.pos = {
-                    attrib.vertices[(3 * i.vertex_index) + 0],
-                    attrib.vertices[(3 * i.vertex_index) + 1],
-                    attrib.vertices[(3 * i.vertex_index) + 2],
-                };
-                v.texCoord = {
-                    attrib.texcoords[(2 * i.texcoord_index) + 0],
-                    1.0f - attrib.texcoords[(2 * i.texcoord_index) + 1],
-                };
-                v.color = { 1.0f, 1.0f, 1.0f };
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Stops the threads (abandoning anything not yet started). Must be called before the
+        pipeline cache is saved, since the threads' caches get merged then.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+            mQueue.clear();
+        }
+        mWorkCondition.notify_all();
+        for (auto &thread : mThreads) {
+            thread.join();
+        }
+        mThreads.clear();
+    }
 
-                if (uniqueVertexIndices.count(v) == 0) {
-                    // haven't seen this before, so store the current vertex index
-                    uniqueVertexIndices[v] = static_cast<uint32_t>(mVertexes.size());
-                    mVertexes.push_back(v);
-                }
+    ~PipelineManager() {
+        Shutdown();
+    }
 
-                mVertexIndices.push_back(uniqueVertexIndices.at(v));
+    void Cleanup() {
+        for (auto &entry : mVariants) {
+            if (entry.second.pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(mDevice, entry.second.pipeline, nullptr);
             }
         }
+        mVariants.clear();
+        for (VkPipeline pipeline : mReplaced) {
+            vkDestroyPipeline(mDevice, pipeline, nullptr);
+        }
+        mReplaced.clear();
+    }
+
+private:
+    enum class State {
+        IDLE,       // known, but not compiled or queued (new, or retired)
+        QUEUED,
+        COMPILING,
+        READY,
+        FAILED,     // the fallback is used until a shader change (see Rebuild(...))
+    };
+
+    struct Variant {
+        PipelineDescription description;
+        State state = State::IDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
 
-        return;
+        // a READY variant being compiled again (see Rebuild(...)); the old pipeline is still 
+        // used until then
+        bool rebuilding = false;
+        bool rebuildQueued = false;
+    };
+
+    // mMutex must be held
+    void Enqueue(uint64_t key, Variant &variant) {
+        variant.state = State::QUEUED;
+        mQueue.push_back(key);
+        mWorkCondition.notify_one();
+    }
+
+    void WorkerMain() {
+        VkPipelineCache threadCache = VK_NULL_HANDLE;
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mWorkCondition.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+            if (mStopping) {
+                break;
+            }
+            uint64_t key = mQueue.front();
+            mQueue.pop_front();
+            Variant &variant = mVariants.at(key);
+            bool isRebuild = false;
+            if (variant.state == State::READY && variant.rebuildQueued && !variant.rebuilding) {
+                isRebuild = true;
+                variant.rebuildQueued = false;
+                variant.rebuilding = true;
+            }
+            else if (variant.state == State::QUEUED) {
+                variant.state = State::COMPILING;
+            }
+            else {
+                // compiled synchronously in the meantime
+                continue;
+            }
+            PipelineDescription description = variant.description;
+            mNumCompiling++;
+            lock.unlock();
+
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            std::string error;
+            auto startTime = std::chrono::high_resolution_clock::now();
+            try {
+                if (threadCache == VK_NULL_HANDLE) {
+                    threadCache = mCreateThreadCache();
+                }
+                pipeline = mBuild(description, threadCache);
+            }
+            catch (const std::exception &e) {
+                error = e.what();
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+            lock.lock();
+            // Note: The map never erases while threads are running, so the reference is still 
+            // good, but look it up again anyway rather than rely on that.
+            Variant &finished = mVariants.at(key);
+            if (isRebuild) {
+                finished.rebuilding = false;
+                if (pipeline != VK_NULL_HANDLE) {
+                    mReplaced.push_back(finished.pipeline);
+                    finished.pipeline = pipeline;
+                    mNumRebuilt++;
+                }
+                else {
+                    // keep drawing with what worked last
+                    std::cout << "Pipeline '" << description.ToString() << "' failed to rebuild: " << error << std::endl;
+                }
+            }
+            else if (pipeline != VK_NULL_HANDLE && finished.pipeline != VK_NULL_HANDLE) {
+                // AddSynchronously(...) beat us to it
+                vkDestroyPipeline(mDevice, pipeline, nullptr);
+            }
+            else if (pipeline != VK_NULL_HANDLE) {
+                finished.pipeline = pipeline;
+                finished.state = State::READY;
+                mNumCompiled++;
+                mTotalCompileMs += ms;
+            }
+            else {
+                std::cout << "Pipeline '" << description.ToString() << "' failed to compile: " << error << std::endl;
+                finished.state = State::FAILED;
+                mNumFailed++;
+            }
+            if (finished.rebuildQueued) {
+                // the shader changed while this was compiling
+                if (finished.state == State::FAILED) {
+                    finished.rebuildQueued = false;
+                    Enqueue(key, finished);
+                }
+                else {
+                    mQueue.push_back(key);
+                    mWorkCondition.notify_one();
+                }
+            }
+            mNumCompiling--;
+            mIdleCondition.notify_all();
+        }
     }
 
+    VkDevice mDevice = VK_NULL_HANDLE;
+    BuildFunction mBuild;
+    ThreadCacheFunction mCreateThreadCache;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkCondition;
+    std::condition_variable mIdleCondition;
+    std::unordered_map<uint64_t, Variant> mVariants;
+    std::deque<uint64_t> mQueue;
+    uint64_t mFallbackKey = 0;
+    std::vector<VkPipeline> mReplaced;
+    uint32_t mNumCompiling = 0;
+    bool mStopping = false;
+    std::vector<std::thread> mThreads;
+
+    size_t mNumPrewarmed = 0;
+    uint64_t mNumCompiled = 0;
+    uint64_t mNumFailed = 0;
+    uint64_t mNumFallbackUses = 0;
+    uint64_t mNumRebuilt = 0;
+    double mTotalCompileMs = 0.0;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Dynamic resolution. Picks the fraction of the output resolution (per axis) that the scene is
+    rendered at so that the GPU frame time stays at or under a target. Fed one GPU time per
+    frame (see GpuQueryProfiler), which arrives a few frames late.
+
+    Drops fast and climbs slow. The GPU time of the scene is roughly proportional to the number
+    of pixels, which is scale^2, so an over-budget frame drops the scale by sqrt(target/actual)
+    all at once. Climbing is one step at a time, and only after a good run of frames with
+    headroom to spare, so that it doesn't oscillate around the target. After every change, the
+    next few samples are ignored because they were already in flight at the old scale.
+
+    Also decides how big the offscreen target needs to be. That is done in coarse steps (see
+    ALLOCATION_STEP) rather than for every scale, and it only shrinks after the scale has stayed
+    well below it for a while, so that a load spike doesn't turn into a string of reallocations.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class ResolutionScaler {
+public:
+    // every scale is a multiple of this
+    static constexpr double SCALE_STEP = 1.0 / 16.0;
+
+    // the offscreen target is sized to a multiple of this
+    static constexpr double ALLOCATION_STEP = 1.0 / 4.0;
+
     /*---------------------------------------------------------------------------------------------
     Description:
-        Not all memory is created equal. Some is only available on the GPU ("device local"), some
-        is visible to the host (the program), some is coherent (immediately copied to a duplicate
-        chunk of GPU memory upon writing, though this has system-memory->GPU-memory transfer
-        costs), etc.
+        "cooldownFrames" should be at least the number of frames in flight (plus one), which is
+        how late a GPU time arrives.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Init(double targetMs, double minScale, uint32_t cooldownFrames) {
+        mTargetMs = targetMs;
+        mMinScale = std::min(std::max(Quantize(minScale, SCALE_STEP, true), SCALE_STEP), 1.0);
+        mCooldownFrames = cooldownFrames;
+        mScale = 1.0;
+        mAllocationScale = 1.0;
+    }
 
-        ??why are there a bunch of property-less pieces of memory??
-    Creator:    John Cox, 12/2018
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Call once per collected GPU frame time. Returns true if the scale changed.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-        VkPhysicalDeviceMemoryProperties memoryProperties{};
-        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
-        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-            //std::stringstream ss;
-            //ss << "memory type[" << i << "], heap index '" << memoryProperties.memoryTypes[i].heapIndex << "':";
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0) {
-            //    ss << " DEVICE_LOCAL";
-            //}
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
-            //    ss << " HOST_VISIBLE";
-            //}
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) {
-            //    ss << " HOST_COHERENT";
-            //}
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0) {
-            //    ss << " HOST_CACHED";
-            //}
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0) {
-            //    ss << " LAZILY_ALLOCATED";
-            //}
-            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_PROTECTED_BIT) != 0) {
-            //    ss << " PROTECTED_BIT";
-            //}
-            //std::cout << ss.str() << std::endl;
+    bool AddGpuTime(double gpuMs) {
+        mNumSamples++;
+        mTotalScale += mScale;
+        mLowestScale = std::min(mLowestScale, mScale);
+        if (gpuMs <= 0.0) {
+            return false;
+        }
 
-            bool typeOk = (typeFilter & (1 << i)) != 0;
+        if (mCooldown > 0) {
+            mCooldown--;
+            return false;
+        }
 
-            // Problem: More than one memory property may be requested, so a simple bitwise 
-            // AND != 0 check won't be suitable, and there may be more properties available than 
-            // we are asking for, so a simple equivalence check won't work either. Solution: Check 
-            // if the bitwise AND has all the requested properties.
-            bool propertyOk = (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties;
-            if (typeOk && propertyOk) {
-                return i;
+        double newScale = mScale;
+        if (gpuMs > mTargetMs) {
+            newScale = Quantize(mScale * std::sqrt(mTargetMs / gpuMs), SCALE_STEP, false);
+            mFramesUnderBudget = 0;
+        }
+        else if (gpuMs < mTargetMs * HEADROOM) {
+            if (++mFramesUnderBudget >= FRAMES_BEFORE_CLIMB) {
+                newScale = mScale + SCALE_STEP;
+                mFramesUnderBudget = 0;
+            }
+        }
+        else {
+            // close to the target; stay put
+            mFramesUnderBudget = 0;
+        }
+
+        newScale = std::min(std::max(newScale, mMinScale), 1.0);
+        if (newScale == mScale) {
+            return false;
+        }
+
+        mScale = newScale;
+        mCooldown = mCooldownFrames;
+        mNumChanges++;
+        return true;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The scale that the offscreen target should be allocated at. Grows right away when the
+        current scale doesn't fit, shrinks one step at a time after SHRINK_AFTER_FRAMES frames
+        of not needing it. Call once per frame.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    double UpdateAllocationScale() {
+        double needed = Quantize(mScale, ALLOCATION_STEP, true);
+        if (needed > mAllocationScale) {
+            mAllocationScale = needed;
+            mFramesOversized = 0;
+        }
+        else if (needed < mAllocationScale) {
+            if (++mFramesOversized >= SHRINK_AFTER_FRAMES) {
+                mAllocationScale -= ALLOCATION_STEP;
+                mFramesOversized = 0;
+            }
+        }
+        else {
+            mFramesOversized = 0;
+        }
+        return mAllocationScale;
+    }
+
+    double GetScale() const {
+        return mScale;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Ex: "avg scale 0.81, min 0.56, 14 changes"
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::string GetSummary() const {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "target " << mTargetMs << " ms, avg scale " << (mNumSamples == 0 ? mScale : mTotalScale / static_cast<double>(mNumSamples))
+            << ", min " << std::min(mLowestScale, mScale) << ", " << mNumChanges << " changes";
+        return ss.str();
+    }
+
+private:
+    // climb once the GPU time has been under this fraction of the target for a while
+    static constexpr double HEADROOM = 0.85;
+    static const uint32_t FRAMES_BEFORE_CLIMB = 30;
+    static const uint32_t SHRINK_AFTER_FRAMES = 300;
+
+    static double Quantize(double value, double step, bool roundUp) {
+        // the small bias keeps exact multiples from being pushed a step by rounding error
+        double steps = value / step;
+        return step * (roundUp ? std::ceil(steps - 1e-6) : std::floor(steps + 1e-6));
+    }
+
+    double mTargetMs = 16.67;
+    double mMinScale = 0.5;
+    uint32_t mCooldownFrames = 3;
+
+    double mScale = 1.0;
+    double mAllocationScale = 1.0;
+    uint32_t mCooldown = 0;
+    uint32_t mFramesUnderBudget = 0;
+    uint32_t mFramesOversized = 0;
+
+    uint64_t mNumSamples = 0;
+    uint64_t mNumChanges = 0;
+    double mTotalScale = 0.0;
+    double mLowestScale = 1.0;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    What a pass does with an image or buffer. Each one stands for the pipeline stages that touch
+    it, the kind of memory access they make, and (images only) the layout it has to be in, as
+    listed in GetResourceUsageInfo(...). Barriers are worked out from a pair of these (before
+    and after) instead of being written out by hand.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+enum class ResourceUsage : uint32_t {
+    NONE = 0,                   // nothing yet; contents undefined
+    ACQUIRED,                   // a swap chain image straight from vkAcquireNextImageKHR(...)
+    TRANSFER_SRC,
+    TRANSFER_DST,
+    COLOR_ATTACHMENT,
+    DEPTH_ATTACHMENT,
+    FRAGMENT_SAMPLED,           // textures
+    COMPUTE_SAMPLED_DEPTH,      // a depth image read by a compute shader
+    COMPUTE_SAMPLED,            // a (storage) image read through a sampler, still in GENERAL
+    COMPUTE_STORAGE_READ,
+    COMPUTE_STORAGE_WRITE,
+    COMPUTE_STORAGE_READ_WRITE,
+    INDIRECT_READ,              // draw parameters
+    PRESENT,
+    COUNT
+};
+
+struct ResourceUsageInfo {
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    VkImageLayout layout;       // ignored for buffers
+    bool writes;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    The table behind ResourceUsage. Adding a new kind of usage is one line here rather than
+    another branch in every function that makes barriers.
+
+    Note: ACQUIRED is on the color attachment stage with no access because that is the stage
+    that waits on the acquire semaphore (see DrawFrame()). Anything that waits on it waits on
+    the acquire too.
+
+    Also Note: PRESENT isn't a pipeline stage. BOTTOM_OF_PIPE with no access is the way to say
+    "nothing after this in the command buffer"; the semaphore that present waits on does the
+    rest.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+const ResourceUsageInfo &GetResourceUsageInfo(ResourceUsage usage) {
+    const VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    static const std::array<ResourceUsageInfo, static_cast<size_t>(ResourceUsage::COUNT)> table{ {
+        { 0, 0, VK_IMAGE_LAYOUT_UNDEFINED, false },
+        { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, false },
+        { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false },
+        { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true },
+        { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true },
+        { depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true },
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false },
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false },
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false },
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false },
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true },
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true },
+        { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false },
+        { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false },
+    } };
+    return table.at(static_cast<size_t>(usage));
+}
+
+// the access bits that put something in memory (as opposed to reading it)
+const VkAccessFlags WRITE_ACCESS_MASK =
+    VK_ACCESS_SHADER_WRITE_BIT |
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_TRANSFER_WRITE_BIT |
+    VK_ACCESS_HOST_WRITE_BIT |
+    VK_ACCESS_MEMORY_WRITE_BIT;
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    A one-off barrier between two usages of (part of) an image, for code that runs outside of the
+    frame's RenderGraph (texture uploads and mip map generation).
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+void RecordImageBarrier(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange &range, ResourceUsage from, ResourceUsage to) {
+    const ResourceUsageInfo &src = GetResourceUsageInfo(from);
+    const ResourceUsageInfo &dst = GetResourceUsageInfo(to);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = src.layout;
+    barrier.newLayout = dst.layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+    barrier.srcAccessMask = src.writes ? (src.access & WRITE_ACCESS_MASK) : 0;
+    barrier.dstAccessMask = dst.access;
+
+    // "nothing before" still needs a stage; TOP_OF_PIPE waits on nothing
+    VkPipelineStageFlags srcStages = src.stages;
+    if (srcStages == 0) {
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer,
+        srcStages, dst.stages, 0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    One half of handing (part of) an image from one queue family to another, ex: graphics ->
+    async compute and back. The family that has been using it records the release, and the one
+    that uses it next records the acquire, after waiting on a semaphore that the release's
+    submission signals. Both halves have to describe the same layout change.
+
+    Note: The release can't name the other queue's stages (a compute queue has no fragment
+    stage), so it ends at BOTTOM_OF_PIPE, and the semaphore carries the dependency the rest of
+    the way. The acquire starts at the stages that it will be used in, which is also what the
+    semaphore wait should wait at.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+void RecordQueueFamilyTransfer(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange &range, ResourceUsage from, ResourceUsage to, uint32_t srcQueueFamily, uint32_t dstQueueFamily, bool isRelease) {
+    const ResourceUsageInfo &src = GetResourceUsageInfo(from);
+    const ResourceUsageInfo &dst = GetResourceUsageInfo(to);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = src.layout;
+    barrier.newLayout = dst.layout;
+    barrier.srcQueueFamilyIndex = srcQueueFamily;
+    barrier.dstQueueFamilyIndex = dstQueueFamily;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    if (isRelease) {
+        barrier.srcAccessMask = src.writes ? (src.access & WRITE_ACCESS_MASK) : 0;
+        barrier.dstAccessMask = 0;
+        srcStages = (src.stages != 0) ? src.stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    }
+    else {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dst.access;
+        srcStages = dst.stages;
+        dstStages = dst.stages;
+    }
+    vkCmdPipelineBarrier(commandBuffer,
+        srcStages, dstStages, 0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    The frame as a list of passes, each of which declares the images and buffers that it reads
+    and writes (and how; see ResourceUsage). It is rebuilt every frame, and then:
+    - Compile() throws out passes whose results nobody uses (nothing downstream reads what they
+        write, and they aren't marked as having side effects), and finds memory for the
+        transient images.
+    - Execute(...) records the passes in order. Before each pass, everything that the pass needs
+        to wait on goes into a single vkCmdPipelineBarrier(...) with exactly the stages and
+        access masks of the usages on either side of it, and none at all if it doesn't need
+        to wait (ex: two reads in the same layout).
+
+    Imported resources live outside of the graph. Their owner keeps their ResourceState, so that
+    the first barrier of a frame knows what the last frame left them as.
+
+    Transient images belong to the graph and only live for the passes between their first and
+    last use. Two transients whose lifetimes don't overlap share memory. They are only
+    recreated when the set of them (or the way that they overlap) changes, so in a steady state
+    their handles stay the same from frame to frame and framebuffers can be cached on them.
+
+    Note: Barriers are per image or buffer, not per mip level. A pass that works its way
+    through mip levels (ex: the Hi-Z build) makes its own barriers between them.
+
+    Also Note: One queue only. Everything is recorded into the same command buffer.
+
+    And Also Note: Rebuilding it every frame is meant to cost next to nothing. Names are string
+    literals (const char *), Reset() keeps the passes (and their access lists) and the resource
+    list around to be filled in again, and the scratch space for Compile() and Execute(...) is
+    kept from frame to frame. In a steady state, none of it touches the heap. That's on the
+    caller too: a pass's function should capture little enough (ex: just "this") that
+    std::function can hold it without allocating.
+
+    And Also Also Note: A transient with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT (an attachment
+    that never leaves its render pass) gets lazily allocated memory if the device has any. That
+    memory is only committed if the driver needs it (on a tiler, usually never), so there is
+    nothing to gain from aliasing it, and it gets a block of its own.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+class RenderGraph {
+public:
+    using ResourceId = uint32_t;
+    using PassId = uint32_t;
+    using ExecuteFunction = std::function<void(VkCommandBuffer)>;
+    using DeferFunction = std::function<void(std::function<void()>)>;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        What the next barrier for a resource has to wait on: the last write (a layout transition
+        counts as one), and the reads since then, which a write has to wait for before it
+        overwrites anything. "Reads" also remembers who has already been made to wait for the
+        write so that they aren't made to wait again.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct ResourceState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+        VkAccessFlags readAccess = 0;
+
+        // as if the last thing that happened to it was this
+        static ResourceState After(ResourceUsage usage) {
+            const ResourceUsageInfo &info = GetResourceUsageInfo(usage);
+            ResourceState state{};
+            state.layout = info.layout;
+            if (info.writes) {
+                state.writeStages = info.stages;
+                state.writeAccess = info.access & WRITE_ACCESS_MASK;
+            }
+            else {
+                state.readStages = info.stages;
+                state.readAccess = info.access;
+            }
+            return state;
+        }
+    };
+
+    struct TransientImageDesc {
+        VkExtent2D extent{ 0, 0 };
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        VkImageAspectFlags aspect = 0;
+
+        bool operator==(const TransientImageDesc &other) const {
+            return extent.width == other.extent.width && extent.height == other.extent.height &&
+                format == other.format && usage == other.usage && aspect == other.aspect;
+        }
+    };
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Returned by AddPass(...) to declare what the pass touches.
+
+        Note: "discardContents" on a write means that the pass doesn't care what was there
+        before (ex: a render pass that clears it), so the old contents can be thrown away with
+        the layout transition, and passes that only wrote those contents aren't kept alive for
+        it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    class PassBuilder {
+    public:
+        PassBuilder(RenderGraph &graph, PassId pass) : mGraph(graph), mPass(pass) {}
+
+        PassBuilder &Read(ResourceId resource, ResourceUsage usage) {
+            mGraph.AddAccess(mPass, resource, usage, false);
+            return *this;
+        }
+
+        PassBuilder &Write(ResourceId resource, ResourceUsage usage, bool discardContents = false) {
+            mGraph.AddAccess(mPass, resource, usage, discardContents);
+            return *this;
+        }
+
+        // always run, even if nothing reads what it writes
+        PassBuilder &HasSideEffects() {
+            mGraph.mPasses.at(mPass).sideEffects = true;
+            return *this;
+        }
+
+        PassId GetId() const {
+            return mPass;
+        }
+
+    private:
+        RenderGraph &mGraph;
+        PassId mPass;
+    };
+
+    void Init(VkDevice device, VkPhysicalDevice physicalDevice, DeferFunction deferDestruction) {
+        mDevice = device;
+        mPhysicalDevice = physicalDevice;
+        mDeferDestruction = deferDestruction;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Forgets last frame's passes and resources. The transient images' memory is kept for
+        Compile() to reuse.
+
+        Note: The Pass objects themselves stay in mPasses (only mNumPasses goes back to 0) so
+        that their access lists keep their capacity for the next frame's passes. Resources
+        don't own anything, so clear() (which keeps the capacity) is enough for them.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Reset() {
+        mNumPasses = 0;
+        mResources.clear();
+        mCompiled = false;
+    }
+
+    ResourceId ImportImage(const char *name, VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, ResourceState &state) {
+        Resource resource{};
+        resource.name = name;
+        resource.isImage = true;
+        resource.image = image;
+        resource.range.aspectMask = aspect;
+        resource.range.baseMipLevel = 0;
+        resource.range.levelCount = mipLevels;
+        resource.range.baseArrayLayer = 0;
+        resource.range.layerCount = 1;
+        resource.state = &state;
+        mResources.push_back(resource);
+        return static_cast<ResourceId>(mResources.size() - 1);
+    }
+
+    ResourceId ImportBuffer(const char *name, VkBuffer buffer, ResourceState &state) {
+        Resource resource{};
+        resource.name = name;
+        resource.isImage = false;
+        resource.buffer = buffer;
+        resource.state = &state;
+        mResources.push_back(resource);
+        return static_cast<ResourceId>(mResources.size() - 1);
+    }
+
+    ResourceId CreateTransientImage(const char *name, const TransientImageDesc &desc) {
+        Resource resource{};
+        resource.name = name;
+        resource.isImage = true;
+        resource.transient = true;
+        resource.desc = desc;
+        resource.range.aspectMask = desc.aspect;
+        resource.range.baseMipLevel = 0;
+        resource.range.levelCount = 1;
+        resource.range.baseArrayLayer = 0;
+        resource.range.layerCount = 1;
+        mResources.push_back(resource);
+        return static_cast<ResourceId>(mResources.size() - 1);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Something outside of this frame's passes needs the resource (presentation, next frame,
+        etc.), so whatever writes it is kept. If a final usage is given, the resource is
+        transitioned to it after the last pass.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void MarkOutput(ResourceId resource, ResourceUsage finalUsage = ResourceUsage::NONE) {
+        mResources.at(resource).isOutput = true;
+        mResources.at(resource).finalUsage = finalUsage;
+    }
+
+    PassBuilder AddPass(const char *name, ExecuteFunction execute) {
+        // reuse last frame's pass in this slot if there was one (see Reset())
+        if (mNumPasses == mPasses.size()) {
+            mPasses.emplace_back();
+        }
+        Pass &pass = mPasses[mNumPasses];
+        pass.name = name;
+        pass.execute = std::move(execute);
+        pass.accesses.clear();
+        pass.sideEffects = false;
+        pass.live = false;
+        return PassBuilder(*this, mNumPasses++);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Culls the passes that don't contribute to an output, then gives the transient images
+        that the rest use somewhere to live (see RealizeTransients()).
+
+        Note: Walks the passes backwards. A pass is needed if it has side effects or writes
+        something that is needed; then what it reads is needed too. A write that discards the
+        contents doesn't need what was there before, so it ends the chain: earlier passes that
+        only wrote it aren't needed for it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Compile() {
+        std::vector<bool> &needed = mNeeded;
+        needed.assign(mResources.size(), false);
+        for (size_t i = 0; i < mResources.size(); i++) {
+            needed[i] = mResources[i].isOutput;
+        }
+
+        // Note: Only the first mNumPasses are this frame's (see Reset()).
+        for (auto pass = mPasses.rend() - mNumPasses; pass != mPasses.rend(); ++pass) {
+            pass->live = pass->sideEffects;
+            for (const Access &access : pass->accesses) {
+                if (GetResourceUsageInfo(access.usage).writes && needed[access.resource]) {
+                    pass->live = true;
+                }
+            }
+            if (!pass->live) {
+                continue;
+            }
+            for (const Access &access : pass->accesses) {
+                if (GetResourceUsageInfo(access.usage).writes && access.discard) {
+                    needed[access.resource] = false;
+                }
+            }
+            for (const Access &access : pass->accesses) {
+                if (!(GetResourceUsageInfo(access.usage).writes && access.discard)) {
+                    needed[access.resource] = true;
+                }
+            }
+        }
+
+        for (PassId p = 0; p < mNumPasses; p++) {
+            mNumPassesCulled += mPasses[p].live ? 0 : 1;
+        }
+        mNumPassesRecorded += mNumPasses;
+        RealizeTransients();
+        mCompiled = true;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Records every live pass, each preceded by its batch of barriers, then the transitions of
+        the outputs into their final usages (one more batch).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void Execute(VkCommandBuffer commandBuffer) {
+        if (!mCompiled) {
+            throw std::runtime_error("render graph executed before it was compiled");
+        }
+
+        // transients pick up from whatever last used their memory (this frame or the last one)
+        std::vector<bool> &touched = mTouched;
+        touched.assign(mResources.size(), false);
+        auto getState = [this, &touched](ResourceId id) -> ResourceState & {
+            Resource &resource = mResources.at(id);
+            if (!resource.transient) {
+                return *resource.state;
+            }
+            PhysicalImage &physical = mPhysicalImages.at(resource.physicalIndex);
+            if (!touched[id]) {
+                physical.state = mMemoryBlocks.at(physical.block).state;
+                physical.state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                touched[id] = true;
+            }
+            return physical.state;
+        };
+        auto updateBlock = [this](ResourceId id) {
+            const Resource &resource = mResources.at(id);
+            if (resource.transient) {
+                const PhysicalImage &physical = mPhysicalImages.at(resource.physicalIndex);
+                mMemoryBlocks.at(physical.block).state = physical.state;
+            }
+        };
+
+        BarrierBatch &batch = mBatch;
+        for (PassId p = 0; p < mNumPasses; p++) {
+            const Pass &pass = mPasses[p];
+            if (!pass.live) {
+                continue;
+            }
+
+            batch.Clear();
+            for (const Access &access : pass.accesses) {
+                const Resource &resource = mResources.at(access.resource);
+                if (resource.transient && !touched[access.resource] && !(GetResourceUsageInfo(access.usage).writes && access.discard)) {
+                    throw std::runtime_error("render graph: '" + std::string(pass.name) + "' reads transient '" + resource.name + "' before anything wrote it");
+                }
+                AddBarrier(access.resource, getState(access.resource), access.usage, access.discard, batch);
+                updateBlock(access.resource);
+            }
+            FlushBarriers(commandBuffer, batch);
+            pass.execute(commandBuffer);
+        }
+
+        batch.Clear();
+        for (ResourceId id = 0; id < mResources.size(); id++) {
+            const Resource &resource = mResources.at(id);
+            if (resource.isOutput && resource.finalUsage != ResourceUsage::NONE) {
+                AddBarrier(id, getState(id), resource.finalUsage, false, batch);
+                updateBlock(id);
+            }
+        }
+        FlushBarriers(commandBuffer, batch);
+        mNumFramesExecuted++;
+    }
+
+    bool IsPassLive(PassId pass) const {
+        if (pass >= mNumPasses) {
+            throw std::runtime_error("render graph: pass doesn't exist");
+        }
+        return mPasses[pass].live;
+    }
+
+    // Note: Transient images only have handles after Compile().
+    VkImage GetImage(ResourceId resource) const {
+        const Resource &r = mResources.at(resource);
+        return r.transient ? mPhysicalImages.at(r.physicalIndex).image : r.image;
+    }
+
+    VkImageView GetImageView(ResourceId resource) const {
+        const Resource &r = mResources.at(resource);
+        if (!r.transient) {
+            throw std::runtime_error("render graph: imported image '" + std::string(r.name) + "' has no view of the graph's");
+        }
+        return mPhysicalImages.at(r.physicalIndex).view;
+    }
+
+    std::string GetSummary() const {
+        double frames = static_cast<double>(std::max<uint64_t>(mNumFramesExecuted, 1));
+
+        // the current set of transients; aliasing is the difference between the two
+        VkDeviceSize bytesRequired = 0;
+        VkDeviceSize bytesAllocated = 0;
+        for (const PhysicalImage &physical : mPhysicalImages) {
+            bytesRequired += physical.requirements.size;
+        }
+        for (const MemoryBlock &block : mMemoryBlocks) {
+            bytesAllocated += block.size;
+        }
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1);
+        ss << static_cast<double>(mNumPassesRecorded) / frames << " passes/frame ("
+            << static_cast<double>(mNumPassesCulled) / frames << " culled), "
+            << static_cast<double>(mNumBarrierBatches) / frames << " barrier calls/frame ("
+            << static_cast<double>(mNumBarriers) / frames << " barriers), "
+            << mPhysicalImages.size() << " transient images in " << mMemoryBlocks.size() << " blocks ("
+            << static_cast<double>(bytesAllocated) / (1024.0 * 1024.0) << " MB for "
+            << static_cast<double>(bytesRequired) / (1024.0 * 1024.0) << " MB of images), "
+            << mNumTransientAllocations << " transient allocations";
+        VkDeviceSize lazyAllocated = 0;
+        VkDeviceSize lazyCommitted = 0;
+        GetLazyMemory(lazyAllocated, lazyCommitted);
+        if (lazyAllocated > 0) {
+            ss << ", " << static_cast<double>(lazyAllocated) / (1024.0 * 1024.0) << " MB lazily allocated ("
+                << static_cast<double>(lazyCommitted) / (1024.0 * 1024.0) << " MB committed)";
+        }
+        return ss.str();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        How much of the current transients' memory is lazily allocated, and how much of that
+        the driver has actually committed (see vkGetDeviceMemoryCommitment(...)).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void GetLazyMemory(VkDeviceSize &allocated, VkDeviceSize &committed) const {
+        for (const MemoryBlock &block : mMemoryBlocks) {
+            if (block.lazy) {
+                VkDeviceSize blockCommitted = 0;
+                vkGetDeviceMemoryCommitment(mDevice, block.memory, &blockCommitted);
+                allocated += block.size;
+                committed += blockCommitted;
+            }
+        }
+    }
+
+    void Cleanup() {
+        DestroyPhysical(mPhysicalImages, mMemoryBlocks);
+        mPhysicalImages.clear();
+        mMemoryBlocks.clear();
+        mSignatureDescs.clear();
+        mSignatureOverlaps.clear();
+    }
+
+private:
+    struct Access {
+        ResourceId resource = 0;
+        ResourceUsage usage = ResourceUsage::NONE;
+        bool discard = false;
+    };
+
+    struct Pass {
+        const char *name = "";
+        ExecuteFunction execute;
+        std::vector<Access> accesses;
+        bool sideEffects = false;
+        bool live = false;
+    };
+
+    struct Resource {
+        const char *name = "";
+        bool isImage = true;
+        bool transient = false;
+        VkImage image = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImageSubresourceRange range{};
+        ResourceState *state = nullptr;     // imported only
+        TransientImageDesc desc{};          // transient only
+        uint32_t physicalIndex = 0;         // transient only; set by Compile()
+        bool isOutput = false;
+        ResourceUsage finalUsage = ResourceUsage::NONE;
+    };
+
+    struct PhysicalImage {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkMemoryRequirements requirements{};
+        bool lazy = false;                  // asked for lazily allocated memory
+        uint32_t block = 0;
+        ResourceState state;
+    };
+
+    struct MemoryBlock {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t memoryTypeBits = ~0u;
+        bool lazy = false;                  // and got it
+        std::vector<uint32_t> occupants;    // physical image indices
+        ResourceState state;                // of the last image that used it
+    };
+
+    struct BarrierBatch {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+
+        // empties it, but keeps the vectors' capacity for the next batch
+        void Clear() {
+            srcStages = 0;
+            dstStages = 0;
+            imageBarriers.clear();
+            bufferBarriers.clear();
+        }
+    };
+
+    void AddAccess(PassId pass, ResourceId resource, ResourceUsage usage, bool discard) {
+        if (resource >= mResources.size()) {
+            throw std::runtime_error("render graph: pass '" + std::string(mPasses.at(pass).name) + "' uses a resource that doesn't exist");
+        }
+        Access access{};
+        access.resource = resource;
+        access.usage = usage;
+        access.discard = discard;
+        mPasses.at(pass).accesses.push_back(access);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Works out what, if anything, has to happen before "usage" can touch a resource that is
+        in "state", adds it to the batch, and moves the state along.
+        - A write or a layout change waits on everything since the last write (reads included,
+            so that they aren't overwritten early) and makes the last write available.
+        - A read in the same layout only waits on the last write, and only if its stage and
+            access haven't already been made to wait on it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void AddBarrier(ResourceId id, ResourceState &state, ResourceUsage usage, bool discard, BarrierBatch &batch) {
+        const Resource &resource = mResources.at(id);
+        const ResourceUsageInfo &info = GetResourceUsageInfo(usage);
+        bool layoutChange = resource.isImage && (info.layout != state.layout);
+
+        bool needsBarrier = false;
+        VkPipelineStageFlags srcStages = 0;
+        VkAccessFlags srcAccess = 0;
+        if (layoutChange || info.writes) {
+            srcStages = state.writeStages | state.readStages;
+            srcAccess = state.writeAccess;
+            needsBarrier = layoutChange || (srcStages != 0);
+        }
+        else if (state.writeStages != 0) {
+            bool alreadyWaited = ((info.stages & ~state.readStages) == 0) && ((info.access & ~state.readAccess) == 0);
+            if (!alreadyWaited) {
+                srcStages = state.writeStages;
+                srcAccess = state.writeAccess;
+                needsBarrier = true;
+            }
+        }
+
+        if (needsBarrier) {
+            if (srcStages == 0) {
+                srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            }
+            batch.srcStages |= srcStages;
+            batch.dstStages |= info.stages;
+            if (resource.isImage) {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+                barrier.newLayout = info.layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = GetImage(id);
+                barrier.subresourceRange = resource.range;
+                barrier.srcAccessMask = srcAccess;
+                barrier.dstAccessMask = info.access;
+                batch.imageBarriers.push_back(barrier);
+            }
+            else {
+                VkBufferMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = resource.buffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+                barrier.srcAccessMask = srcAccess;
+                barrier.dstAccessMask = info.access;
+                batch.bufferBarriers.push_back(barrier);
+            }
+        }
+
+        // a layout transition is a write as far as later readers in other stages are concerned
+        if (info.writes) {
+            state.writeStages = info.stages;
+            state.writeAccess = info.access & WRITE_ACCESS_MASK;
+            state.readStages = 0;
+            state.readAccess = 0;
+        }
+        else if (layoutChange) {
+            state.writeStages = info.stages;
+            state.writeAccess = 0;
+            state.readStages = info.stages;
+            state.readAccess = info.access;
+        }
+        else {
+            state.readStages |= info.stages;
+            state.readAccess |= info.access;
+        }
+        if (resource.isImage) {
+            state.layout = info.layout;
+        }
+    }
+
+    void FlushBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &batch) {
+        if (batch.imageBarriers.empty() && batch.bufferBarriers.empty()) {
+            return;
+        }
+        vkCmdPipelineBarrier(commandBuffer,
+            batch.srcStages, batch.dstStages, 0,
+            0, nullptr,
+            static_cast<uint32_t>(batch.bufferBarriers.size()), batch.bufferBarriers.data(),
+            static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+        mNumBarrierBatches++;
+        mNumBarriers += batch.imageBarriers.size() + batch.bufferBarriers.size();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Gives every transient image that a live pass uses an image and memory. Memory is shared
+        between transients whose lifetimes (first to last live pass that uses them) don't
+        overlap: biggest first, each into the first block that it fits and whose current
+        occupants are all dead by the time it is first used (or that it is dead before they
+        start).
+
+        Note: If the transients (descriptions and which ones overlap) are the same as last
+        frame, last frame's images are used as they are. Otherwise the old ones are handed to
+        the deferred destruction function (frames in flight may still be using them) and a new
+        set is made.
+
+        Also Note: The lists that this works in are members so that they keep their capacity
+        from frame to frame (see Reset()).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RealizeTransients() {
+        const uint32_t NOT_USED = ~0u;
+        std::vector<ResourceId> &used = mUsed;
+        std::vector<uint32_t> &firstPass = mFirstPass;
+        std::vector<uint32_t> &lastPass = mLastPass;
+        used.clear();
+        firstPass.clear();
+        lastPass.clear();
+        for (ResourceId id = 0; id < mResources.size(); id++) {
+            if (!mResources[id].transient) {
+                continue;
+            }
+            uint32_t first = NOT_USED;
+            uint32_t last = NOT_USED;
+            for (uint32_t p = 0; p < mNumPasses; p++) {
+                if (!mPasses[p].live) {
+                    continue;
+                }
+                for (const Access &access : mPasses[p].accesses) {
+                    if (access.resource == id) {
+                        first = (first == NOT_USED) ? p : first;
+                        last = p;
+                    }
+                }
+            }
+            if (first != NOT_USED) {
+                used.push_back(id);
+                firstPass.push_back(first);
+                lastPass.push_back(last);
+            }
+        }
+
+        // what the physical images depend on
+        std::vector<TransientImageDesc> &descs = mUsedDescs;
+        std::vector<bool> &overlaps = mOverlaps;
+        descs.clear();
+        overlaps.assign(used.size() * used.size(), false);
+        for (size_t i = 0; i < used.size(); i++) {
+            descs.push_back(mResources[used[i]].desc);
+            for (size_t j = 0; j < used.size(); j++) {
+                overlaps[(i * used.size()) + j] = (firstPass[i] <= lastPass[j]) && (firstPass[j] <= lastPass[i]);
+            }
+        }
+
+        if (descs != mSignatureDescs || overlaps != mSignatureOverlaps) {
+            RetirePhysical();
+            mSignatureDescs = descs;
+            mSignatureOverlaps = overlaps;
+            CreatePhysical(used, overlaps);
+        }
+        for (size_t i = 0; i < used.size(); i++) {
+            mResources[used[i]].physicalIndex = static_cast<uint32_t>(i);
+        }
+    }
+
+    void CreatePhysical(const std::vector<ResourceId> &used, const std::vector<bool> &overlaps) {
+        mPhysicalImages.resize(used.size());
+        for (size_t i = 0; i < used.size(); i++) {
+            const TransientImageDesc &desc = mResources[used[i]].desc;
+            VkImageCreateInfo imageCreateInfo{};
+            imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageCreateInfo.extent = { desc.extent.width, desc.extent.height, 1 };
+            imageCreateInfo.mipLevels = 1;
+            imageCreateInfo.arrayLayers = 1;
+            imageCreateInfo.format = desc.format;
+            imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageCreateInfo.usage = desc.usage;
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            if (vkCreateImage(mDevice, &imageCreateInfo, nullptr, &mPhysicalImages[i].image) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create transient image '" + std::string(mResources[used[i]].name) + "'");
+            }
+            vkGetImageMemoryRequirements(mDevice, mPhysicalImages[i].image, &mPhysicalImages[i].requirements);
+            mPhysicalImages[i].lazy = (desc.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+        }
+
+        // biggest first, so that the blocks are sized by the first image in them
+        std::vector<uint32_t> order(used.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return mPhysicalImages[a].requirements.size > mPhysicalImages[b].requirements.size;
+        });
+        for (uint32_t i : order) {
+            const VkMemoryRequirements &requirements = mPhysicalImages[i].requirements;
+            bool placed = false;
+            for (uint32_t b = 0; b < mMemoryBlocks.size() && !placed && !mPhysicalImages[i].lazy; b++) {
+                MemoryBlock &block = mMemoryBlocks[b];
+                bool fits = (requirements.size <= block.size) && ((requirements.memoryTypeBits & block.memoryTypeBits) != 0);
+                for (uint32_t occupant : block.occupants) {
+                    fits = fits && !overlaps[(i * used.size()) + occupant];
+                }
+                if (fits) {
+                    block.occupants.push_back(i);
+                    block.memoryTypeBits &= requirements.memoryTypeBits;
+                    mPhysicalImages[i].block = b;
+                    placed = true;
+                }
+            }
+            if (!placed) {
+                MemoryBlock block{};
+                block.size = requirements.size;
+                block.memoryTypeBits = requirements.memoryTypeBits;
+                block.lazy = mPhysicalImages[i].lazy;
+                block.occupants.push_back(i);
+                mPhysicalImages[i].block = static_cast<uint32_t>(mMemoryBlocks.size());
+                mMemoryBlocks.push_back(block);
+            }
+        }
+
+        // offset 0 of a block satisfies every alignment
+        // Note: Lazily allocated memory is a request. Without it, the image gets ordinary memory.
+        for (MemoryBlock &block : mMemoryBlocks) {
+            VkMemoryPropertyFlags lazyProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+            uint32_t memoryTypeIndex = 0;
+            if (!block.lazy || !TryFindMemoryType(block.memoryTypeBits, lazyProperties, memoryTypeIndex)) {
+                block.lazy = false;
+                memoryTypeIndex = FindMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            }
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = block.size;
+            allocInfo.memoryTypeIndex = memoryTypeIndex;
+            if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate transient image memory");
+            }
+        }
+        for (size_t i = 0; i < used.size(); i++) {
+            PhysicalImage &physical = mPhysicalImages[i];
+            const TransientImageDesc &desc = mResources[used[i]].desc;
+            vkBindImageMemory(mDevice, physical.image, mMemoryBlocks[physical.block].memory, 0);
+
+            // a depth/stencil image can only be viewed (and sampled) one aspect at a time
+            VkImageViewCreateInfo viewCreateInfo{};
+            viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewCreateInfo.image = physical.image;
+            viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewCreateInfo.format = desc.format;
+            VkImageAspectFlags viewAspect = desc.aspect;
+            if (desc.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) {
+                viewAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+            }
+            viewCreateInfo.subresourceRange.aspectMask = viewAspect;
+            viewCreateInfo.subresourceRange.baseMipLevel = 0;
+            viewCreateInfo.subresourceRange.levelCount = 1;
+            viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+            viewCreateInfo.subresourceRange.layerCount = 1;
+            if (vkCreateImageView(mDevice, &viewCreateInfo, nullptr, &physical.view) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create transient image view");
+            }
+        }
+        mNumTransientAllocations++;
+    }
+
+    void RetirePhysical() {
+        if (mPhysicalImages.empty() && mMemoryBlocks.empty()) {
+            return;
+        }
+        std::vector<PhysicalImage> oldImages = mPhysicalImages;
+        std::vector<MemoryBlock> oldBlocks = mMemoryBlocks;
+        mDeferDestruction([this, oldImages, oldBlocks]() {
+            DestroyPhysical(oldImages, oldBlocks);
+        });
+        mPhysicalImages.clear();
+        mMemoryBlocks.clear();
+    }
+
+    void DestroyPhysical(const std::vector<PhysicalImage> &images, const std::vector<MemoryBlock> &blocks) {
+        for (const PhysicalImage &physical : images) {
+            vkDestroyImageView(mDevice, physical.view, nullptr);
+            vkDestroyImage(mDevice, physical.image, nullptr);
+        }
+        for (const MemoryBlock &block : blocks) {
+            vkFreeMemory(mDevice, block.memory, nullptr);
+        }
+    }
+
+    bool TryFindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &index) const {
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        uint32_t index = 0;
+        if (!TryFindMemoryType(typeFilter, properties, index)) {
+            throw std::runtime_error("failed to find a memory type for transient images");
+        }
+        return index;
+    }
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+    DeferFunction mDeferDestruction;
+
+    // Note: Only the first mNumPasses of mPasses are this frame's (see Reset()).
+    std::vector<Pass> mPasses;
+    uint32_t mNumPasses = 0;
+    std::vector<Resource> mResources;
+    bool mCompiled = false;
+
+    // scratch space for Compile(), Execute(...), and RealizeTransients(), kept between frames
+    std::vector<bool> mNeeded;
+    std::vector<bool> mTouched;
+    BarrierBatch mBatch;
+    std::vector<ResourceId> mUsed;
+    std::vector<uint32_t> mFirstPass;
+    std::vector<uint32_t> mLastPass;
+    std::vector<TransientImageDesc> mUsedDescs;
+    std::vector<bool> mOverlaps;
+
+    std::vector<PhysicalImage> mPhysicalImages;
+    std::vector<MemoryBlock> mMemoryBlocks;
+
+    // what the current physical images were made for (see RealizeTransients())
+    std::vector<TransientImageDesc> mSignatureDescs;
+    std::vector<bool> mSignatureOverlaps;
+
+    uint64_t mNumFramesExecuted = 0;
+    uint64_t mNumPassesRecorded = 0;
+    uint64_t mNumPassesCulled = 0;
+    uint64_t mNumBarrierBatches = 0;
+    uint64_t mNumBarriers = 0;
+    uint64_t mNumTransientAllocations = 0;
+};
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    The class for this tutorial series.
+Creator:    John Cox, 10/2018
+-------------------------------------------------------------------------------------------------*/
+class HelloTriangleApplication {
+private:
+    const RuntimeOptions mOptions;
+
+    GLFWwindow *mWindow = nullptr;
+    uint32_t mWindowWidth = 0;
+    uint32_t mWindowHeight = 0;
+
+#ifdef NDEBUG
+    const bool mEnableValidationLayers = false;
+#else
+    const bool mEnableValidationLayers = true;
+#endif // NDEBUG
+
+
+    VkInstance mInstance = VK_NULL_HANDLE;
+    VkDebugUtilsMessengerEXT mCallback = VK_NULL_HANDLE;
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+    VkDevice mLogicalDevice = VK_NULL_HANDLE;
+    VkQueue mGraphicsQueue = VK_NULL_HANDLE;
+    VkSurfaceKHR mSurface = VK_NULL_HANDLE;
+    VkQueue mPresentationQueue = VK_NULL_HANDLE;
+    VkSwapchainKHR mSwapChain = VK_NULL_HANDLE;
+    VkFormat mSwapChainImageFormat = VkFormat::VK_FORMAT_UNDEFINED;
+    VkExtent2D mSwapChainExtent{};
+    std::vector<VkImageView> mSwapChainImageViews;
+    std::vector<VkFramebuffer> mSwapChainFramebuffers;
+
+    // retired objects that the GPU may still be using; see DeferDestruction(...)
+    struct DeferredDestruction {
+        uint64_t timelineValue = 0;
+        size_t frameNumber = 0;
+        std::function<void()> destroy;
+    };
+    std::deque<DeferredDestruction> mDeferredDestructions;
+    VkRenderPass mRenderPass = VK_NULL_HANDLE;
+    VkRenderPass mRenderPassDepthDiscarded = VK_NULL_HANDLE;    // for frames without a Hi-Z build
+    VkDescriptorSetLayout mPerFrameDescriptorSetLayout = VK_NULL_HANDLE;    // set 0
+    VkDescriptorSetLayout mMaterialDescriptorSetLayout = VK_NULL_HANDLE;    // set 1
+    VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+    VkCommandPool mCommandPool = VK_NULL_HANDLE;    // for one-time upload commands
+    size_t mCurrentFrame = 0;
+    bool mFrameBufferResized = false;   // not all drivers properly handle window resize notifications in Vulkan
+
+    // the render thread's copy of the framebuffer size (glfwGetFramebufferSize(...) may only be 
+    // called from the main thread)
+    uint32_t mFramebufferWidth = 0;
+    uint32_t mFramebufferHeight = 0;
+    float mCameraZoom = 0.0f;           // mouse wheel; + => farther away
+    bool mQuitRequested = false;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Everything that the main thread (window events) tells the render thread. The render
+        thread drains these once per frame, just before building it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct RenderCommand {
+        enum Type {
+            RESIZE,         // width, height (either may be 0 when minimized)
+            CAMERA_ZOOM,    // zoomDelta
+            QUIT
+        };
+        Type type = QUIT;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        float zoomDelta = 0.0f;
+    };
+    SpscQueue<RenderCommand, 256> mRenderCommands;
+    bool mUseRenderThread = false;
+    std::atomic<bool> mRenderThreadExited{ false };
+    std::exception_ptr mRenderThreadException;
+    VkPresentModeKHR mPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+    FramePacer mFramePacer;
+    GpuQueryProfiler mGpuProfiler;
+    RenderGraph mFrameGraph;                // rebuilt every frame (see RecordCommandBuffer(...))
+    FrameProfiler mFrameProfiler;
+    PhaseTimer mStartupTimer;
+    ScriptedCameraPath mCameraPath;
+    uint64_t mCameraPathFirstFrame = 0;     // the frame that the path starts from
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        One measured frame of a benchmark run. The GPU time arrives a few frames after the CPU
+        time (see GpuQueryProfiler), so it is filled in later (negative until then).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct BenchmarkFrame {
+        uint64_t frameNumber = 0;
+        double cpuMs = 0.0;
+        double gpuMs = -1.0;
+        uint64_t vertexShaderInvocations = 0;       // if pipeline statistics are available
+        uint64_t fragmentShaderInvocations = 0;
+        double renderScale = 1.0;                   // dynamic resolution
+    };
+    std::vector<BenchmarkFrame> mBenchmarkFrames;
+    uint64_t mBenchmarkFirstFrame = 0;
+    bool mBenchmarkMeasuring = false;
+
+    // running tallies of every vkAllocateMemory(...) made through CreateBuffer/CreateImage
+    // Note: Atomic because startup creates buffers and images on several threads at once.
+    std::atomic<uint64_t> mNumDeviceAllocations{ 0 };
+    std::atomic<VkDeviceSize> mTotalDeviceAllocationBytes{ 0 };
+
+    // runs InitVulkan()'s task graph
+    TaskScheduler mTaskScheduler;
+
+    PipelineCacheFile mPipelineCache;
+    double mPipelineCreateMs = 0.0;     // the most recent fallback pipeline compile
+
+    // owns every graphics pipeline; the main one is compiled up front and doubles as the 
+    // fallback for variants still compiling in the background
+    PipelineManager mPipelineManager;
+    PipelineDescription mMainPipelineDescription;
+    uint64_t mMainPipelineKey = 0;
+
+    // which subpass (and depth test) a pipeline variant is for (see GetPipelineVariant(...))
+    enum class DrawStage : uint32_t {
+        MAIN,                   // depth test LESS, writes depth
+        MAIN_AFTER_PREPASS,     // depth test EQUAL against the pre-pass, no writes
+        DEPTH_PREPASS,          // depth only
+    };
+
+    // draw stage and shader feature mask => pipeline key, so that the per-frame lookup doesn't 
+    // have to build and hash a description (see GetPipelineVariant(...))
+    std::unordered_map<uint64_t, uint64_t> mFeatureVariantKeys;
+    uint32_t mDrawFeatures = SHADER_FEATURE_TEXTURED;   // what the drawn material uses
+    std::vector<PipelineDescription> mPrewarmList;  // from the last run
+
+    // CPU-side asset work done up front by startup tasks, consumed by the Vulkan-side tasks
+    // Note: One slot per texture and per mesh in the scene, each filled in by its own task, so 
+    // they don't need any locking.
+    struct DecodedTexture {
+        stbi_uc *pixels = nullptr;  // nullptr => 1x1 white
+        int width = 0;
+        int height = 0;
+    };
+    struct LoadedMesh {
+        std::vector<Vertex> vertexes;
+        std::vector<uint32_t> indices;      // into "vertexes"
+        std::vector<uint32_t> submeshIndexCounts;   // one run of "indices" per material
+        std::vector<uint32_t> submeshTextures;
+    };
+    std::vector<DecodedTexture> mDecodedTextures;
+    std::vector<LoadedMesh> mLoadedMeshes;
+    ShaderModuleCache mShaderModules;
+
+    // hot reload (see ReloadChangedShaders())
+    ShaderCompiler mShaderCompiler;
+    FileWatcher mShaderWatcher;
+
+    // while an upload batch is open, "single use" command buffers all record into this one and 
+    // staging buffers are kept around until it has been submitted
+    VkCommandBuffer mUploadBatchCommandBuffer = VK_NULL_HANDLE;
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> mPendingStagingBuffers;
+
+    // textures whose base level has been uploaded, waiting for SubmitPendingMipMaps() to make 
+    // the rest of their levels on the compute queue
+    struct PendingMipMaps {
+        VkImage image = VK_NULL_HANDLE;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent{};
+        uint32_t mipLevels = 0;
+    };
+    std::vector<PendingMipMaps> mPendingMipMaps;
+    bool mMemoryBudgetEnabled = false;
+
+    bool mPipelineStatisticsEnabled = false;
+
+    // every mesh in the scene, one after the other (see BuildSceneGeometry())
+    std::vector<Vertex> mVertexes;
+    std::vector<uint32_t> mVertexIndices;
+    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mVertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer mVertexIndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mVertexIndexBufferMemory = VK_NULL_HANDLE;
+
+    // one buffer, sliced up between the frame contexts
+    VkBuffer mUniformBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mUniformBufferMemory = VK_NULL_HANDLE;
+    VkDeviceSize mUniformSliceSize = 0;
+    void *mUniformBufferMapped = nullptr;
+
+    DescriptorLayoutCache mDescriptorLayoutCache;
+    DescriptorAllocator mDescriptorAllocator;
+    VkDescriptorUpdateTemplate mPerFrameUpdateTemplate = VK_NULL_HANDLE;
+    VkDescriptorUpdateTemplate mMaterialUpdateTemplate = VK_NULL_HANDLE;
+
+    // "bindless" textures (VK_EXT_descriptor_indexing); falls back to a descriptor set per 
+    // texture (SceneTexture::descriptorSet) if the device doesn't support it
+    const bool mPreferBindlessTextures = true;
+    bool mUseBindlessTextures = false;
+    uint32_t mMaxBindlessTextures = 0;
+    uint32_t mNumBindlessTextures = 0;
+    VkDescriptorSetLayout mBindlessDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool mBindlessDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mBindlessDescriptorSet = VK_NULL_HANDLE;
+
+    // the scene (see SceneManifest)
+    // Note: A mesh is a run of submeshes, and a submesh is a run of the index buffer with one 
+    // texture (and, with culling, a run of clusters). Indices are into the whole vertex buffer, 
+    // so every draw has a vertex offset of 0.
+    struct Submesh {
+        uint32_t mesh = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t texture = 0;   // into mTextures
+        uint32_t firstCluster = 0;
+        uint32_t numClusters = 0;
+    };
+    struct SceneMesh {
+        uint32_t firstSubmesh = 0;
+        uint32_t numSubmeshes = 0;
+        uint32_t firstCluster = 0;
+        uint32_t numClusters = 0;
+    };
+
+    // one draw per submesh of every instance, in the order that they're drawn
+    struct SceneDraw {
+        uint32_t instance = 0;
+        uint32_t submesh = 0;
+    };
+    SceneManifest mScene;
+    std::vector<SceneMesh> mSceneMeshes;
+    std::vector<Submesh> mSubmeshes;
+    std::vector<SceneDraw> mSceneDraws;
+
+    struct SceneTexture {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        uint32_t mipLevels = 1;
+        uint32_t materialId = 0;    // its slot in the bindless texture array
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;     // without bindless
+    };
+    std::vector<SceneTexture> mTextures;
+    VkSampler mTextureSampler = VK_NULL_HANDLE;     // shared by all of them
+
+    VkImage mDepthImage = VK_NULL_HANDLE;
+    VkDeviceMemory mDepthImageMemory = VK_NULL_HANDLE;
+    VkImageView mDepthImageView = VK_NULL_HANDLE;
+    RenderGraph::ResourceState mDepthImageState;
+    bool mDepthMemoryLazy = false;      // the depth images (this one, or headless, each target's)
+
+    // depth pre-pass (see CreateColorDepthRenderPass(...))
+    // Note: "Enabled" means that the render pass has the pre-pass subpass; "draw" is whether 
+    // anything is drawn in it this frame (the occlusion benchmark turns it off and on).
+    bool mDepthPrepassEnabled = false;
+    bool mDrawPrepass = false;
+    uint64_t mPrepassPipelineKey = 0;       // compiled up front; the pre-pass' fallback
+    VkBuffer mPositionBuffer = VK_NULL_HANDLE;  // mVertexes' positions only, tightly packed
+    VkDeviceMemory mPositionBufferMemory = VK_NULL_HANDLE;
+
+    // GPU cluster culling (see RecordClusterCull(...))
+    bool mClusterCullingEnabled = false;
+    bool mDrawCulling = false;
+    bool mMultiDrawIndirectEnabled = false;
+    std::vector<MeshCluster> mClusters;
+    VkBuffer mClusterBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mClusterBufferMemory = VK_NULL_HANDLE;
+    VkBuffer mDrawCommandBuffer = VK_NULL_HANDLE;   // one VkDrawIndexedIndirectCommand per cluster per instance
+    std::vector<uint32_t> mInstanceFirstDrawCommands;  // where each instance's draws start
+    uint32_t mNumDrawCommands = 0;     // every instance's clusters
+    VkDeviceMemory mDrawCommandBufferMemory = VK_NULL_HANDLE;
+    VkBuffer mCullInstanceBuffer = VK_NULL_HANDLE;  // one ClusterCullInstance per instance
+    VkDeviceMemory mCullInstanceBufferMemory = VK_NULL_HANDLE;
+    RenderGraph::ResourceState mClusterBufferState;     // as last left by the frame graph
+    RenderGraph::ResourceState mDrawCommandBufferState;
+    RenderGraph::ResourceState mCullInstanceBufferState;
+    VkDescriptorSetLayout mClusterCullSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout mClusterCullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline mClusterCullPipeline = VK_NULL_HANDLE;
+    glm::mat4 mPrevViewProj = glm::mat4(1.0f);
+    bool mHasPrevViewProj = false;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The Hi-Z pyramid: a mip chain where every texel is the farthest depth under it, built
+        from the depth buffer at the end of each frame (see RecordHiZBuild(...)) and tested
+        against by the next frame's cluster culling. Level 0 is half the size of the swap chain
+        (a full-size level 0 would be a copy of the depth buffer).
+
+        It stays in the GENERAL layout: it is written as a storage image and read as a sampled
+        one, level by level, and switching layouts per level isn't worth it. The frame graph
+        gets it there (from UNDEFINED) the first time that it is used.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct HiZPyramid {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+        VkImageView fullView = VK_NULL_HANDLE;      // all levels; for culling
+        std::vector<VkImageView> levelViews;        // one level each; for building
+        VkExtent2D extent{};                        // level 0
+        uint32_t mipLevels = 0;
+        RenderGraph::ResourceState state;           // as last left by the frame graph
+    };
+    HiZPyramid mHiZ;
+    bool mHiZEnabled = false;           // culling is on, and the depth format can be sampled
+    bool mHiZValid = false;             // built last frame (and still the right size)
+    VkExtent2D mHiZDepthExtent{};       // the size of the depth that it was built from
+    VkSampler mHiZSampler = VK_NULL_HANDLE;
+    VkDescriptorSetLayout mHiZBuildSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout mHiZBuildPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline mHiZBuildPipeline = VK_NULL_HANDLE;
+
+    // Single-pass downsampler (see spd_downsample.comp and RecordDownsample(...)): texture mip 
+    // maps and the Hi-Z pyramid in one dispatch each, instead of a blit or dispatch per level.
+    // Each queue that runs it has its own counter (the shader leaves it at 0 when it's done).
+    bool mDownsampleEnabled = false;
+    VkDescriptorSetLayout mDownsampleSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout mDownsamplePipelineLayout = VK_NULL_HANDLE;
+    VkPipeline mDownsampleColorPipeline = VK_NULL_HANDLE;   // average
+    VkPipeline mDownsampleDepthPipeline = VK_NULL_HANDLE;   // farthest (Hi-Z)
+    VkSampler mDownsampleSampler = VK_NULL_HANDLE;
+    VkBuffer mFrameDownsampleCounter = VK_NULL_HANDLE;      // graphics queue; Hi-Z
+    VkDeviceMemory mFrameDownsampleCounterMemory = VK_NULL_HANDLE;
+    VkBuffer mUploadDownsampleCounter = VK_NULL_HANDLE;     // compute queue; texture mip maps
+    VkDeviceMemory mUploadDownsampleCounterMemory = VK_NULL_HANDLE;
+
+
+    const std::vector<const char *> mRequiredDeviceExtensions{
+        VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+    };
+
+    // only required if there is something to present to
+    const std::vector<const char *> mPresentationDeviceExtensions{
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME
+    };
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Stands in for the swap chain when headless. There is one per frame context, and each has
+        its own depth image so that consecutive frames don't share anything.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct OffscreenTarget {
+        VkImage colorImage = VK_NULL_HANDLE;
+        VkDeviceMemory colorImageMemory = VK_NULL_HANDLE;
+        VkImage depthImage = VK_NULL_HANDLE;
+        VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
+        VkImageView depthImageView = VK_NULL_HANDLE;
+        RenderGraph::ResourceState colorState;
+        RenderGraph::ResourceState depthState;
+    };
+    std::vector<OffscreenTarget> mOffscreenTargets;
+
+    // the images behind mSwapChainImageViews (swap chain or offscreen); upscaled into
+    std::vector<VkImage> mSwapChainImages;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Dynamic resolution renders the scene here instead of straight into the swap chain image,
+        then upscales it (see RecordUpscale(...)). It is allocated bigger than the scene usually
+        needs (see ResolutionScaler::UpdateAllocationScale()), and the scene only uses the 
+        top-left corner of it, so that every change of scale doesn't mean a new image.
+
+        The images themselves are the frame graph's transients ("scene-color" and
+        "scene-depth"). The graph keeps them for as long as they are asked for at the same
+        size, and this keeps a framebuffer for whichever ones it handed out last.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct SceneTarget {
+        VkExtent2D extent{};    // allocated size
+        VkImageView colorImageView = VK_NULL_HANDLE;
+        VkImageView depthImageView = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    };
+    SceneTarget mSceneTarget;
+
+    ResolutionScaler mResolutionScaler;
+    bool mDynamicResolutionEnabled = false;     // asked for, and the format can be upscaled into
+    VkExtent2D mRenderExtent{};                 // the scene's size this frame
+    uint64_t mNumSceneTargetAllocations = 0;
+    bool mSamplerAnisotropyEnabled = false;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Encapsulates info about whether or not the necessary command queue indexes
+        (driver-specific-but-won't-change-at-runtime locations) have been acquired.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    struct QueueFamilyIndices {
+        // can the GPU draw graphics?
+        std::optional<uint32_t> graphicsFamily;
+
+        // can the GPU's driver draw to the surface that we're using?
+        std::optional<uint32_t> presentationFamily; //??"present family"??
+
+        bool IsComplete() {
+            return graphicsFamily.has_value() && presentationFamily.has_value();
+        }
+    };
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Windows are containers. We don't draw to windows. Window managers provide a "surface" that
+        is displayed on top of the window (and that usually encompasses less than the whole thing
+        so that we can have a border, etc.). We draw to these surfaces. To use it properly, we
+        must understand what our chosen window manager's surface support is capable of doing.
+
+        Those details are stored here.
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    struct SwapChainSupportDetails {
+        // min/max image count, min/max image width, min/max image height, others
+        VkSurfaceCapabilitiesKHR capabilities;
+
+        // pixel format and color space for each image
+        std::vector<VkSurfaceFormatKHR> formats;
+
+        // ??presentation modes?? for each image
+        std::vector<VkPresentModeKHR> presentModes;
+    };
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Everything that the CPU touches while building one frame, and that therefore must not be
+        touched again until the GPU is done with that frame. There is a ring of these, and the
+        size of the ring (chosen at startup) is how many frames the CPU may get ahead of the GPU.
+
+        Note: This used to be split up: uniform buffers and descriptor sets were indexed by the
+        swap chain image index while the fences and semaphores were indexed by the frame counter.
+        The two don't line up (the swap chain can hand back images in any order), so the CPU
+        could write a uniform buffer that the GPU was still reading from. Now everything that a
+        frame writes is owned by its context and guarded by that context's fence.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct FrameContext {
+        uint32_t index = 0;     // position in the ring; also the GPU profiler's frame slot
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+        // this frame's slice of mUniformBuffer
+        VkDeviceSize uniformOffset = 0;
+        void *pUniformData = nullptr;
+
+        DescriptorAllocator descriptorAllocator;
+        VkDescriptorSet perFrameDescriptorSet = VK_NULL_HANDLE;
+
+        // binary; the swap chain doesn't take timeline semaphores
+        VkSemaphore imageAvailable = VK_NULL_HANDLE;
+        VkSemaphore renderFinished = VK_NULL_HANDLE;
+
+        // graphics timeline value that this context's last submission will signal (0 => never 
+        // submitted)
+        uint64_t timelineValue = 0;
+
+        // for overlap/latency stats
+        bool submitted = false;
+        std::chrono::high_resolution_clock::time_point submitTime;
+    };
+    std::vector<FrameContext> mFrameContexts;
+
+    // graphics timeline value of the last submission that rendered to each swap chain image 
+    // (0 if none)
+    std::vector<uint64_t> mImagesInFlight;
+
+    // what this frame's graph passes need that isn't one of the graph's resources
+    // Note: The passes capture only "this" and read the rest from here when they execute, so 
+    // that their closures fit inside of std::function instead of each one going to the heap 
+    // every frame (see RenderGraph).
+    struct FrameGraphInputs {
+        FrameContext *frame = nullptr;
+        uint32_t imageIndex = 0;
+        bool upscale = false;
+        bool buildHiZ = false;
+        VkImage targetImage = VK_NULL_HANDLE;
+        RenderGraph::ResourceId sceneColor = 0;
+        RenderGraph::ResourceId depth = 0;
+        VkImageView depthView = VK_NULL_HANDLE;
+    };
+    FrameGraphInputs mFrameGraphInputs;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        One timeline semaphore per queue. Every submission to the queue signals the next value of
+        its counter, so "has submission X finished?" is just "is the counter >= X?". The CPU can
+        wait on any specific value, and other queues can wait on it too, without fences and
+        without idling the whole queue.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct QueueTimeline {
+        VkQueue queue = VK_NULL_HANDLE;
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        uint64_t lastSubmittedValue = 0;
+    };
+    QueueTimeline mGraphicsTimeline;
+
+    // A queue family that can compute but can't draw runs alongside the graphics queue (ex: 
+    // AMD's compute queues), so work on it overlaps with rendering. Without one, "compute queue" 
+    // work goes on the graphics queue and mComputeTimeline isn't used.
+    bool mAsyncComputeEnabled = false;
+    uint32_t mGraphicsQueueFamily = 0;
+    uint32_t mComputeQueueFamily = 0;
+    QueueTimeline mComputeTimeline;
+    VkCommandPool mComputeCommandPool = VK_NULL_HANDLE;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Something for a submission to wait on. For binary semaphores (ex: swap chain acquire), the
+        value is ignored.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct SemaphoreWait {
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        uint64_t value = 0;
+        VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    };
+
+    // VK_KHR_timeline_semaphore is an extension in Vulkan 1.1, so its functions must be looked up
+    PFN_vkWaitSemaphoresKHR mVkWaitSemaphoresKHR = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR mVkGetSemaphoreCounterValueKHR = nullptr;
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Running totals for reporting how well the CPU and GPU overlap with a given frame ring
+        depth. See ReportFrameContextStats().
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    struct FrameContextStats {
+        uint64_t numFrames = 0;
+        uint64_t numStalledFrames = 0;  // CPU had to wait on the GPU before reusing a context
+        double totalRetireWaitMs = 0.0;
+        double totalRetireLatencyMs = 0.0;
+        uint64_t numRetireLatencySamples = 0;
+        std::chrono::high_resolution_clock::time_point firstFrameTime;
+        std::chrono::high_resolution_clock::time_point lastFrameTime;
+    };
+    FrameContextStats mFrameContextStats;
+
+public:
+    HelloTriangleApplication(const RuntimeOptions &options) :
+        mOptions(options) {
+        mWindowWidth = mOptions.width;
+        mWindowHeight = mOptions.height;
+        mFrameProfiler.Init(mOptions.frameStatsWindow);
+        mUseRenderThread = !mOptions.headless && !mOptions.benchmark && !mOptions.singleThreaded;
+        mDrawFeatures = mOptions.shaderFeatures;
+        if (mOptions.dynamicResolution) {
+            // GPU times arrive a frame context's worth of frames late
+            double targetMs = mOptions.dynamicResolutionTargetMs;
+            if (targetMs <= 0.0) {
+                targetMs = 1000.0 / (mOptions.targetFps > 0.0 ? mOptions.targetFps : 60.0);
+            }
+            mResolutionScaler.Init(targetMs, mOptions.dynamicResolutionMinScale, mOptions.framesInFlight + 1);
+        }
+        if (!mOptions.cameraPathFile.empty()) {
+            mCameraPath.LoadFromFile(mOptions.cameraPathFile);
+        }
+    }
+
+    void Run() {
+        mStartupTimer.Start();
+        InitWindow();
+        mStartupTimer.Mark("InitWindow");
+        InitVulkan();
+        mStartupTimer.Mark("InitVulkan");
+        MainLoop();
+        ReportStartup();
+        ReportFrameContextStats();
+        ReportPresentation();
+        mFrameProfiler.Report();
+        Cleanup();
+
+        // CPU-side data only, so it can wait until Vulkan has been torn down
+        WriteStartupTrace();
+        if (!mOptions.frameStatsJsonPath.empty()) {
+            mFrameProfiler.WriteJson(mOptions.frameStatsJsonPath);
+        }
+    }
+
+private:
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Support function for CreateInstance(). It checks ever string in the argument against the
+        extension list provided by the driver. If there is something in the required list that
+        isn't in the driver's list, an error is thrown.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CheckRequiredExtensionsSupportedByDriver(const std::vector<const char *> &requiredExtensions) const {
+        uint32_t instanceExtensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr);
+        std::vector<VkExtensionProperties> instanceExtensions(instanceExtensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, instanceExtensions.data());
+
+#define PRINT_EXTENSIONS
+#ifndef PRINT_EXTENSIONS
+        // carry on
+#else
+        std::stringstream ss;
+        std::string name("    Name: ");
+        std::string spec("Spec Version: ");
+
+        //std::cout << "Instance extensions (GLFW) required:" << std::endl;
+        //ss << std::setfill(' ') << std::left;
+        //for (uint32_t i = 0; i < instanceExtensionCount; i++) {
+        //    ss << std::setw(name.length()) << name
+        //        << std::setw(40) << instanceExtensions[i].extensionName << std::endl;
+        //}
+        //std::cout << ss.str();
+
+        ss.clear();
+        std::cout << "Instance extensions (driver) available:" << std::endl;
+        ss << std::setfill(' ') << std::left;
+        for (auto &ext : instanceExtensions) {
+            ss << std::setw(name.length()) << name
+                << std::setw(40) << ext.extensionName
+                << std::setw(spec.length()) << spec
+                << std::setw(3) << ext.specVersion << std::endl;
+        }
+        std::cout << ss.str();
+#undef PRINT_EXTENSIONS
+#endif // NDEBUG
+
+        for (auto &reqExt : requiredExtensions) {
+            bool found = false;
+            for (auto &prop : instanceExtensions) {
+                if (strcmp(reqExt, prop.extensionName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                std::stringstream ss;
+                ss << "Required extension '" << reqExt << "' not found in the available driver extensions";
+                throw std::runtime_error(ss.str());
+            }
+
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Support function for CreateInstance(). Like CheckRequiredExtensionsSupportedByDriver(...),
+        but for validation layers.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CheckValidationLayersSupportedByDriver(const std::vector<const char *> &requiredLayers) const {
+        uint32_t layerCount;
+        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+        std::vector<VkLayerProperties> availableLayers(layerCount);
+        vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+
+#define PRINT_EXTENSIONS
+#ifndef PRINT_EXTENSIONS
+        // carry on
+#else
+        std::stringstream ss;
+        std::string name("    Name: ");
+        std::string spec("Spec Version: ");
+
+        ss.clear();
+        std::cout << "Instance validation layers (driver) available:" << std::endl;
+        ss << std::setfill(' ') << std::left;
+        for (auto &layer : availableLayers) {
+            ss << std::setw(name.length()) << name
+                << std::setw(40) << layer.layerName
+                << std::setw(spec.length()) << spec
+                << std::setw(3) << layer.specVersion << std::endl;
+        }
+        std::cout << ss.str();
+#undef PRINT_EXTENSIONS
+#endif // NDEBUG
+
+
+        for (auto reqLayer : requiredLayers) {
+            bool found = false;
+            for (auto &availableLayer : availableLayers) {
+                if (strcmp(reqLayer, availableLayer.layerName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                std::stringstream ss;
+                ss << "Required layer '" << reqLayer << "' not found in the available layers";
+                throw std::runtime_error(ss.str());
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The function called by VK_EXT_debug_utils callback object.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
+        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+        VkDebugUtilsMessageTypeFlagsEXT messageType,
+        const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
+        void *pUserData) {
+
+        std::cerr << "validation layer [" << pCallbackData->pMessageIdName << "]: " << pCallbackData->pMessage << std::endl << std::flush;
+        return VK_FALSE;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates the VkInstance class member. Includes checking for extension and layer support.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateInstance() {
+        // general info about the application
+        VkApplicationInfo appInfo{};
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName = "Hello Triangle";
+        appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.pEngineName = "No Engine";
+        appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.apiVersion = VK_MAKE_VERSION(1, 1, 0);   // 1.1 for descriptor update templates
+
+        // have to ask GLFW for info about the required extensions
+        // Note: Headless doesn't have a window, so it doesn't need any of GLFW's surface 
+        // extensions (and GLFW was never initialized).
+        std::vector<const char *> requiredExtensions;
+        if (!mOptions.headless) {
+            uint32_t glfwExtensionCount = 0;
+            const char ** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            requiredExtensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
+        if (mEnableValidationLayers) {
+            requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+
+        // for debugging
+        const std::vector<const char *> requiredValidationLayers{
+            "VK_LAYER_LUNARG_core_validation",
+            "VK_LAYER_LUNARG_standard_validation",
+        };
+        if (mEnableValidationLayers) {
+            CheckValidationLayersSupportedByDriver(requiredValidationLayers);
+            CheckRequiredExtensionsSupportedByDriver(requiredExtensions);
+        }
+
+        // for printing debug info with the "debug utils" callback messenger object
+        // https://www.lunarg.com/wp-content/uploads/2018/05/Vulkan-Debug-Utils_05_18_v1.pdf
+        VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};   // default null
+        if (mEnableValidationLayers) {
+            debugCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+            debugCreateInfo.messageSeverity =
+                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+                //VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+                VkDebugUtilsMessageSeverityFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+            debugCreateInfo.messageType =
+                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                VkDebugUtilsMessageTypeFlagBitsEXT::VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+            debugCreateInfo.pfnUserCallback = DebugCallback;    // global function
+            debugCreateInfo.pUserData = nullptr;
+        }
+
+        // finally, pull all that info together to create the instance
+        VkInstanceCreateInfo instanceCreateInfo{};
+        instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceCreateInfo.pApplicationInfo = &appInfo;
+        instanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
+        instanceCreateInfo.ppEnabledExtensionNames = requiredExtensions.data();
+
+        if (mEnableValidationLayers) {
+            instanceCreateInfo.enabledLayerCount = static_cast<uint32_t>(requiredValidationLayers.size());
+            instanceCreateInfo.ppEnabledLayerNames = requiredValidationLayers.data();
+        }
+
+        instanceCreateInfo.pNext = &debugCreateInfo;
+
+        if (vkCreateInstance(&instanceCreateInfo, nullptr, &mInstance) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create instance");
+        }
+
+        // and create the debug messenger itself
+        if (CreateDebugUtilsMessengerEXT(mInstance, &debugCreateInfo, nullptr, &mCallback) != VK_SUCCESS) {
+            throw std::runtime_error("failed to set up debug callback");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The window in an OS-specific container. You can't draw to a "window" object as designed in modern OS'. It's become a graphical paradigm that a window will have a "surface" object instead, a ??what is it??
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateSurface() {
+        if (mOptions.headless) {
+            // nothing to draw to but our own images
+            return;
+        }
+        if (glfwCreateWindowSurface(mInstance, mWindow, nullptr, &mSurface) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create window surface");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Queries the provided device and checks the properties to see if it supports graphics
+        command queues. (??is there a GPU that doesn't??)
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device) {
+        QueueFamilyIndices indices;
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyProperties.data());
+
+        for (uint32_t index = 0; index < queueFamilyCount; index++) {
+            const auto &queueFamilyProp = queueFamilyProperties.at(index);
+            bool queueExists = queueFamilyProp.queueCount > 0;
+
+            bool supportsGraphics = (queueFamilyProp.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+            if (queueExists && supportsGraphics) {
+                indices.graphicsFamily = index;
+            }
+
+            VkBool32 surfaceSupported = false;    //??"present support"? what does that mean??
+            if (mOptions.headless) {
+                // no surface; "presentation" is just the end of the graphics queue's work
+                surfaceSupported = supportsGraphics;
+            }
+            else {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, index, mSurface, &surfaceSupported);
+            }
+            if (queueExists && surfaceSupported) {
+                indices.presentationFamily = index;
+            }
+
+            if (indices.IsComplete()) {
+                break;
+            }
+        }
+        return indices;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Looks for a queue family that can run compute shaders but not graphics. Work submitted
+        to it can run at the same time as the graphics queue's, where a graphics family that
+        also computes would run it in line with everything else.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::optional<uint32_t> FindAsyncComputeQueueFamily(VkPhysicalDevice device) {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyProperties.data());
+
+        for (uint32_t index = 0; index < queueFamilyCount; index++) {
+            const auto &queueFamilyProp = queueFamilyProperties.at(index);
+            bool supportsCompute = (queueFamilyProp.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+            bool supportsGraphics = (queueFamilyProp.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+            if (queueFamilyProp.queueCount > 0 && supportsCompute && !supportsGraphics) {
+                return index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Self-explanatory.
+        TODO: ??make into a "Get" function instead? shove "Required" items into a namespace or another file??
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    bool CheckDeviceExtensionsSupport(VkPhysicalDevice device) {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        std::vector<const char *> requiredExtensionNames = GetRequiredDeviceExtensions();
+        std::set<std::string> requiredExtensions(requiredExtensionNames.begin(), requiredExtensionNames.end());
+        for (const auto &ext : availableExtensions) {
+            requiredExtensions.erase(ext.extensionName);
+        }
+
+        // if empty, all required extensions have been found
+        return requiredExtensions.empty();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        For optional extensions; the required ones are checked all at once by 
+        CheckDeviceExtensionsSupport(...).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char *extensionName) const {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto &ext : availableExtensions) {
+            if (strcmp(ext.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The swap chain extension is only needed when there is a window.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    std::vector<const char *> GetRequiredDeviceExtensions() const {
+        std::vector<const char *> extensions(mRequiredDeviceExtensions.begin(), mRequiredDeviceExtensions.end());
+        if (!mOptions.headless) {
+            extensions.insert(extensions.end(), mPresentationDeviceExtensions.begin(), mPresentationDeviceExtensions.end());
+        }
+        return extensions;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        If the preferred format sRGB (B8G8R8A8 nonlinear) is available, return that. Else return
+        the first available supported image format.
+
+        More on non-linear color space:
+        https://stackoverflow.com/questions/12524623/what-are-the-practical-differences-when-working-with-colors-in-a-linear-vs-a-no
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats) {
+        if (availableFormats.size() == 1 && availableFormats.front().format == VK_FORMAT_UNDEFINED) {
+            return {
+                VK_FORMAT_B8G8R8A8_UNORM,
+                VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+            };
+        }
+
+        for (const auto &available : availableFormats) {
+            if (available.format == VK_FORMAT_B8G8R8A8_UNORM &&
+                available.colorSpace == VK_COLORSPACE_SRGB_NONLINEAR_KHR) {
+                return available;
+            }
+        }
+
+        // preferred format not available, so just use the first supported; should be good enough
+        return availableFormats.front();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Rankings:
+        (1) Mailbox
+        (2) Immediate
+        (3) FIFO
+
+        Note: The tutorial places "Immediate" above "FIFO", saying "Unfortunately some drivers
+        currently don't properly support VK_PRESENT_MODE_FIFO_KHR, so we should prefer
+        VK_PRESENT_MODE_IMMEDIATE_KHR if VK_PRESENT_MODE_MAILBOX_KHR is not available".
+
+        Mailbox can be used to implement a triple buffer => first choice.
+
+        FIFO is a simple double buffer, reminiscient of OpenGL's size 2 framebuffer. It is
+        guaranteed to be an option.
+
+        Immediate shoves finished images to screen without waiting for screen refresh. This can
+        cause tearing => last choice.
+
+        Note: The above is only the default preference. A specific mode can be requested from the
+        command line (--present-mode=...) to trade throughput for latency on purpose (ex: FIFO
+        plus low-latency pacing). If the requested mode isn't supported, say so and fall back.
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) {
+        if (mOptions.presentMode.has_value()) {
+            VkPresentModeKHR requested = mOptions.presentMode.value();
+            if (std::find(availablePresentModes.begin(), availablePresentModes.end(), requested) != availablePresentModes.end()) {
+                return requested;
+            }
+            std::cout << "requested present mode " << requested << " not supported; using default" << std::endl;
+        }
+
+        bool immediateAvailable = false;
+
+        for (const auto &available : availablePresentModes) {
+            if (available == VK_PRESENT_MODE_MAILBOX_KHR) {
+                // found most preferred option; don't bother with the rest of the loop
+                return available;
+            }
+            else if (available == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+                immediateAvailable = true;
+            }
+        }
+
+        if (immediateAvailable) {
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        }
+        return VK_PRESENT_MODE_FIFO_KHR;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        "Extent" is the resolution (width, height) of the images that are put into the swap chain.
+        This is either slightly smaller than the window's resolution (windowed mode) or equal to
+        it (usually full screen mode).
+
+        Note: Some window managers (GLFW included) allow the extent of the image to be
+        automatically selected by the window manager. If the window manager did not automatically
+        select the resolution (either because it couldn't or for some reason it just didn't), then
+        the "extent" is set to maximum uint32. In that case, manually clamp the resolution to the
+        size of the window.
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) {
+        if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
+            // window manager will select image extent for us
+            return capabilities.currentExtent;
+        }
+
+        // Note: Not glfwGetFramebufferSize(...) because this may be on the render thread.
+        VkExtent2D actualExtent = {
+            mFramebufferWidth,
+            mFramebufferHeight
+        };
+
+        std::cout << "Extent2D width: " << mFramebufferWidth << ", height: " << mFramebufferHeight << ", window width: " << mWindowWidth << ", height: " << mWindowHeight << std::endl;
+
+        // manually clamp to window size
+        actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
+        actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
+        return actualExtent;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Unlike OpenGL, which has a default framebuffer, we have to set one up manually. In Vulkan,
+        the buffer of images that the surface will pull from to swap out the current image is
+        called a "swap chain". Need to make sure that the surface can pull from a buffer created
+        by this device.
+
+        Note: Not all GPUs can do this. Computers made for blade PCs in a server rack may not even
+        have an output, and so it is unlikely that the creator of that GPU's driver would have
+        even bothered to set it up to talk with the OS' window surfaces. (??is this right??)
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device) {
+        SwapChainSupportDetails details;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, mSurface, &details.capabilities);
+
+        uint32_t formatCount = 0;
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, mSurface, &formatCount, nullptr);
+        if (formatCount != 0) {
+            details.formats.resize(formatCount);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(device, mSurface, &formatCount, details.formats.data());
+        }
+
+        uint32_t presentModeCount = 0;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, mSurface, &presentModeCount, nullptr);
+        if (presentModeCount != 0) {
+            details.presentModes.resize(presentModeCount);
+            vkGetPhysicalDeviceSurfacePresentModesKHR(device, mSurface, &presentModeCount, details.presentModes.data());
+        }
+
+        return details;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Checks if the necessary features to run this program are available on the provided GPU.
+
+        Note: Headless mode is meant for CI machines that only have a CPU implementation of
+        Vulkan (lavapipe, SwiftShader), so it doesn't insist on a discrete GPU or on features
+        that this program doesn't strictly need (geometry shaders, anisotropic filtering), and
+        there is no swap chain to be adequate.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    bool IsDeviceSuitable(VkPhysicalDevice device) {
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(device, &deviceProperties);
+        bool isDiscreteGpu = (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
+
+        VkPhysicalDeviceFeatures deviceFeatures;
+        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+        bool supportsGeometryShader = deviceFeatures.geometryShader;
+        bool supportsSamplerAnisotropy = deviceFeatures.samplerAnisotropy;
+
+        QueueFamilyIndices indices = FindQueueFamilies(device);
+        bool hasAllRequiredQueueFamilyIndices = indices.IsComplete();
+
+        bool deviceExtensionsSupported = CheckDeviceExtensionsSupport(device);
+
+        // the extension being listed isn't enough; the feature must also be turned on
+        bool supportsTimelineSemaphore = false;
+        if (deviceExtensionsSupported) {
+            VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+            timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &timelineFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+            supportsTimelineSemaphore = timelineFeatures.timelineSemaphore;
+        }
+
+        bool swapChainAdequate = mOptions.headless;
+        if (deviceExtensionsSupported && !mOptions.headless) {
+            SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
+            swapChainAdequate =
+                !swapChainSupport.formats.empty() &&
+                !swapChainSupport.presentModes.empty();
+        }
+
+        if (mOptions.headless) {
+            isDiscreteGpu = true;
+            supportsGeometryShader = true;
+            supportsSamplerAnisotropy = true;
+        }
+
+        bool suitable =
+            isDiscreteGpu &&
+            supportsGeometryShader &&
+            supportsSamplerAnisotropy &&
+            hasAllRequiredQueueFamilyIndices &&
+            deviceExtensionsSupported &&
+            supportsTimelineSemaphore &&
+            swapChainAdequate;
+        return suitable;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Sets the GPU that will be used for the rest of the program.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void PickPhysicalDevice() {
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
+        if (deviceCount == 0) {
+            throw std::runtime_error("failed to find GPUs with Vulkan support");
+        }
+
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(mInstance, &deviceCount, devices.data());
+
+        // take the first one that Vulkan can use
+        // Note: Headless accepts any kind of device, so when there is a choice, prefer real 
+        // hardware over a CPU implementation.
+        auto deviceRank = [](VkPhysicalDevice dev) {
+            VkPhysicalDeviceProperties deviceProperties;
+            vkGetPhysicalDeviceProperties(dev, &deviceProperties);
+            switch (deviceProperties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 3;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 2;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 1;
+            default: return 0;
+            }
+        };
+        for (const auto &dev : devices) {
+            if (IsDeviceSuitable(dev)) {
+                if (mPhysicalDevice == VK_NULL_HANDLE || deviceRank(dev) > deviceRank(mPhysicalDevice)) {
+                    mPhysicalDevice = dev;
+                }
+            }
+        }
+        if (mPhysicalDevice == VK_NULL_HANDLE) {
+            throw std::runtime_error("failed to find a suitable GPU");
+        }
+
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &deviceProperties);
+        std::cout << "Using device: " << deviceProperties.deviceName << std::endl;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Checks if the device can do "bindless" textures: one big descriptor array of textures
+        that shaders index into, which is only partially filled in and can be added to while
+        command buffers that use it are still in flight. Requires VK_EXT_descriptor_indexing
+        (core in Vulkan 1.2) and a handful of its optional features.
+
+        If supported, also figures out how big the texture array can be.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool CheckBindlessTexturesSupport(VkPhysicalDevice device) {
+        if (!IsDeviceExtensionSupported(device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+            return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &indexingFeatures;
+        vkGetPhysicalDeviceFeatures2(device, &features2);
+
+        bool featuresOk =
+            indexingFeatures.runtimeDescriptorArray &&
+            indexingFeatures.descriptorBindingPartiallyBound &&
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing;
+        if (!featuresOk) {
+            return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &indexingProperties;
+        vkGetPhysicalDeviceProperties2(device, &properties2);
+
+        // "hundreds of materials" is the goal; don't ask for more than we could ever use since 
+        // the whole array is reserved in the pool whether it is filled or not
+        const uint32_t desiredMaxTextures = 4096;
+        mMaxBindlessTextures = std::min({
+            desiredMaxTextures,
+            indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+        return mMaxBindlessTextures > 0;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        A logical device seems to be the C-based Vulkan's version of a "base class" that
+        implements common functions regardless of the physical device.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateLogicalDevice() {
+        float queuePriority = 1.0f;
+        QueueFamilyIndices indices = FindQueueFamilies(mPhysicalDevice);
+        std::optional<uint32_t> asyncComputeFamily = FindAsyncComputeQueueFamily(mPhysicalDevice);
+        mGraphicsQueueFamily = indices.graphicsFamily.value();
+
+        std::vector<VkDeviceQueueCreateInfo> deviceCommandQueuesCreateInfo;
+
+        // Note: Graphics command queues on dedicated graphics cards will also be accepted by the 
+        // OS as being able to draw to a surface. This is not always the case across all graphics 
+        // devices and all OSs. This tutorial is being done on an NVidia GTX 980 TI, who's 
+        // graphics commands queue can put out results to a surface. For design reasons, we are 
+        // keeping the "graphics queue" and the "presentation queue" two queues in separate 
+        // structures, but they are actually the same thing. When creating a logical device, we 
+        // need to tell it how many *unique* command queues it has, hence std::set(...). I could 
+        // certainly hard-code the use of one of them and move one, but this verbose approach is 
+        // better for a tutorial.
+        std::set<uint32_t> uniqueQueueFamiliesIndices{
+            indices.graphicsFamily.value(),
+            indices.presentationFamily.value()
+        };
+        if (asyncComputeFamily.has_value()) {
+            uniqueQueueFamiliesIndices.insert(asyncComputeFamily.value());
+        }
+        for (const auto &queueFamilyIndex : uniqueQueueFamiliesIndices) {
+            VkDeviceQueueCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            createInfo.queueFamilyIndex = queueFamilyIndex;
+            createInfo.queueCount = 1;
+            createInfo.pQueuePriorities = &queuePriority;   //??same priority??
+            deviceCommandQueuesCreateInfo.push_back(createInfo);
+        }
+
+        // don't need any features yet, so leave it blank for now
+        VkPhysicalDeviceFeatures deviceFeatures{};
+
+        // Note: Required unless headless, in which case it is used if available.
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(mPhysicalDevice, &supportedFeatures);
+        deviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+        mSamplerAnisotropyEnabled = (supportedFeatures.samplerAnisotropy == VK_TRUE);
+
+        // optional; only used by the GPU profiler
+        deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+        mPipelineStatisticsEnabled = (supportedFeatures.pipelineStatisticsQuery == VK_TRUE);
+        //deviceFeatures.fillModeNonSolid = VK_TRUE;
+
+        // optional; culled clusters are drawn with one indirect call if this is there, or with 
+        // one call per cluster if not
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        mMultiDrawIndirectEnabled = (supportedFeatures.multiDrawIndirect == VK_TRUE);
+
+        // Note: The depth pre-pass is only a render pass and pipeline change, so it always 
+        // works. Culling runs compute shaders on the graphics queue, and the Hi-Z part of it 
+        // reads the depth buffer in them.
+        mDepthPrepassEnabled = mOptions.depthPrepass;
+        mDrawPrepass = mDepthPrepassEnabled;
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+        bool graphicsCanCompute = (queueFamilies.at(indices.graphicsFamily.value()).queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+        mClusterCullingEnabled = mOptions.hiZCulling && graphicsCanCompute;
+        mDrawCulling = mClusterCullingEnabled;
+        mHiZEnabled = mClusterCullingEnabled && CanSampleDepthFormat();
+        if (mOptions.depthPrepass || mOptions.hiZCulling) {
+            std::cout << "Depth pre-pass: " << (mDepthPrepassEnabled ? "on" : "off")
+                << "; cluster culling: " << (mClusterCullingEnabled ? (mHiZEnabled ? "frustum + Hi-Z" : "frustum only (depth format " + DepthFormatToString(FindDepthFormat()) + " can't be sampled)") : "off")
+                << (mClusterCullingEnabled && !mMultiDrawIndirectEnabled ? ", one draw per cluster (no multiDrawIndirect)" : "") << std::endl;
+        }
+
+        // Note: The downsampler reads and writes its storage images without a format in the 
+        // shader (one shader for RGBA8 textures and R32F Hi-Z) and picks the level with an 
+        // index into an array of them. Without those, textures are blitted and the Hi-Z is 
+        // built a level at a time.
+        mAsyncComputeEnabled = asyncComputeFamily.has_value();
+        mComputeQueueFamily = mAsyncComputeEnabled ? asyncComputeFamily.value() : mGraphicsQueueFamily;
+        mDownsampleEnabled = !mOptions.blitMipMaps &&
+            (mAsyncComputeEnabled || graphicsCanCompute) &&
+            supportedFeatures.shaderStorageImageReadWithoutFormat == VK_TRUE &&
+            supportedFeatures.shaderStorageImageWriteWithoutFormat == VK_TRUE &&
+            supportedFeatures.shaderStorageImageArrayDynamicIndexing == VK_TRUE;
+        deviceFeatures.shaderStorageImageReadWithoutFormat = mDownsampleEnabled ? VK_TRUE : VK_FALSE;
+        deviceFeatures.shaderStorageImageWriteWithoutFormat = mDownsampleEnabled ? VK_TRUE : VK_FALSE;
+        deviceFeatures.shaderStorageImageArrayDynamicIndexing = mDownsampleEnabled ? VK_TRUE : VK_FALSE;
+        if (!mDownsampleEnabled) {
+            std::cout << "Mip maps: " << (mOptions.blitMipMaps ? "blit (--blit-mips)" : "blit (no format-less storage images)") << std::endl;
+        }
+        else if (mAsyncComputeEnabled) {
+            std::cout << "Mip maps: single-pass compute, textures on the async compute queue (family " << mComputeQueueFamily << ")" << std::endl;
+        }
+        else {
+            std::cout << "Mip maps: single-pass compute, on the graphics queue (no async compute queue)" << std::endl;
+        }
+
+        if (mOptions.reversedZ) {
+            std::cout << "Depth: reversed-Z (no far plane), " << DepthFormatToString(FindDepthFormat()) << std::endl;
+        }
+        else {
+            std::cout << "Depth: standard (far plane " << mOptions.farPlane << "), " << DepthFormatToString(FindDepthFormat()) << std::endl;
+        }
+
+        // optional extensions and features go on top of the required ones
+        std::vector<const char *> enabledExtensions = GetRequiredDeviceExtensions();
+        void *pFeatureChain = nullptr;
+
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+        timelineFeatures.timelineSemaphore = VK_TRUE;
+        timelineFeatures.pNext = pFeatureChain;
+        pFeatureChain = &timelineFeatures;
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        mUseBindlessTextures = mPreferBindlessTextures && CheckBindlessTexturesSupport(mPhysicalDevice);
+        if (mUseBindlessTextures) {
+            enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+            indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            indexingFeatures.pNext = pFeatureChain;
+            pFeatureChain = &indexingFeatures;
+        }
+        std::cout << "Bindless textures: " << (mUseBindlessTextures ? "enabled" : "not supported; using per-material descriptor sets") << std::endl;
+
+        // optional; lets the benchmark report how much of each heap is in use
+        mMemoryBudgetEnabled = IsDeviceExtensionSupported(mPhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (mMemoryBudgetEnabled) {
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        VkDeviceCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = pFeatureChain;
+        createInfo.queueCreateInfoCount = static_cast<uint32_t>(deviceCommandQueuesCreateInfo.size());
+        createInfo.pQueueCreateInfos = deviceCommandQueuesCreateInfo.data();
+        createInfo.pEnabledFeatures = &deviceFeatures;
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
+
+        if (vkCreateDevice(mPhysicalDevice, &createInfo, nullptr, &mLogicalDevice) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create logical device");
+        }
+
+        // and retrieve the command queue that was created with it (based on createInfo)
+        // Note: Only created one command queue with the device, so use index 0.
+        // Also Note: Not to be confused with queueFamilyIndex, which is physical-device-specific.
+        // Gah.
+        uint32_t queueIndex = 0;
+
+        // if the graphics queue's family also supported surface drawing, then both queues will have the same handle now (??isn't that a bad thing??)
+        vkGetDeviceQueue(mLogicalDevice, indices.graphicsFamily.value(), queueIndex, &mGraphicsQueue);
+        vkGetDeviceQueue(mLogicalDevice, indices.presentationFamily.value(), queueIndex, &mPresentationQueue);
+
+        mVkWaitSemaphoresKHR = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(mLogicalDevice, "vkWaitSemaphoresKHR");
+        mVkGetSemaphoreCounterValueKHR = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(mLogicalDevice, "vkGetSemaphoreCounterValueKHR");
+        if (mVkWaitSemaphoresKHR == nullptr || mVkGetSemaphoreCounterValueKHR == nullptr) {
+            throw std::runtime_error("failed to load timeline semaphore functions");
+        }
+
+        mGraphicsTimeline.queue = mGraphicsQueue;
+        mGraphicsTimeline.semaphore = CreateTimelineSemaphore(0);
+        mGraphicsTimeline.lastSubmittedValue = 0;
+
+        if (mAsyncComputeEnabled) {
+            vkGetDeviceQueue(mLogicalDevice, mComputeQueueFamily, queueIndex, &mComputeTimeline.queue);
+            mComputeTimeline.semaphore = CreateTimelineSemaphore(0);
+            mComputeTimeline.lastSubmittedValue = 0;
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates a timeline semaphore (as opposed to a binary one) that starts at the given value.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkSemaphore CreateTimelineSemaphore(uint64_t initialValue) {
+        VkSemaphoreTypeCreateInfoKHR typeCreateInfo{};
+        typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        typeCreateInfo.initialValue = initialValue;
+
+        VkSemaphoreCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeCreateInfo;
+
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        if (vkCreateSemaphore(mLogicalDevice, &createInfo, nullptr, &semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timeline semaphore");
+        }
+        return semaphore;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Returns the highest value that the GPU has finished on this timeline. Never blocks.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint64_t GetCompletedTimelineValue(const QueueTimeline &timeline) const {
+        uint64_t value = 0;
+        mVkGetSemaphoreCounterValueKHR(mLogicalDevice, timeline.semaphore, &value);
+        return value;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Blocks the CPU until the timeline reaches the given value. Only waits on that one
+        submission (and whatever came before it on the same queue), not on the whole queue.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void WaitForTimelineValue(const QueueTimeline &timeline, uint64_t value) const {
+        if (value == 0) {
+            // nothing was ever submitted
+            return;
+        }
+
+        VkSemaphoreWaitInfoKHR waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timeline.semaphore;
+        waitInfo.pValues = &value;
+        uint64_t timeout_ns = std::numeric_limits<uint64_t>::max();
+        if (mVkWaitSemaphoresKHR(mLogicalDevice, &waitInfo, timeout_ns) != VK_SUCCESS) {
+            throw std::runtime_error("failed to wait on timeline semaphore");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Submits a command buffer to the timeline's queue. The submission waits on everything in
+        "waits" (binary or timeline, possibly from other queues), signals every binary semaphore
+        in "binarySignals" (ex: for present), and signals the next value on its own timeline.
+
+        Returns the timeline value that will be reached when this submission has finished.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint64_t SubmitOnTimeline(QueueTimeline &timeline, VkCommandBuffer commandBuffer, const std::vector<SemaphoreWait> &waits, const std::vector<VkSemaphore> &binarySignals) {
+        uint64_t signalValue = timeline.lastSubmittedValue + 1;
+
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        for (const auto &wait : waits) {
+            waitSemaphores.push_back(wait.semaphore);
+            waitValues.push_back(wait.value);
+            waitStages.push_back(wait.stageMask);
+        }
+
+        // Note: The values array must line up with the semaphore array. Binary semaphores' 
+        // values are ignored, so just put a 0 there.
+        std::vector<VkSemaphore> signalSemaphores(binarySignals.begin(), binarySignals.end());
+        std::vector<uint64_t> signalValues(binarySignals.size(), 0);
+        signalSemaphores.push_back(timeline.semaphore);
+        signalValues.push_back(signalValue);
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{};
+        timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineSubmitInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+        timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineSubmitInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+        timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineSubmitInfo;
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+        submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+        uint32_t submitCount = 1;
+        VkFence nullFence = VK_NULL_HANDLE;
+        if (vkQueueSubmit(timeline.queue, submitCount, &submitInfo, nullFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit command buffer");
+        }
+        timeline.lastSubmittedValue = signalValue;
+        return signalValue;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Rather than the simple "swap" functionality of OpenGL, which had a default "framebuffer"
+        with "front" and "back" buffers (where "buffer" means "a pixel array"), Vulkan's
+        framebuffer requires more setup and puts in place a "swap chain", which is a set of image
+        buffers that can be swapped out as desired. This "chain" (??is it a linked list??) has more flexibility than OpenGL's framebuffer.
+
+        There is a minimum and maximum size to this swap chain. When the window manager's creators
+        implemented Vulkan support on the window's drawing surface, they determined these values.
+        We just need to query them.
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateSwapChain() {
+        SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(mPhysicalDevice);
+        VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.formats);
+        VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes);
+        mPresentMode = presentMode;
+        VkExtent2D extent = ChooseSwapExtent(swapChainSupport.capabilities);
+
+        // attempt to allocate enough images for a triple buffer
+        // Note: Min image count should always be 2 (minimum required for present mode FIFO 
+        // (simple double buffer), which is always available). For a triple buffer, we want the 
+        // min image count to be 3.
+        uint32_t createMinImageCount = swapChainSupport.capabilities.minImageCount + 1;
+        if (mOptions.swapChainImages > 0) {
+            // asked for a specific count (ex: 2 for FIFO with minimal queueing)
+            createMinImageCount = std::max(mOptions.swapChainImages, swapChainSupport.capabilities.minImageCount);
+        }
+        if (swapChainSupport.capabilities.maxImageCount == 0) {
+            // indicates no limit for swap chain size aside from memory
+        }
+        else {
+            // there is a constraint aside from memory
+            // Note: The count is unsigned, so implicitly this means "> 0".
+            if (createMinImageCount > swapChainSupport.capabilities.maxImageCount) {
+                // it seems that max image count == min image count; clamp "min" to prevent errors
+                createMinImageCount = swapChainSupport.capabilities.maxImageCount;
+            }
+            else {
+                // no problem with minimum 3 images
+            }
+        }
+
+        // 1 layer per image in the swapchain unless doing stereoscopic 3D, in which case there 
+        // will be 2 layers, one for each eye, that get pushed out the swap chain simultaneously
+        uint32_t numImageLayers = 1;
+
+        // will draw directly to an image in the swap chain
+        // Note: If doing post-processing, will need to create one swap chain with 
+        // VK_IMAGE_USAGE_TRANSFER_SRC_BIT, create another swap chain with 
+        // VK_IMAGE_USAGE_TRANSFER_DST_BIT, and use a memory operation to transfer the rendered 
+        // image from the "source" swap chain to the "destination" swap chain.
+        VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+        // Note: Dynamic resolution is exactly that post-processing case, but it doesn't need a 
+        // second swap chain. The scene is rendered to an image of its own and blitted into the 
+        // swap chain image, which only has to be able to be a transfer destination.
+        mDynamicResolutionEnabled = false;
+        if (mOptions.dynamicResolution) {
+            bool canTransfer = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+            mDynamicResolutionEnabled = canTransfer && CanUpscaleFormat(surfaceFormat.format);
+            if (mDynamicResolutionEnabled) {
+                imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            }
+            else {
+                std::cout << "Dynamic resolution: the swap chain format can't be upscaled into; rendering at full resolution" << std::endl;
+            }
+        }
+
+        VkSwapchainCreateInfoKHR createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        createInfo.surface = mSurface;
+        createInfo.minImageCount = createMinImageCount;
+        createInfo.imageFormat = surfaceFormat.format;
+        createInfo.imageColorSpace = surfaceFormat.colorSpace;
+        createInfo.imageExtent = extent;
+        createInfo.imageArrayLayers = numImageLayers;
+        createInfo.imageUsage = imageUsage;
+
+        //???what does this sentence mean: "we need to specify how to handle swap chain images that will be used across multiple queue families"??
+        QueueFamilyIndices indices = FindQueueFamilies(mPhysicalDevice);
+        if (indices.graphicsFamily == indices.presentationFamily) {
+            // Note: Default "exclusive", meaning that only one queue family can access the swap 
+            // chain at a time. This allows Vulkan to optimize and is thus the most efficient.
+        }
+        else {
+            // both the graphics queue family and the presentation queue family need to use this 
+            // swap chain; this is the tutorial's way of handling it for now, saying that it will 
+            // do something more latter
+            uint32_t queueFamilyIndices[]{
+                indices.graphicsFamily.value(),
+                indices.presentationFamily.value()
+            };
+            createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+            createInfo.queueFamilyIndexCount = 2;
+            createInfo.pQueueFamilyIndices = queueFamilyIndices;
+        }
+
+        // Note: We can bake a transform (90 degree clockwise rotation, horizontal flip, etc.) 
+        // into the swap chain. For example, a fish-eye transform can be run on the image before 
+        // the image gets sent to a VR headset.
+        createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
+
+        // set to opaque unless you want to make the window surface transluscent (might want to do 
+        // this in mobile GUIs)
+        createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+
+        // retrieved earlier
+        createInfo.presentMode = presentMode;
+
+        // if a region of the surface is not visible (ex: another window is in front of this one), 
+        // discard the obscured pixels
+        createInfo.clipped = VK_TRUE;
+
+        // Note: If a swap chain becomes invalid at runtime (ex: window resized, so image extents 
+        // are no longer valid), then it needs to be recreated. Handing over the old one (null 
+        // the first time) lets the driver reuse its resources and lets frames that are still 
+        // presenting from it finish. It is "retired" by this, and it is destroyed later (see 
+        // RecreateSwapChain()).
+        createInfo.oldSwapchain = mSwapChain;
+
+        // all that leads up to this
+        if (vkCreateSwapchainKHR(mLogicalDevice, &createInfo, nullptr, &mSwapChain) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create swap chain");
+        }
+
+        // Note: Cannot create space for the images in the swap chain prior to creating it because 
+        // the create info only specifies "minimum" image count. Vulkan is allowed to create more 
+        // than that (I don't know why it would, but it can, and need to account for it).
+        uint32_t imageCount = 0;
+        vkGetSwapchainImagesKHR(mLogicalDevice, mSwapChain, &imageCount, nullptr);
+        std::vector<VkImage> swapChainImages(imageCount, VK_NULL_HANDLE);
+        vkGetSwapchainImagesKHR(mLogicalDevice, mSwapChain, &imageCount, swapChainImages.data());
+
+        // store these for later
+        mSwapChainImages = swapChainImages;
+        mSwapChainImageFormat = surfaceFormat.format;
+        mSwapChainExtent = extent;
+
+        // create a "view" for each image
+        // Note: A "view" tells Vulkan how to handle the array of data that we generically call 
+        // "image". Not every "image" is a finished drawing. It may be a rendering from a 
+        // particular point of view and will be used as a texture, or it may be a lighting map 
+        // with simple intensity values, or it could simply be a finished array of pixel colors.
+        mSwapChainImageViews.resize(swapChainImages.size());
+        for (size_t i = 0; i < swapChainImages.size(); i++) {
+            uint32_t mipLevels = 1;
+            mSwapChainImageViews.at(i) = CreateImageView(swapChainImages.at(i), mSwapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The headless stand-in for CreateSwapChain(). Makes one color image (and one depth image)
+        per frame context at the requested resolution, and fills in the same members that the
+        swap chain would have (format, extent, image views), so everything downstream (render
+        pass, framebuffers, pipeline) is built exactly the same way.
+
+        Note: The color images are made transfer-source-capable so that a frame could be read
+        back for checking.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateOffscreenTargets() {
+        mSwapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;   // always supported as a color attachment
+        mSwapChainExtent = { mOptions.width, mOptions.height };
+
+        uint32_t mipLevels = 1;
+        VkFormat depthFormat = FindDepthFormat();
+        mDynamicResolutionEnabled = mOptions.dynamicResolution && CanUpscaleFormat(mSwapChainImageFormat);
+
+        mOffscreenTargets.resize(mOptions.framesInFlight);
+        mSwapChainImages.resize(mOffscreenTargets.size());
+        mSwapChainImageViews.resize(mOffscreenTargets.size());
+        for (size_t i = 0; i < mOffscreenTargets.size(); i++) {
+            OffscreenTarget &target = mOffscreenTargets.at(i);
+
+            VkImageUsageFlags colorUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            if (mDynamicResolutionEnabled) {
+                // the scene is upscaled into it (see RecordUpscale(...))
+                colorUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            }
+            CreateImage(mSwapChainExtent.width, mSwapChainExtent.height, mipLevels, mSwapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, colorUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target.colorImage, target.colorImageMemory);
+            mSwapChainImages.at(i) = target.colorImage;
+            mSwapChainImageViews.at(i) = CreateImageView(target.colorImage, mSwapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+
+            VkImageUsageFlags depthUsage = GetDepthImageUsage();
+            CreateImage(mSwapChainExtent.width, mSwapChainExtent.height, mipLevels, depthFormat, VK_IMAGE_TILING_OPTIMAL, depthUsage, GetAttachmentMemoryProperties(depthUsage), target.depthImage, target.depthImageMemory, &mDepthMemoryLazy);
+            target.depthImageView = CreateImageView(target.depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, mipLevels);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        This code is used during swap chain recreation, so it was moved from program-end Cleanup()
+        to here.
+
+        Note: Recreation now retires the old objects instead (see RecreateSwapChain()), so this
+        is back to only being used at program end.
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CleanupSwapChain() {
+        // not necessary to destroy in reverse order of creation since they are all created off 
+        // the logical device and will not complain when destroyed out of order unless the logical 
+        // device is destroyed first, but I'm doing it anyway because it looks orderly
+        for (auto &framebuffer : mSwapChainFramebuffers) {
+            vkDestroyFramebuffer(mLogicalDevice, framebuffer, nullptr);
+        }
+        vkDestroyImageView(mLogicalDevice, mDepthImageView, nullptr);
+        vkDestroyImage(mLogicalDevice, mDepthImage, nullptr);
+        vkFreeMemory(mLogicalDevice, mDepthImageMemory, nullptr);
+        vkDestroyRenderPass(mLogicalDevice, mRenderPass, nullptr);
+        vkDestroyRenderPass(mLogicalDevice, mRenderPassDepthDiscarded, nullptr);
+        for (auto &imageView : mSwapChainImageViews) {
+            vkDestroyImageView(mLogicalDevice, imageView, nullptr);
+        }
+        if (mOptions.headless) {
+            for (auto &target : mOffscreenTargets) {
+                vkDestroyImageView(mLogicalDevice, target.depthImageView, nullptr);
+                vkDestroyImage(mLogicalDevice, target.depthImage, nullptr);
+                vkFreeMemory(mLogicalDevice, target.depthImageMemory, nullptr);
+                vkDestroyImage(mLogicalDevice, target.colorImage, nullptr);
+                vkFreeMemory(mLogicalDevice, target.colorImageMemory, nullptr);
+            }
+            mOffscreenTargets.clear();
+        }
+        else {
+            vkDestroySwapchainKHR(mLogicalDevice, mSwapChain, nullptr);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        During window resizing, image extent is no longer valid, and therefore the swap chain
+        create info is no longer valid, and neither are the image views, or the render pass, or
+        anything downstream that depended upon image extent.
+
+        Note: That used to mean waiting for the device to go idle and rebuilding nearly
+        everything, which made live resizing hitch. Now only what is actually sized to the
+        window (swap chain, image views, depth image, framebuffers) is rebuilt, and the render
+        pass and pipeline are kept unless the format changed.
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void RecreateSwapChain() {
+        // minimized; nothing to draw to until the window comes back (or is closed)
+        while ((mFramebufferWidth == 0 || mFramebufferHeight == 0) && !mQuitRequested) {
+            std::cout << "Waiting on frame buffer" << std::endl;
+            if (mUseRenderThread) {
+                // the main thread is doing the waiting on events; just check back periodically
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            else {
+                glfwWaitEvents();
+            }
+            ProcessRenderCommands();
+        }
+        if (mQuitRequested) {
+            return;
+        }
+
+        // Note: No vkDeviceWaitIdle(...). Frames still in flight keep using the old swap chain 
+        // and everything sized to it, so those are retired rather than destroyed, and destroyed 
+        // once the GPU has moved past them (see DeferDestruction(...)).
+        VkSwapchainKHR oldSwapChain = mSwapChain;
+        std::vector<VkImageView> oldImageViews = mSwapChainImageViews;
+        std::vector<VkFramebuffer> oldFramebuffers = mSwapChainFramebuffers;
+        VkImage oldDepthImage = mDepthImage;
+        VkDeviceMemory oldDepthImageMemory = mDepthImageMemory;
+        VkImageView oldDepthImageView = mDepthImageView;
+        VkFormat oldFormat = mSwapChainImageFormat;
+
+        CreateSwapChain();
+        DeferDestruction([this, oldSwapChain, oldImageViews, oldFramebuffers, oldDepthImage, oldDepthImageMemory, oldDepthImageView]() {
+            for (auto &framebuffer : oldFramebuffers) {
+                vkDestroyFramebuffer(mLogicalDevice, framebuffer, nullptr);
+            }
+            vkDestroyImageView(mLogicalDevice, oldDepthImageView, nullptr);
+            vkDestroyImage(mLogicalDevice, oldDepthImage, nullptr);
+            vkFreeMemory(mLogicalDevice, oldDepthImageMemory, nullptr);
+            for (auto &imageView : oldImageViews) {
+                vkDestroyImageView(mLogicalDevice, imageView, nullptr);
+            }
+            vkDestroySwapchainKHR(mLogicalDevice, oldSwapChain, nullptr);
+        });
+
+        // the render pass (and so the pipeline, which is built against it) only cares about the 
+        // format, and the viewport and scissor are dynamic, so a plain resize keeps both
+        // Note: Not recreating the descriptor set layout because those are independent of image.
+        // Also Note: Every pipeline variant was built against the old render pass, so they are 
+        // all retired. Only the main one is rebuilt right away; the rest go back in the 
+        // background queue and use it as the fallback until they are done.
+        if (mSwapChainImageFormat != oldFormat) {
+            VkRenderPass oldRenderPass = mRenderPass;
+            VkRenderPass oldRenderPassDepthDiscarded = mRenderPassDepthDiscarded;
+            std::vector<VkPipeline> oldPipelines = mPipelineManager.RetireAll();
+            DeferDestruction([this, oldRenderPass, oldRenderPassDepthDiscarded, oldPipelines]() {
+                for (VkPipeline pipeline : oldPipelines) {
+                    vkDestroyPipeline(mLogicalDevice, pipeline, nullptr);
+                }
+                vkDestroyRenderPass(mLogicalDevice, oldRenderPass, nullptr);
+                vkDestroyRenderPass(mLogicalDevice, oldRenderPassDepthDiscarded, nullptr);
+            });
+            CreateRenderPass();
+            CreateGraphicsPipeline();
+            mPipelineManager.RequeueAll();
+        }
+        CreateDepthResources();
+        CreateFramebuffers();
+
+        // the scene target is sized (and formatted) to match the swap chain; the next frame 
+        // below full scale makes a new one
+        RetireSceneTarget();
+
+        // the Hi-Z pyramid is sized from the swap chain too; culling goes without occlusion 
+        // until the first frame at the new size has built the new one
+        RetireHiZPyramid();
+        CreateHiZPyramid();
+
+        // the image count may have changed, and none of the new images are in use yet
+        mImagesInFlight.assign(mSwapChainImageViews.size(), 0);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Queues up the destruction of something that the GPU might still be using. It runs once
+        (1) the GPU has finished everything that had been submitted when this was called, and
+        (2) every frame context has gone around once since then.
+
+        The second part is for the presentation engine, which can hold on to a swap chain image
+        after the GPU is done rendering to it, and which the timeline doesn't know about. By the
+        time each frame context has been reused, each of their earlier presents has been waited
+        out by the acquire that followed it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void DeferDestruction(std::function<void()> destroy) {
+        DeferredDestruction deferred{};
+        deferred.timelineValue = mGraphicsTimeline.lastSubmittedValue;
+        deferred.frameNumber = mCurrentFrame + mFrameContexts.size();
+        deferred.destroy = std::move(destroy);
+        mDeferredDestructions.push_back(std::move(deferred));
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Destroys whatever has been retired long enough. Called once per frame, or with "all" at
+        shutdown (after the device has gone idle).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RunDeferredDestructions(bool all) {
+        uint64_t completedValue = all ? std::numeric_limits<uint64_t>::max() : GetCompletedTimelineValue(mGraphicsTimeline);
+        while (!mDeferredDestructions.empty()) {
+            DeferredDestruction &deferred = mDeferredDestructions.front();
+            if (!all && (deferred.timelineValue > completedValue || deferred.frameNumber > mCurrentFrame)) {
+                // queued in order, so nothing after this one is ready either
+                break;
+            }
+            deferred.destroy();
+            mDeferredDestructions.pop_front();
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        At this time (1/12/2019) in the tutorial (Texture Mapping: Image view and sampler), the
+        image view create is mostly the same, so while image creation is special, image view
+        creation is not. We are not using images for depth, which require a different type of
+        image view.
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t baseMipLevel = 0) {
+        VkImageViewCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        createInfo.image = image;
+        createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        createInfo.format = format;
+
+        // we could mess with the mappings of components.r, components.g, etc. and set all 
+        // color components in the view to be "red" (VK_COMPONENT_SWIZZLE_R), thus giving us a 
+        // monochrome red shade, or we could leave them at their default values 
+        // (VK_COMPONENT_SWIZZLE_IDENTITY = 0), which is what we're going to do here 
+        // Note: I could ignore this completely since structure creation with {} makes them all 0, 
+        // but for the sake fo the tutorial, I will be explicit.
+        createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+        // no mip mapping, and 1 layer (stereoscopic 3D needs 2 layers (??I think??))
+        // Note: A view can also start partway down the mip chain (ex: one Hi-Z level).
+        createInfo.subresourceRange.aspectMask = aspectFlags;
+        createInfo.subresourceRange.baseMipLevel = baseMipLevel;
+        createInfo.subresourceRange.levelCount = mipLevels;
+        createInfo.subresourceRange.baseArrayLayer = 0;
+        createInfo.subresourceRange.layerCount = 1;
+
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(mLogicalDevice, &createInfo, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create image views");
+        }
+        return view;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        "Before we can finish creating the pipeline, we need to tell Vulkan about the framebuffer
+        attachments that will be used while rendering. We need to specify how many color and depth
+        buffers there will be, how many samples to use for each of them and how their contents
+        should be handled throughout the rendering operations. All of this information is wrapped
+        in a render pass object..."
+
+        Note: An "attachment" is one of the Vulkan synonyms for images. See my (mildly popular)
+        post on Reddit that asked what it is.
+        https://www.reddit.com/r/vulkan/comments/a27cid/what_is_an_attachment_in_the_render_passes/
+
+        ??what? "color and depth buffers"? "framebuffer attachments"??
+
+        https://vulkan-tutorial.com/Drawing_a_triangle/Graphics_pipeline_basics/Render_passes
+
+        Render Passes in Vulkan
+        https://www.youtube.com/watch?v=x2SGVjlVGhE
+
+        Also Note: With a depth pre-pass, there are two subpasses: subpass 0 only writes depth,
+        and subpass 1 is the usual color + depth subpass, which tests against what subpass 0
+        wrote. Pipelines are built for one specific subpass (see BuildGraphicsPipeline(...)).
+
+        And Also Note: The attachments start and end in the layouts that the subpasses use, and
+        there are no dependencies on anything outside of the render pass. Getting the images
+        into those layouts, and waiting on whatever used them before (or making whatever uses
+        them after wait), is the frame graph's job (see RecordCommandBuffer(...)), since only it
+        knows what that is this frame (the acquire, last frame's Hi-Z build, the upscale, etc.).
+
+        And Also Also Note: "storeDepth" is only worth turning on if something reads the depth
+        after the render pass (see IsDepthReadAfterRenderPass()).
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkRenderPass CreateColorDepthRenderPass(bool storeDepth) {
+        VkAttachmentDescription colorAttachmentDesc{};
+        colorAttachmentDesc.format = mSwapChainImageFormat;
+        colorAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;    // not doing multisampling yet, so ??one sample per texture? per pixel??
+        colorAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachmentDesc.initialLayout = GetResourceUsageInfo(ResourceUsage::COLOR_ATTACHMENT).layout;
+        colorAttachmentDesc.finalLayout = GetResourceUsageInfo(ResourceUsage::COLOR_ATTACHMENT).layout;
+
+        VkAttachmentDescription depthAttachmentDesc{};
+        depthAttachmentDesc.format = FindDepthFormat();
+        depthAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+
+        // the Hi-Z build reads depth after the render pass (see RecordHiZBuild(...))
+        // Note: Otherwise it is never written out, which on a tiler is most of its cost.
+        depthAttachmentDesc.storeOp = storeDepth ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachmentDesc.initialLayout = GetResourceUsageInfo(ResourceUsage::DEPTH_ATTACHMENT).layout;
+        depthAttachmentDesc.finalLayout = GetResourceUsageInfo(ResourceUsage::DEPTH_ATTACHMENT).layout;
+
+        std::array<VkAttachmentDescription, 2> attachments = { colorAttachmentDesc, depthAttachmentDesc };
+
+        // Note: The render pass' create info specifies all the attachments that will be available 
+        // during it. Each subpass description only specifies references though, and it does this 
+        // through indexing.
+        // Also Note: This index is the same as the "layout(location=0/location=1/etc.)" in the 
+        // shaders that are in use during this render pass.
+        VkAttachmentReference colorAttachmentRef{};
+        colorAttachmentRef.attachment = 0;  // index into attachment descriptions array
+        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        // Note: There is a "count" for the color attachments but not for the depth because a 
+        // shader that is used within a subpass may be designed to read from/write to (??I think 
+        // multiple write??) multiple color attachments, hence the need for a count, but cannot be 
+        // designed to read from/write to more than one depth attachment because it is assumed 
+        // that the depth attachment is relevant only to the current image under construction, and 
+        // so there would be no need to check any other image's depth data. (??I think??)
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        // the depth pre-pass: same depth attachment, no color
+        VkSubpassDescription prepassSubpass{};
+        prepassSubpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        prepassSubpass.colorAttachmentCount = 0;
+        prepassSubpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        std::vector<VkSubpassDescription> subpasses;
+        if (mDepthPrepassEnabled) {
+            subpasses.push_back(prepassSubpass);
+        }
+        subpasses.push_back(subpass);
+        uint32_t colorSubpass = static_cast<uint32_t>(subpasses.size() - 1);
+
+        VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        std::vector<VkSubpassDependency> dependencies;
+
+        // the main subpass tests against the pre-pass' depth
+        if (mDepthPrepassEnabled) {
+            VkSubpassDependency prepassDependency{};
+            prepassDependency.srcSubpass = 0;
+            prepassDependency.dstSubpass = colorSubpass;
+            prepassDependency.srcStageMask = depthStages;
+            prepassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            prepassDependency.dstStageMask = depthStages;
+            prepassDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            prepassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+            dependencies.push_back(prepassDependency);
+        }
+
+        // finally, make the render pass object itself
+        VkRenderPassCreateInfo renderPassCreateInfo{};
+        renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassCreateInfo.pAttachments = attachments.data();
+        renderPassCreateInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+        renderPassCreateInfo.pSubpasses = subpasses.data();
+        renderPassCreateInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassCreateInfo.pDependencies = dependencies.data();
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        if (vkCreateRenderPass(mLogicalDevice, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create render pass");
+        }
+        return renderPass;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The render pass that draws the scene, whether into the swap chain image, a headless
+        target, or (with dynamic resolution) the frame graph's scene color image. What happens
+        to the image after it (present, copy out, upscale) is up to the frame graph, so one
+        render pass does for all of them.
+
+        Note: With a Hi-Z pyramid, depth is stored for the Hi-Z build, but a frame that doesn't
+        build one (culling is toggled off) has no use for it. Such frames begin an otherwise
+        identical render pass that discards depth instead. Render passes that only differ in
+        load/store ops are "compatible", so the same framebuffers and pipelines work with both.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateRenderPass() {
+        mRenderPass = CreateColorDepthRenderPass(IsDepthReadAfterRenderPass());
+        if (IsDepthReadAfterRenderPass()) {
+            mRenderPassDepthDiscarded = CreateColorDepthRenderPass(false);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        A "descriptor" is shorthand for the general programming term "data descriptor", which is a
+        structure containing information that describes data. How helpful :/. In Vulkan, a
+        descriptor is used to provide information to shaders in a pipeline about resources that
+        are available (uniforms, texture samplers, etc.).
+
+        Note: It is possible for the shader's descriptor at a particular binding index (in this
+        case we're using 0) to specify an array of descriptor objects, such as an array of uniform
+        buffer objects, each with a set of transforms, for every "bone" in a skeletal animation.
+        We're just using a single descriptor though, so our descriptor count is only 1;
+
+        Also Note: The descriptors are split by update frequency into two sets:
+        - Set 0: per-frame data (view-projection UBO). Bound once per frame.
+        - Set 1: per-material data (texture sampler). Only rebound when the material changes.
+        The per-object model transform doesn't use a descriptor at all (push constants).
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDescriptorSetLayout() {
+        // identical layouts are only ever created once; the cache owns them all
+        mDescriptorLayoutCache.Init(mLogicalDevice);
+
+        // Note: Despite the name, this is info about a single descriptor, not a set. It is to be 
+        // understood as a single descriptor "binding" within a descriptor set.
+        VkDescriptorSetLayoutBinding uboLayoutBinding{};
+        uboLayoutBinding.binding = 0;   // same binding location as in the shader that uses it
+        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboLayoutBinding.descriptorCount = 1;
+        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        uboLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo perFrameCreateInfo{};
+        perFrameCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        perFrameCreateInfo.bindingCount = 1;
+        perFrameCreateInfo.pBindings = &uboLayoutBinding;
+
+        mPerFrameDescriptorSetLayout = mDescriptorLayoutCache.CreateDescriptorSetLayout(perFrameCreateInfo);
+
+        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+        samplerLayoutBinding.binding = 0;   // binding 0 of set 1
+        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerLayoutBinding.descriptorCount = 1;
+        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        samplerLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo materialCreateInfo{};
+        materialCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        materialCreateInfo.bindingCount = 1;
+        materialCreateInfo.pBindings = &samplerLayoutBinding;
+
+        mMaterialDescriptorSetLayout = mDescriptorLayoutCache.CreateDescriptorSetLayout(materialCreateInfo);
+
+        if (mUseBindlessTextures) {
+            // one big array of textures instead of one texture per set
+            // Note: "Partially bound" means that not every element needs to have a valid 
+            // descriptor as long as the shaders don't access the empty ones. "Update after bind" 
+            // means that new textures can be written into the array while command buffers that 
+            // use the set are pending execution.
+            VkDescriptorSetLayoutBinding bindlessBinding{};
+            bindlessBinding.binding = 0;
+            bindlessBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            bindlessBinding.descriptorCount = mMaxBindlessTextures;
+            bindlessBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+            bindlessBinding.pImmutableSamplers = nullptr;
+
+            VkDescriptorBindingFlagsEXT bindingFlags =
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT;
+            VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo{};
+            bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+            bindingFlagsCreateInfo.bindingCount = 1;
+            bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+            VkDescriptorSetLayoutCreateInfo bindlessCreateInfo{};
+            bindlessCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            bindlessCreateInfo.pNext = &bindingFlagsCreateInfo;
+            bindlessCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+            bindlessCreateInfo.bindingCount = 1;
+            bindlessCreateInfo.pBindings = &bindlessBinding;
+
+            mBindlessDescriptorSetLayout = mDescriptorLayoutCache.CreateDescriptorSetLayout(bindlessCreateInfo);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        A descriptor update template tells the driver, once, where each descriptor lives inside a
+        plain block of application memory. Updating a set is then a single call that hands over
+        a pointer to that memory, instead of filling out (and having the driver parse) an array of
+        VkWriteDescriptorSet structures every time.
+
+        Note: The "offset" and "stride" in each entry are into the data pointer that is later
+        given to vkUpdateDescriptorSetWithTemplate(...). Here that pointer is a single
+        VkDescriptorBufferInfo or VkDescriptorImageInfo.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDescriptorUpdateTemplates() {
+        VkDescriptorUpdateTemplateEntry uboEntry{};
+        uboEntry.dstBinding = 0;
+        uboEntry.dstArrayElement = 0;
+        uboEntry.descriptorCount = 1;
+        uboEntry.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboEntry.offset = 0;
+        uboEntry.stride = sizeof(VkDescriptorBufferInfo);
+
+        VkDescriptorUpdateTemplateCreateInfo perFrameCreateInfo{};
+        perFrameCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        perFrameCreateInfo.descriptorUpdateEntryCount = 1;
+        perFrameCreateInfo.pDescriptorUpdateEntries = &uboEntry;
+        perFrameCreateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        perFrameCreateInfo.descriptorSetLayout = mPerFrameDescriptorSetLayout;
+        if (vkCreateDescriptorUpdateTemplate(mLogicalDevice, &perFrameCreateInfo, nullptr, &mPerFrameUpdateTemplate) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create per-frame descriptor update template");
+        }
+
+        VkDescriptorUpdateTemplateEntry samplerEntry{};
+        samplerEntry.dstBinding = 0;
+        samplerEntry.dstArrayElement = 0;
+        samplerEntry.descriptorCount = 1;
+        samplerEntry.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerEntry.offset = 0;
+        samplerEntry.stride = sizeof(VkDescriptorImageInfo);
+
+        VkDescriptorUpdateTemplateCreateInfo materialCreateInfo{};
+        materialCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        materialCreateInfo.descriptorUpdateEntryCount = 1;
+        materialCreateInfo.pDescriptorUpdateEntries = &samplerEntry;
+        materialCreateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        materialCreateInfo.descriptorSetLayout = mMaterialDescriptorSetLayout;
+        if (vkCreateDescriptorUpdateTemplate(mLogicalDevice, &materialCreateInfo, nullptr, &mMaterialUpdateTemplate) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create material descriptor update template");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Maps every shader binary that BuildGraphicsPipeline(...) might want (which fragment
+        shader it wants isn't known until the device is) so that opening the files happens
+        while the device is being created.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void LoadShaderBinaries() {
+        if (mOptions.hotReload) {
+            CompileShaderSources();
+        }
+
+        const std::vector<std::string> filePaths{
+            "shaders/vert.spv",
+            "shaders/frag.spv",
+            "shaders/frag_bindless.spv",
+            "shaders/depth_prepass_vert.spv",
+            "shaders/hiz_build_comp.spv",
+            "shaders/cluster_cull_comp.spv",
+            "shaders/spd_downsample_comp.spv",
+        };
+        for (const auto &filePath : filePaths) {
+            // a missing one is only an error if it turns out to be needed (see 
+            // ShaderModuleCache::Get(...))
+            mShaderModules.Preload(filePath);
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Which GLSL file each SPIR-V file is compiled from (see shaders/compile_shaders.cmd).
+
+        Note: The compute shaders are compiled at startup like the rest, but their pipelines
+        aren't managed by the PipelineManager, so edits to them only take effect on restart.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static const std::vector<std::pair<std::string, std::string>> &GetShaderSources() {
+        static const std::vector<std::pair<std::string, std::string>> sources{
+            { "shaders/vert.spv", "shaders/triangle.vert" },
+            { "shaders/frag.spv", "shaders/triangle.frag" },
+            { "shaders/frag_bindless.spv", "shaders/triangle_bindless.frag" },
+            { "shaders/depth_prepass_vert.spv", "shaders/depth_prepass.vert" },
+            { "shaders/hiz_build_comp.spv", "shaders/hiz_build.comp" },
+            { "shaders/cluster_cull_comp.spv", "shaders/cluster_cull.comp" },
+            { "shaders/spd_downsample_comp.spv", "shaders/spd_downsample.comp" },
+        };
+        return sources;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Hot reload startup: compiles every shader from its GLSL (mostly cache hits after the
+        first run) and starts watching the GLSL files. A shader that doesn't compile falls back
+        on its prebuilt .spv file.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CompileShaderSources() {
+        mShaderCompiler.Init(mOptions.shaderCacheDirectory);
+        std::vector<std::string> sourcePaths;
+        for (const auto &entry : GetShaderSources()) {
+            std::vector<uint32_t> spirv;
+            std::string error;
+            if (mShaderCompiler.Compile(entry.second, spirv, error)) {
+                mShaderModules.SetSpirv(entry.first, std::move(spirv));
+            }
+            else {
+                std::cout << "Shader '" << entry.second << "' failed to compile; using '" << entry.first << "':" << std::endl << error << std::endl;
+            }
+            sourcePaths.push_back(entry.second);
+        }
+        mShaderWatcher.Start(sourcePaths);
+        std::cout << "Shader hot reload: " << ShaderCompiler::GetCompilerName() << ", watching with " << (mShaderWatcher.IsUsingInotify() ? "inotify" : "polling") << std::endl;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Called once per frame by the render thread. Edited GLSL files are recompiled on the
+        shader compiler's thread, and when that finishes, every pipeline that uses the shader
+        is rebuilt on the pipeline manager's threads. Rendering carries on with the old
+        pipelines the whole time, and the old ones are destroyed once the GPU is done with them.
+
+        A shader that fails to compile is reported and otherwise ignored, so a typo doesn't
+        take the app down.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void ReloadChangedShaders() {
+        if (!mOptions.hotReload) {
+            return;
+        }
+
+        for (const auto &sourcePath : mShaderWatcher.Poll()) {
+            std::cout << "Shader '" << sourcePath << "' changed; recompiling" << std::endl;
+            mShaderCompiler.CompileAsync(sourcePath);
+        }
+
+        for (auto &result : mShaderCompiler.TakeFinished()) {
+            if (result.spirv.empty()) {
+                std::cout << "Shader '" << result.sourcePath << "' failed to compile; keeping the old one:" << std::endl << result.error << std::endl;
+                continue;
+            }
+
+            // Note: The watcher normalizes paths (ex: backslashes on Windows), so compare likewise.
+            std::filesystem::path changedPath = std::filesystem::path(result.sourcePath).lexically_normal();
+            for (const auto &entry : GetShaderSources()) {
+                if (std::filesystem::path(entry.second).lexically_normal() != changedPath) {
+                    continue;
+                }
+                if (!mShaderModules.SetSpirv(entry.first, std::move(result.spirv))) {
+                    // ex: only a comment changed
+                    std::cout << "Shader '" << result.sourcePath << "' compiled to the same code; nothing to rebuild" << std::endl;
+                    break;
+                }
+                size_t numPipelines = mPipelineManager.Rebuild(entry.first);
+                std::cout << "Shader '" << result.sourcePath << "' reloaded; rebuilding " << numPipelines << (numPipelines == 1 ? " pipeline" : " pipelines") << std::endl;
+                break;
+            }
+        }
+
+        for (VkPipeline pipeline : mPipelineManager.TakeReplaced()) {
+            DeferDestruction([this, pipeline]() {
+                vkDestroyPipeline(mLogicalDevice, pipeline, nullptr);
+            });
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Governs the creation of all stages of the graphics pipeline.
+
+        Note: This builds whatever pipeline the description asks for, and may be called on a
+        background compile thread (see PipelineManager), so it only reads things that stay put
+        while pipelines are in use.
+
+        Some stages are fixed, and others are programmable.
+        - The "fixed" stages can be configured with a set number of options from the SDK.
+        - The "programmable" stages can be set up with a shader or be skipped entirely.
+
+        From the tutorial:
+        - The input assembler collects the raw vertex data from the buffers you specify and may
+            also use an index buffer to repeat certain elements without having to duplicate the
+            vertex data itself. This stage is FIXED.
+        - The vertex shader is run for every vertex and generally applies transformations to turn
+            vertex positions from model space to screen space. It also passes per-vertex data down
+            the pipeline. This stage is PROGRAMMABLE.
+        - The tessellation shaders allow you to subdivide geometry based on certain rules to
+            increase the mesh quality. This is often used to make surfaces like brick walls and
+            staircases look less flat when they are nearby. This stage is PROGRAMMABLE.
+        - The geometry shader is run on every primitive (triangle, line, point) and can discard it
+            or output more primitives than came in. This is similar to the tessellation shader,
+            but much more flexible. However, it is not used much in today's applications because
+            the performance is not that good on most graphics cards except for Intel's integrated
+            GPUs. This stage is PROGRAMMABLE.
+        - The rasterization stage discretizes the primitives into fragments. These are the pixel
+            elements that they fill on the framebuffer. Any fragments that fall outside the screen
+            are discarded and the attributes outputted by the vertex shader are interpolated
+            across the fragments, as shown in the figure. Usually the fragments that are behind
+            other primitive fragments are also discarded here because of depth testing. This stage
+            is FIXED.
+        - The fragment shader is invoked for every fragment that survives and determines which
+            framebuffer(s) the fragments are written to and with which color and depth values. It
+            can do this using the interpolated data from the vertex shader, which can include
+            things like texture coordinates and normals for lighting. This stage is PROGRAMMABLE.
+        - The color blending stage applies operations to mix different fragments that map to the
+            same pixel in the framebuffer. Fragments can simply overwrite each other, add up or be
+            mixed based upon transparency. This stage is FIXED (??is it configurable??)
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    VkPipeline BuildGraphicsPipeline(const PipelineDescription &description, VkPipelineCache pipelineCache) {
+        // the names in the description are what keep it valid from one run to the next (see 
+        // PipelineDescription); these are the only ones there are so far
+        // Note: The render pass names are really "which subpass, and how to test depth there". 
+        // With a depth pre-pass, the main subpass is subpass 1 (see 
+        // CreateColorDepthRenderPass(...)).
+        if (description.vertexLayout != "Vertex" && description.vertexLayout != "Position") {
+            throw std::runtime_error("unknown vertex layout '" + description.vertexLayout + "'");
+        }
+        bool depthOnly = false;
+        bool afterPrepass = false;
+        if (description.renderPass == "depth-prepass" || description.renderPass == "main-after-prepass") {
+            if (!mDepthPrepassEnabled) {
+                throw std::runtime_error("render pass '" + description.renderPass + "' needs a depth pre-pass");
+            }
+            depthOnly = (description.renderPass == "depth-prepass");
+            afterPrepass = !depthOnly;
+        }
+        else if (description.renderPass != "main") {
+            throw std::runtime_error("unknown render pass '" + description.renderPass + "'");
+        }
+        uint32_t subpassIndex = (mDepthPrepassEnabled && !depthOnly) ? 1 : 0;
+
+        // specialization constants are baked in when the pipeline is compiled, which is what 
+        // makes them cheaper than uniforms, and also what makes each combination a separate 
+        // pipeline
+        // Note: Both stages get the same constants. A constant that a stage doesn't declare is 
+        // ignored.
+        std::vector<VkSpecializationMapEntry> specializationEntries;
+        std::vector<uint32_t> specializationData;
+        for (const auto &constant : description.specializationConstants) {
+            VkSpecializationMapEntry entry{};
+            entry.constantID = constant.first;
+            entry.offset = static_cast<uint32_t>(specializationData.size() * sizeof(uint32_t));
+            entry.size = sizeof(uint32_t);
+            specializationEntries.push_back(entry);
+            specializationData.push_back(constant.second);
+        }
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+        specializationInfo.pMapEntries = specializationEntries.data();
+        specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+        specializationInfo.pData = specializationData.data();
+        const VkSpecializationInfo *pSpecializationInfo = specializationEntries.empty() ? nullptr : &specializationInfo;
+
+        // Note: The modules are owned by the cache and shared between pipelines. They are only 
+        // needed while the pipeline is being created, but keeping them around means that 
+        // rebuilding a pipeline doesn't have to create them all over again.
+        // Also Note: Depth-only pipelines may have no fragment shader at all.
+        VkShaderModule vertShaderModule = mShaderModules.Get(description.vertexShader);
+        bool hasFragmentStage = (description.fragmentShader != "none");
+
+        std::vector<VkPipelineShaderStageCreateInfo> shaderStageCreateInfos;
+        {
+            VkPipelineShaderStageCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            createInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+            createInfo.module = vertShaderModule;
+            createInfo.pName = "main";
+            createInfo.pSpecializationInfo = pSpecializationInfo;
+            shaderStageCreateInfos.push_back(createInfo);
+        }
+        if (hasFragmentStage) {
+            VkPipelineShaderStageCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            createInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            createInfo.module = mShaderModules.Get(description.fragmentShader);
+            createInfo.pName = "main";
+            createInfo.pSpecializationInfo = pSpecializationInfo;
+            shaderStageCreateInfos.push_back(createInfo);
+        }
+
+        auto bindingDescription = Vertex::GetBindingDescription();
+        auto attributeDescription = Vertex::GetAttributeDescription();
+        VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
+        vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
+        vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
+        vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescription.data();
+
+        // "Position" is the depth pre-pass' stream: only the positions, tightly packed (see 
+        // CreatePositionBuffer()), in the same binding and location as Vertex's
+        if (description.vertexLayout == "Position") {
+            bindingDescription.stride = sizeof(glm::vec3);
+            vertexInputCreateInfo.vertexAttributeDescriptionCount = 1;
+            attributeDescription.at(0).offset = 0;
+        }
+
+        // the Input Assembly State's "topology" is like OpenGL's "draw style" (GL_LINES, 
+        // GL_TRIANGLES, etc.)
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+        inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+        // Note: Vulkan's Y values are like everyone else now, with (0,0) in the upper left. This 
+        // is unlike OpenGL, which had (0,0) in the lower left.
+        // Note: The viewport and scissor are dynamic state, set in the command buffer (see 
+        // RecordCommandBuffer(...)), so that the pipeline doesn't depend on the window size and 
+        // doesn't need to be rebuilt when the window is resized. Only the counts are baked in.
+        // Also Note: There may be cases in which multiple viewports are desired, such as a 
+        // flight simulated with a viewport for each instrument, though there are likely more 
+        // efficient ways to handle that through textures. Still, multiple viewports could be a 
+        // nice thing in the toolbag, even if we're not going to be using them.
+        VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+        viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportStateCreateInfo.viewportCount = 1;
+        viewportStateCreateInfo.pViewports = nullptr;
+        viewportStateCreateInfo.scissorCount = 1;
+        viewportStateCreateInfo.pScissors = nullptr;
+
+        std::array<VkDynamicState, 2> dynamicStates{
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR,
+        };
+        VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+        dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
+
+        // "The rasterizer takes the geometry that is shaped by the vertices from the vertex 
+        // shader and turns it into fragments to be colored by the fragment shader. It also 
+        // performs depth testing, face culling and the scissor test, and it can be configured to 
+        // output fragments that fill entire polygons or just the edges (wireframe rendering)."
+        // Note: If depth clamping is enabled, fragments beyond near/far planes are discarded. 
+        // Disabling depth clamping could be useful if we want a render stage that considers all 
+        // depth values.
+        VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo{};
+        rasterizerCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizerCreateInfo.depthClampEnable = VK_FALSE; //??why are we using false??
+        rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE; // definitely want rasterization
+        rasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;    // or LINE or POINT
+        rasterizerCreateInfo.lineWidth = 1.0f;  //>1.0f requires enabling "wideLines" GPU feature
+        rasterizerCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+
+        // changed from `CLOCKWISE` because the GLM project matrix had to have its Y axis flipped 
+        // to bring it in line with Vulkan's NDCs
+        rasterizerCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        //rasterizerCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        rasterizerCreateInfo.depthBiasEnable = VK_FALSE;    //??what is "depth bias"??
+
+        // multisampling is an antialiasing technique that combines fragment shader results of 
+        // multiple polygons that rasterize to the same pixel, but we won't be using this at this 
+        // time (11/24/2018)
+        // Note: Enabling this requires enabling a GPU feature (??which one??)
+        VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo{};
+        multisamplingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisamplingCreateInfo.sampleShadingEnable = VK_FALSE; //VK_TRUE;
+        multisamplingCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        // color blending requires two structures: (1) the "blending attachment state" is per 
+        // framebuffer (we only have one) and (2) the "blend state create info", which contains 
+        // global color blending settings
+        // Note: Color blending often used in conjunction with alpha values.
+        // Ex: .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; //(1-srcAlpha)
+        // Pseudocode:
+        //    if (blendEnable) {
+        //        finalColor.rgb = (srcColorBlendFactor * newColor.rgb) < colorBlendOp > (dstColorBlendFactor * oldColor.rgb);
+        //        finalColor.a = (srcAlphaBlendFactor * newColor.a) < alphaBlendOp > (dstAlphaBlendFactor * oldColor.a);
+        //    }
+        //    else {
+        //        finalColor = newColor;
+        //    }
+        //    finalColor = finalColor & colorWriteMask;
+        VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
+        colorBlendAttachmentState.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT |
+            VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachmentState.blendEnable = VK_FALSE;
+        //colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;    //??
+        //colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;   //??
+        //colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;               //??
+        //colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;    //??
+        //colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;   //??
+        //colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;               //??
+
+        VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo{};
+        colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlendCreateInfo.logicOpEnable = VK_FALSE;
+        colorBlendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+        colorBlendCreateInfo.attachmentCount = depthOnly ? 0 : 1;   // only one framebuffer (and none in the depth pre-pass)
+        colorBlendCreateInfo.pAttachments = &colorBlendAttachmentState;
+
+        //??does this 4-item array follow the RGBA order? and what does it do??
+        colorBlendCreateInfo.blendConstants[0] = 0.0f;
+        colorBlendCreateInfo.blendConstants[1] = 0.0f;
+        colorBlendCreateInfo.blendConstants[2] = 0.0f;
+        colorBlendCreateInfo.blendConstants[3] = 0.0f;
+
+        // need to tell the pipeline to use depth testing
+        // Note: Depth testing says to compare depth of a new fragment with the existing depth in 
+        // the buffer for that pixel. Depth writing means to write the new depth if the new 
+        // fragment is closer to the screen (could be altered by the "compare op", but let's not 
+        // mess with normality). The former we always want (unless we are doing something very 
+        // odd), but we don't want the latter if we are drawing a transparent object. It would 
+        // require another pipeline (all these things get baked into the pipeline, so even minor 
+        // changes require another pipeline) to perform depth writing for previously compared 
+        // fragments for opaque objects, but if the current pipeline is trying to draw transparent 
+        // objects, then we *don't* want to write new depth tests. Right now (1/20/2019) though, 
+        // for this tutorial, we do.
+        VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo{};
+        depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        // Also Note: After a depth pre-pass, the depth buffer already holds the nearest surface 
+        // at every pixel, so only fragments at exactly that depth are shaded (and there is 
+        // nothing left to write). That is only exact because both vertex shaders compute the 
+        // position the same way ("invariant gl_Position").
+        depthStencilCreateInfo.depthTestEnable = VK_TRUE;
+        depthStencilCreateInfo.depthWriteEnable = afterPrepass ? VK_FALSE : VK_TRUE;
+        // And Also Note: With reversed-Z, nearer is a *larger* depth (see MakeProjection(...)).
+        depthStencilCreateInfo.depthCompareOp = afterPrepass ? VK_COMPARE_OP_EQUAL : (mOptions.reversedZ ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS);
+        depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;    //??what??
+        depthStencilCreateInfo.stencilTestEnable = VK_FALSE;        //??what is this??
+
+        VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStageCreateInfos.size());
+        pipelineCreateInfo.pStages = shaderStageCreateInfos.data();
+        pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+        pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+        pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+        pipelineCreateInfo.pRasterizationState = &rasterizerCreateInfo;
+        pipelineCreateInfo.pMultisampleState = &multisamplingCreateInfo;
+        pipelineCreateInfo.pColorBlendState = &colorBlendCreateInfo;
+        pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+        pipelineCreateInfo.layout = mPipelineLayout;
+        pipelineCreateInfo.renderPass = mRenderPass;
+        pipelineCreateInfo.subpass = subpassIndex; // index of the subpass in the given render pass where this pipeline will be used (??what??)
+        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // not deriving from existing pipeline
+        pipelineCreateInfo.pDepthStencilState = &depthStencilCreateInfo;
+
+        // Note: With a warm cache (see PipelineCacheFile), the driver can skip compiling the 
+        // shaders and this is much faster.
+        uint32_t pipelineCreateInfoCount = 1;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(mLogicalDevice, pipelineCache, pipelineCreateInfoCount, &pipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create graphics pipeline");
+        }
+        return pipeline;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The pipeline layout describes all the descriptor sets and push constants that the
+        shaders can see. Every pipeline variant shares it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreatePipelineLayout() {
+        // Note: The order of the set layouts is the "set = N" index in the shaders.
+        std::array<VkDescriptorSetLayout, 2> setLayouts{
+            mPerFrameDescriptorSetLayout,   // set 0; MUST have been created prior to this
+            mUseBindlessTextures ? mBindlessDescriptorSetLayout : mMaterialDescriptorSetLayout, // set 1
+        };
+
+        // the per-object model transform (and material ID) is pushed straight into the command 
+        // buffer
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstantObject);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(mLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &mPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Starts the background compile threads (see PipelineManager). A couple is plenty; the
+        point is keeping compiles off of the render thread, not finishing them all at once.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void StartPipelineManager() {
+        uint32_t numThreads = std::min(std::max(std::thread::hardware_concurrency() / 4, 1u), 2u);
+        mPipelineManager.Init(mLogicalDevice, numThreads,
+            [this](const PipelineDescription &description, VkPipelineCache pipelineCache) {
+                return BuildGraphicsPipeline(description, pipelineCache);
+            },
+            [this]() {
+                return mPipelineCache.CreateThreadCache();
+            });
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Compiles the main pipeline right here, since nothing can be drawn without it, and makes
+        it the fallback for every variant that is still compiling in the background.
+
+        Note: The layout only depends on the descriptor set layouts, so it outlives any pipeline 
+        rebuilds (ex: the swap chain format changed).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateGraphicsPipeline() {
+        if (mPipelineLayout == VK_NULL_HANDLE) {
+            CreatePipelineLayout();
+        }
+
+        // Note: Every feature variant (see GetPipelineVariant(...)) is this with a different 
+        // feature mask (and maybe a different draw stage).
+        mMainPipelineDescription = PipelineDescription{};
+        mMainPipelineDescription.vertexShader = "shaders/vert.spv";
+        mMainPipelineDescription.fragmentShader = mUseBindlessTextures ? "shaders/frag_bindless.spv" : "shaders/frag.spv";
+        mMainPipelineDescription.renderPass = mDepthPrepassEnabled ? "main-after-prepass" : "main";
+        mMainPipelineDescription.specializationConstants = { { SHADER_FEATURE_MASK_CONSTANT_ID, mOptions.shaderFeatures } };
+
+        // the time is kept for comparing cold and warm pipeline cache runs
+        auto createStartTime = std::chrono::high_resolution_clock::now();
+        mMainPipelineKey = mPipelineManager.AddSynchronously(mMainPipelineDescription, mPipelineCache.Get());
+        mPipelineCreateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - createStartTime).count();
+        mPipelineManager.SetFallback(mMainPipelineKey);
+
+        // the main pipeline can't stand in for a depth pre-pass one (different subpass), so the 
+        // plain pre-pass is compiled up front too
+        if (mDepthPrepassEnabled) {
+            mPrepassPipelineKey = mPipelineManager.AddSynchronously(GetPipelineDescription(0, DrawStage::DEPTH_PREPASS), mPipelineCache.Get());
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        What to build for the given shader features in the given draw stage.
+
+        Note: The depth pre-pass only needs to run the fragment shader if the fragment shader
+        can throw fragments away (alpha test); otherwise it reads positions only and has no
+        fragment shader at all, and every feature mask shares that one pipeline.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    PipelineDescription GetPipelineDescription(uint32_t features, DrawStage stage) const {
+        PipelineDescription description = mMainPipelineDescription;
+        description.specializationConstants = { { SHADER_FEATURE_MASK_CONSTANT_ID, features } };
+        if (stage == DrawStage::MAIN) {
+            description.renderPass = "main";
+        }
+        else if (stage == DrawStage::MAIN_AFTER_PREPASS) {
+            description.renderPass = "main-after-prepass";
+        }
+        else {
+            description.renderPass = "depth-prepass";
+            if ((features & SHADER_FEATURE_ALPHA_TEST) == 0) {
+                description.vertexShader = "shaders/depth_prepass_vert.spv";
+                description.fragmentShader = "none";
+                description.vertexLayout = "Position";
+                description.specializationConstants.clear();
+            }
+        }
+        return description;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Which stage the main draw is in this frame. Only EQUAL if the pre-pass is drawn.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    DrawStage GetMainDrawStage() const {
+        return (mDepthPrepassEnabled && mDrawPrepass) ? DrawStage::MAIN_AFTER_PREPASS : DrawStage::MAIN;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The key of the main pipeline specialized for the given shader features (see
+        ShaderFeature) and draw stage. The first request for a combination queues its compile
+        (see PipelineManager); the lookups after that are a hash map hit.
+
+        Note: Render thread only.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint64_t GetPipelineVariant(uint32_t features, DrawStage stage) {
+        uint64_t lookupKey = (static_cast<uint64_t>(stage) << 32) | features;
+        auto itr = mFeatureVariantKeys.find(lookupKey);
+        if (itr != mFeatureVariantKeys.end()) {
+            return itr->second;
+        }
+
+        uint64_t key = mPipelineManager.Request(GetPipelineDescription(features, stage));
+        mFeatureVariantKeys[lookupKey] = key;
+        return key;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        For benchmarks: queues and waits for every pipeline that a frame with these features
+        will draw with (the main one, and the pre-pass one if the pre-pass is drawn). Returns
+        false if any of them failed.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool WaitForDrawPipelines(uint32_t features) {
+        bool compiled = mPipelineManager.WaitUntilCompiled(GetPipelineVariant(features, GetMainDrawStage()));
+        if (mDepthPrepassEnabled && mDrawPrepass) {
+            compiled = mPipelineManager.WaitUntilCompiled(GetPipelineVariant(features, DrawStage::DEPTH_PREPASS)) && compiled;
+        }
+        return compiled;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Compute pipelines don't depend on the render pass or the vertex layout, and there are
+        only a couple, so they are built right here instead of going through the
+        PipelineManager.
+
+        Note: Specialization constant 0, if given, is a uint or a bool (ex: spd_downsample.comp's
+        REDUCE_MODE, cluster_cull.comp's REVERSED_Z). A bool is 4 bytes too (VkBool32).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkPipeline CreateComputePipeline(const std::string &shaderPath, VkPipelineLayout pipelineLayout, std::optional<uint32_t> specializationConstant = std::nullopt) {
+        VkSpecializationMapEntry specializationEntry{};
+        specializationEntry.constantID = 0;
+        specializationEntry.offset = 0;
+        specializationEntry.size = sizeof(uint32_t);
+        uint32_t specializationValue = specializationConstant.value_or(0);
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = 1;
+        specializationInfo.pMapEntries = &specializationEntry;
+        specializationInfo.dataSize = sizeof(specializationValue);
+        specializationInfo.pData = &specializationValue;
+
+        VkComputePipelineCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        createInfo.stage.module = mShaderModules.Get(shaderPath);
+        createInfo.stage.pName = "main";
+        createInfo.stage.pSpecializationInfo = specializationConstant.has_value() ? &specializationInfo : nullptr;
+        createInfo.layout = pipelineLayout;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateComputePipelines(mLogicalDevice, mPipelineCache.Get(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute pipeline for '" + shaderPath + "'");
+        }
+        return pipeline;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Layouts and pipelines for cluster culling, the Hi-Z build, and the downsampler, if
+        they're enabled (see CreateLogicalDevice()). Their descriptor sets are thrown away every
+        frame, so they come from the frame contexts' descriptor allocators.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateComputePipelines() {
+        // "counts" => an array at that binding; 1 each if left out
+        auto createSetLayout = [this](const std::vector<VkDescriptorType> &types, const std::vector<uint32_t> &counts = {}) {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            for (uint32_t i = 0; i < types.size(); i++) {
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = i;
+                binding.descriptorType = types[i];
+                binding.descriptorCount = (i < counts.size()) ? counts[i] : 1;
+                binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                bindings.push_back(binding);
+            }
+            VkDescriptorSetLayoutCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            createInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+            createInfo.pBindings = bindings.data();
+            return mDescriptorLayoutCache.CreateDescriptorSetLayout(createInfo);
+        };
+        auto createPipelineLayout = [this](VkDescriptorSetLayout setLayout, uint32_t pushConstantSize) {
+            VkPushConstantRange pushConstantRange{};
+            pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            pushConstantRange.offset = 0;
+            pushConstantRange.size = pushConstantSize;
+
+            VkPipelineLayoutCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            createInfo.setLayoutCount = 1;
+            createInfo.pSetLayouts = &setLayout;
+            createInfo.pushConstantRangeCount = 1;
+            createInfo.pPushConstantRanges = &pushConstantRange;
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            if (vkCreatePipelineLayout(mLogicalDevice, &createInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compute pipeline layout");
+            }
+            return pipelineLayout;
+        };
+
+        // the Hi-Z keeps the farthest depth, which is the smallest with reversed-Z
+        uint32_t reversedZ = mOptions.reversedZ ? VK_TRUE : VK_FALSE;
+        if (mClusterCullingEnabled) {
+            // per-frame uniforms, clusters, draw commands, Hi-Z, instances
+            mClusterCullSetLayout = createSetLayout({
+                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            });
+            mClusterCullPipelineLayout = createPipelineLayout(mClusterCullSetLayout, sizeof(ClusterCullPushConstants));
+            mClusterCullPipeline = CreateComputePipeline("shaders/cluster_cull_comp.spv", mClusterCullPipelineLayout, reversedZ);
+        }
+        if (mHiZEnabled && !mDownsampleEnabled) {
+            // the level above (or the depth buffer), the level being written
+            mHiZBuildSetLayout = createSetLayout({
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            });
+            mHiZBuildPipelineLayout = createPipelineLayout(mHiZBuildSetLayout, sizeof(HiZBuildPushConstants));
+            mHiZBuildPipeline = CreateComputePipeline("shaders/hiz_build_comp.spv", mHiZBuildPipelineLayout, reversedZ);
+        }
+        if (mDownsampleEnabled) {
+            // the source level, every level being written, the counter
+            mDownsampleSetLayout = createSetLayout({
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            }, { 1, DOWNSAMPLE_MAX_MIPS, 1 });
+            mDownsamplePipelineLayout = createPipelineLayout(mDownsampleSetLayout, sizeof(DownsamplePushConstants));
+            uint32_t reduceAverage = 0;
+            uint32_t reduceFarthest = mOptions.reversedZ ? 2 : 1;   // REDUCE_MIN : REDUCE_MAX
+            mDownsampleColorPipeline = CreateComputePipeline("shaders/spd_downsample_comp.spv", mDownsamplePipelineLayout, reduceAverage);
+            if (mHiZEnabled) {
+                mDownsampleDepthPipeline = CreateComputePipeline("shaders/spd_downsample_comp.spv", mDownsamplePipelineLayout, reduceFarthest);
+            }
+            CreateDownsampleResources();
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The downsampler's sampler (for the source level; it is only ever read with texelFetch,
+        so no filtering) and its "finished workgroups" counters, which start at 0.
+
+        Note: The counters are host visible so that they can be zeroed without a command
+        buffer. They are a single uint each, so where they live doesn't matter.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDownsampleResources() {
+        VkSamplerCreateInfo samplerCreateInfo{};
+        samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+        samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+        samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(mLogicalDevice, &samplerCreateInfo, nullptr, &mDownsampleSampler) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create downsample sampler");
+        }
+
+        auto createCounter = [this](VkBuffer &buffer, VkDeviceMemory &memory) {
+            VkDeviceSize size = sizeof(uint32_t);
+            CreateBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+            void *data = nullptr;
+            vkMapMemory(mLogicalDevice, memory, 0, size, 0, &data);
+            memset(data, 0, static_cast<size_t>(size));
+            vkUnmapMemory(mLogicalDevice, memory);
+        };
+        createCounter(mFrameDownsampleCounter, mFrameDownsampleCounterMemory);
+        createCounter(mUploadDownsampleCounter, mUploadDownsampleCounterMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Generates a framebuffer object for each image in the swap chain.
+        ??how is the image in the swap chain different from the framebuffer for it??
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateFramebuffers() {
+        mSwapChainFramebuffers.resize(mSwapChainImageViews.size());
+        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
+            std::array<VkImageView, 2> attachments{
+                mSwapChainImageViews.at(i),
+
+                // Note: The drawing waits for all items in the Color Attachment pipeline stage to 
+                // finish before moving on, so our semaphores may be unnecessary with this 
+                // particular design (??you sure??), and as a side effect we can use the same 
+                // depth image view for every frame instead of having to do one depth image for 
+                // each frame. Personally, I think that this is flimsly justification to avoid 
+                // creating extra images. I want a better explanation (??but how do I get one??)
+                // Also Note: Headless gives every offscreen target its own depth image.
+                mOptions.headless ? mOffscreenTargets.at(i).depthImageView : mDepthImageView,
+            };
+            VkFramebufferCreateInfo frameBufferCreateInfo{};
+            frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            frameBufferCreateInfo.renderPass = mRenderPass;
+            frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            frameBufferCreateInfo.pAttachments = attachments.data();
+            frameBufferCreateInfo.width = mSwapChainExtent.width;
+            frameBufferCreateInfo.height = mSwapChainExtent.height;
+            frameBufferCreateInfo.layers = 1;
+
+            if (vkCreateFramebuffer(mLogicalDevice, &frameBufferCreateInfo, nullptr, &mSwapChainFramebuffers.at(i)) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create framebuffer");
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Generates the command pool object that will store the command buffers. Command pools
+        manage the memory that is used to store the buffers, and command buffers are allocated
+        from them.
+
+        Note: Each command pool can only allocate command buffers for a single type of queue.
+        This means that there cannot exist a command buffer that contains both compute and
+        graphics commands. Why? The API spec for Mantle (forerunner to Vulkan) describes the
+        "Queue submission model" in the section "Execution Model" as different CPU threads
+        submitting commands to different queues (graphics queue, compute queue), which are in turn
+        submitted to the GPU's "3D Engine" and "Compute Engine", respectively. Vulkan's queue
+        family indices are looked up with the VkPhysicalDevice, and combine this with the Mantle
+        API descriptions, and it seems that the command queues, and thus the command queue
+        families, are a software design model that accomodate's the GPU hardware design that
+        implements separate graphics and compute "engines" (??what are these??)
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateCommandPool() {
+        QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(mPhysicalDevice);
+        VkCommandPoolCreateInfo commandPoolCreateInfo{};
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+        if (vkCreateCommandPool(mLogicalDevice, &commandPoolCreateInfo, nullptr, &mCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create command pool");
+        }
+
+        // the async compute queue's command buffers have to come from a pool of its own family
+        if (mAsyncComputeEnabled) {
+            commandPoolCreateInfo.queueFamilyIndex = mComputeQueueFamily;
+            if (vkCreateCommandPool(mLogicalDevice, &commandPoolCreateInfo, nullptr, &mComputeCommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compute command pool");
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Takes a buffer of data on the GPU and copies it into another chunk of memory that is
+        reserved for use by a particular image. This is how we get texture data into an image for
+        use as a sampler.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CopyBufferToImage(VkBuffer buffer, VkImage image, VkImageLayout memLayout, uint32_t width, uint32_t height) {
+        // need to specify which parts of the buffer will be copied to this image
+        VkBufferImageCopy region{};
+
+        // offset where pixels start
+        region.bufferOffset = 0;
+
+        // 0 for both indicates close packing (that is, no padding between rows)
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+
+        // indicates the parts of the image that we want to copy
+        // Note: If we really wanted to, this allows us to copy one particular mipmap level.
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0,0,0 };
+        region.imageExtent = { width,height,1 };
+
+
+        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+        vkCmdCopyBufferToImage(commandBuffer, buffer, image, memLayout, 1, &region);
+        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Changes the usage of an image (all mip levels) outside of the frame, ex: a texture from
+        nothing to being a copy destination. The barrier comes from the two usages' entries in
+        GetResourceUsageInfo(...), so any pair of usages works; there is no list of "supported"
+        transitions to keep up to date.
+
+        Note: Going from ResourceUsage::NONE (VK_IMAGE_LAYOUT_UNDEFINED) lets the implementation
+        throw the contents away. That's fine for a brand new image, but an image that already
+        has something in it (ex: the JPEG's pixels after the copy) has to say what it was last
+        used for so that the contents are kept.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void TransitionImageLayout(VkImage image, VkFormat format, ResourceUsage currentUsage, ResourceUsage newUsage, uint32_t mipLevels) {
+        VkImageSubresourceRange range{};
+        range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        if (newUsage == ResourceUsage::DEPTH_ATTACHMENT) {
+            range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            if (HasStencilComponent(format)) {
+                range.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
+        }
+        range.baseMipLevel = 0;
+        range.levelCount = mipLevels;
+        range.baseArrayLayer = 0;       // not an array right now (1/1/2019)
+        range.layerCount = 1;
+
+        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+        RecordImageBarrier(commandBuffer, image, range, currentUsage, newUsage);
+        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates an image that is not part of the swap chain.
+
+        Note: When creating the swap chain, image extent was specified and applied to every image
+        that it created. We are now creating a standalone image that is the size of the texture.
+        If we have lots of textures, then we will have lots of standalone images, and many will
+        not share the same extent. Thus we need to specify the extent for each and every texture
+        image.
+
+
+        TODO: split into two functions, one that creates a VkImage, the other which allocates VkDeviceMemory, or better yet, a class that does this for you and that handles cleanup
+
+
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags memProperties, VkImage &image, VkDeviceMemory &imageMemory, bool *pLazilyAllocated = nullptr) {
+        VkImageCreateInfo imageCreateInfo{};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.extent.width = static_cast<uint32_t>(width);
+        imageCreateInfo.extent.height = static_cast<uint32_t>(height);
+        imageCreateInfo.extent.depth = 1;   //??what happens at 0??
+        imageCreateInfo.mipLevels = mipLevels;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.format = format;
+        imageCreateInfo.tiling = tiling;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageCreateInfo.usage = usage;
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        if (vkCreateImage(mLogicalDevice, &imageCreateInfo, nullptr, &image) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create image for texture");
+        }
+
+        // now allocate memory for the image
+        VkMemoryRequirements memRequirements{};
+        vkGetImageMemoryRequirements(mLogicalDevice, image, &memRequirements);
+
+        // lazily allocated memory is a request; without it, the image gets ordinary memory
+        if ((memProperties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) && !HasMemoryType(memRequirements.memoryTypeBits, memProperties)) {
+            memProperties &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        }
+        if (pLazilyAllocated != nullptr) {
+            *pLazilyAllocated = (memProperties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+        }
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, memProperties);
+        if (vkAllocateMemory(mLogicalDevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate image memory");
+        }
+        mNumDeviceAllocations++;
+        mTotalDeviceAllocationBytes += allocInfo.allocationSize;
+
+        VkDeviceSize offset = 0;
+        vkBindImageMemory(mLogicalDevice, image, imageMemory, offset);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        ??what??
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    VkFormat FindSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
+        for (const VkFormat &format : candidates) {
+            VkFormatProperties props{};
+            vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &props);
+
+            if (tiling == VK_IMAGE_TILING_LINEAR &&
+                (props.linearTilingFeatures & features) == features) {
+                return format;
+            }
+            else if (tiling == VK_IMAGE_TILING_OPTIMAL &&
+                (props.optimalTilingFeatures & features) == features) {
+                return format;
+            }
+        }
+
+        throw std::runtime_error("failed to find supported format");    //??wat??
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        ??again, what??
+
+        Note: Nothing uses the stencil, so the formats with one are a last resort. Depth-only
+        formats are smaller (D32_SFLOAT_S8_UINT is often 8 bytes per pixel) and skip the
+        stencil's part of every clear and load/store.
+
+        Also Note: D32_SFLOAT is preferred because reversed-Z (see MakeProjection(...)) only
+        pays off with a float depth buffer. A scene with a short enough depth range can ask for
+        something cheaper with "--depth-format" (see RunDepthPrecisionTest(...)).
+
+        And Also Note: With Hi-Z culling asked for, the depth buffer is also sampled by the Hi-Z
+        build, and sampling isn't guaranteed for every depth format (X8_D24 in particular), so
+        a format that can be sampled wins over one that can't. If the only one left can't be (or
+        "--depth-format" asked for one that can't), the Hi-Z is turned off and culling goes
+        frustum only (see CanSampleDepthFormat()).
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    VkFormat FindDepthFormat() {
+        if (mOptions.depthFormat.has_value()) {
+            VkFormatProperties props{};
+            vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, mOptions.depthFormat.value(), &props);
+            if ((props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) == 0) {
+                throw std::runtime_error("depth format '" + DepthFormatToString(mOptions.depthFormat.value()) + "' isn't supported by this device");
+            }
+            return mOptions.depthFormat.value();
+        }
+
+        std::vector<VkFormat> candidates{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+        if (mOptions.hiZCulling) {
+            for (VkFormat format : candidates) {
+                VkFormatProperties props{};
+                vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &props);
+                VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+                if ((props.optimalTilingFeatures & features) == features) {
+                    return format;
+                }
+            }
+        }
+        return FindSupportedFormat(candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The Hi-Z pyramid is built by sampling the depth buffer in a compute shader, which not
+        every depth format allows.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool CanSampleDepthFormat() {
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, FindDepthFormat(), &props);
+        return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        ??yet again, what??
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    bool HasStencilComponent(VkFormat format) {
+        return format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
+            format == VK_FORMAT_D24_UNORM_S8_UINT ||
+            format == VK_FORMAT_D16_UNORM_S8_UINT;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Does anything look at the depth after the render pass? Only the Hi-Z build does. If
+        nothing does, it is never written out to memory (see CreateColorDepthRenderPass(...)) and
+        doesn't need real memory behind it (see GetDepthImageUsage()).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool IsDepthReadAfterRenderPass() const {
+        return mHiZEnabled;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Every depth image is an attachment, and is also read by the Hi-Z build if there is one.
+        Otherwise it lives and dies inside the render pass (cleared on load, not stored), which
+        is what VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT says, and which lets it have lazily
+        allocated memory (see GetAttachmentMemoryProperties(...)).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkImageUsageFlags GetDepthImageUsage() const {
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (IsDepthReadAfterRenderPass()) {
+            usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+        else {
+            usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+        return usage;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The memory to ask for for an attachment with the given usage. A transient attachment
+        asks for lazily allocated memory, which on a tiler (or anything else that keeps
+        attachments on chip) is never committed at all. CreateImage(...) falls back to ordinary
+        device-local memory if the device doesn't have any.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkMemoryPropertyFlags GetAttachmentMemoryProperties(VkImageUsageFlags usage) const {
+        VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        if (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+            properties |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        }
+        return properties;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        ??
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDepthResources() {
+        if (mOptions.headless) {
+            // each offscreen target has its own; see CreateOffscreenTargets()
+            return;
+        }
+
+        uint32_t mipLevels = 1;
+        VkFormat depthFormat = FindDepthFormat();
+        VkImageUsageFlags depthUsage = GetDepthImageUsage();
+        CreateImage(mSwapChainExtent.width, mSwapChainExtent.height, mipLevels, depthFormat, VK_IMAGE_TILING_OPTIMAL, depthUsage, GetAttachmentMemoryProperties(depthUsage), mDepthImage, mDepthImageMemory, &mDepthMemoryLazy);
+        mDepthImageView = CreateImageView(mDepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, mipLevels);
+
+        // Note: No layout transition. The frame graph moves it out of 
+        // VK_IMAGE_LAYOUT_UNDEFINED the first time that it is drawn to, so a separate transition 
+        // (and the submit and wait that came with it) only held up swap chain recreation.
+        mDepthImageState = RenderGraph::ResourceState{};
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Dynamic resolution draws the scene into an image of the given format, then blits it
+        (with filtering) into an image of the same format. Not every format can do all of that.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool CanUpscaleFormat(VkFormat format) {
+        VkFormatFeatureFlags required =
+            VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+            VK_FORMAT_FEATURE_BLIT_DST_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &props);
+        return (props.optimalTilingFeatures & required) == required;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Makes sure that the scene framebuffer binds the images that the frame graph handed out
+        for the scene this frame. The graph only makes new ones when the size changes, so this
+        is almost always a comparison and nothing else.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void UpdateSceneFramebuffer(VkImageView colorImageView, VkImageView depthImageView) {
+        if (mSceneTarget.framebuffer != VK_NULL_HANDLE &&
+            mSceneTarget.colorImageView == colorImageView &&
+            mSceneTarget.depthImageView == depthImageView) {
+            return;
+        }
+        RetireSceneTarget();
+        mSceneTarget.colorImageView = colorImageView;
+        mSceneTarget.depthImageView = depthImageView;
+
+        std::array<VkImageView, 2> attachments{ colorImageView, depthImageView };
+        VkFramebufferCreateInfo frameBufferCreateInfo{};
+        frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        frameBufferCreateInfo.renderPass = mRenderPass;
+        frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        frameBufferCreateInfo.pAttachments = attachments.data();
+        frameBufferCreateInfo.width = mSceneTarget.extent.width;
+        frameBufferCreateInfo.height = mSceneTarget.extent.height;
+        frameBufferCreateInfo.layers = 1;
+        if (vkCreateFramebuffer(mLogicalDevice, &frameBufferCreateInfo, nullptr, &mSceneTarget.framebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create scene framebuffer");
+        }
+        mNumSceneTargetAllocations++;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Hands the scene framebuffer over to DeferDestruction(...) (frames in flight may still be
+        drawing with it) and forgets it. The images are the frame graph's, and it retires those
+        itself when they are no longer asked for.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RetireSceneTarget() {
+        if (mSceneTarget.framebuffer == VK_NULL_HANDLE) {
+            return;
+        }
+
+        VkFramebuffer oldFramebuffer = mSceneTarget.framebuffer;
+        DeferDestruction([this, oldFramebuffer]() {
+            vkDestroyFramebuffer(mLogicalDevice, oldFramebuffer, nullptr);
+        });
+        mSceneTarget.framebuffer = VK_NULL_HANDLE;
+        mSceneTarget.colorImageView = VK_NULL_HANDLE;
+        mSceneTarget.depthImageView = VK_NULL_HANDLE;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Decides how big this frame's scene is (mRenderExtent) and how big the scene target has
+        to be to hold it (mSceneTarget.extent), which is what the frame graph is asked for.
+        Called once per frame before recording.
+
+        Note: At full scale there is nothing to upscale, so the scene goes straight into the swap
+        chain image as usual (and the blit isn't paid for).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void PrepareSceneTarget() {
+        mRenderExtent = mSwapChainExtent;
+        if (!mDynamicResolutionEnabled) {
+            return;
+        }
+
+        double scale = mResolutionScaler.GetScale();
+        double allocationScale = mResolutionScaler.UpdateAllocationScale();
+        if (scale >= 1.0) {
+            return;
+        }
+
+        auto scaled = [](uint32_t size, double s) {
+            return std::max(static_cast<uint32_t>(std::ceil(static_cast<double>(size) * s - 0.5)), 1u);
+        };
+        mRenderExtent.width = scaled(mSwapChainExtent.width, scale);
+        mRenderExtent.height = scaled(mSwapChainExtent.height, scale);
+
+        // the allocation scale is always at least the scale, and changes rarely
+        VkExtent2D allocationExtent{
+            std::max(scaled(mSwapChainExtent.width, allocationScale), mRenderExtent.width),
+            std::max(scaled(mSwapChainExtent.height, allocationScale), mRenderExtent.height),
+        };
+        if (mSceneTarget.extent.width != allocationExtent.width || mSceneTarget.extent.height != allocationExtent.height) {
+            RetireSceneTarget();
+            mSceneTarget.extent = allocationExtent;
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Stretches the scene (the top-left mRenderExtent of the scene target) over the whole swap
+        chain image with a bilinear blit.
+
+        Note: The frame graph has already put the scene in TRANSFER_SRC_OPTIMAL and the swap
+        chain image in TRANSFER_DST_OPTIMAL (waiting on the acquire and on the drawing), and
+        takes the swap chain image on to be presented (or, headless, read back) afterwards.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RecordUpscale(VkCommandBuffer commandBuffer, VkImage sceneImage, VkImage swapChainImage) {
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { static_cast<int32_t>(mRenderExtent.width), static_cast<int32_t>(mRenderExtent.height), 1 };
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = 0;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { static_cast<int32_t>(mSwapChainExtent.width), static_cast<int32_t>(mSwapChainExtent.height), 1 };
+        blit.dstSubresource = blit.srcSubresource;
+        vkCmdBlitImage(commandBuffer,
+            sceneImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            swapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit,
+            VK_FILTER_LINEAR);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Makes the Hi-Z pyramid (see HiZPyramid) for the current swap chain size, and the sampler
+        that reads it (and the depth buffer). Nothing is in it until the end of the next frame.
+
+        Note: Nearest filtering. Averaging depths would make up depths that aren't there.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateHiZPyramid() {
+        if (!mHiZEnabled) {
+            return;
+        }
+
+        if (mHiZSampler == VK_NULL_HANDLE) {
+            VkSamplerCreateInfo samplerCreateInfo{};
+            samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+            samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+            samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+            samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+            samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+            if (vkCreateSampler(mLogicalDevice, &samplerCreateInfo, nullptr, &mHiZSampler) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create Hi-Z sampler");
+            }
+        }
+
+        mHiZ.extent.width = std::max(mSwapChainExtent.width / 2, 1u);
+        mHiZ.extent.height = std::max(mSwapChainExtent.height / 2, 1u);
+        mHiZ.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(mHiZ.extent.width, mHiZ.extent.height)))) + 1;
+        mHiZ.state = RenderGraph::ResourceState{};
+
+        VkFormat format = VK_FORMAT_R32_SFLOAT;     // storage image support is required for this one
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        CreateImage(mHiZ.extent.width, mHiZ.extent.height, mHiZ.mipLevels, format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mHiZ.image, mHiZ.imageMemory);
+        mHiZ.fullView = CreateImageView(mHiZ.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mHiZ.mipLevels);
+        for (uint32_t level = 0; level < mHiZ.mipLevels; level++) {
+            mHiZ.levelViews.push_back(CreateImageView(mHiZ.image, format, VK_IMAGE_ASPECT_COLOR_BIT, 1, level));
+        }
+        mHiZValid = false;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Like RetireSceneTarget(): frames in flight may still be using it, so it is handed over
+        to DeferDestruction(...).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RetireHiZPyramid() {
+        if (mHiZ.image == VK_NULL_HANDLE) {
+            return;
+        }
+
+        HiZPyramid old = mHiZ;
+        DeferDestruction([this, old]() {
+            for (VkImageView view : old.levelViews) {
+                vkDestroyImageView(mLogicalDevice, view, nullptr);
+            }
+            vkDestroyImageView(mLogicalDevice, old.fullView, nullptr);
+            vkDestroyImage(mLogicalDevice, old.image, nullptr);
+            vkFreeMemory(mLogicalDevice, old.imageMemory, nullptr);
+        });
+        mHiZ = HiZPyramid{};
+        mHiZValid = false;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Builds the Hi-Z pyramid from the depth that this frame just drew, all levels in one
+        dispatch with the downsampler (see RecordDownsample(...)), or if that's not available,
+        one level per dispatch, each level from the one above it (see hiz_build.comp). The next
+        frame's cluster culling tests against it.
+
+        Note: Only the top-left "depthExtent" of the depth image was drawn to (dynamic
+        resolution), so only that much is reduced, and the levels below it are correspondingly
+        smaller than the images' full levels. The cull shader knows the size (see
+        mHiZDepthExtent).
+
+        Also Note: The frame graph has the depth in DEPTH_STENCIL_READ_ONLY_OPTIMAL and the
+        pyramid in GENERAL before this, with the drawing and the cull (which reads the pyramid
+        that is about to be overwritten) finished. It only deals in whole images though, so the
+        barriers between one level and the next are still made here (per-level version only).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RecordHiZBuild(FrameContext &frame, VkImage depthImage, VkImageView depthImageView, VkExtent2D depthExtent) {
+        VkCommandBuffer commandBuffer = frame.commandBuffer;
+        if (mDownsampleDepthPipeline != VK_NULL_HANDLE) {
+            RecordDownsample(commandBuffer, frame.descriptorAllocator, mDownsampleDepthPipeline, mFrameDownsampleCounter,
+                depthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, depthExtent, mHiZ.levelViews);
+            mHiZValid = true;
+            mHiZDepthExtent = depthExtent;
+            return;
+        }
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mHiZBuildPipeline);
+        glm::ivec2 srcSize(static_cast<int>(depthExtent.width), static_cast<int>(depthExtent.height));
+        for (uint32_t level = 0; level < mHiZ.mipLevels; level++) {
+            HiZBuildPushConstants pushConstants{};
+            pushConstants.srcSize = srcSize;
+            pushConstants.dstSize = glm::max(srcSize / 2, glm::ivec2(1));
+
+            VkDescriptorImageInfo srcInfo{};
+            srcInfo.sampler = mHiZSampler;
+            srcInfo.imageView = (level == 0) ? depthImageView : mHiZ.levelViews.at(level - 1);
+            srcInfo.imageLayout = (level == 0) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+            VkDescriptorImageInfo dstInfo{};
+            dstInfo.imageView = mHiZ.levelViews.at(level);
+            dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            VkDescriptorSet descriptorSet = frame.descriptorAllocator.Allocate(mHiZBuildSetLayout);
+            std::array<VkWriteDescriptorSet, 2> writes{};
+            writes.at(0).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes.at(0).dstSet = descriptorSet;
+            writes.at(0).dstBinding = 0;
+            writes.at(0).descriptorCount = 1;
+            writes.at(0).descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes.at(0).pImageInfo = &srcInfo;
+            writes.at(1) = writes.at(0);
+            writes.at(1).dstBinding = 1;
+            writes.at(1).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes.at(1).pImageInfo = &dstInfo;
+            vkUpdateDescriptorSets(mLogicalDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mHiZBuildPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, mHiZBuildPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+            uint32_t groupsX = (static_cast<uint32_t>(pushConstants.dstSize.x) + 7) / 8;
+            uint32_t groupsY = (static_cast<uint32_t>(pushConstants.dstSize.y) + 7) / 8;
+            vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+            // the next level reads this one (the frame graph sees to the next frame's cull)
+            if (level + 1 < mHiZ.mipLevels) {
+                VkMemoryBarrier levelBarrier{};
+                levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                vkCmdPipelineBarrier(commandBuffer,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                    1, &levelBarrier,
+                    0, nullptr,
+                    0, nullptr);
+            }
+            srcSize = pushConstants.dstSize;
+        }
+
+        mHiZValid = true;
+        mHiZDepthExtent = depthExtent;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Given an image (assuming it is used for color in 2 dimensions), generates progressively
+        more and more scaled down image resolutions for each increasing mip level (level 0 = base
+        image, and the detail decreases from there).
+
+        Note: Scaling is performed by VkCmdBlit(...). This function calculates scaling by, for
+        each axis, dividing the specified size of the source region by the specified size of the
+        destination region. The result could be >1, and Vulkan will be fine with this. We want to
+        generate lesser-detailed mip levels though, so we will make sure that our calculations
+        result in progressively more and more scaled down images.
+
+        Also Note: Vulkan will automatically place the new texels in the appropriate memory
+        location when we tell it what mip level the destination is. Sweet.
+
+        And Also Note: This is now the fallback for when the single-pass downsampler can't be
+        used (see SubmitPendingMipMaps()). It serializes every level behind the one before it,
+        with two barriers per level.
+    Creator:    John Cox, 02/2019
+    ---------------------------------------------------------------------------------------------*/
+    void GenerateMipMaps(VkImage image, VkFormat imageFormat, int32_t tWidth, int32_t tHeight, uint32_t mipLevels) {
+        // first check if image format supports blitting like this ("linear blitting")
+        // Note: Not all platforms support "blitting", so need to check for it's support if 
+        // planning on making this program cross-platform.
+        // (??what are "platforms"? Windows vs Linux? PC vs phone??) 
+        // Also Note: The image was created with VK_IMAGE_TILING_OPTIMAL, so we need to check if 
+        // "optimal tiling" even supports linear filtering from one image to another (it is 
+        // expected to; if it doesn't...don't know what to do).
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, imageFormat, &formatProperties);
+        if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+            throw std::runtime_error("texture image format does not support linear blitting");
+        }
+
+        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+
+        // one mip level at a time
+        VkImageSubresourceRange level{};
+        level.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        level.baseArrayLayer = 0;
+        level.layerCount = 1;
+        level.levelCount = 1;
+
+        int32_t mipWidth = tWidth;
+        int32_t mipHeight = tHeight;
+        int32_t mipDepth = 1;
+
+        // Note: On each loop:
+        // - transition mip level (index) i - 1 from a transfer destination to a source
+        // - wait for that level to be filled (either vkCmdBlitImage or vkCmdCopyBufferToImage)
+        // - start a blit command to create the next mip level from the previous
+        for (uint32_t mipIndex = 1; mipIndex < mipLevels; mipIndex++) {
+            // Note: Each mip level can have its own layout. The entire image (all mip levels) is 
+            // created with the same layout. The CreateTextureImage(...) function transitions 
+            // images after creation and buffer copy to being a transfer destination. As this loop 
+            // progresses, need to change the previous texture region (mip level) to a transfer 
+            // source. For the first loop, the base texture image is set to source.
+            level.baseMipLevel = mipIndex - 1;
+            RecordImageBarrier(commandBuffer, image, level, ResourceUsage::TRANSFER_DST, ResourceUsage::TRANSFER_SRC);
+
+            // minimum mipmap size 1px x 1px
+            // Note: We are only dealing with 2D textures at this time (2/2/2019), so Z will not 
+            // have any changes.
+            // Also Note: Each mip map level must be constructed from the previous, so only one 
+            // region at a time
+            std::vector<VkImageBlit> blit(1);
+
+            // describe source region (width = x_src_1 - x_src_0, etc.)
+            blit.at(0).srcOffsets[0] = { 0, 0, 0 }; // VkOffset3D
+            blit.at(0).srcOffsets[1] = { mipWidth, mipHeight, mipDepth };
+            blit.at(0).srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.at(0).srcSubresource.mipLevel = mipIndex - 1;
+            blit.at(0).srcSubresource.baseArrayLayer = 0;
+            blit.at(0).srcSubresource.layerCount = 1;
+
+            // describe destination region (width = x_dst_1 - x_dst_0, etc.)
+            blit.at(0).dstOffsets[0] = { 0, 0, 0 }; // VkOffset3D;
+            blit.at(0).dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth };
+            blit.at(0).dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.at(0).dstSubresource.mipLevel = mipIndex;
+            blit.at(0).dstSubresource.baseArrayLayer = 0;
+            blit.at(0).dstSubresource.layerCount = 1;
+
+            // do the actual command to scale down the previous image to make this mip level
+            vkCmdBlitImage(commandBuffer,
+                image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,    // src image == dst image
+                image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<uint32_t>(blit.size()), blit.data(),
+                VK_FILTER_LINEAR);
+
+            // transition the previous region (mip level) to be shader read-only before moving on
+            RecordImageBarrier(commandBuffer, image, level, ResourceUsage::TRANSFER_SRC, ResourceUsage::FRAGMENT_SAMPLED);
+
+            // make sure to do the ">1?" check on both dimensions in case our texture isn't square
+            mipWidth = (mipWidth > 1) ? mipWidth / 2 : 1;
+            mipHeight = (mipHeight > 1) ? mipHeight / 2 : 1;
+        }
+
+        // now transition that last mip level (index) to be used by the fragment shader
+        level.baseMipLevel = mipLevels - 1;
+        RecordImageBarrier(commandBuffer, image, level, ResourceUsage::TRANSFER_DST, ResourceUsage::FRAGMENT_SAMPLED);
+
+        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Records the single-pass downsampler (see spd_downsample.comp): "dstViews" (one
+        single-level view each) are filled in from "srcView", which is the level above the
+        first of them (ex: a texture's base level, or the depth buffer for the Hi-Z). Up to
+        DOWNSAMPLE_MAX_MIPS levels take one dispatch; longer chains carry on from the last level
+        of the dispatch before.
+
+        Everything is expected to be in the GENERAL layout already, except the source, which
+        is in "srcLayout".
+
+        Note: The barrier before each dispatch covers the dispatch before it, whether that was
+        the previous part of this chain (it reads that part's last level) or an earlier use of
+        the same counter (the counter has to be back at 0).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RecordDownsample(VkCommandBuffer commandBuffer, DescriptorAllocator &descriptorAllocator, VkPipeline pipeline, VkBuffer counterBuffer,
+        VkImageView srcView, VkImageLayout srcLayout, VkExtent2D srcExtent, const std::vector<VkImageView> &dstViews) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        glm::ivec2 srcSize(static_cast<int>(srcExtent.width), static_cast<int>(srcExtent.height));
+        for (size_t firstLevel = 0; firstLevel < dstViews.size(); firstLevel += DOWNSAMPLE_MAX_MIPS) {
+            uint32_t mipCount = static_cast<uint32_t>(std::min<size_t>(DOWNSAMPLE_MAX_MIPS, dstViews.size() - firstLevel));
+            if (firstLevel > 0) {
+                srcView = dstViews.at(firstLevel - 1);
+                srcLayout = VK_IMAGE_LAYOUT_GENERAL;
+            }
+
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr);
+
+            // every binding in the array has to be valid, so the unused ones repeat the last level
+            VkDescriptorImageInfo srcInfo{};
+            srcInfo.sampler = mDownsampleSampler;
+            srcInfo.imageView = srcView;
+            srcInfo.imageLayout = srcLayout;
+            std::array<VkDescriptorImageInfo, DOWNSAMPLE_MAX_MIPS> dstInfos{};
+            for (uint32_t i = 0; i < DOWNSAMPLE_MAX_MIPS; i++) {
+                dstInfos.at(i).imageView = dstViews.at(firstLevel + std::min(i, mipCount - 1));
+                dstInfos.at(i).imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            }
+            VkDescriptorBufferInfo counterInfo{};
+            counterInfo.buffer = counterBuffer;
+            counterInfo.offset = 0;
+            counterInfo.range = sizeof(uint32_t);
+
+            VkDescriptorSet descriptorSet = descriptorAllocator.Allocate(mDownsampleSetLayout);
+            std::array<VkWriteDescriptorSet, 3> writes{};
+            writes.at(0).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes.at(0).dstSet = descriptorSet;
+            writes.at(0).dstBinding = 0;
+            writes.at(0).descriptorCount = 1;
+            writes.at(0).descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes.at(0).pImageInfo = &srcInfo;
+            writes.at(1) = writes.at(0);
+            writes.at(1).dstBinding = 1;
+            writes.at(1).descriptorCount = DOWNSAMPLE_MAX_MIPS;
+            writes.at(1).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes.at(1).pImageInfo = dstInfos.data();
+            writes.at(2) = writes.at(0);
+            writes.at(2).dstBinding = 2;
+            writes.at(2).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes.at(2).pImageInfo = nullptr;
+            writes.at(2).pBufferInfo = &counterInfo;
+            vkUpdateDescriptorSets(mLogicalDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+            // each workgroup takes 64x64 source texels (32x32 of the first level written)
+            glm::ivec2 firstLevelSize = glm::max(srcSize / 2, glm::ivec2(1));
+            uint32_t groupsX = (static_cast<uint32_t>(firstLevelSize.x) + 31) / 32;
+            uint32_t groupsY = (static_cast<uint32_t>(firstLevelSize.y) + 31) / 32;
+
+            DownsamplePushConstants pushConstants{};
+            pushConstants.srcSize = srcSize;
+            pushConstants.mipCount = mipCount;
+            pushConstants.numGroups = groupsX * groupsY;
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mDownsamplePipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, mDownsamplePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+            vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+            srcSize = glm::max(glm::ivec2(srcSize.x >> mipCount, srcSize.y >> mipCount), glm::ivec2(1));
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Makes the mip levels of every texture that CreateTextureImage(...) left with only its base
+        level, with the downsampler, all in one submission to the compute queue.
+
+        With an async compute queue:
+        - The compute submission waits (on the GPU) for the graphics timeline to reach the
+            upload that filled in the base levels, and takes the images over from graphics.
+        - A small graphics submission waits for the compute timeline and takes them back, in
+            the layout that the fragment shader reads them in.
+        Neither blocks the CPU. Frames that are submitted to graphics after that wait for the
+        mip maps through it, and anything that only uses the base level (or doesn't use the
+        texture at all) isn't held up by them until then.
+
+        Without one, all of it is one submission to the graphics queue, which runs it in order.
+
+        Note: The command buffers, views, and descriptor sets made here are destroyed once the
+        graphics timeline has passed the hand back (see DeferDestruction(...)), since that
+        comes after the compute work.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void SubmitPendingMipMaps() {
+        if (mPendingMipMaps.empty()) {
+            return;
+        }
+
+        uint32_t numDispatches = 0;
+        for (const auto &pending : mPendingMipMaps) {
+            numDispatches += (pending.mipLevels - 1 + DOWNSAMPLE_MAX_MIPS - 1) / DOWNSAMPLE_MAX_MIPS;
+        }
+        DescriptorAllocator descriptorAllocator;
+        std::vector<DescriptorAllocator::PoolSizeRatio> ratios{
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, static_cast<float>(DOWNSAMPLE_MAX_MIPS) },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+        };
+        descriptorAllocator.Init(mLogicalDevice, numDispatches, ratios);
+
+        VkCommandBuffer computeCommandBuffer = BeginOneTimeCommandBuffer(mAsyncComputeEnabled ? mComputeCommandPool : mCommandPool);
+        std::vector<VkImageView> views;
+        for (const auto &pending : mPendingMipMaps) {
+            VkImageSubresourceRange baseLevel{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            VkImageSubresourceRange otherLevels{ VK_IMAGE_ASPECT_COLOR_BIT, 1, pending.mipLevels - 1, 0, 1 };
+            VkImageSubresourceRange allLevels{ VK_IMAGE_ASPECT_COLOR_BIT, 0, pending.mipLevels, 0, 1 };
+            if (mAsyncComputeEnabled) {
+                RecordQueueFamilyTransfer(computeCommandBuffer, pending.image, baseLevel, ResourceUsage::TRANSFER_DST, ResourceUsage::COMPUTE_SAMPLED, mGraphicsQueueFamily, mComputeQueueFamily, false);
+            }
+            else {
+                RecordImageBarrier(computeCommandBuffer, pending.image, baseLevel, ResourceUsage::TRANSFER_DST, ResourceUsage::COMPUTE_SAMPLED);
+            }
+
+            // the other levels have nothing worth keeping yet (and so don't need handing over)
+            RecordImageBarrier(computeCommandBuffer, pending.image, otherLevels, ResourceUsage::NONE, ResourceUsage::COMPUTE_STORAGE_READ_WRITE);
+
+            VkImageView srcView = CreateImageView(pending.image, pending.format, VK_IMAGE_ASPECT_COLOR_BIT, 1, 0);
+            views.push_back(srcView);
+            std::vector<VkImageView> dstViews;
+            for (uint32_t level = 1; level < pending.mipLevels; level++) {
+                dstViews.push_back(CreateImageView(pending.image, pending.format, VK_IMAGE_ASPECT_COLOR_BIT, 1, level));
+                views.push_back(dstViews.back());
+            }
+            RecordDownsample(computeCommandBuffer, descriptorAllocator, mDownsampleColorPipeline, mUploadDownsampleCounter,
+                srcView, VK_IMAGE_LAYOUT_GENERAL, pending.extent, dstViews);
+
+            // all levels are in GENERAL now
+            if (mAsyncComputeEnabled) {
+                RecordQueueFamilyTransfer(computeCommandBuffer, pending.image, allLevels, ResourceUsage::COMPUTE_STORAGE_READ_WRITE, ResourceUsage::FRAGMENT_SAMPLED, mComputeQueueFamily, mGraphicsQueueFamily, true);
+            }
+            else {
+                RecordImageBarrier(computeCommandBuffer, pending.image, allLevels, ResourceUsage::COMPUTE_STORAGE_READ_WRITE, ResourceUsage::FRAGMENT_SAMPLED);
+            }
+        }
+        vkEndCommandBuffer(computeCommandBuffer);
+
+        VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+        if (mAsyncComputeEnabled) {
+            SemaphoreWait uploaded{};
+            uploaded.semaphore = mGraphicsTimeline.semaphore;
+            uploaded.value = mGraphicsTimeline.lastSubmittedValue;
+            uploaded.stageMask = GetResourceUsageInfo(ResourceUsage::COMPUTE_SAMPLED).stages;
+            uint64_t computeValue = SubmitOnTimeline(mComputeTimeline, computeCommandBuffer, { uploaded }, {});
+
+            acquireCommandBuffer = BeginOneTimeCommandBuffer(mCommandPool);
+            for (const auto &pending : mPendingMipMaps) {
+                VkImageSubresourceRange allLevels{ VK_IMAGE_ASPECT_COLOR_BIT, 0, pending.mipLevels, 0, 1 };
+                RecordQueueFamilyTransfer(acquireCommandBuffer, pending.image, allLevels, ResourceUsage::COMPUTE_STORAGE_READ_WRITE, ResourceUsage::FRAGMENT_SAMPLED, mComputeQueueFamily, mGraphicsQueueFamily, false);
+            }
+            vkEndCommandBuffer(acquireCommandBuffer);
+
+            SemaphoreWait mipMapsDone{};
+            mipMapsDone.semaphore = mComputeTimeline.semaphore;
+            mipMapsDone.value = computeValue;
+            mipMapsDone.stageMask = GetResourceUsageInfo(ResourceUsage::FRAGMENT_SAMPLED).stages;
+            SubmitOnTimeline(mGraphicsTimeline, acquireCommandBuffer, { mipMapsDone }, {});
+        }
+        else {
+            SubmitOnTimeline(mGraphicsTimeline, computeCommandBuffer, {}, {});
+        }
+        mPendingMipMaps.clear();
+
+        VkCommandPool computeCommandPool = mAsyncComputeEnabled ? mComputeCommandPool : mCommandPool;
+        DeferDestruction([this, descriptorAllocator, views, computeCommandPool, computeCommandBuffer, acquireCommandBuffer]() mutable {
+            descriptorAllocator.Cleanup();
+            for (VkImageView view : views) {
+                vkDestroyImageView(mLogicalDevice, view, nullptr);
+            }
+            vkFreeCommandBuffers(mLogicalDevice, computeCommandPool, 1, &computeCommandBuffer);
+            if (acquireCommandBuffer != VK_NULL_HANDLE) {
+                vkFreeCommandBuffers(mLogicalDevice, mCommandPool, 1, &acquireCommandBuffer);
+            }
+        });
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Loads one of the scene's images (a JPEG, or anything else that stb_image can read) into
+        a buffer of pixel data. This is the slow part of loading a texture, and it doesn't need
+        Vulkan at all, so it is split out to run while the device is still being set up, one
+        task per texture. CreateTextureImage(...) picks up the pixels.
+
+        Stock image:
+        https://pixabay.com/en/statue-sculpture-figure-1275469/
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void DecodeTextureImage(uint32_t textureIndex) {
+        const SceneManifest::Texture &texture = mScene.GetTextures().at(textureIndex);
+        DecodedTexture &decoded = mDecodedTextures.at(textureIndex);
+        if (texture.filePath.empty()) {
+            // plain white; nothing to decode
+            decoded.pixels = nullptr;
+            decoded.width = 1;
+            decoded.height = 1;
+            return;
+        }
+
+        int tWidth = 0;
+        int tHeight = 0;
+        int numActualChannels = 0;
+        /*stbi_uc *pixels = stbi_load("textures/statue.jpg", &tWidth, &tHeight, &numActualChannels, STBI_rgb_alpha);*/
+        stbi_uc *pixels = stbi_load(texture.filePath.c_str(), &tWidth, &tHeight, &numActualChannels, STBI_rgb_alpha);
+        if (pixels == nullptr) {
+            throw std::runtime_error("failed to load texture image '" + texture.filePath + "'");
+        }
+
+        decoded.pixels = pixels;
+        decoded.width = tWidth;
+        decoded.height = tHeight;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Takes the pixels from DecodeTextureImage(...), creates a VkImage for them and allocates
+        memory for it, copies the pixels into it, then transitions the image for optimal use by
+        the shaders.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateTextureImage(uint32_t textureIndex) {
+        DecodedTexture &decoded = mDecodedTextures.at(textureIndex);
+        SceneTexture &texture = mTextures.at(textureIndex);
+        int tWidth = decoded.width;
+        int tHeight = decoded.height;
+        if (tWidth == 0 || tHeight == 0) {
+            throw std::runtime_error("texture image '" + mScene.GetTextures().at(textureIndex).name + "' was not decoded");
+        }
+        const stbi_uc WHITE_PIXEL[4] = { 255, 255, 255, 255 };
+        const stbi_uc *pixels = (decoded.pixels != nullptr) ? decoded.pixels : WHITE_PIXEL;
+
+        // - max finds largest dimension (w or h)
+        // - log2 finds how many times that dimension can be divided by 2
+        // - floor rounds down to the nearest integer just in case the largest dimension was not a 
+        //  power of two
+        // - at least 1 (base image is mip level 0 and must exist for the texture to draw at all)
+        texture.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(tWidth, tHeight)))) + 1;
+
+        // Note: We requested the image with RGBA, so even if it doesn't actually have 4 channels, 
+        // we'll get a 4-channel image (alpha expected to be 0), so we should allocate space for 
+        // that.
+        VkDeviceSize imageSize = static_cast<VkDeviceSize>(tWidth) * tHeight * 4;
+
+        // we want this image to live in GPU memory for fast access, but as with the vertex 
+        // buffer, DEVICE_LOCAL memory is not host coherent, so we'll have to make a staging 
+        // buffer for it, copy to that, then copy that into device-only-accessible memory
+        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        CreateBuffer(imageSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
+
+        // copy pixels to host-coherent GPU memory
+        void *data = nullptr;
+        VkDeviceSize zeroOffset = 0;
+        VkMemoryMapFlags flags = 0;
+        vkMapMemory(mLogicalDevice, stagingBufferMemory, zeroOffset, imageSize, flags, &data);
+        memcpy(data, pixels, static_cast<size_t>(imageSize));
+        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+        if (decoded.pixels != nullptr) {
+            stbi_image_free(decoded.pixels);    // done with the image now
+            decoded.pixels = nullptr;
+        }
+
+        // now create a Vulkan image for it
+        VkFormat imageFormat = VK_FORMAT_R8G8B8A8_UNORM;      //??what happens if it isn't? is this just JPEG??
+        VkImageTiling imageTiling = VK_IMAGE_TILING_OPTIMAL;
+        VkImageUsageFlags imageUsage =
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+            VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        // the downsampler writes the mip levels as storage images (not every format can be one; 
+        // sRGB formats usually can't)
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, imageFormat, &formatProperties);
+        bool computeMipMaps = mDownsampleEnabled && texture.mipLevels > 1 &&
+            (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+        if (computeMipMaps) {
+            imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        }
+        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        CreateImage(tWidth, tHeight, texture.mipLevels,
+            imageFormat,
+            imageTiling,
+            imageUsage,
+            memProperties,
+            texture.image,
+            texture.memory);
+
+        // copy staging buffer into VkImage memory
+        TransitionImageLayout(texture.image, imageFormat, ResourceUsage::NONE, ResourceUsage::TRANSFER_DST, texture.mipLevels);
+        CopyBufferToImage(stagingBuffer, texture.image, GetResourceUsageInfo(ResourceUsage::TRANSFER_DST).layout, static_cast<uint32_t>(tWidth), static_cast<uint32_t>(tHeight));
+
+        // generate the lesser detailed textures for the non-base mip levels
+        // Note: The compute version doesn't happen until the upload batch has been submitted 
+        // (see SubmitPendingMipMaps()). If it will be on another queue family, the base level is 
+        // handed over to it from here.
+        if (computeMipMaps) {
+            if (mAsyncComputeEnabled) {
+                VkImageSubresourceRange baseLevel{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+                VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+                RecordQueueFamilyTransfer(commandBuffer, texture.image, baseLevel, ResourceUsage::TRANSFER_DST, ResourceUsage::COMPUTE_SAMPLED, mGraphicsQueueFamily, mComputeQueueFamily, true);
+                SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+            }
+            PendingMipMaps pending{};
+            pending.image = texture.image;
+            pending.format = imageFormat;
+            pending.extent = { static_cast<uint32_t>(tWidth), static_cast<uint32_t>(tHeight) };
+            pending.mipLevels = texture.mipLevels;
+            mPendingMipMaps.push_back(pending);
+        }
+        else {
+            GenerateMipMaps(texture.image, VK_FORMAT_R8G8B8A8_UNORM, tWidth, tHeight, texture.mipLevels);
+        }
+
+        // lastly, create a view for the new image
+        texture.view = CreateImageView(texture.image, imageFormat, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+
+        // cleanup
+        DestroyStagingBuffer(stagingBuffer, stagingBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        A texture sampler tells Vulkan how to access the pixels of an image ("an image" indicating
+        to any image that it is applied to; the sampler itself does not have a link to any image).
+        If the fragment density exceeds the texel density for a given triangle and texture, and
+        nothing clever is done but rather the fragment shader just takes the closest pixel, then
+        the result is blocky and pixelated as a chunk of fragments take on the same texel, and an
+        adjacent chunk of fragments take on the adjacent text. This is called "oversampling", and
+        can be seen with low-res textures up close.
+
+        On the flip side (that is, the fragment density is less than the texel density), adjacent
+        fragments will take on non-adjacent texels, and the result is blurry. This is called
+        "undersampling", and can be seen with hi-res textures at a distance.
+
+        A sampler can specify filtering techniques and how to handle texel coordinate requests
+        that are outside the border of the texture (repeat for a tiled image, mirrored repeat,
+        clamping).
+
+        Note: "Minification" is the process of dealing with oversampling, and "magnification" is
+        the process of dealing with undersampling.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateTextureSampler() {
+        VkSamplerCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        createInfo.magFilter = VK_FILTER_LINEAR;    // more texels than fragments
+        createInfo.minFilter = VK_FILTER_LINEAR;    // more fragments than texels
+        createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        createInfo.minLod = 0.0f;
+        //createInfo.maxLod = 0.0f;
+        // Note: Shared by every texture, so it can't be limited to any one's mip levels.
+        createInfo.maxLod = VK_LOD_CLAMP_NONE;
+        createInfo.mipLodBias = 0.0f;
+        createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;   // in other words, tiling
+        createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        createInfo.anisotropyEnable = mSamplerAnisotropyEnabled ? VK_TRUE : VK_FALSE;
+        createInfo.maxAnisotropy = mSamplerAnisotropyEnabled ? 16.0f : 1.0f;
+        createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        createInfo.unnormalizedCoordinates = VK_FALSE;  // ??maybe TRUE if using sparse textures??
+        createInfo.compareEnable = VK_FALSE;    // not using "texel compare" operations for now
+        createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+
+        if (vkCreateSampler(mLogicalDevice, &createInfo, nullptr, &mTextureSampler) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture sampler");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Loads the vertices and vertex indexes contained in one of the scene's object models into
+        its own vertex storage, one task per mesh. BuildSceneGeometry() puts them all together.
+
+        The triangles are grouped by material, one run of indices (a submesh) per material,
+        so that each run can be drawn with its own texture.
+    Creator:    John Cox, 02/2019
+    ---------------------------------------------------------------------------------------------*/
+    void LoadMesh(uint32_t meshIndex) {
+        const SceneManifest::Mesh &mesh = mScene.GetMeshes().at(meshIndex);
+        LoadedMesh &loaded = mLoadedMeshes.at(meshIndex);
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn;
+        std::string err;
+
+        // Note: Faces can contain an arbitrary number of vertices, and we might try to load a 
+        // model that was constructed with, say, quads, but LoadObj has an optional parameter 
+        // "triangulate" and is set to true by default, so we don't need to worry about anything 
+        // except triangles.
+        // Also Note: The .mtl file is looked for next to the OBJ.
+        std::filesystem::path folder = std::filesystem::path(mesh.filePath).parent_path();
+        std::string materialFolder = folder.empty() ? "" : folder.generic_string() + "/";
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, mesh.filePath.c_str(), materialFolder.c_str())) {
+            throw std::runtime_error("failed to load mesh '" + mesh.filePath + "': " + warn + err);
+        }
+
+        // material => texture; a listed map_Kd, or else the mesh's texture (see SceneManifest)
+        // Note: Worked out once per material up front. Looking it up by path per index would 
+        // be a path normalization and a search for every vertex of every triangle.
+        std::vector<uint32_t> materialToTexture(materials.size(), mesh.texture);
+        for (size_t i = 0; i < materials.size(); i++) {
+            if (!materials[i].diffuse_texname.empty()) {
+                std::optional<uint32_t> texture = mScene.FindTextureByPath(folder / materials[i].diffuse_texname);
+                materialToTexture[i] = texture.value_or(mesh.texture);
+            }
+        }
+
+        // there are some duplicate vertices in this mesh that we'll want to trim out
+        // Note: The whole point of using vertex indices is to avoid duplicating vertices. An 
+        // index is cheap to copy. A vertex much less so. There are 1/2 million faces in the 
+        // chalet, ~700k vertices extracted (but only ~260k unique ones), and 1.5 million 
+        // indices. Definitely want to avoid duplicating vertices when this much memory is at 
+        // stake.
+        std::unordered_map<Vertex, uint32_t> uniqueVertexIndices{};
+
+        // texture => its triangles' indices, in the order that they were found
+        std::map<uint32_t, std::vector<uint32_t>> indicesByTexture;
+        size_t numFaces = 0;
+        for (const auto &s : shapes) {
+            numFaces += s.mesh.num_face_vertices.size();
+            for (size_t i = 0; i < s.mesh.indices.size(); i++) {
+                const tinyobj::index_t &index = s.mesh.indices[i];
+                Vertex v{};
+                v.pos = {
+                    attrib.vertices[(3 * index.vertex_index) + 0],
+                    attrib.vertices[(3 * index.vertex_index) + 1],
+                    attrib.vertices[(3 * index.vertex_index) + 2],
+                };
+                if (index.texcoord_index >= 0) {
+                    v.texCoord = {
+                        attrib.texcoords[(2 * index.texcoord_index) + 0],
+                        1.0f - attrib.texcoords[(2 * index.texcoord_index) + 1],
+                    };
+                }
+                v.color = { 1.0f, 1.0f, 1.0f };
+
+                if (uniqueVertexIndices.count(v) == 0) {
+                    // haven't seen this before, so store the current vertex index
+                    uniqueVertexIndices[v] = static_cast<uint32_t>(loaded.vertexes.size());
+                    loaded.vertexes.push_back(v);
+                }
+
+                // 3 indices per face (triangulated)
+                size_t face = i / 3;
+                int materialId = (face < s.mesh.material_ids.size()) ? s.mesh.material_ids[face] : -1;
+                bool hasMaterial = materialId >= 0 && materialId < static_cast<int>(materialToTexture.size());
+                uint32_t texture = hasMaterial ? materialToTexture[materialId] : mesh.texture;
+                indicesByTexture[texture].push_back(uniqueVertexIndices.at(v));
+            }
+        }
+
+        for (const auto &submesh : indicesByTexture) {
+            loaded.submeshTextures.push_back(submesh.first);
+            loaded.submeshIndexCounts.push_back(static_cast<uint32_t>(submesh.second.size()));
+            loaded.indices.insert(loaded.indices.end(), submesh.second.begin(), submesh.second.end());
+        }
+
+        std::stringstream ss;
+        ss << "mesh '" << mesh.name << "': " << numFaces << " faces, " << loaded.vertexes.size() << " unique vertices, " << loaded.submeshTextures.size() << " material(s)" << std::endl;
+        std::cout << ss.str();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Puts every loaded mesh into one vertex list and one index list, so that the whole scene
+        is one vertex buffer and one index buffer, bound once. Each mesh's indices are shifted to
+        point at where its vertices ended up.
+
+        Then lists the draws: every submesh of every instance, grouped by texture and then by
+        mesh, so that a run of draws shares as much state as possible (see RecordSceneDraw(...)).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void BuildSceneGeometry() {
+        size_t numVertexes = 0;
+        size_t numIndices = 0;
+        for (const LoadedMesh &loaded : mLoadedMeshes) {
+            numVertexes += loaded.vertexes.size();
+            numIndices += loaded.indices.size();
+        }
+        if (numVertexes > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("too many vertices in the scene for 32-bit indices");
+        }
+        mVertexes.clear();
+        mVertexIndices.clear();
+        mVertexes.reserve(numVertexes);
+        mVertexIndices.reserve(numIndices);
+
+        mSceneMeshes.clear();
+        mSubmeshes.clear();
+        for (uint32_t meshIndex = 0; meshIndex < mLoadedMeshes.size(); meshIndex++) {
+            LoadedMesh &loaded = mLoadedMeshes[meshIndex];
+            uint32_t baseVertex = static_cast<uint32_t>(mVertexes.size());
+            uint32_t firstIndex = static_cast<uint32_t>(mVertexIndices.size());
+            mVertexes.insert(mVertexes.end(), loaded.vertexes.begin(), loaded.vertexes.end());
+            for (uint32_t index : loaded.indices) {
+                mVertexIndices.push_back(baseVertex + index);
+            }
+
+            SceneMesh sceneMesh{};
+            sceneMesh.firstSubmesh = static_cast<uint32_t>(mSubmeshes.size());
+            sceneMesh.numSubmeshes = static_cast<uint32_t>(loaded.submeshTextures.size());
+            for (uint32_t i = 0; i < sceneMesh.numSubmeshes; i++) {
+                Submesh submesh{};
+                submesh.mesh = meshIndex;
+                submesh.firstIndex = firstIndex;
+                submesh.indexCount = loaded.submeshIndexCounts[i];
+                submesh.texture = loaded.submeshTextures[i];
+                mSubmeshes.push_back(submesh);
+                firstIndex += submesh.indexCount;
+            }
+            mSceneMeshes.push_back(sceneMesh);
+
+            // done with the mesh's own copy
+            loaded = LoadedMesh{};
+        }
+
+        mSceneDraws.clear();
+        const auto &instances = mScene.GetInstances();
+        for (uint32_t instanceIndex = 0; instanceIndex < instances.size(); instanceIndex++) {
+            const SceneMesh &sceneMesh = mSceneMeshes.at(instances[instanceIndex].mesh);
+            for (uint32_t i = 0; i < sceneMesh.numSubmeshes; i++) {
+                mSceneDraws.push_back({ instanceIndex, sceneMesh.firstSubmesh + i });
+            }
+        }
+        std::stable_sort(mSceneDraws.begin(), mSceneDraws.end(), [this](const SceneDraw &a, const SceneDraw &b) {
+            const Submesh &submeshA = mSubmeshes[a.submesh];
+            const Submesh &submeshB = mSubmeshes[b.submesh];
+            if (submeshA.texture != submeshB.texture) {
+                return submeshA.texture < submeshB.texture;
+            }
+            return submeshA.mesh < submeshB.mesh;
+        });
+
+        std::cout << "Scene: " << mSceneMeshes.size() << " meshes (" << mSubmeshes.size() << " submeshes), "
+            << instances.size() << " instances (" << mSceneDraws.size() << " draws), "
+            << mScene.GetTextures().size() << " textures, "
+            << mVertexes.size() << " vertices, " << mVertexIndices.size() / 3 << " triangles" << std::endl;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Cuts every submesh into MeshClusters of (up to) CLUSTER_TRIANGLES triangles each and puts
+        a sphere around each one. A mesh's clusters are contiguous, and so are a submesh's.
+
+        Note: The sphere is centered on the cluster's bounding box, which is not the smallest
+        sphere, but it's close and it's cheap.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void BuildMeshClusters() {
+        // small enough to cull finely, big enough that there aren't too many draws
+        // Note: The chalet has ~500k triangles => ~2k clusters.
+        const uint32_t CLUSTER_TRIANGLES = 256;
+        const uint32_t clusterIndices = CLUSTER_TRIANGLES * 3;
+
+        mClusters.clear();
+        for (SceneMesh &sceneMesh : mSceneMeshes) {
+            sceneMesh.firstCluster = static_cast<uint32_t>(mClusters.size());
+            for (uint32_t submeshIndex = sceneMesh.firstSubmesh; submeshIndex < sceneMesh.firstSubmesh + sceneMesh.numSubmeshes; submeshIndex++) {
+                Submesh &submesh = mSubmeshes[submeshIndex];
+                submesh.firstCluster = static_cast<uint32_t>(mClusters.size());
+                uint32_t endIndex = submesh.firstIndex + submesh.indexCount;
+                for (uint32_t firstIndex = submesh.firstIndex; firstIndex < endIndex; firstIndex += clusterIndices) {
+                    MeshCluster cluster{};
+                    cluster.firstIndex = firstIndex;
+                    cluster.indexCount = std::min(clusterIndices, endIndex - firstIndex);
+
+                    glm::vec3 boxMin(std::numeric_limits<float>::max());
+                    glm::vec3 boxMax(std::numeric_limits<float>::lowest());
+                    for (uint32_t i = 0; i < cluster.indexCount; i++) {
+                        const glm::vec3 &pos = mVertexes.at(mVertexIndices.at(firstIndex + i)).pos;
+                        boxMin = glm::min(boxMin, pos);
+                        boxMax = glm::max(boxMax, pos);
+                    }
+                    glm::vec3 center = (boxMin + boxMax) * 0.5f;
+                    float radius = 0.0f;
+                    for (uint32_t i = 0; i < cluster.indexCount; i++) {
+                        const glm::vec3 &pos = mVertexes.at(mVertexIndices.at(firstIndex + i)).pos;
+                        radius = std::max(radius, glm::length(pos - center));
+                    }
+                    cluster.sphere = glm::vec4(center, radius);
+                    mClusters.push_back(cluster);
+                }
+                submesh.numClusters = static_cast<uint32_t>(mClusters.size()) - submesh.firstCluster;
+            }
+            sceneMesh.numClusters = static_cast<uint32_t>(mClusters.size()) - sceneMesh.firstCluster;
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Not all memory is created equal. Some is only available on the GPU ("device local"), some
+        is visible to the host (the program), some is coherent (immediately copied to a duplicate
+        chunk of GPU memory upon writing, though this has system-memory->GPU-memory transfer
+        costs), etc.
+
+        ??why are there a bunch of property-less pieces of memory??
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            //std::stringstream ss;
+            //ss << "memory type[" << i << "], heap index '" << memoryProperties.memoryTypes[i].heapIndex << "':";
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0) {
+            //    ss << " DEVICE_LOCAL";
+            //}
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            //    ss << " HOST_VISIBLE";
+            //}
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) {
+            //    ss << " HOST_COHERENT";
+            //}
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0) {
+            //    ss << " HOST_CACHED";
+            //}
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0) {
+            //    ss << " LAZILY_ALLOCATED";
+            //}
+            //if ((memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_PROTECTED_BIT) != 0) {
+            //    ss << " PROTECTED_BIT";
+            //}
+            //std::cout << ss.str() << std::endl;
+
+            bool typeOk = (typeFilter & (1 << i)) != 0;
+
+            // Problem: More than one memory property may be requested, so a simple bitwise 
+            // AND != 0 check won't be suitable, and there may be more properties available than 
+            // we are asking for, so a simple equivalence check won't work either. Solution: Check 
+            // if the bitwise AND has all the requested properties.
+            bool propertyOk = (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties;
+            if (typeOk && propertyOk) {
+                return i;
+            }
+        }
+        throw std::runtime_error("failed to find suitable memory type");
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        FindMemoryType(...) without the exception, for memory properties that are nice to have.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            bool typeOk = (typeFilter & (1 << i)) != 0;
+            bool propertyOk = (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties;
+            if (typeOk && propertyOk) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates a VkBuffer of the requested type, then allocates memory for it with the requested
+        memory usage and properties (specifying these allows the driver to optimize where it can).
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags memProperties, VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
+        VkBufferCreateInfo bufferCreateInfo{};
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.size = bufferSize;
+        bufferCreateInfo.usage = bufferUsage;
+
+        // only in use by one queue family (graphics queue)
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(mLogicalDevice, &bufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create vertex buffer");
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(mLogicalDevice, buffer, &memoryRequirements);
+
+        VkMemoryAllocateInfo memoryAllocateInfo{};
+        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocateInfo.allocationSize = memoryRequirements.size;
+        memoryAllocateInfo.memoryTypeIndex = FindMemoryType(memoryRequirements.memoryTypeBits, memProperties);
+        if (vkAllocateMemory(mLogicalDevice, &memoryAllocateInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate vertex buffer memory");
+        }
+        mNumDeviceAllocations++;
+        mTotalDeviceAllocationBytes += memoryAllocateInfo.allocationSize;
+
+        uint32_t memoryOffset = 0;
+        vkBindBufferMemory(mLogicalDevice, buffer, bufferMemory, memoryOffset);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Copies from the non-device-local host-visible buffer to the device-local non-host-visible
+        buffer.
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+
+        VkBufferCopy copyRegion{};
+        copyRegion.size = size;
+        uint32_t regionCount = 1;
+        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, &copyRegion);
+
+        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        With not only vertex buffers needing copying but also texture images needing initial
+        processing, this common code for the beginning of a one-time command buffer was broken
+        into two dedicated functions to prevent copying.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    VkCommandBuffer BeginSingleUseCommandBuffer() {
+        if (mUploadBatchCommandBuffer != VK_NULL_HANDLE) {
+            // recording into the batch; see BeginUploadBatch()
+            return mUploadBatchCommandBuffer;
+        }
+        return BeginOneTimeCommandBuffer(mCommandPool);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Allocates a primary command buffer from the given pool (and so for that pool's queue
+        family) and begins it for a single submit.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    VkCommandBuffer BeginOneTimeCommandBuffer(VkCommandPool commandPool) {
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandPool = commandPool;
+        allocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        vkAllocateCommandBuffers(mLogicalDevice, &allocateInfo, &commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        return commandBuffer;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        This is the second half of the common code used in executing a one-time command buffer.
+
+        Note: The callers free their staging buffers as soon as this returns, so the CPU still has
+        to wait, but now it only waits for this one submission's timeline value rather than for
+        the whole queue to go idle (which would include any frames still in flight).
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void SubmitAndEndSingleUseCommandBuffer(VkCommandBuffer commandBuffer) {
+        if (commandBuffer == mUploadBatchCommandBuffer) {
+            // submitted all at once by EndUploadBatch()
+            return;
+        }
+
+        vkEndCommandBuffer(commandBuffer);
+
+        uint64_t uploadValue = SubmitOnTimeline(mGraphicsTimeline, commandBuffer, {}, {});
+        WaitForTimelineValue(mGraphicsTimeline, uploadValue);
+
+        uint32_t commandBufferCount = 1;
+        vkFreeCommandBuffers(mLogicalDevice, mCommandPool, commandBufferCount, &commandBuffer);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Until EndUploadBatch(), everything that would have been its own single use command
+        buffer (and its own submit, and its own wait) is recorded into one command buffer
+        instead. Commands are recorded in order, and the barriers that were already between
+        them (ex: transition -> copy -> mipmaps) keep working as before.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void BeginUploadBatch() {
+        mUploadBatchCommandBuffer = BeginSingleUseCommandBuffer();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Submits the batch, waits for it, then frees the staging buffers that it read from.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void EndUploadBatch() {
+        VkCommandBuffer commandBuffer = mUploadBatchCommandBuffer;
+        mUploadBatchCommandBuffer = VK_NULL_HANDLE;
+        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
+
+        for (const auto &staging : mPendingStagingBuffers) {
+            vkDestroyBuffer(mLogicalDevice, staging.first, nullptr);
+            vkFreeMemory(mLogicalDevice, staging.second, nullptr);
+        }
+        mPendingStagingBuffers.clear();
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Staging buffers can't be freed until the copy out of them has executed, which, in an
+        upload batch, isn't until the end of the batch.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void DestroyStagingBuffer(VkBuffer stagingBuffer, VkDeviceMemory stagingBufferMemory) {
+        if (mUploadBatchCommandBuffer != VK_NULL_HANDLE) {
+            mPendingStagingBuffers.push_back({ stagingBuffer, stagingBufferMemory });
+            return;
+        }
+        vkDestroyBuffer(mLogicalDevice, stagingBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, stagingBufferMemory, nullptr);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates a non-device-local but host-visible and host-coherent buffer, meaning that the
+        buffer will reside in system memory, though it will have a GPU-memory equivalent, and the
+        program will have write access and that it will be immediately uploaded to the GPU upon
+        writing. This has memory copy costs though because the memory has to be sent to the GPU.
+        The vertex data is copied to this buffer once.
+
+        Then we create another buffer that is device local only and that is not host visible,
+        meaning that the memory will reside on the GPU only and that the program will not write to
+        it (that is, vkMapMemory(...) will blow up on us if we try to use it on this buffer's
+        memory). We will then issue a command to copy the memory from the first buffer to the
+        second, then dismiss the first buffer. The program will then run by accessing the
+        device-local memory.
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateVertexBuffer() {
+        VkDeviceSize bufferSize = sizeof(mVertexes[0]) * mVertexes.size();
+
+        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        CreateBuffer(bufferSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
+
+        void *data = nullptr;
+        VkDeviceSize offset = 0;
+        VkMemoryMapFlags flags = 0;
+        vkMapMemory(mLogicalDevice, stagingBufferMemory, offset, bufferSize, flags, &data);
+        memcpy(data, mVertexes.data(), static_cast<size_t>(bufferSize));
+        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+
+        bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        CreateBuffer(bufferSize, bufferUsage, memProperties, mVertexBuffer, mVertexBufferMemory);
+
+        CopyBuffer(stagingBuffer, mVertexBuffer, bufferSize);
+        DestroyStagingBuffer(stagingBuffer, stagingBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        To avoid duplicate vertex data, we will tell the drawing commands to use vertex by index
+        instead of sequentially plucking out 3 vertices at a time from the vertex buffer. After
+        setting this up, the drawing will sequentially pluck out 3 indices at a time from the
+        index buffer, where it is cheaper to have duplicates (16bit duplicate indices much cheaper
+        than duplicating an entire 2x 32bit position float + 3x 32bit color float vertex).
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateVertexIndexBuffer() {
+        VkDeviceSize bufferSize = sizeof(mVertexIndices[0]) * mVertexIndices.size();
+
+        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        CreateBuffer(bufferSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
+
+        void *data = nullptr;
+        VkDeviceSize offset = 0;
+        VkMemoryMapFlags flags = 0;
+        vkMapMemory(mLogicalDevice, stagingBufferMemory, offset, bufferSize, flags, &data);
+        memcpy(data, mVertexIndices.data(), static_cast<size_t>(bufferSize));
+        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+
+        bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        CreateBuffer(bufferSize, bufferUsage, memProperties, mVertexIndexBuffer, mVertexIndexBufferMemory);
+        CopyBuffer(stagingBuffer, mVertexIndexBuffer, bufferSize);
+        DestroyStagingBuffer(stagingBuffer, stagingBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The staging dance of CreateVertexBuffer() for any device-local buffer that is filled once
+        at startup.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDeviceLocalBuffer(const void *source, VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+        void *data = nullptr;
+        vkMapMemory(mLogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, source, static_cast<size_t>(bufferSize));
+        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
+        CopyBuffer(stagingBuffer, buffer, bufferSize);
+        DestroyStagingBuffer(stagingBuffer, stagingBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The depth pre-pass only needs positions. Giving it a tightly packed copy of them (12
+        bytes per vertex instead of a whole Vertex) means less memory to fetch for a pass that
+        is all vertex work.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreatePositionBuffer() {
+        std::vector<glm::vec3> positions;
+        positions.reserve(mVertexes.size());
+        for (const Vertex &v : mVertexes) {
+            positions.push_back(v.pos);
+        }
+        VkDeviceSize bufferSize = sizeof(positions[0]) * positions.size();
+        CreateDeviceLocalBuffer(positions.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mPositionBuffer, mPositionBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The clusters (see BuildMeshClusters()) go to the GPU once. The draw commands are written
+        by cluster_cull.comp every frame and then drawn from, so there is no CPU data for them.
+
+        Each instance gets its own run of draw commands, one per cluster of its mesh, because the
+        same cluster can be visible in one instance and culled in another. The instances go to
+        the GPU too (see ClusterCullInstance), and they don't move, so that's once as well.
+
+        Note: The draw commands start out with every cluster drawn, which is what the first frame
+        would have done anyway.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateClusterBuffers() {
+        VkDeviceSize clusterBufferSize = sizeof(mClusters[0]) * mClusters.size();
+        CreateDeviceLocalBuffer(mClusters.data(), clusterBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mClusterBuffer, mClusterBufferMemory);
+
+        mInstanceFirstDrawCommands.clear();
+        std::vector<VkDrawIndexedIndirectCommand> drawCommands;
+        std::vector<ClusterCullInstance> cullInstances;
+        for (const SceneManifest::Instance &instance : mScene.GetInstances()) {
+            const SceneMesh &sceneMesh = mSceneMeshes.at(instance.mesh);
+            mInstanceFirstDrawCommands.push_back(static_cast<uint32_t>(drawCommands.size()));
+
+            ClusterCullInstance cullInstance{};
+            cullInstance.model = instance.transform;
+            cullInstance.firstCluster = sceneMesh.firstCluster;
+            cullInstance.numClusters = sceneMesh.numClusters;
+            cullInstance.firstDrawCommand = static_cast<uint32_t>(drawCommands.size());
+            cullInstances.push_back(cullInstance);
+
+            for (uint32_t i = sceneMesh.firstCluster; i < sceneMesh.firstCluster + sceneMesh.numClusters; i++) {
+                VkDrawIndexedIndirectCommand drawCommand{};
+                drawCommand.indexCount = mClusters.at(i).indexCount;
+                drawCommand.instanceCount = 1;
+                drawCommand.firstIndex = mClusters.at(i).firstIndex;
+                drawCommand.vertexOffset = 0;   // indices already point into the whole scene's vertices
+                drawCommand.firstInstance = 0;
+                drawCommands.push_back(drawCommand);
+            }
+        }
+        mNumDrawCommands = static_cast<uint32_t>(drawCommands.size());
+
+        VkDeviceSize drawCommandBufferSize = sizeof(drawCommands[0]) * drawCommands.size();
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        CreateDeviceLocalBuffer(drawCommands.data(), drawCommandBufferSize, usage, mDrawCommandBuffer, mDrawCommandBufferMemory);
+
+        VkDeviceSize cullInstanceBufferSize = sizeof(cullInstances[0]) * cullInstances.size();
+        CreateDeviceLocalBuffer(cullInstances.data(), cullInstanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mCullInstanceBuffer, mCullInstanceBufferMemory);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates one uniform buffer with a slice for every frame context so that we neither risk
+        running over the current frame-in-flight's uniforms nor have to wait for the frame to
+        finish before beginning the next one. With every frame having it's own uniforms, we can
+        go as fast as possible.
+
+        Note: We're going to have upload new transforms every frame, so it would be pointless to
+        create device-local memory that has to wait on a coherent staging buffer. We'll just use
+        coherent memory (as soon as it is written to in system memory, it starts uploading to the
+        GPU). The frame ring will give it a bit of time since the GPU is busy with older frames.
+
+        Also Note: The buffer stays mapped for the life of the program. Mapping and unmapping
+        every frame was pure overhead.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateUniformBuffers() {
+        // each slice must start on a multiple of the device's UBO offset alignment
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &deviceProperties);
+        VkDeviceSize alignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
+        mUniformSliceSize = sizeof(UniformBufferObject);
+        if (alignment > 0) {
+            mUniformSliceSize = (mUniformSliceSize + alignment - 1) & ~(alignment - 1);
+        }
+
+        VkDeviceSize bufferSize = mUniformSliceSize * mOptions.framesInFlight;
+        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        CreateBuffer(bufferSize, bufferUsage, memProperties, mUniformBuffer, mUniformBufferMemory);
+
+        VkDeviceSize offset = 0;
+        VkMemoryMapFlags flags = 0;
+        vkMapMemory(mLogicalDevice, mUniformBufferMemory, offset, bufferSize, flags, &mUniformBufferMapped);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        For this tutorial at this stage (Texture mapping: Combined image sampler), we will
+        allocate a UBO for each possible frame (set 0) and a sampler for each of the scene's
+        textures (set 1).
+
+        Note: This used to be a single descriptor pool sized to exactly the number of sets that
+        were needed at startup, which meant that not a single extra set could be allocated for a
+        new material or object. The allocator chains more pools on as needed, so the initial size
+        is just a starting guess.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDescriptorAllocator() {
+        // Note: This allocator is for long-lived sets (materials). Per-frame sets come out of 
+        // each frame context's own allocator, which is reset wholesale every frame.
+        uint32_t numMaterialSets = static_cast<uint32_t>(mScene.GetTextures().size());
+        std::vector<DescriptorAllocator::PoolSizeRatio> ratios{
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f },
+        };
+        mDescriptorAllocator.Init(mLogicalDevice, numMaterialSets, ratios);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        A descriptor is something like a uniform or an image sampler. The descriptor (shorthand
+        for "data descriptor") tells Vulkan where this information is coming from. Info on
+        individual descriptors is generalized in the descriptor set layout setup and given exact
+        info here via VkDescriptorBufferInfo (or VkDescriptorImageInfo, or others).
+
+        Note: The designers of Vulkan did not expect users to have only one descriptor in their
+        shaders (not most of the time, at least), so we do not see a VkDescriptor structure,
+        instead only seeing VkDescriptorSet, indicating possibility for multiple descriptors. When
+        you only have one descriptor, such as in this tutorial prior to image sampling, then the
+        set is size 1 and the plural terminology is confusing.
+    Creator:    John Cox, 01/2019
+    ---------------------------------------------------------------------------------------------*/
+    void CreateDescriptorSets() {
+        // Note: This is an "allocate" function, not a "create" function, and it allocates from a 
+        // pool that was already created, so we don't need to explicitly free or destroy the 
+        // descriptor sets. They will be destroyed when the pool is.
+        // Also Note: The per-frame (set 0) sets are allocated every frame out of the frame 
+        // context's allocator. See AllocatePerFrameDescriptorSet(...).
+
+        // a texture's set doesn't change from frame to frame, so there is only one of each
+        for (SceneTexture &texture : mTextures) {
+            texture.descriptorSet = mDescriptorAllocator.Allocate(mMaterialDescriptorSetLayout);
+
+            // arguably should be called VkDescriptorSamplerInfo, but eh
+            // Note: The layout is the same value used when transitioning the texture image after 
+            // copying.
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = texture.view;
+            imageInfo.sampler = mTextureSampler;
+            vkUpdateDescriptorSetWithTemplate(mLogicalDevice, texture.descriptorSet, mMaterialUpdateTemplate, &imageInfo);
+        }
+
+        if (mUseBindlessTextures) {
+            CreateBindlessDescriptorSet();
+            for (SceneTexture &texture : mTextures) {
+                texture.materialId = RegisterBindlessTexture(texture.view, mTextureSampler);
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        The bindless texture array needs its own pool because "update after bind" sets can only
+        come from pools created with the matching flag. There is only ever one of these sets, so
+        it doesn't go through the growable allocator.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateBindlessDescriptorSet() {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = mMaxBindlessTextures;
+
+        VkDescriptorPoolCreateInfo poolCreateInfo{};
+        poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolCreateInfo.maxSets = 1;
+        poolCreateInfo.poolSizeCount = 1;
+        poolCreateInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(mLogicalDevice, &poolCreateInfo, nullptr, &mBindlessDescriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = mBindlessDescriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &mBindlessDescriptorSetLayout;
+        if (vkAllocateDescriptorSets(mLogicalDevice, &allocateInfo, &mBindlessDescriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate bindless descriptor set");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Writes a texture into the next free slot of the bindless texture array and returns the
+        slot index. That index is the "material ID" that draws push to the fragment shader.
+
+        Note: The set was created with "update after bind", so this is legal even while command
+        buffers that bind the set are in flight, as long as they don't use this particular slot.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    uint32_t RegisterBindlessTexture(VkImageView imageView, VkSampler sampler) {
+        if (mNumBindlessTextures >= mMaxBindlessTextures) {
+            throw std::runtime_error("bindless texture array is full");
+        }
+        uint32_t slot = mNumBindlessTextures++;
+
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = imageView;
+        imageInfo.sampler = sampler;
+
+        // Note: Not a template update; the array element changes with every call.
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = mBindlessDescriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = slot;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(mLogicalDevice, 1, &descriptorWrite, 0, nullptr);
+
+        return slot;
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        (Re)allocates this frame's per-frame (set 0) descriptor set out of the frame context's own
+        allocator and points it at the frame's slice of the uniform buffer.
+
+        Note: The frame context's allocator was reset wholesale at the start of the frame, so this
+        is effectively a pointer bump in the driver. Anything else that needs a throwaway
+        descriptor set for just this frame can allocate from the same place.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void AllocatePerFrameDescriptorSet(FrameContext &frame) {
+        frame.perFrameDescriptorSet = frame.descriptorAllocator.Allocate(mPerFrameDescriptorSetLayout);
+
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = mUniformBuffer;
+        bufferInfo.offset = frame.uniformOffset;
+        bufferInfo.range = sizeof(UniformBufferObject);
+
+        // the template already knows that this is binding 0 and that it is a UBO
+        vkUpdateDescriptorSetWithTemplate(mLogicalDevice, frame.perFrameDescriptorSet, mPerFrameUpdateTemplate, &bufferInfo);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Runs cluster_cull.comp, which rewrites every cluster's indirect draw command for this
+        frame. Frustum culling always; occlusion culling too once there is a Hi-Z pyramid from
+        last frame.
+
+        One dispatch for the whole scene: a thread per draw command, which is a cluster of one
+        instance, culled with that instance's transform (see ClusterCullInstance). The number of
+        commands recorded here doesn't depend on how many instances there are.
+
+        Note: No barriers. The frame graph has last frame's draws done with the commands (and
+        last frame's Hi-Z build done with the pyramid) before this, and this frame's draws wait
+        for it.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RecordClusterCull(FrameContext &frame) {
+        VkCommandBuffer commandBuffer = frame.commandBuffer;
+
+        VkDescriptorBufferInfo uniformInfo{};
+        uniformInfo.buffer = mUniformBuffer;
+        uniformInfo.offset = frame.uniformOffset;
+        uniformInfo.range = sizeof(UniformBufferObject);
+        VkDescriptorBufferInfo clusterInfo{};
+        clusterInfo.buffer = mClusterBuffer;
+        clusterInfo.offset = 0;
+        clusterInfo.range = VK_WHOLE_SIZE;
+        VkDescriptorBufferInfo drawCommandInfo{};
+        drawCommandInfo.buffer = mDrawCommandBuffer;
+        drawCommandInfo.offset = 0;
+        drawCommandInfo.range = VK_WHOLE_SIZE;
+        VkDescriptorBufferInfo cullInstanceInfo{};
+        cullInstanceInfo.buffer = mCullInstanceBuffer;
+        cullInstanceInfo.offset = 0;
+        cullInstanceInfo.range = VK_WHOLE_SIZE;
+
+        // without a pyramid, binding 3 still needs something valid in it; the shader won't look
+        // at it (hiZMipCount == 0)
+        VkDescriptorImageInfo hiZInfo{};
+        if (mHiZEnabled) {
+            hiZInfo.sampler = mHiZSampler;
+            hiZInfo.imageView = mHiZ.fullView;
+            hiZInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+        else {
+            hiZInfo.sampler = mTextureSampler;
+            hiZInfo.imageView = mTextures.at(0).view;
+            hiZInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkDescriptorSet descriptorSet = frame.descriptorAllocator.Allocate(mClusterCullSetLayout);
+        std::array<VkWriteDescriptorSet, 5> writes{};
+        for (uint32_t i = 0; i < writes.size(); i++) {
+            writes.at(i).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes.at(i).dstSet = descriptorSet;
+            writes.at(i).dstBinding = i;
+            writes.at(i).descriptorCount = 1;
+        }
+        writes.at(0).descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes.at(0).pBufferInfo = &uniformInfo;
+        writes.at(1).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes.at(1).pBufferInfo = &clusterInfo;
+        writes.at(2).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes.at(2).pBufferInfo = &drawCommandInfo;
+        writes.at(3).descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes.at(3).pImageInfo = &hiZInfo;
+        writes.at(4).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes.at(4).pBufferInfo = &cullInstanceInfo;
+        vkUpdateDescriptorSets(mLogicalDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        ClusterCullPushConstants pushConstants{};
+        pushConstants.depthSize = glm::ivec2(static_cast<int>(mHiZDepthExtent.width), static_cast<int>(mHiZDepthExtent.height));
+        pushConstants.hiZMipCount = mHiZValid ? mHiZ.mipLevels : 0;
+        pushConstants.numDrawCommands = mNumDrawCommands;
+        pushConstants.numInstances = static_cast<uint32_t>(mScene.GetInstances().size());
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mClusterCullPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mClusterCullPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, mClusterCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (pushConstants.numDrawCommands + 63) / 64, 1, 1);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Draws the scene with whatever pipeline and vertex buffer are bound, one submesh of one
+        instance at a time in the order that BuildSceneGeometry() sorted them (by texture, then
+        by mesh). Everything comes out of the same vertex and index buffers, so between draws
+        there is only the texture to change (when it does) and the push constants.
+
+        With cluster culling, each draw is the submesh's run of this instance's indirect draw
+        commands, culled ones having no indices. Otherwise it's the submesh's whole index range.
+
+        Note: Without the multiDrawIndirect feature, an indirect draw can only have one command,
+        so there's one vkCmdDrawIndexedIndirect(...) per cluster. Still no CPU readback.
+
+        Also Note: In bindless mode, set 1 already has every texture in it and the material ID
+        push constant picks one, so there are no descriptor binds in here at all.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RecordSceneDraw(VkCommandBuffer commandBuffer) {
+        const auto &instances = mScene.GetInstances();
+        VkShaderStageFlags pushConstantStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+        // Note: Called once per subpass, and the last one left whatever texture it ended on 
+        // bound, so the first draw always binds and pushes.
+        std::optional<uint32_t> boundTexture;
+        std::optional<uint32_t> pushedInstance;
+        std::optional<uint32_t> pushedTexture;
+        for (const SceneDraw &draw : mSceneDraws) {
+            const Submesh &submesh = mSubmeshes[draw.submesh];
+            const SceneTexture &texture = mTextures.at(submesh.texture);
+            if (!mUseBindlessTextures && submesh.texture != boundTexture) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 1, 1, &texture.descriptorSet, 0, nullptr);
+                boundTexture = submesh.texture;
+            }
+
+            // per-object transform and material
+            // Note: These are recorded into the command buffer itself, so there is no buffer 
+            // to update and no descriptor set to write for each object.
+            if (pushedInstance != draw.instance || pushedTexture != submesh.texture) {
+                PushConstantObject pushConstants{};
+                pushConstants.model = instances[draw.instance].transform;
+                pushConstants.materialId = texture.materialId;
+                vkCmdPushConstants(commandBuffer, mPipelineLayout, pushConstantStages, 0, sizeof(pushConstants), &pushConstants);
+                pushedInstance = draw.instance;
+                pushedTexture = submesh.texture;
+            }
+
+            if (mDrawCulling) {
+                if (submesh.numClusters == 0) {
+                    continue;
+                }
+                const SceneMesh &sceneMesh = mSceneMeshes[submesh.mesh];
+                uint32_t firstDrawCommand = mInstanceFirstDrawCommands.at(draw.instance) + (submesh.firstCluster - sceneMesh.firstCluster);
+                if (mMultiDrawIndirectEnabled) {
+                    vkCmdDrawIndexedIndirect(commandBuffer, mDrawCommandBuffer, VkDeviceSize(firstDrawCommand) * stride, submesh.numClusters, stride);
+                }
+                else {
+                    for (uint32_t i = 0; i < submesh.numClusters; i++) {
+                        vkCmdDrawIndexedIndirect(commandBuffer, mDrawCommandBuffer, VkDeviceSize(firstDrawCommand + i) * stride, 1, stride);
+                    }
+                }
+            }
+            else {
+                uint32_t instanceCount = 1;
+                int32_t vertexOffset = 0;   // the indices already point into the whole scene's vertices
+                uint32_t firstInstance = 0;
+                vkCmdDrawIndexed(commandBuffer, submesh.indexCount, instanceCount, submesh.firstIndex, vertexOffset, firstInstance);
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Records the drawing commands for one frame into the frame context's command buffer,
+        targeting the framebuffer of the swap chain image that was acquired for it.
+
+        Note:
+        - "Primary" level command buffers can be submitted to a queue for execution.
+        - "Secondary" level command buffers cannot be submitted directly, but can be submitted
+            from primary command buffers. Primary buffers cannot do this.
+
+        Also Note: These used to be recorded once per swap chain image at startup and reused
+        forever. Recording every frame is cheap (a handful of commands) and lets each frame use
+        its own descriptor sets and push constants.
+
+        And Also Note: The passes (cull, main, Hi-Z build, upscale) are recorded through the
+        frame graph (see RenderGraph). Each one says what it reads and writes, and the graph
+        puts the barriers and layout transitions between them, so none of the Record*(...)
+        functions have any of their own (other than between mip levels).
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    void RecordCommandBuffer(FrameContext &frame, uint32_t imageIndex) {
+        auto currentCommandBuffer = frame.commandBuffer;
+
+        VkCommandBufferBeginInfo commandBufferBeginInfo{};
+        commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(currentCommandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording command buffer");
+        }
+
+        // GPU timing; the query resets must happen outside of the render pass
+        mGpuProfiler.BeginFrame(currentCommandBuffer, frame.index, mCurrentFrame);
+        uint32_t framePass = mGpuProfiler.BeginPass(currentCommandBuffer, "frame");
+
+        // dynamic resolution below full scale draws the scene offscreen (see 
+        // PrepareSceneTarget()), then upscales it into the swap chain image
+        bool upscale = (mRenderExtent.width != mSwapChainExtent.width || mRenderExtent.height != mSwapChainExtent.height);
+
+        // the frame's resources, as far as the frame graph is concerned
+        // Note: A swap chain image's old contents are whatever presentation left, so every 
+        // frame starts it over as freshly acquired. Everything else carries its state over 
+        // from the last frame that used it.
+        mFrameGraph.Reset();
+        VkImage targetImage = mSwapChainImages.at(imageIndex);
+        RenderGraph::ResourceState acquiredState = RenderGraph::ResourceState::After(ResourceUsage::ACQUIRED);
+        RenderGraph::ResourceState &targetState = mOptions.headless ? mOffscreenTargets.at(imageIndex).colorState : acquiredState;
+        RenderGraph::ResourceId target = mFrameGraph.ImportImage("target", targetImage, VK_IMAGE_ASPECT_COLOR_BIT, 1, targetState);
+        mFrameGraph.MarkOutput(target, mOptions.headless ? ResourceUsage::TRANSFER_SRC : ResourceUsage::PRESENT);
+
+        VkFormat depthFormat = FindDepthFormat();
+        VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (HasStencilComponent(depthFormat)) {
+            depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+
+        RenderGraph::ResourceId sceneColor = target;
+        RenderGraph::ResourceId depth = 0;
+        VkImageView depthView = VK_NULL_HANDLE;
+        if (upscale) {
+            RenderGraph::TransientImageDesc colorDesc{};
+            colorDesc.extent = mSceneTarget.extent;
+            colorDesc.format = mSwapChainImageFormat;
+            colorDesc.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            colorDesc.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            sceneColor = mFrameGraph.CreateTransientImage("scene-color", colorDesc);
+
+            RenderGraph::TransientImageDesc depthDesc{};
+            depthDesc.extent = mSceneTarget.extent;
+            depthDesc.format = depthFormat;
+            depthDesc.usage = GetDepthImageUsage();
+            depthDesc.aspect = depthAspect;
+            depth = mFrameGraph.CreateTransientImage("scene-depth", depthDesc);
+        }
+        else if (mOptions.headless) {
+            OffscreenTarget &offscreenTarget = mOffscreenTargets.at(imageIndex);
+            depth = mFrameGraph.ImportImage("depth", offscreenTarget.depthImage, depthAspect, 1, offscreenTarget.depthState);
+            depthView = offscreenTarget.depthImageView;
+        }
+        else {
+            depth = mFrameGraph.ImportImage("depth", mDepthImage, depthAspect, 1, mDepthImageState);
+            depthView = mDepthImageView;
+        }
+
+        RenderGraph::ResourceId drawCommands = 0;
+        RenderGraph::ResourceId clusters = 0;
+        RenderGraph::ResourceId cullInstances = 0;
+        if (mClusterCullingEnabled) {
+            drawCommands = mFrameGraph.ImportBuffer("draw-commands", mDrawCommandBuffer, mDrawCommandBufferState);
+            clusters = mFrameGraph.ImportBuffer("clusters", mClusterBuffer, mClusterBufferState);
+            cullInstances = mFrameGraph.ImportBuffer("cull-instances", mCullInstanceBuffer, mCullInstanceBufferState);
+        }
+        RenderGraph::ResourceId hiZ = 0;
+        if (mHiZEnabled) {
+            hiZ = mFrameGraph.ImportImage("hiz", mHiZ.image, VK_IMAGE_ASPECT_COLOR_BIT, mHiZ.mipLevels, mHiZ.state);
+        }
+
+        // cluster culling writes this frame's draws before the render pass reads them
+        if (mDrawCulling) {
+            RenderGraph::PassBuilder cull = mFrameGraph.AddPass("cull", [this](VkCommandBuffer commandBuffer) {
+                uint32_t cullPass = mGpuProfiler.BeginPass(commandBuffer, "cull");
+                RecordClusterCull(*mFrameGraphInputs.frame);
+                mGpuProfiler.EndPass(commandBuffer, cullPass);
+            });
+            cull.Read(clusters, ResourceUsage::COMPUTE_STORAGE_READ);
+            cull.Read(cullInstances, ResourceUsage::COMPUTE_STORAGE_READ);
+            if (mHiZEnabled) {
+                cull.Read(hiZ, ResourceUsage::COMPUTE_SAMPLED);
+            }
+            cull.Write(drawCommands, ResourceUsage::COMPUTE_STORAGE_WRITE);
+        }
+
+        // next frame's occlusion culling tests against this frame's depth
+        // Note: Only if there will be a next frame's culling to read it. Otherwise there's no 
+        // Hi-Z build, and the depth doesn't even need to be stored.
+        bool buildHiZ = mHiZEnabled && mDrawCulling;
+
+        // for the passes (see FrameGraphInputs)
+        mFrameGraphInputs.frame = &frame;
+        mFrameGraphInputs.imageIndex = imageIndex;
+        mFrameGraphInputs.upscale = upscale;
+        mFrameGraphInputs.buildHiZ = buildHiZ;
+        mFrameGraphInputs.targetImage = targetImage;
+        mFrameGraphInputs.sceneColor = sceneColor;
+        mFrameGraphInputs.depth = depth;
+        mFrameGraphInputs.depthView = depthView;
+
+        RenderGraph::PassBuilder mainPassBuilder = mFrameGraph.AddPass("main", [this](VkCommandBuffer currentCommandBuffer) {
+            FrameContext &frame = *mFrameGraphInputs.frame;
+            bool upscale = mFrameGraphInputs.upscale;
+            uint32_t imageIndex = mFrameGraphInputs.imageIndex;
+            bool buildHiZ = mFrameGraphInputs.buildHiZ;
+            uint32_t mainPass = mGpuProfiler.BeginPass(currentCommandBuffer, "main");
+            mGpuProfiler.BeginStatistics(currentCommandBuffer);
+
+            VkRenderPassBeginInfo renderPassBeginInfo{};
+            renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassBeginInfo.renderPass = (mRenderPassDepthDiscarded != VK_NULL_HANDLE && !buildHiZ) ? mRenderPassDepthDiscarded : mRenderPass;
+            renderPassBeginInfo.framebuffer = upscale ? mSceneTarget.framebuffer : mSwapChainFramebuffers.at(imageIndex);
+            renderPassBeginInfo.renderArea.offset = { 0, 0 };
+            renderPassBeginInfo.renderArea.extent = mRenderExtent;
+
+            // defines the colors for the color and depth attachments' .loadOp = 
+            // VK_ATTACHMENT_LOAD_OP_CLEAR
+            // Note: For depth, clear to 1.0f because closer to 0 (as long as it is between 0-1) 
+            // take precedence, so if we were to clear the depth to 0 (closest possible value), 
+            // then the cleared color would be all that we would see. 
+            // Also Note: The second depth clear value is "stencil", which is not in yse right now 
+            // (1/20/2019).
+            std::array<VkClearValue, 2> clearValues{};
+            clearValues.at(0).color = { 0.0, 0.0f, 0.0f, 1.0f };
+            clearValues.at(1).depthStencil = { mOptions.reversedZ ? 0.0f : 1.0f, 0 };   // farthest
+            renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassBeginInfo.pClearValues = clearValues.data();
+
+            vkCmdBeginRenderPass(currentCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            {
+                VkPipelineBindPoint graphicsBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+                // dynamic state (see BuildGraphicsPipeline(...))
+                // Note: Vulkan's rectangle uses "offset" and "extent" instead of "x,y" and 
+                // "width,height". They work out to the same thing though.
+                VkViewport viewport{};
+                viewport.x = 0.0f;
+                viewport.y = 0.0f;
+                viewport.width = static_cast<float>(mRenderExtent.width);
+                viewport.height = static_cast<float>(mRenderExtent.height);
+                viewport.minDepth = 0.0f;
+                viewport.maxDepth = 1.0f;
+                vkCmdSetViewport(currentCommandBuffer, 0, 1, &viewport);
+
+                VkRect2D scissor{};
+                scissor.offset = VkOffset2D{ 0,0 };
+                scissor.extent = mRenderExtent;
+                vkCmdSetScissor(currentCommandBuffer, 0, 1, &scissor);
+
+                VkDeviceSize offset = 0;
+                vkCmdBindIndexBuffer(currentCommandBuffer, mVertexIndexBuffer, offset, VK_INDEX_TYPE_UINT32);
+
+                // set 0 (per-frame) and set 1 (material) are adjacent, so bind both at once
+                // Note: In bindless mode, set 1 holds every texture, so it never needs to be 
+                // rebound between draws; the material ID push constant picks the texture.
+                std::array<VkDescriptorSet, 2> descriptorSets{
+                    frame.perFrameDescriptorSet,
+                    mUseBindlessTextures ? mBindlessDescriptorSet : mTextures.at(0).descriptorSet,
+                };
+                uint32_t firstDescriptorSetIndex = 0;
+                uint32_t descriptorSetCount = static_cast<uint32_t>(descriptorSets.size());
+                uint32_t dynamicOffsetCount = 0;    // not considering dynamic descriptors now (1/1/2019)
+                vkCmdBindDescriptorSets(
+                    currentCommandBuffer,
+                    graphicsBindPoint,
+                    mPipelineLayout,
+                    firstDescriptorSetIndex,
+                    descriptorSetCount,
+                    descriptorSets.data(),
+                    dynamicOffsetCount,
+                    nullptr);
+
+                // Note: The per-object push constants (and, without bindless, the texture's set) 
+                // change from draw to draw, so RecordSceneDraw(...) does those.
+
+                uint32_t firstBindingIndex = Vertex::VERTEX_BUFFER_BINDING_LOCATION;
+                uint32_t bindingCounter = 1;
+                VkDeviceSize offsets[] = { 0 };
+
+                // subpass 0 of the render pass when there is a pre-pass: depth only
+                // Note: The layouts, descriptor sets, and dynamic state above carry across 
+                // subpasses. Only the pipeline and vertex buffer change. Turning the pre-pass off 
+                // (mDrawPrepass) leaves an empty subpass, and the main draw falls back to a 
+                // pipeline that tests and writes depth as usual (see GetMainDrawStage()).
+                if (mDepthPrepassEnabled) {
+                    if (mDrawPrepass) {
+                        // Note: The alpha-tested variant has to sample the texture, so it takes 
+                        // whole vertices instead of positions. Every other feature mask comes 
+                        // out as the same description, and so the same pipeline, as the plain 
+                        // pre-pass (see GetPipelineDescription(...)).
+                        VkPipeline positionsOnlyPipeline = mPipelineManager.Get(mPrepassPipelineKey);
+                        VkPipeline prepassPipeline = mPipelineManager.Get(GetPipelineVariant(mDrawFeatures, DrawStage::DEPTH_PREPASS), mPrepassPipelineKey);
+                        VkBuffer prepassVertexBuffers[] = { (prepassPipeline == positionsOnlyPipeline) ? mPositionBuffer : mVertexBuffer };
+                        vkCmdBindPipeline(currentCommandBuffer, graphicsBindPoint, prepassPipeline);
+                        vkCmdBindVertexBuffers(currentCommandBuffer, firstBindingIndex, bindingCounter, prepassVertexBuffers, offsets);
+                        RecordSceneDraw(currentCommandBuffer);
+                    }
+                    vkCmdNextSubpass(currentCommandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+                }
+
+                // Note: Until the variant for these features has compiled, this is the main 
+                // pipeline (see PipelineManager::Get(...)).
+                vkCmdBindPipeline(currentCommandBuffer, graphicsBindPoint, mPipelineManager.Get(GetPipelineVariant(mDrawFeatures, GetMainDrawStage())));
+
+                VkBuffer vertexBuffers[] = { mVertexBuffer };
+                vkCmdBindVertexBuffers(currentCommandBuffer, firstBindingIndex, bindingCounter, vertexBuffers, offsets);
+                RecordSceneDraw(currentCommandBuffer);
+            }
+            vkCmdEndRenderPass(currentCommandBuffer);
+
+            mGpuProfiler.EndStatistics(currentCommandBuffer);
+            mGpuProfiler.EndPass(currentCommandBuffer, mainPass);
+        });
+        if (mDrawCulling) {
+            mainPassBuilder.Read(drawCommands, ResourceUsage::INDIRECT_READ);
+        }
+
+        // the render pass clears both, so whatever was in them before doesn't matter
+        mainPassBuilder.Write(sceneColor, ResourceUsage::COLOR_ATTACHMENT, true);
+        mainPassBuilder.Write(depth, ResourceUsage::DEPTH_ATTACHMENT, true);
+
+        RenderGraph::PassId hiZPassId = 0;
+        if (buildHiZ) {
+            RenderGraph::PassBuilder hiZBuild = mFrameGraph.AddPass("hiz", [this](VkCommandBuffer commandBuffer) {
+                uint32_t hiZPass = mGpuProfiler.BeginPass(commandBuffer, "hiz");
+                FrameContext &frame = *mFrameGraphInputs.frame;
+                RenderGraph::ResourceId depth = mFrameGraphInputs.depth;
+                VkImageView depthView = mFrameGraphInputs.depthView;
+                VkImageView view = (depthView != VK_NULL_HANDLE) ? depthView : mFrameGraph.GetImageView(depth);
+                RecordHiZBuild(frame, mFrameGraph.GetImage(depth), view, mRenderExtent);
+                mGpuProfiler.EndPass(commandBuffer, hiZPass);
+            });
+            hiZBuild.Read(depth, ResourceUsage::COMPUTE_SAMPLED_DEPTH);
+            hiZBuild.Write(hiZ, ResourceUsage::COMPUTE_STORAGE_READ_WRITE);
+            hiZPassId = hiZBuild.GetId();
+            mFrameGraph.MarkOutput(hiZ);
+        }
+
+        if (upscale) {
+            RenderGraph::PassBuilder upscaleBuilder = mFrameGraph.AddPass("upscale", [this](VkCommandBuffer commandBuffer) {
+                uint32_t upscalePass = mGpuProfiler.BeginPass(commandBuffer, "upscale");
+                RecordUpscale(commandBuffer, mFrameGraph.GetImage(mFrameGraphInputs.sceneColor), mFrameGraphInputs.targetImage);
+                mGpuProfiler.EndPass(commandBuffer, upscalePass);
+            });
+            upscaleBuilder.Read(sceneColor, ResourceUsage::TRANSFER_SRC);
+            upscaleBuilder.Write(target, ResourceUsage::TRANSFER_DST, true);
+        }
+
+        // the scene images (if any) exist once the graph has been compiled
+        mFrameGraph.Compile();
+        if (upscale) {
+            UpdateSceneFramebuffer(mFrameGraph.GetImageView(sceneColor), mFrameGraph.GetImageView(depth));
+        }
+        else {
+            RetireSceneTarget();
+        }
+        mFrameGraph.Execute(currentCommandBuffer);
+        if (!buildHiZ || !mFrameGraph.IsPassLive(hiZPassId)) {
+            mHiZValid = false;
+        }
+
+        mGpuProfiler.EndPass(currentCommandBuffer, framePass);
+        mGpuProfiler.EndFrame();
+        if (vkEndCommandBuffer(currentCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer");
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Creates the ring of frame contexts. Each one gets:
+        - its own command pool (reset wholesale every frame instead of per command buffer)
+        - its own slice of the uniform buffer
+        - its own descriptor allocator (reset wholesale every frame)
+        - the semaphores that will let the
+            "acquire image" ->
+            "execute command buffer" ->
+            "return to swap chain" events occur in order
+        - a graphics timeline value that tells the CPU when the GPU is done with all of the above
+    Creator:    John Cox, 11/2018
+    ---------------------------------------------------------------------------------------------*/
+    void CreateFrameContexts() {
+        mFrameContexts.resize(mOptions.framesInFlight);
+        mImagesInFlight.assign(mSwapChainImageViews.size(), 0);
+
+        QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(mPhysicalDevice);
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo{};
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for (size_t i = 0; i < mFrameContexts.size(); i++) {
+            FrameContext &frame = mFrameContexts.at(i);
+
+            // Note: "Transient" hints to the driver that the command buffers are short-lived 
+            // (re-recorded every frame).
+            VkCommandPoolCreateInfo commandPoolCreateInfo{};
+            commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+            if (vkCreateCommandPool(mLogicalDevice, &commandPoolCreateInfo, nullptr, &frame.commandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create frame command pool");
+            }
+
+            VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+            commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            commandBufferAllocateInfo.commandPool = frame.commandPool;
+            commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            commandBufferAllocateInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(mLogicalDevice, &commandBufferAllocateInfo, &frame.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate command buffers");
+            }
+
+            frame.index = static_cast<uint32_t>(i);
+            frame.uniformOffset = mUniformSliceSize * i;
+            frame.pUniformData = static_cast<char *>(mUniformBufferMapped) + frame.uniformOffset;
+
+            // Note: Culling and the Hi-Z build allocate their sets here too, one per Hi-Z level 
+            // (or one with a dozen storage images, with the downsampler), so a frame with them 
+            // on wants a dozen or more.
+            // Also Note: A downsample set alone has DOWNSAMPLE_MAX_MIPS storage images, so the 
+            // storage image ratio is sized so that every pool has room for that many per set, 
+            // and the frame's first downsample doesn't overflow the pool and force a new one.
+            std::vector<DescriptorAllocator::PoolSizeRatio> ratios{
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f },
+                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f },
+                { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, static_cast<float>(DOWNSAMPLE_MAX_MIPS) },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0.5f },
+            };
+            uint32_t initialSetsPerFrame = 16;
+            frame.descriptorAllocator.Init(mLogicalDevice, initialSetsPerFrame, ratios);
+
+            if (vkCreateSemaphore(mLogicalDevice, &semaphoreCreateInfo, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+                vkCreateSemaphore(mLogicalDevice, &semaphoreCreateInfo, nullptr, &frame.renderFinished) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create synchronization objects for a frame");
+            }
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Sets up GPU timestamp and pipeline statistics queries, one set per frame context.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void CreateGpuProfiler() {
+        QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(mPhysicalDevice);
+        uint32_t numFrameSlots = static_cast<uint32_t>(mFrameContexts.size());
+        mGpuProfiler.Init(mLogicalDevice, mPhysicalDevice, queueFamilyIndices.graphicsFamily.value(), numFrameSlots, mPipelineStatisticsEnabled);
+        mGpuProfiler.SetReporting(mOptions.gpuStatsInterval, mOptions.gpuStatsCsvPath);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Called when GLFW detects a change in the size of the renderable area.
+
+        Note: Created static because GLFW callback registration function was built with C-style
+        function pointers in mind and therefore does not know how to call a member function with
+        the correct "this" pointer.
+    Creator:    John Cox, 12/2018
+    ---------------------------------------------------------------------------------------------*/
+    static void FramebufferResizeCallback(GLFWwindow *window, int width, int height) {
+        auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        RenderCommand command{};
+        command.type = RenderCommand::RESIZE;
+        command.width = static_cast<uint32_t>(width);
+        command.height = static_cast<uint32_t>(height);
+        app->PushRenderCommand(command);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Mouse wheel zooms the camera in and out.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static void ScrollCallback(GLFWwindow *window, double xOffset, double yOffset) {
+        auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        RenderCommand command{};
+        command.type = RenderCommand::CAMERA_ZOOM;
+        command.zoomDelta = static_cast<float>(-yOffset) * 0.1f;
+        app->PushRenderCommand(command);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Tells the renderer to stop (in particular, it may be waiting for a minimized window to
+        come back).
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    static void WindowCloseCallback(GLFWwindow *window) {
+        auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        RenderCommand command{};
+        command.type = RenderCommand::QUIT;
+        app->PushRenderCommand(command);
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Main thread only. The queue is big enough that it should never actually be full, but if
+        the render thread has fallen that far behind then camera input is dropped (the next 
+        scroll will be along shortly) and anything else waits for space.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void PushRenderCommand(const RenderCommand &command) {
+        while (!mRenderCommands.TryPush(command)) {
+            if (command.type == RenderCommand::CAMERA_ZOOM || mRenderThreadExited.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Render thread (or, single threaded, DrawFrame()) only. Applies everything that the main
+        thread has sent since the last frame.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void ProcessRenderCommands() {
+        RenderCommand command{};
+        while (mRenderCommands.TryPop(command)) {
+            switch (command.type) {
+            case RenderCommand::RESIZE:
+                mFramebufferWidth = command.width;
+                mFramebufferHeight = command.height;
+                mFrameBufferResized = true;
+                break;
+            case RenderCommand::CAMERA_ZOOM:
+                // Note: The orbit brings the camera as close as 1 + zoom along each axis (see 
+                // UpdateUniformBuffer(...)), so at -1 the eye would land on the target and the 
+                // view transform would come out as NaNs. -0.5 keeps it at least 0.5 away.
+                mCameraZoom = std::min(std::max(mCameraZoom + command.zoomDelta, -0.5f), 5.0f);
+                break;
+            case RenderCommand::QUIT:
+                mQuitRequested = true;
+                break;
+            default:
+                break;
             }
         }
-        throw std::runtime_error("failed to find suitable memory type");
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Creates a VkBuffer of the requested type, then allocates memory for it with the requested
-        memory usage and properties (specifying these allows the driver to optimize where it can).
-    Creator:    John Cox, 12/2018
+        Creates a GLFW window (??anything else??).
+    Creator:    John Cox, 10/2018M
     ---------------------------------------------------------------------------------------------*/
-    void CreateBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags memProperties, VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
-        VkBufferCreateInfo bufferCreateInfo{};
-        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferCreateInfo.size = bufferSize;
-        bufferCreateInfo.usage = bufferUsage;
-
-        // only in use by one queue family (graphics queue)
-        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    void InitWindow() {
+        if (mOptions.headless) {
+            // no window, and no monitor to pace to
+            mFramePacer.Init(false, 0.0);
+            return;
+        }
 
-        if (vkCreateBuffer(mLogicalDevice, &bufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create vertex buffer");
+        if (glfwInit() != GLFW_TRUE) {
+            return;
         }
 
-        VkMemoryRequirements memoryRequirements;
-        vkGetBufferMemoryRequirements(mLogicalDevice, buffer, &memoryRequirements);
+        // Note: GLFW was originally designed to create an OpenGL context. Possible "client API"
+        // values are OpenGL or OpenGL ES. At this time (10/20/2018), there is no option for
+        // Vulkan, so tell it to use "no API".
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
-        VkMemoryAllocateInfo memoryAllocateInfo{};
-        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = FindMemoryType(memoryRequirements.memoryTypeBits, memProperties);
-        if (vkAllocateMemory(mLogicalDevice, &memoryAllocateInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate vertex buffer memory");
-        }
+        GLFWmonitor *monitor = nullptr;
+        mWindow = glfwCreateWindow(mWindowWidth, mWindowHeight, "Vulkan", monitor, nullptr);
+        glfwSetWindowUserPointer(mWindow, this);    // gets a class pointer into callback function
+        glfwSetFramebufferSizeCallback(mWindow, FramebufferResizeCallback);
+        glfwSetScrollCallback(mWindow, ScrollCallback);
+        glfwSetWindowCloseCallback(mWindow, WindowCloseCallback);
 
-        uint32_t memoryOffset = 0;
-        vkBindBufferMemory(mLogicalDevice, buffer, bufferMemory, memoryOffset);
+        // after this, the size only changes through RESIZE commands
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(mWindow, &width, &height);
+        mFramebufferWidth = static_cast<uint32_t>(width);
+        mFramebufferHeight = static_cast<uint32_t>(height);
+
+        // if no target was given, pace to the monitor
+        double targetFps = mOptions.targetFps;
+        if (targetFps <= 0.0) {
+            const GLFWvidmode *videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+            targetFps = (videoMode != nullptr && videoMode->refreshRate > 0) ? videoMode->refreshRate : 60.0;
+        }
+        mFramePacer.Init(mOptions.lowLatency, 1000.0 / targetFps);
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Copies from the non-device-local host-visible buffer to the device-local non-host-visible
-        buffer.
-    Creator:    John Cox, 12/2018
-    ---------------------------------------------------------------------------------------------*/
-    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        VkCommandBuffer commandBuffer = BeginSingleUseCommandBuffer();
+        Governs the initialization of a Vulkan instance and devices.
 
-        VkBufferCopy copyRegion{};
-        copyRegion.size = size;
-        uint32_t regionCount = 1;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, &copyRegion);
+        Most of the steps don't actually depend on each other. The slow CPU-side work (decoding
+        the textures, parsing the OBJs, reading the shader binaries) doesn't need a device at all,
+        so it runs alongside instance/device/swap chain creation. The steps are a task graph 
+        (see TaskScheduler) rather than a list, and each task lists exactly what it needs.
 
-        SubmitAndEndSingleUseCommandBuffer(commandBuffer);
-    }
+        Every texture and every mesh in the scene is its own task, so they all load at once.
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        With not only vertex buffers needing copying but also texture images needing initial
-        processing, this common code for the beginning of a one-time command buffer was broken
-        into two dedicated functions to prevent copying.
-    Creator:    John Cox, 01/2019
+        All GPU uploads (depth image transition, texture copies and mipmaps, vertex and index
+        buffers) are recorded into one command buffer and submitted once, at the point where
+        everything that they need is ready.
+
+        Note: Only the upload task records commands or submits to a queue during startup, so
+        the command pool and the queue don't need any locking.
+    Creator:    John Cox, 10/2018
     ---------------------------------------------------------------------------------------------*/
-    VkCommandBuffer BeginSingleUseCommandBuffer() {
-        VkCommandBufferAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocateInfo.commandPool = mCommandPool;
-        allocateInfo.commandBufferCount = 1;
+    void InitVulkan() {
+        uint32_t numWorkers = 0;
+        if (!mOptions.serialInit) {
+            // the calling thread works too
+            numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+        mTaskScheduler.Start(numWorkers);
 
-        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-        vkAllocateCommandBuffers(mLogicalDevice, &allocateInfo, &commandBuffer);
+        // Note: Not a task. The task graph can't change once it's running, and the manifest is 
+        // what says how many textures and meshes there are to load.
+        if (!mOptions.scenePath.empty()) {
+            mScene.LoadFromFile(mOptions.scenePath);
+        }
+        mDecodedTextures.resize(mScene.GetTextures().size());
+        mTextures.resize(mScene.GetTextures().size());
+        mLoadedMeshes.resize(mScene.GetMeshes().size());
+
+        TaskScheduler &ts = mTaskScheduler;
+        using TaskId = TaskScheduler::TaskId;
+
+        // no device needed
+        std::vector<TaskId> decodeTextures;
+        for (uint32_t i = 0; i < mScene.GetTextures().size(); i++) {
+            std::string name = "DecodeTexture " + mScene.GetTextures()[i].name;
+            decodeTextures.push_back(ts.AddTask(name, [this, i]() { DecodeTextureImage(i); }));
+        }
+        std::vector<TaskId> loadMeshes;
+        for (uint32_t i = 0; i < mScene.GetMeshes().size(); i++) {
+            std::string name = "LoadMesh " + mScene.GetMeshes()[i].name;
+            loadMeshes.push_back(ts.AddTask(name, [this, i]() { LoadMesh(i); }));
+        }
+        TaskId buildScene = ts.AddTask("BuildSceneGeometry", [this]() { BuildSceneGeometry(); }, loadMeshes);
+        TaskId loadShaders = ts.AddTask("LoadShaderBinaries", [this]() { LoadShaderBinaries(); });
+        TaskId readPipelineCache = ts.AddTask("ReadPipelineCacheFile", [this]() {
+            if (!mOptions.pipelineCachePath.empty()) {
+                mPipelineCache.ReadFile(mOptions.pipelineCachePath);
+            }
+        });
+        TaskId readPrewarmList = ts.AddTask("ReadPipelinePrewarmList", [this]() {
+            if (!mOptions.pipelinePrewarmPath.empty()) {
+                mPrewarmList = PipelineManager::LoadPrewarmList(mOptions.pipelinePrewarmPath);
+            }
+        });
 
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        TaskId instance = ts.AddTask("CreateInstance", [this]() { CreateInstance(); });
+        TaskId surface = ts.AddTask("CreateSurface", [this]() { CreateSurface(); }, { instance });
+        TaskId physicalDevice = ts.AddTask("PickPhysicalDevice", [this]() { PickPhysicalDevice(); }, { surface });
+        TaskId device = ts.AddTask("CreateLogicalDevice", [this]() { CreateLogicalDevice(); }, { physicalDevice });
 
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-        return commandBuffer;
+        TaskId swapChain = ts.AddTask(mOptions.headless ? "CreateOffscreenTargets" : "CreateSwapChain", [this]() {
+            if (mOptions.headless) {
+                CreateOffscreenTargets();
+            }
+            else {
+                CreateSwapChain();
+            }
+        }, { device });
+        TaskId renderPass = ts.AddTask("CreateRenderPass", [this]() { CreateRenderPass(); }, { swapChain });
+        TaskId setLayouts = ts.AddTask("CreateDescriptorSetLayout", [this]() { CreateDescriptorSetLayout(); }, { device });
+        TaskId updateTemplates = ts.AddTask("CreateDescriptorUpdateTemplates", [this]() { CreateDescriptorUpdateTemplates(); }, { setLayouts });
+        TaskId pipelineCache = ts.AddTask("CreatePipelineCache", [this]() { mPipelineCache.Create(mLogicalDevice, mPhysicalDevice); }, { device, readPipelineCache });
+        ts.AddTask("CreateGraphicsPipeline", [this]() {
+            mShaderModules.Init(mLogicalDevice);
+            StartPipelineManager();
+            CreateGraphicsPipeline();
+            CreateComputePipelines();
+
+            // last run's variants compile in the background from here on
+            // Note: Pre-pass render passes don't exist unless the pre-pass is on this run.
+            if (!mDepthPrepassEnabled) {
+                mPrewarmList.erase(std::remove_if(mPrewarmList.begin(), mPrewarmList.end(), [](const PipelineDescription &description) {
+                    return description.renderPass != "main";
+                }), mPrewarmList.end());
+            }
+            mPipelineManager.Prewarm(mPrewarmList);
+        }, { renderPass, setLayouts, loadShaders, pipelineCache, readPrewarmList });
+        TaskId commandPool = ts.AddTask("CreateCommandPool", [this]() { CreateCommandPool(); }, { device });
+        TaskId sampler = ts.AddTask("CreateTextureSampler", [this]() { CreateTextureSampler(); }, { device });
+        TaskId uniformBuffers = ts.AddTask("CreateUniformBuffers", [this]() { CreateUniformBuffers(); }, { device });
+        TaskId descriptorAllocator = ts.AddTask("CreateDescriptorAllocator", [this]() { CreateDescriptorAllocator(); }, { device });
+        ts.AddTask("CreateFrameGraph", [this]() {
+            mFrameGraph.Init(mLogicalDevice, mPhysicalDevice, [this](std::function<void()> destroy) { DeferDestruction(std::move(destroy)); });
+        }, { device });
+
+        // the join point for everything that has to go to the GPU
+        std::vector<TaskId> uploadDependencies{ commandPool, swapChain, buildScene };
+        uploadDependencies.insert(uploadDependencies.end(), decodeTextures.begin(), decodeTextures.end());
+        TaskId uploads = ts.AddTask("UploadAssets", [this]() {
+            BeginUploadBatch();
+            CreateDepthResources();
+            CreateHiZPyramid();
+            for (uint32_t i = 0; i < mTextures.size(); i++) {
+                CreateTextureImage(i);
+            }
+            CreateVertexBuffer();
+            CreateVertexIndexBuffer();
+            if (mDepthPrepassEnabled) {
+                CreatePositionBuffer();
+            }
+            if (mClusterCullingEnabled) {
+                BuildMeshClusters();
+                CreateClusterBuffers();
+            }
+            EndUploadBatch();
+        }, uploadDependencies);
+
+        ts.AddTask("CreateFramebuffers", [this]() { CreateFramebuffers(); }, { renderPass, uploads });
+        ts.AddTask("CreateDescriptorSets", [this]() { CreateDescriptorSets(); }, { updateTemplates, descriptorAllocator, uploads, sampler });
+        TaskId frameContexts = ts.AddTask("CreateFrameContexts", [this]() { CreateFrameContexts(); }, { swapChain, uniformBuffers });
+        ts.AddTask("CreateGpuProfiler", [this]() { CreateGpuProfiler(); }, { frameContexts });
+
+        ts.Run();
+
+        // Note: Not a task. Nothing waits for it on the CPU, and it needs the frame contexts 
+        // (for DeferDestruction(...)) and a queue that no task is submitting to any more.
+        SubmitPendingMipMaps();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        This is the second half of the common code used in executing a one-time command buffer.
+        Updates the uniform buffer for the current frame so that the vertex shader will have the
+        correct transforms.
+
+        Note: GLM was designed for OpenGL ("GLM" = "GL Math"), in which the Y values in the
+        Normalized Device Coordinates (NDC) increased from bottom to top. This was chosen because
+        cartesian coordinates in 2D graphs start at (0,0) and increase going right (+x) and up
+        (+y). Early text editors were terminals (ex: Command Prompt in Windows), in which the
+        first character was entered in the upper left, as we English speakers expect of our text,
+        and early image processing (ASCII characters, not pixels) leveraged this text mechanism,
+        thereby declaring (0,0) to also be the upper left, and it never changed when image
+        processing became pixel-based and there was no longer any technical reason to be the upper
+        left. Direct3D followed image processing. And OpenGL didn't change, so as far as the rest
+        of the image processing world is concerned, OpenGL (and therefore GLM) is upside down.
+
+        That's why we flip projection's Y.
     Creator:    John Cox, 01/2019
     ---------------------------------------------------------------------------------------------*/
-    void SubmitAndEndSingleUseCommandBuffer(VkCommandBuffer commandBuffer) {
-        vkEndCommandBuffer(commandBuffer);
+    void UpdateUniformBuffer(FrameContext &frame) {
+        static auto startTime = std::chrono::high_resolution_clock::now();
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        // Note: The model transform is per-object and is no longer part of the UBO. See the 
+        // scene's instances and the push constants in RecordSceneDraw(...).
 
-        uint32_t submitCount = 1;
-        VkFence nullFence = VK_NULL_HANDLE;
-        vkQueueSubmit(mGraphicsQueue, submitCount, &submitInfo, nullFence);
-        vkQueueWaitIdle(mGraphicsQueue);
+        // eye at (2,2,2), looking at (0,0,0), with Z axis as "up"
+        // Note: Flip the camera's "up" (in this case Z) axis from + to - as an alternative to 
+        // dealing with the counterclockwise face culling problem that is currently dealt with by 
+        // flipping one of the projection transform's Y axes.
+        // Also Note: Benchmarks follow a path by frame number instead so that every run (and 
+        // every variant or configuration within a run) renders the same frames.
+        float zoomAxis = sinf(time / 2.0f);
+        float distance = 2.0f + zoomAxis + mCameraZoom;
+        glm::vec3 eye(distance, distance, distance);
+        glm::vec3 target(0.0f, 0.0f, 0.0f);
+        if (mOptions.benchmark || mOptions.variantBenchmark || mOptions.occlusionBenchmark) {
+            mCameraPath.Evaluate(mCurrentFrame - mCameraPathFirstFrame, eye, target);
+        }
+        glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, 0.0f, 1.0f));
+        view[1][1] *= +1;
 
-        uint32_t commandBufferCount = 1;
-        vkFreeCommandBuffers(mLogicalDevice, mCommandPool, commandBufferCount, &commandBuffer);
+        // Note: If the screen was resized and the swap chain had to be recreated, this 
+        // calculation will use the latest values, and so RecreateSwapChain(...) doesn't have to 
+        // handle that.
+        // Also Note: We *could* make it do that because the perspective projection (that is, the 
+        // camera->projection transform) is constant for a given screen size, but we aren't 
+        // because then we'd have to split the UBO population between this function and that 
+        // function, and that would be a bit of an encapsulation pain.
+        float aspectRatio = mSwapChainExtent.width / static_cast<float>(mSwapChainExtent.height);
+        glm::mat4 proj = MakeProjection(glm::radians(45.0f), aspectRatio, mOptions.nearPlane, mOptions.farPlane, mOptions.reversedZ);
+
+        // Note: See the vertex structure's description for more detail, but in essance, this 
+        // tutorial is considered counterclockwise faces to be the front, but positioning the 
+        // camera ("eye"/"view") as it is moves the vertices such that they draw clockwise, and so 
+        // the tutorial flipped the Y on the projection matrix. I experimented and found that 
+        // flipping view[1][1] in the same way doesn't work, so this hack on the Y axis only works 
+        // in the projection matrix. This could also be achieved by flipping the camera's Z axis 
+        // over from + to -, or by rearranging the vertices to draw differently. For whatever 
+        // reason, he went with this approach. In the long rong, it is probably not important since 
+        // we'll start importing thousands of vertices or more from scene files.
+        proj[1][1] *= -1;
+
+        // premultiply once here rather than once per vertex in the shader
+        UniformBufferObject ubo{};
+        ubo.viewProj = proj * view;
+
+        // last frame's, for occlusion culling against last frame's depth (see cluster_cull.comp)
+        // Note: Recorded in frame order on this thread, so "last" is the frame before this one.
+        ubo.prevViewProj = mHasPrevViewProj ? mPrevViewProj : ubo.viewProj;
+        mPrevViewProj = ubo.viewProj;
+        mHasPrevViewProj = true;
+
+        // persistently mapped and host coherent, so just write it
+        memcpy(frame.pUniformData, &ubo, sizeof(ubo));
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Creates a non-device-local but host-visible and host-coherent buffer, meaning that the
-        buffer will reside in system memory, though it will have a GPU-memory equivalent, and the
-        program will have write access and that it will be immediately uploaded to the GPU upon
-        writing. This has memory copy costs though because the memory has to be sent to the GPU.
-        The vertex data is copied to this buffer once.
+        (1) Acquires an image from the swap chain
+        (2) Executes the command buffer with that image as attachment in the framebuffer (??what??)
+        (3) Returns the image to the swap chain for presentation
 
-        Then we create another buffer that is device local only and that is not host visible,
-        meaning that the memory will reside on the GPU only and that the program will not write to
-        it (that is, vkMapMemory(...) will blow up on us if we try to use it on this buffer's
-        memory). We will then issue a command to copy the memory from the first buffer to the
-        second, then dismiss the first buffer. The program will then run by accessing the
-        device-local memory.
-    Creator:    John Cox, 12/2018
+        The tutorial says that these events are executed asynchronously unless things are put in
+        place to guarantee that they execute in order. There are two synchronization mechanisms:
+        - Fence: Application can wait via vkWaitForFences(...) until the fence(s) are clear.
+        - Semaphore: Cannot be accessed from the application. These are used for the GPu to
+            synchronize operations within or accross command queues.
+
+        Note: Fences are no longer used. Timeline semaphores (see QueueTimeline) can do both: the
+        CPU can wait on a specific value and the GPU can wait on them across queues. Binary
+        semaphores are only still used for acquire and present because the swap chain requires
+        them.
+    Creator:    John Cox, 11/2018
     ---------------------------------------------------------------------------------------------*/
-    void CreateVertexBuffer() {
-        VkDeviceSize bufferSize = sizeof(mVertexes[0]) * mVertexes.size();
+    void DrawFrame() {
+        using Clock = std::chrono::high_resolution_clock;
+        auto frameStartTime = Clock::now();
+        mFrameProfiler.BeginFrame(mCurrentFrame);
+        if (mFrameContextStats.numFrames == 0) {
+            mFrameContextStats.firstFrameTime = frameStartTime;
+        }
 
-        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        VkBuffer stagingBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
-        CreateBuffer(bufferSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
+        // don't reuse a frame context until the GPU is done with everything that it was last 
+        // used for
+        FrameContext &frame = mFrameContexts.at(mCurrentFrame % mFrameContexts.size());
+        bool alreadyRetired = (GetCompletedTimelineValue(mGraphicsTimeline) >= frame.timelineValue);
+        WaitForTimelineValue(mGraphicsTimeline, frame.timelineValue);
+        auto retiredTime = Clock::now();
+        if (frame.submitted) {
+            // Note: If the value was already reached, then the CPU never got ahead of the GPU, 
+            // and the retire latency is only an upper bound (the value was reached sometime 
+            // before we checked).
+            if (!alreadyRetired) {
+                mFrameContextStats.numStalledFrames++;
+            }
+            mFrameContextStats.totalRetireWaitMs += std::chrono::duration<double, std::milli>(retiredTime - frameStartTime).count();
+            mFrameContextStats.totalRetireLatencyMs += std::chrono::duration<double, std::milli>(retiredTime - frame.submitTime).count();
+            mFrameContextStats.numRetireLatencySamples++;
+        }
 
-        void *data = nullptr;
-        VkDeviceSize offset = 0;
-        VkMemoryMapFlags flags = 0;
-        vkMapMemory(mLogicalDevice, stagingBufferMemory, offset, bufferSize, flags, &data);
-        memcpy(data, mVertexes.data(), static_cast<size_t>(bufferSize));
-        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+        // anything retired a while ago (ex: an old swap chain) can go now
+        RunDeferredDestructions(false);
+        ReloadChangedShaders();
 
-        bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-        CreateBuffer(bufferSize, bufferUsage, memProperties, mVertexBuffer, mVertexBufferMemory);
+        // the GPU is done with this context, so its queries are ready
+        if (mGpuProfiler.CollectResults(frame.index)) {
+            if (mBenchmarkMeasuring) {
+                RecordBenchmarkGpuTime(mGpuProfiler.GetLatestResults());
+            }
+            if (mDynamicResolutionEnabled) {
+                for (const auto &pass : mGpuProfiler.GetLatestResults().passes) {
+                    if (pass.name == "frame") {
+                        mResolutionScaler.AddGpuTime(pass.ms);
+                    }
+                }
+            }
+        }
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_WAIT);
+
+        // in low-latency mode, sleep until as late as we dare, then grab the freshest input
+        // Note: Input is taken here rather than at the top of MainLoop() so that anything done 
+        // with it (ex: camera movement) is as recent as possible when the frame is built.
+        // Also Note: With a render thread, the main thread has already handled the events and 
+        // queued up whatever came of them; this just picks that up.
+        mFramePacer.WaitForFrameStart();
+        if (!mOptions.headless && !mUseRenderThread) {
+            glfwPollEvents();
+        }
+        ProcessRenderCommands();
+        mFramePacer.OnInputSampled();
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_PACE);
+
+        // Note: Headless has one offscreen target per frame context, so there is nothing to 
+        // acquire; the frame context's own target is free as soon as the context is.
+        uint32_t imageIndex = frame.index;
+        if (!mOptions.headless) {
+            VkFence nullFence = VK_NULL_HANDLE;
+            uint64_t timeout_ns = std::numeric_limits<uint64_t>::max();
+            VkResult result = vkAcquireNextImageKHR(mLogicalDevice, mSwapChain, timeout_ns, frame.imageAvailable, nullFence, &imageIndex);
+            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                RecreateSwapChain();
+                mFrameProfiler.EndFrame();
+                return;
+            }
+            else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+                throw std::runtime_error("failed to acquire swap chain image");
+            }
+        }
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_ACQUIRE);
+
+        // if the swap chain handed back an image that an older frame context is still rendering 
+        // to (can happen when there are more frames in flight than swap chain images, or when 
+        // the presentation engine returns images out of order), then wait for that one too
+        // Note: Timeline values only ever go up, so unlike fences there is nothing to reset.
+        WaitForTimelineValue(mGraphicsTimeline, mImagesInFlight.at(imageIndex));
+
+        // the GPU is done with everything from this context's last use, so recycle it wholesale
+        VkCommandPoolResetFlags poolResetFlags = 0;
+        vkResetCommandPool(mLogicalDevice, frame.commandPool, poolResetFlags);
+        frame.descriptorAllocator.ResetPools();
+        AllocatePerFrameDescriptorSet(frame);
+
+        UpdateUniformBuffer(frame);
+        PrepareSceneTarget();
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_UPDATE);
+        RecordCommandBuffer(frame, imageIndex);
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_RECORD);
 
-        CopyBuffer(stagingBuffer, mVertexBuffer, bufferSize);
-        vkDestroyBuffer(mLogicalDevice, stagingBuffer, nullptr);
-        vkFreeMemory(mLogicalDevice, stagingBufferMemory, nullptr);
+        // submit the command buffer for this image
+        // Note: In short, this reads, "wait for 'image available semaphore', execute command 
+        // buffer on the render passes' color attachment, then raise the 'render finished' 
+        // semaphore".
+        // Also Note: Once all commands have been completed, the graphics timeline will reach the 
+        // returned value.
+        std::vector<SemaphoreWait> waits;
+        std::vector<VkSemaphore> binarySignals;
+        if (!mOptions.headless) {
+            SemaphoreWait acquireWait{};
+            acquireWait.semaphore = frame.imageAvailable;
+            acquireWait.stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            waits.push_back(acquireWait);
+            binarySignals.push_back(frame.renderFinished);
+        }
+        frame.timelineValue = SubmitOnTimeline(mGraphicsTimeline, frame.commandBuffer, waits, binarySignals);
+        mImagesInFlight.at(imageIndex) = frame.timelineValue;
+        frame.submitted = true;
+        frame.submitTime = Clock::now();
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_SUBMIT);
+
+        if (mOptions.headless) {
+            mFramePacer.OnFramePresented();
+            mFrameProfiler.EndPhase(FrameProfiler::PHASE_PRESENT);
+        }
+        else {
+            PresentFrame(frame, imageIndex);
+        }
+
+        //vkQueueWaitIdle(mPresentationQueue);
+        mCurrentFrame++;
+        mFrameContextStats.numFrames++;
+        if (mFrameContextStats.numFrames == 1) {
+            // time to first frame = all startup phases up to and including this one
+            mStartupTimer.Mark("FirstFrame");
+        }
+        mFrameContextStats.lastFrameTime = Clock::now();
+        mFrameProfiler.EndFrame();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        To avoid duplicate vertex data, we will tell the drawing commands to use vertex by index
-        instead of sequentially plucking out 3 vertices at a time from the vertex buffer. After
-        setting this up, the drawing will sequentially pluck out 3 indices at a time from the
-        index buffer, where it is cheaper to have duplicates (16bit duplicate indices much cheaper
-        than duplicating an entire 2x 32bit position float + 3x 32bit color float vertex).
-    Creator:    John Cox, 12/2018
+        Returns the image to the swap chain for presentation once the frame's rendering is done,
+        and recreates the swap chain if it has gone stale.
+    Creator:    John Cox, 11/2018
     ---------------------------------------------------------------------------------------------*/
-    void CreateVertexIndexBuffer() {
-        VkDeviceSize bufferSize = sizeof(mVertexIndices[0]) * mVertexIndices.size();
-
-        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        VkBuffer stagingBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
-        CreateBuffer(bufferSize, bufferUsage, memProperties, stagingBuffer, stagingBufferMemory);
-
-        void *data = nullptr;
-        VkDeviceSize offset = 0;
-        VkMemoryMapFlags flags = 0;
-        vkMapMemory(mLogicalDevice, stagingBufferMemory, offset, bufferSize, flags, &data);
-        memcpy(data, mVertexIndices.data(), static_cast<size_t>(bufferSize));
-        vkUnmapMemory(mLogicalDevice, stagingBufferMemory);
+    void PresentFrame(FrameContext &frame, uint32_t imageIndex) {
+        VkSemaphore signalSemaphores[] = { frame.renderFinished };
+        VkSwapchainKHR swapChains[] = { mSwapChain };
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = signalSemaphores; // wait on command buffer
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
 
-        bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-        memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-        CreateBuffer(bufferSize, bufferUsage, memProperties, mVertexIndexBuffer, mVertexIndexBufferMemory);
-        CopyBuffer(stagingBuffer, mVertexIndexBuffer, bufferSize);
-        vkDestroyBuffer(mLogicalDevice, stagingBuffer, nullptr);
-        vkFreeMemory(mLogicalDevice, stagingBufferMemory, nullptr);
+        // used if there were multiple swap chains that could return success/fail statuses, but 
+        // we're just using a single swap chain, so we don't need this
+        presentInfo.pResults = nullptr;
+
+        VkResult result = vkQueuePresentKHR(mPresentationQueue, &presentInfo);
+        mFramePacer.OnFramePresented();
+        mFrameProfiler.EndPhase(FrameProfiler::PHASE_PRESENT);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mFrameBufferResized) {
+            RecreateSwapChain();
+            mFrameBufferResized = false;
+        }
+        else if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to present swap chain image");
+        }
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Creates a uniform buffer for every image in the swap chain so that we neither risk running
-        over the current image-in-flight's uniforms nor have to wait for the image to finish
-        before beginning the next one. With every image having it's own uniforms, we can go as
-        fast as possible.
-
-        Note: We're going to have upload new transforms every frame, so it would be pointless to
-        create device-local memory that has to wait on a coherent staging buffer. We'll just use
-        coherent memory (as soon as it is written to in system memory, it starts uploading to the
-        GPU). The swap chain will give it a bit of time since it's busy with the current frame.
-    Creator:    John Cox, 01/2019
+        Prints how long startup took, up to and including the first frame.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateUniformBuffers() {
-        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-        VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        VkMemoryPropertyFlags memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        mUniformBuffers.resize(mSwapChainImageViews.size());
-        mUniformBuffersMemory.resize(mSwapChainImageViews.size());
-
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            CreateBuffer(bufferSize, bufferUsage, memProperties, mUniformBuffers.at(i), mUniformBuffersMemory.at(i));
-            // need to write new transforms every frame, so w'll do memory mapping later
+    void ReportStartup() const {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "Startup (" << mTaskScheduler.GetNumThreads() << (mTaskScheduler.GetNumThreads() == 1 ? " thread" : " threads") << "):";
+        for (const auto &phase : mStartupTimer.GetPhases()) {
+            ss << " " << phase.name << " " << phase.ms << " ms;";
         }
+        ss << " time to first frame " << mStartupTimer.GetTotalMs() << " ms" << std::endl;
+        ss << "Graphics pipeline: " << mPipelineCreateMs << " ms, pipeline cache " << (mPipelineCache.GetStatus().empty() ? "off" : mPipelineCache.GetStatus());
+        if (mPipelineCache.IsWarm()) {
+            ss << " (" << mPipelineCache.GetLoadedBytes() << " bytes)";
+        }
+        ss << ", " << mPrewarmList.size() << " variants prewarming" << std::endl;
+        std::cout << ss.str();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        For this tutorial at this stage (Texture mapping: Combined image sampler), we will
-        allocate a UBO and a sampler for each possible frame.
+        Writes every startup task out as a Chrome trace (open it in chrome://tracing or 
+        ui.perfetto.dev to see which tasks overlapped and what the critical path was).
 
-        Note: We could do fewer than the swap chain image size, but then we might run out, and
-        allocating more will leave some of them unused, and these things are cheap little
-        structures anyway, so just allocate 1 for each frame.
-    Creator:    John Cox, 01/2019
+        Note: CPU-side timings only, so Run() leaves it until after Cleanup().
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateDescriptorPool() {
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        poolSizes.at(0).type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes.at(0).descriptorCount = static_cast<uint32_t>(mSwapChainImageViews.size());
-        poolSizes.at(1).type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes.at(1).descriptorCount = static_cast<uint32_t>(mSwapChainImageViews.size());
-
-        VkDescriptorPoolCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        createInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        createInfo.pPoolSizes = poolSizes.data();
-        createInfo.maxSets = static_cast<uint32_t>(mSwapChainImageViews.size());
-
-        // Note: It is possible to create a "free descriptor set pool" via the 
-        // VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT flag, in which descriptor sets can 
-        // be freed and recreated at runtime. We won't be creating any descriptor sets on the fly, 
-        // so the maximum number of descriptor sets is the same as the number required.
-        createInfo.maxSets = static_cast<uint32_t>(mSwapChainImageViews.size());
-
-        if (vkCreateDescriptorPool(mLogicalDevice, &createInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor pool");
+    void WriteStartupTrace() const {
+        if (mOptions.initTracePath.empty()) {
+            return;
+        }
+        std::vector<TaskScheduler::TaskTiming> phaseEvents;
+        for (const auto &phase : mStartupTimer.GetPhases()) {
+            TaskScheduler::TaskTiming event{};
+            event.name = phase.name;
+            event.startMs = phase.startMs;
+            event.endMs = phase.startMs + phase.ms;
+            phaseEvents.push_back(event);
         }
+        double taskOffsetMs = std::chrono::duration<double, std::milli>(mTaskScheduler.GetRunStartTime() - mStartupTimer.GetStartTime()).count();
+        mTaskScheduler.WriteChromeTrace(mOptions.initTracePath, taskOffsetMs, phaseEvents);
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        A descriptor is something like a uniform or an image sampler. The descriptor (shorthand
-        for "data descriptor") tells Vulkan where this information is coming from. Info on
-        individual descriptors is generalized in the descriptor set layout setup and given exact
-        info here via VkDescriptorBufferInfo (or VkDescriptorImageInfo, or others).
-
-        Note: The designers of Vulkan did not expect users to have only one descriptor in their
-        shaders (not most of the time, at least), so we do not see a VkDescriptor structure,
-        instead only seeing VkDescriptorSet, indicating possibility for multiple descriptors. When
-        you only have one descriptor, such as in this tutorial prior to image sampling, then the
-        set is size 1 and the plural terminology is confusing.
-    Creator:    John Cox, 01/2019
+        Prints the presentation setup that was actually used (requests may have been clamped or
+        unsupported) and what the frame pacer measured.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateDescriptorSets() {
-        // create duplicate descriptor set layouts (because Vulkan expects an array of them and 
-        // cannot be told that they are all one and the same)
-        std::vector<VkDescriptorSetLayout> layouts(mSwapChainImageViews.size(), mDescriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocateInfo.descriptorPool = mDescriptorPool;
-        allocateInfo.descriptorSetCount = static_cast<uint32_t>(mSwapChainImageViews.size());
-        allocateInfo.pSetLayouts = layouts.data();
-
-        // Note: This is an "allocate" function, not a "create" function, and it allocates from a 
-        // pool that was already created, so we don't need to explicitly free or destroy the 
-        // descriptor sets. They will be destroyed when the pool is.
-        mDescriptorSets.resize(mSwapChainImageViews.size());
-        if (vkAllocateDescriptorSets(mLogicalDevice, &allocateInfo, mDescriptorSets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate descriptor sets");
+    void ReportPresentation() const {
+        if (mOptions.headless) {
+            std::cout << "Headless: " << mSwapChainExtent.width << "x" << mSwapChainExtent.height << ", " << mOffscreenTargets.size() << " offscreen targets" << std::endl;
+            return;
         }
 
-        // now we write info to the descriptor sets
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = mUniformBuffers.at(i);
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
-
-            // arguably should be called VkDescriptorSamplerInfo, but eh
-            // Note: The layout is the same value used when transitioning the texture image after 
-            // copying.
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = mTextureImageView;
-            imageInfo.sampler = mTextureSampler;
-
-            // Note: The updating of descriptor sets expects a pointer to an array, so even if we 
-            // only have a single descriptor, we will still need to pass a pointer to the "write" 
-            // structure.
-            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-            descriptorWrites.at(0).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites.at(0).dstSet = mDescriptorSets.at(i);
-            descriptorWrites.at(0).dstBinding = 0;  // same as during layout setup
-            descriptorWrites.at(0).dstArrayElement = 0;
-            descriptorWrites.at(0).descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites.at(0).descriptorCount = 1;
-            descriptorWrites.at(0).pBufferInfo = &bufferInfo;
-
-            descriptorWrites.at(1).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites.at(1).dstSet = mDescriptorSets.at(i);
-            descriptorWrites.at(1).dstBinding = 1;  // same as during layout setup
-            descriptorWrites.at(1).dstArrayElement = 0;
-            descriptorWrites.at(1).descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites.at(1).descriptorCount = 1;
-            descriptorWrites.at(1).pImageInfo = &imageInfo;
-
-            uint32_t writeCount = static_cast<uint32_t>(descriptorWrites.size());
-            uint32_t copyCount = 0; // ??why would you copy descriptors at runtime??
-            VkCopyDescriptorSet descriptorCopy{};
-            vkUpdateDescriptorSets(mLogicalDevice, writeCount, descriptorWrites.data(), copyCount, &descriptorCopy);
+        std::string presentModeName = "other";
+        switch (mPresentMode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: presentModeName = "immediate"; break;
+        case VK_PRESENT_MODE_MAILBOX_KHR: presentModeName = "mailbox"; break;
+        case VK_PRESENT_MODE_FIFO_KHR: presentModeName = "fifo"; break;
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: presentModeName = "fifo-relaxed"; break;
+        default: break;
         }
+        std::cout << "Present mode: " << presentModeName << ", " << mSwapChainImageViews.size() << " swap chain images" << std::endl;
+        mFramePacer.Report();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Generates a dedicated command buffer for each framebuffer with the same drawing commands
-        in each.
-
-        Note:
-        - "Primary" level command buffers can be submitted to a queue for execution.
-        - "Secondary" level command buffers cannot be submitted directly, but can be submitted
-            from primary command buffers. Primary buffers cannot do this.
-    Creator:    John Cox, 11/2018
+        Prints how well the CPU and GPU overlapped with the current frame ring depth. Run with
+        different --frames-in-flight values to compare.
+        - Stalled: percentage of frames in which the CPU came back around to a frame context 
+            before the GPU had retired it. High means GPU-bound (or too shallow a ring).
+        - Retire wait: average CPU time blocked on that.
+        - Retire latency: average time from submission until the CPU noticed that the GPU was 
+            done, which is roughly how many frames of latency the ring adds.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateCommandBuffers() {
-        mCommandBuffers.resize(mSwapChainFramebuffers.size());
-
-        // Note: "AllocateInfo", not "CreateInfo", because command buffers are allocated from the
-        // command pool, not "created", which, in Vulkan terminology, involves creating memory 
-        // for it. There is already memory in the command pool, so we're just allocating from it.
-        VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        commandBufferAllocateInfo.commandPool = mCommandPool;
-        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(mCommandBuffers.size());
-        if (vkAllocateCommandBuffers(mLogicalDevice, &commandBufferAllocateInfo, mCommandBuffers.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate command buffers");
+    void ReportFrameContextStats() const {
+        const FrameContextStats &stats = mFrameContextStats;
+        if (stats.numFrames == 0) {
+            return;
         }
 
-        for (size_t i = 0; i < mCommandBuffers.size(); i++) {
-            // type is actually a pointer, so non-reference assignment is ok
-            auto currentCommandBuffer = mCommandBuffers.at(i);
-
-            VkCommandBufferBeginInfo commandBufferBeginInfo{};
-            commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-            if (vkBeginCommandBuffer(currentCommandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
-                throw std::runtime_error("failed to begin recording command buffer");
-            }
-
-            VkRenderPassBeginInfo renderPassBeginInfo{};
-            renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassBeginInfo.renderPass = mRenderPass;
-            renderPassBeginInfo.framebuffer = mSwapChainFramebuffers.at(i);
-            renderPassBeginInfo.renderArea.offset = { 0, 0 };
-            renderPassBeginInfo.renderArea.extent = mSwapChainExtent;
+        double totalMs = std::chrono::duration<double, std::milli>(stats.lastFrameTime - stats.firstFrameTime).count();
+        double numFrames = static_cast<double>(stats.numFrames);
+        double numSamples = static_cast<double>(std::max<uint64_t>(stats.numRetireLatencySamples, 1));
 
-            // defines the colors for the color and depth attachments' .loadOp = 
-            // VK_ATTACHMENT_LOAD_OP_CLEAR
-            // Note: For depth, clear to 1.0f because closer to 0 (as long as it is between 0-1) 
-            // take precedence, so if we were to clear the depth to 0 (closest possible value), 
-            // then the cleared color would be all that we would see. 
-            // Also Note: The second depth clear value is "stencil", which is not in yse right now 
-            // (1/20/2019).
-            std::array<VkClearValue, 2> clearValues{};
-            clearValues.at(0).color = { 0.0, 0.0f, 0.0f, 1.0f };
-            clearValues.at(1).depthStencil = { 1.0f, 0 };
-            renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-            renderPassBeginInfo.pClearValues = clearValues.data();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "Frame contexts: " << mFrameContexts.size() << " in flight" << std::endl;
+        ss << "    Frames:          " << stats.numFrames << std::endl;
+        ss << "    Avg frame time:  " << totalMs / numFrames << " ms" << std::endl;
+        ss << "    Stalled:         " << 100.0 * static_cast<double>(stats.numStalledFrames) / numFrames << " %" << std::endl;
+        ss << "    Avg retire wait: " << stats.totalRetireWaitMs / numSamples << " ms" << std::endl;
+        ss << "    Avg retire lat:  " << stats.totalRetireLatencyMs / numSamples << " ms" << std::endl;
+        ss << "    Avg GPU frame:   " << mGpuProfiler.GetAveragePassMs("frame") << " ms" << std::endl;
+        std::cout << ss.str();
+    }
 
-            vkCmdBeginRenderPass(currentCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-            {
-                VkPipelineBindPoint graphicsBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-                vkCmdBindPipeline(currentCommandBuffer, graphicsBindPoint, mGraphicsPipeline);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Responsible for the "while(not exit trigger) do program" loop.
+    Creator:    John Cox, 10/2018
+    ---------------------------------------------------------------------------------------------*/
+    void MainLoop() {
+        if (mOptions.occlusionBenchmark) {
+            OcclusionBenchmarkLoop();
+            return;
+        }
+        if (mOptions.variantBenchmark) {
+            VariantBenchmarkLoop();
+            return;
+        }
+        if (mOptions.benchmark) {
+            BenchmarkLoop();
+            return;
+        }
+        if (mOptions.headless) {
+            HeadlessLoop();
+            return;
+        }
 
-                VkBuffer vertexBuffers[] = { mVertexBuffer };
-                VkDeviceSize offsets[] = { 0 };
-                uint32_t firstBindingIndex = Vertex::VERTEX_BUFFER_BINDING_LOCATION;
-                uint32_t bindingCounter = 1;
-                vkCmdBindVertexBuffers(currentCommandBuffer, firstBindingIndex, bindingCounter, vertexBuffers, offsets);
+        if (!mUseRenderThread) {
+            while (!glfwWindowShouldClose(mWindow)) {
+                // Note: DrawFrame() polls for events itself. See the note there.
+                DrawFrame();
+            }
+            vkDeviceWaitIdle(mLogicalDevice);
+            return;
+        }
 
-                VkDeviceSize offset = 0;
-                vkCmdBindIndexBuffer(currentCommandBuffer, mVertexIndexBuffer, offset, VK_INDEX_TYPE_UINT32);
+        // Note: GLFW events must be handled on the main thread (the one that created the 
+        // window), so this thread only waits on events and forwards them (see the callbacks), 
+        // and all Vulkan work moves to the render thread. A slow event (ex: dragging the window 
+        // on Windows blocks inside the event handling) no longer holds up frames, and a slow 
+        // frame no longer holds up events.
+        std::thread renderThread(&HelloTriangleApplication::RenderThreadMain, this);
+        while (!glfwWindowShouldClose(mWindow) && !mRenderThreadExited.load(std::memory_order_acquire)) {
+            glfwWaitEvents();
+        }
 
-                uint32_t firstDescriptorSetIndex = 0;
-                uint32_t descriptorSetCount = 1;
-                uint32_t dynamicOffsetCount = 0;    // not considering dynamic descriptors now (1/1/2019)
-                vkCmdBindDescriptorSets(
-                    currentCommandBuffer,
-                    graphicsBindPoint,
-                    mPipelineLayout,
-                    firstDescriptorSetIndex,
-                    descriptorSetCount,
-                    &mDescriptorSets.at(i),
-                    dynamicOffsetCount,
-                    nullptr);
+        RenderCommand quitCommand{};
+        quitCommand.type = RenderCommand::QUIT;
+        PushRenderCommand(quitCommand);
+        renderThread.join();
+        if (mRenderThreadException) {
+            std::rethrow_exception(mRenderThreadException);
+        }
+    }
 
-                uint32_t indexCount = static_cast<uint32_t>(mVertexIndices.size());
-                uint32_t instanceCount = 1;
-                uint32_t firstIndex = 0;
-                uint32_t vertexOffset = 0;  // you can add a constant offset to the indices (??why would you do that??)
-                uint32_t firstInstance = 0;
-                vkCmdDrawIndexed(currentCommandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
-            }
-            vkCmdEndRenderPass(currentCommandBuffer);
-            if (vkEndCommandBuffer(currentCommandBuffer) != VK_SUCCESS) {
-                throw std::runtime_error("failed to record command buffer");
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Draws until the main thread says to quit. An exception is handed back to the main thread
+        to be rethrown there, and the main thread is woken up so that it notices.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void RenderThreadMain() {
+        try {
+            while (!mQuitRequested) {
+                DrawFrame();
             }
+            vkDeviceWaitIdle(mLogicalDevice);
         }
+        catch (...) {
+            mRenderThreadException = std::current_exception();
+        }
+        mRenderThreadExited.store(true, std::memory_order_release);
+        glfwPostEmptyEvent();
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Generates the semaphores that will let the
-        "acquire image" ->
-        "execute command buffer" ->
-        "return to swap chain" events occur in order.
-    Creator:    John Cox, 11/2018
+        No window to close, so render a fixed number of frames as fast as possible and report
+        the throughput. The clock stops only after the GPU has finished the last frame.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void CreateSyncObjects() {
-        mSemaphoresImageAvailable.resize(MAX_FRAMES_IN_FLIGHT);
-        mSemaphoresRenderFinished.resize(MAX_FRAMES_IN_FLIGHT);
-        mInFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    void HeadlessLoop() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < mOptions.headlessFrames; i++) {
+            DrawFrame();
+        }
+        vkDeviceWaitIdle(mLogicalDevice);
+        auto endTime = std::chrono::high_resolution_clock::now();
 
-        VkSemaphoreCreateInfo semaphoreCreateInfo{};
-        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        double seconds = std::chrono::duration<double>(endTime - startTime).count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "Headless " << mSwapChainExtent.width << "x" << mSwapChainExtent.height << ": "
+            << mOptions.headlessFrames << " frames in " << seconds << " s => "
+            << static_cast<double>(mOptions.headlessFrames) / seconds << " FPS" << std::endl;
+        std::cout << ss.str();
+    }
 
-        VkFenceCreateInfo fenceCreateInfo{};
-        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Runs the warm-up frames (not measured; lets caches, pipelines, and clocks settle), then
+        the measured frames, then writes the report. Works with or without a window, but is
+        meant for headless runs.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void BenchmarkLoop() {
+        for (uint32_t i = 0; i < mOptions.benchmarkWarmupFrames; i++) {
+            if (!mOptions.headless && glfwWindowShouldClose(mWindow)) {
+                break;
+            }
+            DrawFrame();
+        }
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            if (vkCreateSemaphore(mLogicalDevice, &semaphoreCreateInfo, nullptr, &mSemaphoresImageAvailable.at(i)) != VK_SUCCESS ||
-                vkCreateSemaphore(mLogicalDevice, &semaphoreCreateInfo, nullptr, &mSemaphoresRenderFinished.at(i)) != VK_SUCCESS ||
-                vkCreateFence(mLogicalDevice, &fenceCreateInfo, nullptr, &mInFlightFences.at(i)) != VK_SUCCESS) {
-                throw std::runtime_error("failed to create synchronization objects for a frame");
+        mBenchmarkFrames.clear();
+        mBenchmarkFrames.reserve(mOptions.benchmarkFrames);
+        mBenchmarkFirstFrame = mCurrentFrame;
+        mBenchmarkMeasuring = true;
+        for (uint32_t i = 0; i < mOptions.benchmarkFrames; i++) {
+            if (!mOptions.headless && glfwWindowShouldClose(mWindow)) {
+                break;
+            }
+
+            uint64_t frameNumber = mCurrentFrame;
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            DrawFrame();
+            auto frameEnd = std::chrono::high_resolution_clock::now();
+            if (mCurrentFrame == frameNumber) {
+                // swap chain was out of date; nothing was drawn
+                continue;
             }
+
+            BenchmarkFrame benchmarkFrame{};
+            benchmarkFrame.frameNumber = frameNumber;
+            benchmarkFrame.cpuMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+            benchmarkFrame.renderScale = static_cast<double>(mRenderExtent.width) / static_cast<double>(mSwapChainExtent.width);
+            mBenchmarkFrames.push_back(benchmarkFrame);
         }
-    }
+        vkDeviceWaitIdle(mLogicalDevice);
 
-    /*---------------------------------------------------------------------------------------------
-    Description:
-        Called when GLFW detects a change in the size of the renderable area.
+        // the last few frames' GPU times are still sitting in their query pools
+        for (const auto &frame : mFrameContexts) {
+            if (mGpuProfiler.CollectResults(frame.index)) {
+                RecordBenchmarkGpuTime(mGpuProfiler.GetLatestResults());
+            }
+        }
+        mBenchmarkMeasuring = false;
 
-        Note: Created static because GLFW callback registration function was built with C-style
-        function pointers in mind and therefore does not know how to call a member function with
-        the correct "this" pointer.
-    Creator:    John Cox, 12/2018
-    ---------------------------------------------------------------------------------------------*/
-    static void FramebufferResizeCallback(GLFWwindow *window, int width, int height) {
-        auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
-        app->mFrameBufferResized = true;
+        std::cout << "Benchmark: " << mBenchmarkFrames.size() << " frames measured" << std::endl;
+        if (WriteBenchmarkReport(mOptions.benchmarkReportPath)) {
+            std::cout << "Benchmark: report written to '" << mOptions.benchmarkReportPath << "'" << std::endl;
+        }
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Creates a GLFW window (??anything else??).
-    Creator:    John Cox, 10/2018M
+        Draws the same frames with each shader feature variant in turn and reports what each one
+        costs on the GPU, so that the price of a feature can be weighed against using it.
+
+        Each variant is compiled before it is measured (the fallback would otherwise be measured
+        in its place), then gets a few unmeasured frames to settle. The fragment invocation
+        count comes from pipeline statistics if the device has them, and turns the frame time
+        into a rough per-fragment cost.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void InitWindow() {
-        if (glfwInit() != GLFW_TRUE) {
-            return;
+    void VariantBenchmarkLoop() {
+        const std::vector<uint32_t> variants{
+            SHADER_FEATURE_TEXTURED,
+            SHADER_FEATURE_TEXTURED | SHADER_FEATURE_VERTEX_COLOR,
+            SHADER_FEATURE_TEXTURED | SHADER_FEATURE_ALPHA_TEST,
+            SHADER_FEATURE_TEXTURED | SHADER_FEATURE_VERTEX_COLOR | SHADER_FEATURE_ALPHA_TEST,
+            0,
+            SHADER_FEATURE_VERTEX_COLOR,
+            SHADER_FEATURE_DEBUG_UV,
+            SHADER_FEATURE_DEBUG_DEPTH,
+        };
+        const uint32_t settleFrames = 10;
+
+        struct VariantResult {
+            uint32_t features = 0;
+            double avgGpuMs = 0.0;
+            uint64_t fragmentShaderInvocations = 0;
+        };
+        std::vector<VariantResult> results;
+        for (uint32_t features : variants) {
+            // queue all of them up front so that they compile while the earlier ones are measured
+            GetPipelineVariant(features, GetMainDrawStage());
         }
+        for (uint32_t features : variants) {
+            if (!WaitForDrawPipelines(features)) {
+                std::cout << "Variant '" << ShaderFeaturesToString(features) << "' failed to compile; skipped" << std::endl;
+                continue;
+            }
+            mDrawFeatures = features;
 
-        // Note: GLFW was originally designed to create an OpenGL context. Possible "client API"
-        // values are OpenGL or OpenGL ES. At this time (10/20/2018), there is no option for
-        // Vulkan, so tell it to use "no API".
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            // every variant flies the camera path from the start (see UpdateUniformBuffer(...))
+            mCameraPathFirstFrame = mCurrentFrame;
+            for (uint32_t i = 0; i < settleFrames; i++) {
+                DrawFrame();
+            }
 
-        GLFWmonitor *monitor = nullptr;
-        mWindow = glfwCreateWindow(mWindowWidth, mWindowHeight, "Vulkan", monitor, nullptr);
-        glfwSetWindowUserPointer(mWindow, this);    // gets a class pointer into callback function
-        glfwSetFramebufferSizeCallback(mWindow, FramebufferResizeCallback);
+            MeasuredFrames measured = MeasureBenchmarkFrames(mOptions.variantBenchmarkFrames);
+            VariantResult result{};
+            result.features = features;
+            result.avgGpuMs = measured.avgGpuMs;
+            result.fragmentShaderInvocations = measured.avgFragmentShaderInvocations;
+            results.push_back(result);
+        }
+        mDrawFeatures = mOptions.shaderFeatures;
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(4);
+        ss << "Shader variants (" << mSwapChainExtent.width << "x" << mSwapChainExtent.height << ", " << mOptions.variantBenchmarkFrames << " frames each):" << std::endl;
+        for (const auto &result : results) {
+            ss << "    " << std::left << std::setw(40) << ShaderFeaturesToString(result.features) << std::right
+                << " GPU " << result.avgGpuMs << " ms";
+            if (result.fragmentShaderInvocations > 0) {
+                ss << ", " << result.fragmentShaderInvocations << " fragments, "
+                    << (result.avgGpuMs * 1.0e6 / static_cast<double>(result.fragmentShaderInvocations)) << " ns/fragment";
+            }
+            ss << std::endl;
+        }
+        std::cout << ss.str();
+
+        // Note: Cleanup() hasn't run yet, so a bad path mustn't throw past it.
+        std::ofstream outFile(mOptions.variantBenchmarkReportPath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cout << "Variant benchmark: failed to open '" << mOptions.variantBenchmarkReportPath << "'; report not saved" << std::endl;
+            return;
+        }
+        outFile << std::fixed << std::setprecision(4);
+        outFile << "{\n";
+        outFile << "  \"width\": " << mSwapChainExtent.width << ",\n";
+        outFile << "  \"height\": " << mSwapChainExtent.height << ",\n";
+        outFile << "  \"framesPerVariant\": " << mOptions.variantBenchmarkFrames << ",\n";
+        outFile << "  \"variants\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            outFile << "    { \"features\": \"" << ShaderFeaturesToString(results[i].features) << "\", \"mask\": " << results[i].features
+                << ", \"gpuMs\": " << results[i].avgGpuMs
+                << ", \"fragmentShaderInvocations\": " << results[i].fragmentShaderInvocations << " }"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        outFile << "  ]\n";
+        outFile << "}\n";
+        std::cout << "Variant benchmark report written to '" << mOptions.variantBenchmarkReportPath << "'" << std::endl;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Governs the initialization of a Vulkan instance and devices.
-    Creator:    John Cox, 10/2018
+        Runs the given number of frames with the benchmark recording on and averages what the
+        GPU reported for them. The A/B benchmarks below measure each configuration with this.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void InitVulkan() {
-        CreateInstance();
-        CreateSurface();
-        PickPhysicalDevice();
-        CreateLogicalDevice();
-        CreateSwapChain();
-        CreateRenderPass();
-        CreateDescriptorSetLayout();
-        CreateGraphicsPipeline();
-        CreateCommandPool();
-        CreateDepthResources();
-        CreateFramebuffers();
-        CreateTextureImage();
-        CreateTextureSampler();
-        LoadModel();
-        CreateVertexBuffer();
-        CreateVertexIndexBuffer();
-        CreateUniformBuffers();
-        CreateDescriptorPool();
-        CreateDescriptorSets();
-        CreateCommandBuffers();
-        CreateSyncObjects();
+    struct MeasuredFrames {
+        double avgGpuMs = 0.0;
+        uint64_t avgVertexShaderInvocations = 0;
+        uint64_t avgFragmentShaderInvocations = 0;
+    };
+    MeasuredFrames MeasureBenchmarkFrames(uint32_t numFrames) {
+        mBenchmarkFrames.clear();
+        mBenchmarkFrames.reserve(numFrames);
+        mBenchmarkFirstFrame = mCurrentFrame;
+        mBenchmarkMeasuring = true;
+        for (uint32_t i = 0; i < numFrames; i++) {
+            BenchmarkFrame benchmarkFrame{};
+            benchmarkFrame.frameNumber = mCurrentFrame;
+            mBenchmarkFrames.push_back(benchmarkFrame);
+            DrawFrame();
+        }
+        vkDeviceWaitIdle(mLogicalDevice);
+        for (const auto &frame : mFrameContexts) {
+            if (mGpuProfiler.CollectResults(frame.index)) {
+                RecordBenchmarkGpuTime(mGpuProfiler.GetLatestResults());
+            }
+        }
+        mBenchmarkMeasuring = false;
+
+        MeasuredFrames measured{};
+        uint64_t numGpuFrames = 0;
+        uint64_t totalVertexInvocations = 0;
+        uint64_t totalFragmentInvocations = 0;
+        for (const auto &frame : mBenchmarkFrames) {
+            if (frame.gpuMs >= 0.0) {
+                measured.avgGpuMs += frame.gpuMs;
+                totalVertexInvocations += frame.vertexShaderInvocations;
+                totalFragmentInvocations += frame.fragmentShaderInvocations;
+                numGpuFrames++;
+            }
+        }
+        if (numGpuFrames > 0) {
+            measured.avgGpuMs /= static_cast<double>(numGpuFrames);
+            measured.avgVertexShaderInvocations = totalVertexInvocations / numGpuFrames;
+            measured.avgFragmentShaderInvocations = totalFragmentInvocations / numGpuFrames;
+        }
+        return measured;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Updates the uniform buffer for the current frame so that the vertex shader will have the
-        correct transforms.
-
-        Note: GLM was designed for OpenGL ("GLM" = "GL Math"), in which the Y values in the
-        Normalized Device Coordinates (NDC) increased from bottom to top. This was chosen because
-        cartesian coordinates in 2D graphs start at (0,0) and increase going right (+x) and up
-        (+y). Early text editors were terminals (ex: Command Prompt in Windows), in which the
-        first character was entered in the upper left, as we English speakers expect of our text,
-        and early image processing (ASCII characters, not pixels) leveraged this text mechanism,
-        thereby declaring (0,0) to also be the upper left, and it never changed when image
-        processing became pixel-based and there was no longer any technical reason to be the upper
-        left. Direct3D followed image processing. And OpenGL didn't change, so as far as the rest
-        of the image processing world is concerned, OpenGL (and therefore GLM) is upside down.
-
-        That's why we flip projection's Y.
-    Creator:    John Cox, 01/2019
+        Flies the benchmark camera path (see CameraPath) with the depth pre-pass and cluster
+        culling each off and on, and reports how much shading each combination saved compared
+        to neither: fragment and vertex shader invocations (pipeline statistics) and GPU time.
+
+        Note: Every configuration starts the camera path from its beginning, so they all see the
+        same views. Culling's first frame has no Hi-Z pyramid yet (frustum culling only), which
+        the settle frames take care of.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void UpdateUniformBuffer(uint32_t swapChainImageIndex) {
-        static auto startTime = std::chrono::high_resolution_clock::now();
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    void OcclusionBenchmarkLoop() {
+        struct OcclusionConfig {
+            const char *name;
+            bool prepass;
+            bool culling;
+        };
+        const std::vector<OcclusionConfig> configs{
+            { "baseline", false, false },
+            { "depth-prepass", true, false },
+            { "hiz-culling", false, true },
+            { "depth-prepass+hiz-culling", true, true },
+        };
+        const uint32_t settleFrames = 10;
 
-        UniformBufferObject ubo{};
+        struct OcclusionResult {
+            const char *name = "";
+            MeasuredFrames measured;
+        };
+        std::vector<OcclusionResult> results;
+        for (const auto &config : configs) {
+            if ((config.prepass && !mDepthPrepassEnabled) || (config.culling && !mClusterCullingEnabled)) {
+                std::cout << "Occlusion config '" << config.name << "' isn't available on this device; skipped" << std::endl;
+                continue;
+            }
+            mDrawPrepass = config.prepass;
+            mDrawCulling = config.culling;
+            if (!WaitForDrawPipelines(mDrawFeatures)) {
+                std::cout << "Occlusion config '" << config.name << "' failed to compile; skipped" << std::endl;
+                continue;
+            }
 
-        // starting with identity matrix, rotate with elapsed time around the Z axis
-        //ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.model = glm::rotate(glm::mat4(1.0f), glm::radians(220.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+            mCameraPathFirstFrame = mCurrentFrame;
+            for (uint32_t i = 0; i < settleFrames; i++) {
+                DrawFrame();
+            }
+            OcclusionResult result{};
+            result.name = config.name;
+            result.measured = MeasureBenchmarkFrames(mOptions.occlusionBenchmarkFrames);
+            results.push_back(result);
+        }
+        mDrawPrepass = mDepthPrepassEnabled;
+        mDrawCulling = mClusterCullingEnabled;
 
-        // eye at (2,2,2), looking at (0,0,0), with Z axis as "up"
-        // Note: Flip the camera's "up" (in this case Z) axis from + to - as an alternative to 
-        // dealing with the counterclockwise face culling problem that is currently dealt with by 
-        // flipping one of the projection transform's Y axes.
-        float zoomAxis = sinf(time / 2.0f);
-        ubo.view = glm::lookAt(glm::vec3(2.0f + zoomAxis, 2.0f + zoomAxis, 2.0f + zoomAxis), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.view[1][1] *= +1;
+        // reductions are relative to the first config that ran (normally the baseline)
+        auto reduction = [](double value, double baseline) {
+            return (baseline > 0.0) ? (100.0 * (baseline - value) / baseline) : 0.0;
+        };
+        const MeasuredFrames baseline = results.empty() ? MeasuredFrames{} : results.front().measured;
 
-        // Note: If the screen was resized and the swap chain had to be recreated, this 
-        // calculation will use the latest values, and so RecreateSwapChain(...) doesn't have to 
-        // handle that.
-        // Also Note: We *could* make it do that because the perspective projection (that is, the 
-        // camera->projection transform) is constant for a given screen size, but we aren't 
-        // because then we'd have to split the UBO population between this function and that 
-        // function, and that would be a bit of an encapsulation pain.
-        float aspectRatio = mSwapChainExtent.width / static_cast<float>(mSwapChainExtent.height);
-        float nearPlaneDist = 0.1f;
-        float farPlaneDist = 10.0f;
-        ubo.proj = glm::perspective(glm::radians(45.0f), aspectRatio, nearPlaneDist, farPlaneDist);
+        // Note: The baseline skips the Hi-Z build and discards depth (see CreateRenderPass()), 
+        // but the render pass is made once, so with a pre-pass it still has the (empty) pre-pass 
+        // subpass. Say so rather than let it pass for a build without any of this.
+        std::string baselineIncludes = mDepthPrepassEnabled ? "empty depth pre-pass subpass" : "nothing extra";
 
-        // Note: See the vertex structure's description for more detail, but in essance, this 
-        // tutorial is considered counterclockwise faces to be the front, but positioning the 
-        // camera ("eye"/"view") as it is moves the vertices such that they draw clockwise, and so 
-        // the tutorial flipped the Y on the projection matrix. I experimented and found that 
-        // flipping view[1][1] in the same way doesn't work, so this hack on the Y axis only works 
-        // in the projection matrix. This could also be achieved by flipping the camera's Z axis 
-        // over from + to -, or by rearranging the vertices to draw differently. For whatever 
-        // reason, he went with this approach. In the long rong, it is probably not important since 
-        // we'll start importing thousands of vertices or more from scene files.
-        ubo.proj[1][1] *= -1;
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "Occlusion (" << mSwapChainExtent.width << "x" << mSwapChainExtent.height << ", " << mOptions.occlusionBenchmarkFrames << " frames each, vs '" << (results.empty() ? "" : results.front().name) << "'):" << std::endl;
+        for (const auto &result : results) {
+            const MeasuredFrames &m = result.measured;
+            ss << "    " << std::left << std::setw(28) << result.name << std::right
+                << " GPU " << m.avgGpuMs << " ms (" << reduction(m.avgGpuMs, baseline.avgGpuMs) << "% less)"
+                << ", " << m.avgFragmentShaderInvocations << " fragments (" << reduction(static_cast<double>(m.avgFragmentShaderInvocations), static_cast<double>(baseline.avgFragmentShaderInvocations)) << "% less)"
+                << ", " << m.avgVertexShaderInvocations << " vertices (" << reduction(static_cast<double>(m.avgVertexShaderInvocations), static_cast<double>(baseline.avgVertexShaderInvocations)) << "% less)"
+                << std::endl;
+        }
+        ss << "    (baseline still includes: " << baselineIncludes << ")" << std::endl;
+        std::cout << ss.str();
 
-        void *data = nullptr;
-        VkDeviceSize offset = 0;
-        VkMemoryMapFlags flags = 0;
-        vkMapMemory(mLogicalDevice, mUniformBuffersMemory.at(swapChainImageIndex), offset, sizeof(ubo), flags, &data);
-        memcpy(data, &ubo, sizeof(ubo));
-        vkUnmapMemory(mLogicalDevice, mUniformBuffersMemory.at(swapChainImageIndex));
+        // Note: Cleanup() hasn't run yet, so a bad path mustn't throw past it.
+        std::ofstream outFile(mOptions.occlusionBenchmarkReportPath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cout << "Occlusion benchmark: failed to open '" << mOptions.occlusionBenchmarkReportPath << "'; report not saved" << std::endl;
+            return;
+        }
+        outFile << std::fixed << std::setprecision(4);
+        outFile << "{\n";
+        outFile << "  \"width\": " << mSwapChainExtent.width << ",\n";
+        outFile << "  \"height\": " << mSwapChainExtent.height << ",\n";
+        outFile << "  \"framesPerConfig\": " << mOptions.occlusionBenchmarkFrames << ",\n";
+        outFile << "  \"clusters\": " << mClusters.size() << ",\n";
+        outFile << "  \"clusterDraws\": " << mNumDrawCommands << ",\n";     // clusters times instances
+        outFile << "  \"baselineIncludes\": \"" << baselineIncludes << "\",\n";
+        outFile << "  \"configs\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const MeasuredFrames &m = results[i].measured;
+            outFile << "    { \"name\": \"" << results[i].name << "\""
+                << ", \"gpuMs\": " << m.avgGpuMs
+                << ", \"fragmentShaderInvocations\": " << m.avgFragmentShaderInvocations
+                << ", \"vertexShaderInvocations\": " << m.avgVertexShaderInvocations
+                << ", \"gpuReductionPercent\": " << reduction(m.avgGpuMs, baseline.avgGpuMs)
+                << ", \"fragmentReductionPercent\": " << reduction(static_cast<double>(m.avgFragmentShaderInvocations), static_cast<double>(baseline.avgFragmentShaderInvocations))
+                << ", \"vertexReductionPercent\": " << reduction(static_cast<double>(m.avgVertexShaderInvocations), static_cast<double>(baseline.avgVertexShaderInvocations)) << " }"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        outFile << "  ]\n";
+        outFile << "}\n";
+        std::cout << "Occlusion benchmark report written to '" << mOptions.occlusionBenchmarkReportPath << "'" << std::endl;
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        (1) Acquires an image from the swap chain
-        (2) Executes the command buffer with that image as attachment in the framebuffer (??what??)
-        (3) Returns the image to the swap chain for presentation
-
-        The tutorial says that these events are executed asynchronously unless things are put in
-        place to guarantee that they execute in order. There are two synchronization mechanisms:
-        - Fence: Application can wait via vkWaitForFences(...) until the fence(s) are clear.
-        - Semaphore: Cannot be accessed from the application. These are used for the GPu to
-            synchronize operations within or accross command queues.
-    Creator:    John Cox, 11/2018
+        Matches GPU results up with the measured frame that they belong to.
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void DrawFrame() {
-        // don't submit another queue of graphics commands until 
-        size_t inflightFrameIndex = mCurrentFrame % MAX_FRAMES_IN_FLIGHT;
-        VkFence *pCurrentFrameFence = &mInFlightFences.at(inflightFrameIndex);
-        VkBool32 waitAllFences = VK_TRUE; // we only wait on one fence, so "wait all" irrelevant
-        uint64_t timeout_ns = std::numeric_limits<uint64_t>::max();
-        vkWaitForFences(mLogicalDevice, 1, pCurrentFrameFence, waitAllFences, timeout_ns);
-
-        uint32_t imageIndex = 0;
-        VkFence nullFence = VK_NULL_HANDLE;
-        VkResult result = vkAcquireNextImageKHR(mLogicalDevice, mSwapChain, timeout_ns, mSemaphoresImageAvailable.at(inflightFrameIndex), nullFence, &imageIndex);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-            RecreateSwapChain();
+    void RecordBenchmarkGpuTime(const GpuQueryProfiler::FrameResults &results) {
+        if (results.frameNumber < mBenchmarkFirstFrame) {
+            // a warm-up frame
             return;
         }
-        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-            throw std::runtime_error("failed to acquire swap chain image");
-        }
 
-        // only reset the fences once we're good to go (that is, have image and swap chain is not 
-        // out of date)
-        vkResetFences(mLogicalDevice, 1, pCurrentFrameFence);
+        // frames are recorded in order, but out-of-date swap chain frames leave gaps, so search 
+        // back from the end (the match is almost always within the last few)
+        for (auto itr = mBenchmarkFrames.rbegin(); itr != mBenchmarkFrames.rend(); ++itr) {
+            if (itr->frameNumber == results.frameNumber) {
+                for (const auto &pass : results.passes) {
+                    if (pass.name == "frame") {
+                        itr->gpuMs = pass.ms;
+                    }
+                }
+                itr->vertexShaderInvocations = results.vertexShaderInvocations;
+                itr->fragmentShaderInvocations = results.fragmentShaderInvocations;
+                return;
+            }
+        }
+    }
 
-        UpdateUniformBuffer(imageIndex);
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        Writes everything needed to compare two builds: what was run and on what, the startup
+        phase breakdown, summary stats, every measured frame, and memory use.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    bool WriteBenchmarkReport(const std::string &filePath) const {
+        // Note: Called before Cleanup(), so a bad path mustn't throw past it (see 
+        // FrameProfiler::WriteJson(...)).
+        std::ofstream outFile(filePath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            std::cout << "Benchmark: failed to open '" << filePath << "'; report not saved" << std::endl;
+            return false;
+        }
 
-        // submit the command buffer for this image
-        // Note: In short, this reads, "wait for 'image available semaphore', execute command 
-        // buffer on the render passes' color attachment, then raise the 'render finished' 
-        // semaphore".
-        VkSemaphore waitSemaphores[] = { mSemaphoresImageAvailable.at(inflightFrameIndex) };
-        VkSemaphore signalSemaphores[] = { mSemaphoresRenderFinished.at(inflightFrameIndex) };
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &mCommandBuffers.at(imageIndex);
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &deviceProperties);
 
-        // once all commands have been completed, the provided fence will be signaled
-        uint32_t submitCount = 1;
-        if (vkQueueSubmit(mGraphicsQueue, submitCount, &submitInfo, *pCurrentFrameFence) != VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer");
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+        for (const auto &frame : mBenchmarkFrames) {
+            cpuMs.push_back(frame.cpuMs);
+            if (frame.gpuMs >= 0.0) {
+                gpuMs.push_back(frame.gpuMs);
+            }
         }
+        auto writeSummary = [&outFile](const char *name, std::vector<double> values) {
+            std::sort(values.begin(), values.end());
+            double total = 0.0;
+            for (double value : values) {
+                total += value;
+            }
+            auto percentile = [&values](double p) {
+                if (values.empty()) {
+                    return 0.0;
+                }
+                size_t index = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+                return values.at(std::min(std::max<size_t>(index, 1), values.size()) - 1);
+            };
+            outFile << "    \"" << name << "\": { \"avgMs\": " << (values.empty() ? 0.0 : total / static_cast<double>(values.size()))
+                << ", \"p50Ms\": " << percentile(0.50)
+                << ", \"p95Ms\": " << percentile(0.95)
+                << ", \"p99Ms\": " << percentile(0.99)
+                << ", \"maxMs\": " << (values.empty() ? 0.0 : values.back()) << " }";
+        };
 
-        VkSwapchainKHR swapChains[] = { mSwapChain };
-        VkPresentInfoKHR presentInfo{};
-        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores; // wait on command buffer
-        presentInfo.swapchainCount = 1;
-        presentInfo.pSwapchains = swapChains;
-        presentInfo.pImageIndices = &imageIndex;
-
-        // used if there were multiple swap chains that could return success/fail statuses, but 
-        // we're just using a single swap chain, so we don't need this
-        presentInfo.pResults = nullptr;
+        outFile << std::fixed << std::setprecision(4);
+        outFile << "{\n";
+        outFile << "  \"device\": \"" << EscapeJsonString(deviceProperties.deviceName) << "\",\n";
+        outFile << "  \"width\": " << mSwapChainExtent.width << ",\n";
+        outFile << "  \"height\": " << mSwapChainExtent.height << ",\n";
+        outFile << "  \"headless\": " << (mOptions.headless ? "true" : "false") << ",\n";
+        outFile << "  \"framesInFlight\": " << mOptions.framesInFlight << ",\n";
+        outFile << "  \"dynamicResolution\": " << (mDynamicResolutionEnabled ? "true" : "false") << ",\n";
+        outFile << "  \"pipelineCacheWarm\": " << (mPipelineCache.IsWarm() ? "true" : "false") << ",\n";
+        outFile << "  \"pipelineCreateMs\": " << mPipelineCreateMs << ",\n";
+        outFile << "  \"warmupFrames\": " << mOptions.benchmarkWarmupFrames << ",\n";
+        outFile << "  \"measuredFrames\": " << mBenchmarkFrames.size() << ",\n";
+
+        outFile << "  \"startupMs\": {";
+        const auto &phases = mStartupTimer.GetPhases();
+        for (size_t i = 0; i < phases.size(); i++) {
+            outFile << (i == 0 ? " " : ", ") << "\"" << phases[i].name << "\": " << phases[i].ms;
+        }
+        outFile << (phases.empty() ? "" : ", ") << "\"total\": " << mStartupTimer.GetTotalMs() << " },\n";
 
-        result = vkQueuePresentKHR(mPresentationQueue, &presentInfo);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mFrameBufferResized) {
-            RecreateSwapChain();
-            mFrameBufferResized = false;
+        outFile << "  \"startupTasks\": [";
+        const auto &tasks = mTaskScheduler.GetTimings();
+        for (size_t i = 0; i < tasks.size(); i++) {
+            outFile << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << tasks[i].name << "\", \"thread\": " << tasks[i].threadIndex
+                << ", \"startMs\": " << tasks[i].startMs << ", \"endMs\": " << tasks[i].endMs << " }";
         }
-        else if (result != VK_SUCCESS) {
-            throw std::runtime_error("failed to present swap chain image");
+        outFile << "\n  ],\n";
+
+        outFile << "  \"summary\": {\n";
+        writeSummary("cpu", cpuMs);
+        outFile << ",\n";
+        writeSummary("gpu", gpuMs);
+        outFile << "\n  },\n";
+
+        WriteMemoryStats(outFile);
+
+        outFile << "  \"frames\": [\n";
+        for (size_t i = 0; i < mBenchmarkFrames.size(); i++) {
+            const BenchmarkFrame &frame = mBenchmarkFrames[i];
+            outFile << "    { \"frame\": " << frame.frameNumber << ", \"cpuMs\": " << frame.cpuMs << ", \"gpuMs\": ";
+            if (frame.gpuMs >= 0.0) {
+                outFile << frame.gpuMs;
+            }
+            else {
+                outFile << "null";
+            }
+            if (mDynamicResolutionEnabled) {
+                outFile << ", \"renderScale\": " << frame.renderScale;
+            }
+            outFile << " }" << (i + 1 < mBenchmarkFrames.size() ? "," : "") << "\n";
         }
+        outFile << "  ]\n";
+        outFile << "}\n";
+    }
 
-        //vkQueueWaitIdle(mPresentationQueue);
-        mCurrentFrame++;
+    /*---------------------------------------------------------------------------------------------
+    Description:
+        How much memory the lazily allocated attachments (the depth images, when nothing reads
+        them after the render pass, and any such frame graph transients) were given, and how
+        much of it the driver has actually committed. The difference is what they saved.
+    Creator:    John Cox, 10/2026
+    ---------------------------------------------------------------------------------------------*/
+    void GetLazyAttachmentMemory(VkDeviceSize &allocated, VkDeviceSize &committed) const {
+        allocated = 0;
+        committed = 0;
+        auto add = [this, &allocated, &committed](VkImage image, VkDeviceMemory memory) {
+            VkMemoryRequirements requirements{};
+            vkGetImageMemoryRequirements(mLogicalDevice, image, &requirements);
+            VkDeviceSize imageCommitted = 0;
+            vkGetDeviceMemoryCommitment(mLogicalDevice, memory, &imageCommitted);
+            allocated += requirements.size;
+            committed += imageCommitted;
+        };
+        if (mDepthMemoryLazy) {
+            if (mOptions.headless) {
+                for (const OffscreenTarget &target : mOffscreenTargets) {
+                    add(target.depthImage, target.depthImageMemory);
+                }
+            }
+            else {
+                add(mDepthImage, mDepthImageMemory);
+            }
+        }
+        mFrameGraph.GetLazyMemory(allocated, committed);
     }
 
     /*---------------------------------------------------------------------------------------------
     Description:
-        Responsible for the "while(not exit trigger) do program" loop.
-    Creator:    John Cox, 10/2018
+        The "memory" section of the benchmark report: what this program allocated, plus each
+        device-local heap's budget and usage if VK_EXT_memory_budget is available (the usage
+        includes other processes' allocations, so it is only a rough guide).
+    Creator:    John Cox, 10/2026
     ---------------------------------------------------------------------------------------------*/
-    void MainLoop() {
-        while (!glfwWindowShouldClose(mWindow)) {
-            glfwPollEvents();
-            DrawFrame();
+    void WriteMemoryStats(std::ostream &out) const {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2 memoryProperties2{};
+        memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memoryProperties2.pNext = mMemoryBudgetEnabled ? &budgetProperties : nullptr;
+        vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &memoryProperties2);
+        const VkPhysicalDeviceMemoryProperties &memoryProperties = memoryProperties2.memoryProperties;
+
+        out << "  \"memory\": {\n";
+        out << "    \"allocations\": " << mNumDeviceAllocations.load() << ",\n";
+        out << "    \"allocatedBytes\": " << mTotalDeviceAllocationBytes.load() << ",\n";
+        VkDeviceSize lazyAllocated = 0;
+        VkDeviceSize lazyCommitted = 0;
+        GetLazyAttachmentMemory(lazyAllocated, lazyCommitted);
+        out << "    \"lazilyAllocatedBytes\": " << lazyAllocated << ",\n";
+        out << "    \"lazilyCommittedBytes\": " << lazyCommitted << ",\n";
+        out << "    \"heaps\": [";
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+            const VkMemoryHeap &heap = memoryProperties.memoryHeaps[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "      { \"size\": " << heap.size
+                << ", \"deviceLocal\": " << ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false");
+            if (mMemoryBudgetEnabled) {
+                out << ", \"budget\": " << budgetProperties.heapBudget[i]
+                    << ", \"usage\": " << budgetProperties.heapUsage[i];
+            }
+            out << " }";
         }
-        vkDeviceWaitIdle(mLogicalDevice);
+        out << "\n    ]\n";
+        out << "  },\n";
     }
 
     /*---------------------------------------------------------------------------------------------
@@ -2797,33 +11608,114 @@ private:
     Creator:    John Cox, 10/2018
     ---------------------------------------------------------------------------------------------*/
     void Cleanup() {
+        mShaderWatcher.Stop();
+        mShaderCompiler.Shutdown();
+        if (mOptions.hotReload) {
+            std::cout << "Shader compiler: " << mShaderCompiler.GetNumCompiled() << " compiled, " << mShaderCompiler.GetNumCacheHits() << " from the cache" << std::endl;
+        }
+
+        // background compiles use the thread pipeline caches, which are merged when saving
+        mPipelineManager.Shutdown();
+        std::cout << "Pipelines: " << mPipelineManager.GetSummary() << std::endl;
+        std::cout << "Shader modules: " << mShaderModules.GetNumModules() << " created, " << mShaderModules.GetNumHits() << " reused" << std::endl;
+        if (!mOptions.pipelinePrewarmPath.empty()) {
+            mPipelineManager.SavePrewarmList(mOptions.pipelinePrewarmPath);
+        }
+
+        if (mDynamicResolutionEnabled) {
+            std::cout << "Dynamic resolution: " << mResolutionScaler.GetSummary() << ", " << mNumSceneTargetAllocations << " scene target allocations" << std::endl;
+        }
+        std::cout << "Frame graph: " << mFrameGraph.GetSummary() << std::endl;
+        if (!IsDepthReadAfterRenderPass()) {
+            VkDeviceSize lazyAllocated = 0;
+            VkDeviceSize lazyCommitted = 0;
+            GetLazyAttachmentMemory(lazyAllocated, lazyCommitted);
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(1) << "Attachment memory: depth is transient (cleared, never stored)";
+            if (lazyAllocated > 0) {
+                ss << "; " << static_cast<double>(lazyAllocated) / (1024.0 * 1024.0) << " MB lazily allocated, "
+                    << static_cast<double>(lazyCommitted) / (1024.0 * 1024.0) << " MB committed, "
+                    << static_cast<double>(lazyAllocated - lazyCommitted) / (1024.0 * 1024.0) << " MB saved";
+            }
+            else {
+                ss << "; the device has no lazily allocated memory, so it takes ordinary memory";
+            }
+            std::cout << ss.str() << std::endl;
+        }
+        RetireSceneTarget();
+        RetireHiZPyramid();
+        RunDeferredDestructions(true);
+        mFrameGraph.Cleanup();
         CleanupSwapChain();
 
         vkDestroySampler(mLogicalDevice, mTextureSampler, nullptr);
-        vkDestroyImageView(mLogicalDevice, mTextureImageView, nullptr);
-        vkDestroyImage(mLogicalDevice, mTextureImage, nullptr);
-        vkFreeMemory(mLogicalDevice, mTextureImageMemory, nullptr);
+        for (SceneTexture &texture : mTextures) {
+            vkDestroyImageView(mLogicalDevice, texture.view, nullptr);
+            vkDestroyImage(mLogicalDevice, texture.image, nullptr);
+            vkFreeMemory(mLogicalDevice, texture.memory, nullptr);
+        }
 
-        vkDestroyDescriptorSetLayout(mLogicalDevice, mDescriptorSetLayout, nullptr);
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            vkDestroyBuffer(mLogicalDevice, mUniformBuffers.at(i), nullptr);
-            vkFreeMemory(mLogicalDevice, mUniformBuffersMemory.at(i), nullptr);
+        // the compute set layouts belong to the layout cache
+        vkDestroySampler(mLogicalDevice, mHiZSampler, nullptr);
+        vkDestroyPipeline(mLogicalDevice, mHiZBuildPipeline, nullptr);
+        vkDestroyPipelineLayout(mLogicalDevice, mHiZBuildPipelineLayout, nullptr);
+        vkDestroyPipeline(mLogicalDevice, mClusterCullPipeline, nullptr);
+        vkDestroyPipelineLayout(mLogicalDevice, mClusterCullPipelineLayout, nullptr);
+        vkDestroySampler(mLogicalDevice, mDownsampleSampler, nullptr);
+        vkDestroyPipeline(mLogicalDevice, mDownsampleColorPipeline, nullptr);
+        vkDestroyPipeline(mLogicalDevice, mDownsampleDepthPipeline, nullptr);
+        vkDestroyPipelineLayout(mLogicalDevice, mDownsamplePipelineLayout, nullptr);
+        vkDestroyBuffer(mLogicalDevice, mFrameDownsampleCounter, nullptr);
+        vkFreeMemory(mLogicalDevice, mFrameDownsampleCounterMemory, nullptr);
+        vkDestroyBuffer(mLogicalDevice, mUploadDownsampleCounter, nullptr);
+        vkFreeMemory(mLogicalDevice, mUploadDownsampleCounterMemory, nullptr);
+
+        mPipelineManager.Cleanup();
+        mShaderModules.Cleanup();
+        vkDestroyPipelineLayout(mLogicalDevice, mPipelineLayout, nullptr);
+        mPipelineCache.Save();
+        mPipelineCache.Cleanup();
+        vkDestroyDescriptorUpdateTemplate(mLogicalDevice, mPerFrameUpdateTemplate, nullptr);
+        vkDestroyDescriptorUpdateTemplate(mLogicalDevice, mMaterialUpdateTemplate, nullptr);
+        mDescriptorLayoutCache.Cleanup();
+        vkUnmapMemory(mLogicalDevice, mUniformBufferMemory);
+        vkDestroyBuffer(mLogicalDevice, mUniformBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, mUniformBufferMemory, nullptr);
+        mDescriptorAllocator.Cleanup();
+        if (mBindlessDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(mLogicalDevice, mBindlessDescriptorPool, nullptr);
         }
-        vkDestroyDescriptorPool(mLogicalDevice, mDescriptorPool, nullptr);
 
         vkDestroyBuffer(mLogicalDevice, mVertexBuffer, nullptr);
         vkFreeMemory(mLogicalDevice, mVertexBufferMemory, nullptr);
         vkDestroyBuffer(mLogicalDevice, mVertexIndexBuffer, nullptr);
         vkFreeMemory(mLogicalDevice, mVertexIndexBufferMemory, nullptr);
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroySemaphore(mLogicalDevice, mSemaphoresImageAvailable.at(i), nullptr);
-            vkDestroySemaphore(mLogicalDevice, mSemaphoresRenderFinished.at(i), nullptr);
-            vkDestroyFence(mLogicalDevice, mInFlightFences.at(i), nullptr);
+        vkDestroyBuffer(mLogicalDevice, mPositionBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, mPositionBufferMemory, nullptr);
+        vkDestroyBuffer(mLogicalDevice, mClusterBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, mClusterBufferMemory, nullptr);
+        vkDestroyBuffer(mLogicalDevice, mDrawCommandBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, mDrawCommandBufferMemory, nullptr);
+        vkDestroyBuffer(mLogicalDevice, mCullInstanceBuffer, nullptr);
+        vkFreeMemory(mLogicalDevice, mCullInstanceBufferMemory, nullptr);
+
+        for (FrameContext &frame : mFrameContexts) {
+            vkDestroySemaphore(mLogicalDevice, frame.imageAvailable, nullptr);
+            vkDestroySemaphore(mLogicalDevice, frame.renderFinished, nullptr);
+            frame.descriptorAllocator.Cleanup();
+            vkDestroyCommandPool(mLogicalDevice, frame.commandPool, nullptr);
         }
+        mGpuProfiler.Cleanup();
+        vkDestroySemaphore(mLogicalDevice, mGraphicsTimeline.semaphore, nullptr);
         vkDestroyCommandPool(mLogicalDevice, mCommandPool, nullptr);
+        if (mAsyncComputeEnabled) {
+            vkDestroySemaphore(mLogicalDevice, mComputeTimeline.semaphore, nullptr);
+            vkDestroyCommandPool(mLogicalDevice, mComputeCommandPool, nullptr);
+        }
         vkDestroyDevice(mLogicalDevice, nullptr);
-        vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        if (mSurface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        }
 
         if (mCallback != VK_NULL_HANDLE) {
             // Note: This is an externally synchronized object (that is, created at runtime in a 
@@ -2832,12 +11724,455 @@ private:
         }
 
         vkDestroyInstance(mInstance, nullptr);
-        glfwDestroyWindow(mWindow);
-        glfwTerminate();
+        if (!mOptions.headless) {
+            glfwDestroyWindow(mWindow);
+            glfwTerminate();
+        }
     }
 };
 
 
+/*-------------------------------------------------------------------------------------------------
+Description:
+    Turns "--name=value" command line arguments into RuntimeOptions. Anything unrecognized or out
+    of range is an error rather than silently ignored, so that a typo in a benchmark script
+    doesn't quietly measure the wrong thing.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+RuntimeOptions ParseRuntimeOptions(int argc, char *argv[]) {
+    RuntimeOptions options{};
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        size_t equalsPos = arg.find('=');
+        std::string name = arg.substr(0, equalsPos);
+        std::string value = (equalsPos == std::string::npos) ? "" : arg.substr(equalsPos + 1);
+
+        if (name == "--headless") {
+            options.headless = true;
+
+            // "--headless=N" => render N frames
+            if (!value.empty()) {
+                long long numFrames = std::stoll(value);
+                if (numFrames < 1 || numFrames > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument("--headless frame count must be at least 1");
+                }
+                options.headlessFrames = static_cast<uint32_t>(numFrames);
+            }
+        }
+        else if (name == "--width" || name == "--height") {
+            int size = std::stoi(value);
+            if (size < 1 || size > 16384) {
+                throw std::invalid_argument(name + " must be 1-16384");
+            }
+            (name == "--width" ? options.width : options.height) = static_cast<uint32_t>(size);
+        }
+        else if (name == "--benchmark") {
+            // "--benchmark=N" => measure N frames
+            options.benchmark = true;
+            if (!value.empty()) {
+                long long numFrames = std::stoll(value);
+                if (numFrames < 1 || numFrames > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument("--benchmark frame count must be at least 1");
+                }
+                options.benchmarkFrames = static_cast<uint32_t>(numFrames);
+            }
+        }
+        else if (name == "--benchmark-warmup") {
+            long long numFrames = std::stoll(value);
+            if (numFrames < 0 || numFrames > std::numeric_limits<uint32_t>::max()) {
+                throw std::invalid_argument("--benchmark-warmup frame count must be 0 or more");
+            }
+            options.benchmarkWarmupFrames = static_cast<uint32_t>(numFrames);
+        }
+        else if (name == "--benchmark-report") {
+            if (value.empty()) {
+                throw std::invalid_argument("--benchmark-report needs a file path");
+            }
+            options.benchmarkReportPath = value;
+        }
+        else if (name == "--shader-features") {
+            // "--shader-features=textured,vertex-color"; "--shader-features=" => none
+            options.shaderFeatures = 0;
+            std::stringstream ss(value);
+            std::string featureName;
+            while (std::getline(ss, featureName, ',')) {
+                auto itr = std::find_if(SHADER_FEATURE_NAMES.begin(), SHADER_FEATURE_NAMES.end(),
+                    [&featureName](const auto &feature) { return feature.first == featureName; });
+                if (itr == SHADER_FEATURE_NAMES.end()) {
+                    throw std::invalid_argument("unknown shader feature '" + featureName + "'");
+                }
+                options.shaderFeatures |= itr->second;
+            }
+        }
+        else if (name == "--variant-benchmark") {
+            // "--variant-benchmark=N" => measure N frames per variant
+            options.variantBenchmark = true;
+            options.headless = true;
+            if (!value.empty()) {
+                long long numFrames = std::stoll(value);
+                if (numFrames < 1 || numFrames > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument("--variant-benchmark frame count must be at least 1");
+                }
+                options.variantBenchmarkFrames = static_cast<uint32_t>(numFrames);
+            }
+        }
+        else if (name == "--variant-benchmark-report") {
+            if (value.empty()) {
+                throw std::invalid_argument("--variant-benchmark-report needs a file path");
+            }
+            options.variantBenchmarkReportPath = value;
+        }
+        else if (name == "--depth-prepass") {
+            options.depthPrepass = true;
+        }
+        else if (name == "--hiz-culling") {
+            options.hiZCulling = true;
+        }
+        else if (name == "--blit-mips") {
+            options.blitMipMaps = true;
+        }
+        else if (name == "--standard-depth") {
+            options.reversedZ = false;
+        }
+        else if (name == "--near-plane" || name == "--far-plane") {
+            float dist = std::stof(value);
+            if (dist <= 0.0f) {
+                throw std::invalid_argument(name + " must be > 0");
+            }
+            (name == "--near-plane" ? options.nearPlane : options.farPlane) = dist;
+        }
+        else if (name == "--depth-format") {
+            auto itr = std::find_if(DEPTH_FORMAT_NAMES.begin(), DEPTH_FORMAT_NAMES.end(),
+                [&value](const auto &depthFormat) { return depthFormat.first == value; });
+            if (itr == DEPTH_FORMAT_NAMES.end()) {
+                throw std::invalid_argument("--depth-format must be d16, d24, or d32");
+            }
+            options.depthFormat = itr->second;
+        }
+        else if (name == "--depth-precision-test") {
+            options.depthPrecisionTest = true;
+            options.headless = true;
+        }
+        else if (name == "--depth-precision-report") {
+            if (value.empty()) {
+                throw std::invalid_argument("--depth-precision-report needs a file path");
+            }
+            options.depthPrecisionReportPath = value;
+        }
+        else if (name == "--occlusion-benchmark") {
+            // "--occlusion-benchmark=N" => measure N frames per configuration
+            // Note: Every configuration is switched on and off at runtime, so the features that 
+            // they need are all turned on here.
+            options.occlusionBenchmark = true;
+            options.headless = true;
+            options.depthPrepass = true;
+            options.hiZCulling = true;
+            if (!value.empty()) {
+                long long numFrames = std::stoll(value);
+                if (numFrames < 1 || numFrames > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument("--occlusion-benchmark frame count must be at least 1");
+                }
+                options.occlusionBenchmarkFrames = static_cast<uint32_t>(numFrames);
+            }
+        }
+        else if (name == "--occlusion-benchmark-report") {
+            if (value.empty()) {
+                throw std::invalid_argument("--occlusion-benchmark-report needs a file path");
+            }
+            options.occlusionBenchmarkReportPath = value;
+        }
+        else if (name == "--scene") {
+            if (value.empty()) {
+                throw std::invalid_argument("--scene needs a file path");
+            }
+            options.scenePath = value;
+        }
+        else if (name == "--camera-path") {
+            if (value.empty()) {
+                throw std::invalid_argument("--camera-path needs a file path");
+            }
+            options.cameraPathFile = value;
+        }
+        else if (name == "--frames-in-flight") {
+            int framesInFlight = std::stoi(value);
+            if (framesInFlight < 1 || framesInFlight > 4) {
+                throw std::invalid_argument("--frames-in-flight must be 1-4");
+            }
+            options.framesInFlight = static_cast<uint32_t>(framesInFlight);
+        }
+        else if (name == "--present-mode") {
+            if (value == "immediate") {
+                options.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            }
+            else if (value == "mailbox") {
+                options.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            }
+            else if (value == "fifo") {
+                options.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+            }
+            else if (value == "fifo-relaxed") {
+                options.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            }
+            else {
+                throw std::invalid_argument("--present-mode must be immediate, mailbox, fifo, or fifo-relaxed");
+            }
+        }
+        else if (name == "--swapchain-images") {
+            int swapChainImages = std::stoi(value);
+            if (swapChainImages < 2 || swapChainImages > 8) {
+                throw std::invalid_argument("--swapchain-images must be 2-8");
+            }
+            options.swapChainImages = static_cast<uint32_t>(swapChainImages);
+        }
+        else if (name == "--gpu-stats") {
+            // "--gpu-stats" alone => every 120 frames; "--gpu-stats=0" => only at exit
+            options.gpuStatsInterval = 120;
+            if (!value.empty()) {
+                long long interval = std::stoll(value);
+                if (interval < 0 || interval > std::numeric_limits<uint32_t>::max()) {
+                    throw std::invalid_argument("--gpu-stats interval must be 0 or more frames");
+                }
+                options.gpuStatsInterval = static_cast<uint32_t>(interval);
+            }
+        }
+        else if (name == "--gpu-stats-csv") {
+            if (value.empty()) {
+                throw std::invalid_argument("--gpu-stats-csv needs a file path");
+            }
+            options.gpuStatsCsvPath = value;
+        }
+        else if (name == "--frame-stats-window") {
+            int windowSize = std::stoi(value);
+            if (windowSize < 1 || windowSize > static_cast<int>(FrameProfiler::RING_SIZE)) {
+                throw std::invalid_argument("--frame-stats-window must be 1-" + std::to_string(FrameProfiler::RING_SIZE));
+            }
+            options.frameStatsWindow = static_cast<uint32_t>(windowSize);
+        }
+        else if (name == "--frame-stats-json") {
+            // "--frame-stats-json=" (empty) turns it off
+            options.frameStatsJsonPath = value;
+        }
+        else if (name == "--single-threaded") {
+            options.singleThreaded = true;
+        }
+        else if (name == "--pipeline-cache") {
+            // "--pipeline-cache=" (empty) turns it off
+            options.pipelineCachePath = value;
+        }
+        else if (name == "--pipeline-prewarm") {
+            // "--pipeline-prewarm=" (empty) turns it off
+            options.pipelinePrewarmPath = value;
+        }
+        else if (name == "--hot-reload") {
+            options.hotReload = true;
+        }
+        else if (name == "--shader-cache") {
+            if (value.empty()) {
+                throw std::invalid_argument("--shader-cache needs a directory");
+            }
+            options.shaderCacheDirectory = value;
+        }
+        else if (name == "--serial-init") {
+            options.serialInit = true;
+        }
+        else if (name == "--init-trace") {
+            // "--init-trace=" (empty) turns it off
+            options.initTracePath = value;
+        }
+        else if (name == "--dynamic-resolution") {
+            options.dynamicResolution = true;
+        }
+        else if (name == "--drs-target-ms") {
+            options.dynamicResolutionTargetMs = std::stod(value);
+            if (options.dynamicResolutionTargetMs <= 0.0) {
+                throw std::invalid_argument("--drs-target-ms must be > 0");
+            }
+            options.dynamicResolution = true;
+        }
+        else if (name == "--drs-min-scale") {
+            options.dynamicResolutionMinScale = std::stod(value);
+            if (options.dynamicResolutionMinScale < 0.25 || options.dynamicResolutionMinScale > 1.0) {
+                throw std::invalid_argument("--drs-min-scale must be 0.25-1");
+            }
+            options.dynamicResolution = true;
+        }
+        else if (name == "--low-latency") {
+            options.lowLatency = true;
+        }
+        else if (name == "--target-fps") {
+            options.targetFps = std::stod(value);
+            if (options.targetFps <= 0.0) {
+                throw std::invalid_argument("--target-fps must be > 0");
+            }
+            options.lowLatency = true;
+        }
+        else {
+            throw std::invalid_argument("unknown argument '" + arg + "'");
+        }
+    }
+    if (!options.reversedZ && options.farPlane <= options.nearPlane) {
+        throw std::invalid_argument("--far-plane must be beyond --near-plane");
+    }
+    return options;
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    The value that a depth buffer of the given format would store for the given depth, so that
+    two of them can be compared. UNORM formats round to the nearest of 2^N - 1 evenly spaced
+    steps. D32_SFLOAT stores the float as it is.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+double StoreDepth(float depth, VkFormat format) {
+    double clamped = std::clamp(static_cast<double>(depth), 0.0, 1.0);
+    if (format == VK_FORMAT_D16_UNORM) {
+        return std::round(clamped * 65535.0);
+    }
+    if (format == VK_FORMAT_X8_D24_UNORM_PACK32) {
+        return std::round(clamped * 16777215.0);
+    }
+    return clamped;
+}
+
+/*-------------------------------------------------------------------------------------------------
+Description:
+    "--depth-precision-test": for every projection (standard, with the near and far planes from
+    the command line, and reversed-Z) and every depth-only format, and for distances from 1 to
+    100,000, finds how deep the run of distances is that all end up with the same depth value
+    as that distance. Surfaces closer together than that can z-fight.
+
+    The depth is calculated the way that the GPU does it: the same projection (see
+    MakeProjection(...)), in 32-bit floats, with the divide by w, and then stored in the format.
+
+    Note: Doesn't need a GPU, so it runs without creating anything in Vulkan.
+
+    Also Note: The standard projection clips everything past the far plane, so try it again
+    with "--far-plane=100000" to see what pushing the far plane out costs up close.
+Creator:    John Cox, 10/2026
+-------------------------------------------------------------------------------------------------*/
+void RunDepthPrecisionTest(const RuntimeOptions &options) {
+    struct Config {
+        std::string name;
+        bool reversedZ;
+        VkFormat format;
+    };
+    std::vector<Config> configs;
+    for (bool reversedZ : { false, true }) {
+        for (const auto &depthFormat : DEPTH_FORMAT_NAMES) {
+            configs.push_back({ std::string(reversedZ ? "reversed " : "standard ") + depthFormat.first, reversedZ, depthFormat.second });
+        }
+    }
+    const std::vector<float> distances{ 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f };
+
+    // < 0 => the same depth value all the way to the near/far plane, or for more than half the 
+    // distance; NaN => clipped
+    auto findSeparation = [&options](const Config &config, float distance) {
+        glm::mat4 proj = MakeProjection(glm::radians(45.0f), 1.0f, options.nearPlane, options.farPlane, config.reversedZ);
+        auto depthAt = [&proj](float d) {
+            glm::vec4 clip = proj * glm::vec4(0.0f, 0.0f, -d, 1.0f);
+            return clip.z / clip.w;
+        };
+        auto isClipped = [&options, &config](float d) {
+            return d < options.nearPlane || (!config.reversedZ && d > options.farPlane);
+        };
+        if (isClipped(distance)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        double stored = StoreDepth(depthAt(distance), config.format);
+
+        // how far to go in one direction (+1 farther, -1 nearer) to get a different value: 
+        // double until it's different, then narrow it down between that and the last same one
+        auto findEdge = [&](float direction) {
+            float same = 0.0f;
+            float different = distance * 1e-8f;
+            while (StoreDepth(depthAt(distance + direction * different), config.format) == stored) {
+                same = different;
+                different *= 2.0f;
+                if (different > distance * 0.5f || isClipped(distance + direction * different)) {
+                    return -1.0f;
+                }
+            }
+            for (int i = 0; i < 24; i++) {
+                float middle = (same + different) / 2.0f;
+                bool isDifferent = StoreDepth(depthAt(distance + direction * middle), config.format) != stored;
+                (isDifferent ? different : same) = middle;
+            }
+            return different;
+        };
+        float farther = findEdge(+1.0f);
+        float nearer = findEdge(-1.0f);
+        return (farther < 0.0f || nearer < 0.0f) ? -1.0 : static_cast<double>(farther + nearer);
+    };
+
+    std::vector<std::vector<double>> separations;
+    for (const auto &config : configs) {
+        std::vector<double> row;
+        for (float distance : distances) {
+            row.push_back(findSeparation(config, distance));
+        }
+        separations.push_back(row);
+    }
+
+    auto toString = [](double separation) {
+        if (std::isnan(separation)) {
+            return std::string("clipped");
+        }
+        if (separation < 0.0) {
+            return std::string("none");
+        }
+        std::stringstream ss;
+        ss << std::setprecision(3) << separation;
+        return ss.str();
+    };
+
+    std::stringstream ss;
+    ss << "Depth precision (near plane " << options.nearPlane << ", standard far plane " << options.farPlane << "): depth of the range that z-fights" << std::endl;
+    ss << "    " << std::left << std::setw(14) << "distance";
+    for (float distance : distances) {
+        ss << std::setw(12) << distance;
+    }
+    ss << std::endl;
+    for (size_t i = 0; i < configs.size(); i++) {
+        ss << "    " << std::setw(14) << configs[i].name;
+        for (double separation : separations[i]) {
+            ss << std::setw(12) << toString(separation);
+        }
+        ss << std::endl;
+    }
+    std::cout << ss.str();
+
+    std::ofstream outFile(options.depthPrecisionReportPath, std::ios::out | std::ios::trunc);
+    if (!outFile.is_open()) {
+        throw std::runtime_error("failed to open '" + options.depthPrecisionReportPath + "' for the depth precision report");
+    }
+    outFile << "{\n";
+    outFile << "  \"nearPlane\": " << options.nearPlane << ",\n";
+    outFile << "  \"farPlane\": " << options.farPlane << ",\n";
+    outFile << "  \"configs\": [\n";
+    for (size_t i = 0; i < configs.size(); i++) {
+        outFile << "    { \"name\": \"" << configs[i].name << "\""
+            << ", \"reversedZ\": " << (configs[i].reversedZ ? "true" : "false")
+            << ", \"format\": \"" << DepthFormatToString(configs[i].format) << "\""
+            << ", \"zFightRanges\": [";
+        for (size_t j = 0; j < distances.size(); j++) {
+            // null => clipped, or never resolved
+            double separation = separations[i][j];
+            outFile << (j > 0 ? ", " : "") << "{ \"distance\": " << distances[j] << ", \"zFightRange\": ";
+            if (std::isnan(separation) || separation < 0.0) {
+                outFile << "null";
+            }
+            else {
+                outFile << separation;
+            }
+            outFile << " }";
+        }
+        outFile << "] }" << (i + 1 < configs.size() ? "," : "") << "\n";
+    }
+    outFile << "  ]\n";
+    outFile << "}\n";
+    std::cout << "Depth precision report written to '" << options.depthPrecisionReportPath << "'" << std::endl;
+}
+
 /*-------------------------------------------------------------------------------------------------
 Description:
     Startup and tells the program to go. Encases everything in a try-catch-all block to ensure
@@ -2848,16 +12183,32 @@ Description:
     work, and move the code to an appropriate class.
 Creator:    John Cox, 10/2018
 -------------------------------------------------------------------------------------------------*/
-int main() {
+int main(int argc, char *argv[]) {
+    // nobody is there to press a key on a headless CI node
+    bool pauseOnExit = true;
+
+    // Note: A CI node only has the exit code to go on, so anything that was thrown (a bad 
+    // argument, no usable device, a validation failure) must not look like success.
+    int exitCode = EXIT_SUCCESS;
     try {
-        HelloTriangleApplication app;
-        app.Run();
+        RuntimeOptions options = ParseRuntimeOptions(argc, argv);
+        pauseOnExit = !options.headless;
+        if (options.depthPrecisionTest) {
+            RunDepthPrecisionTest(options);
+        }
+        else {
+            HelloTriangleApplication app(options);
+            app.Run();
+        }
     }
     catch (const std::exception& e) {
         std::cout << "Try-Catch All triggered: " << std::endl
             << e.what() << std::endl;
+        exitCode = EXIT_FAILURE;
     }
 
-    system("pause");
-    return 0;
+    if (pauseOnExit) {
+        system("pause");
+    }
+    return exitCode;
 }
@@ -6,8 +6,31 @@
 :: -V tells the compiler to create SPIR-V binaries for Vulkan.
 :: -G tells the compiler to create SPIR-V binaries for OpenGL. (ignored; we're using Vulkan)
 :: -o path/to/output/file.whatevs to use non-default naming.
-C:\ThirdParty\VulkanSDK\1.1.85.0\Bin32\glslangValidator.exe -V triangle.vert
-C:\ThirdParty\VulkanSDK\1.1.85.0\Bin32\glslangValidator.exe -V triangle.frag
+
+:: The SDK installer sets VULKAN_SDK. If it isn't set, use the SDK that this project was made with.
+:: Note: The app can also compile these itself (--hot-reload), and then these are only needed as 
+:: a fallback.
+if not defined VULKAN_SDK set VULKAN_SDK=C:\ThirdParty\VulkanSDK\1.1.85.0
+set GLSLANG="%VULKAN_SDK%\Bin32\glslangValidator.exe"
+
+%GLSLANG% -V triangle.vert
+%GLSLANG% -V triangle.frag
+%GLSLANG% -V triangle_bindless.frag -o frag_bindless.spv
+%GLSLANG% -V depth_prepass.vert -o depth_prepass_vert.spv
+%GLSLANG% -V hiz_build.comp -o hiz_build_comp.spv
+%GLSLANG% -V cluster_cull.comp -o cluster_cull_comp.spv
+%GLSLANG% -V spd_downsample.comp -o spd_downsample_comp.spv
+
+:: --vn name writes the SPIR-V as a C array called "name" instead, which main.cpp compiles in if 
+:: the header is there (no shader files needed at runtime). Delete the headers to go back to 
+:: loading the .spv files.
+%GLSLANG% -V triangle.vert --vn vert_spv -o vert_spv.h
+%GLSLANG% -V triangle.frag --vn frag_spv -o frag_spv.h
+%GLSLANG% -V triangle_bindless.frag --vn frag_bindless_spv -o frag_bindless_spv.h
+%GLSLANG% -V depth_prepass.vert --vn depth_prepass_vert_spv -o depth_prepass_vert_spv.h
+%GLSLANG% -V hiz_build.comp --vn hiz_build_comp_spv -o hiz_build_comp_spv.h
+%GLSLANG% -V cluster_cull.comp --vn cluster_cull_comp_spv -o cluster_cull_comp_spv.h
+%GLSLANG% -V spd_downsample.comp --vn spd_downsample_comp_spv -o spd_downsample_comp_spv.h
 
 :: pause so that we can read the console output
 pause
@@ -0,0 +1,24 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Note: The depth pre-pass only needs positions, so it reads a tightly packed position-only 
+// vertex stream (12 bytes per vertex instead of the whole Vertex) and has no fragment shader.
+// Same per-frame uniforms and push constants as triangle.vert.
+layout(set = 0, binding = 0) uniform PerFrameUniforms {
+    mat4 viewProj;
+} perFrame;
+
+layout(push_constant) uniform PerObjectPushConstants {
+    mat4 model;
+} perObject;
+
+layout(location = 0) in vec3 inPosition;
+
+// Note: The main pass tests depth with EQUAL against what this writes, so both shaders must come 
+// up with bit-for-bit the same position. "invariant" is what promises that the same expression 
+// on the same inputs does, even across different shaders.
+invariant gl_Position;
+
+void main() {
+    gl_Position = perFrame.viewProj * (perObject.model * vec4(inPosition, 1.0f));
+}
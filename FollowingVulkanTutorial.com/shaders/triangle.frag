@@ -1,7 +1,19 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Note: Set 0 is per-frame data (see the vertex shader). Textures are per-material, so they live 
+// in their own set that only needs to be rebound when the material changes.
+layout(set = 1, binding = 0) uniform sampler2D texSampler;
+
+// Note: What this shader does is picked when the pipeline is created (a specialization 
+// constant), not while it runs, so the "if"s below are decided at compile time and each pipeline 
+// variant only carries the features that it uses. Must match ShaderFeature in main.cpp.
+layout(constant_id = 0) const uint FEATURE_MASK = 1u;
+const uint FEATURE_TEXTURED = 1u;
+const uint FEATURE_VERTEX_COLOR = 2u;
+const uint FEATURE_ALPHA_TEST = 4u;
+const uint FEATURE_DEBUG_UV = 8u;
+const uint FEATURE_DEBUG_DEPTH = 16u;
 
 // Note: Only the location of the "out" from the previous shader stage and "in" in this 
 // shader stage have to match. The name does not, unlike my prior experiences in Vulkan.
@@ -13,5 +25,21 @@ layout(location = 1) in vec2 texCoord;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, texCoord);
+    vec4 color = vec4(1.0f);
+    if ((FEATURE_MASK & FEATURE_TEXTURED) != 0u) {
+        color = texture(texSampler, texCoord);
+    }
+    if ((FEATURE_MASK & FEATURE_VERTEX_COLOR) != 0u) {
+        color.rgb *= fragColorGoober;
+    }
+    if ((FEATURE_MASK & FEATURE_ALPHA_TEST) != 0u && color.a < 0.5f) {
+        discard;
+    }
+    if ((FEATURE_MASK & FEATURE_DEBUG_UV) != 0u) {
+        color = vec4(texCoord, 0.0f, 1.0f);
+    }
+    if ((FEATURE_MASK & FEATURE_DEBUG_DEPTH) != 0u) {
+        color = vec4(vec3(gl_FragCoord.z), 1.0f);
+    }
+    outColor = color;
 }
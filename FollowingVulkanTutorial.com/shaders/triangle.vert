@@ -3,15 +3,20 @@
 //??what benefit does this have??
 #extension GL_ARB_separate_shader_objects : enable
 
-// Note: If there are descriptors that vary per object (ex: model->world transforms) and 
-// descriptors that don't (ex: world->camera and camera->window), you can put them into separate 
-// descriptor sets so that we don't have to rebind the constant ones on every frame. But we aren't 
-// doing that here (and I don't know how yet).
-layout(set = 0, binding = 0) uniform UniformBufferObject {
+// Note: Descriptors that vary per object (ex: model->world transforms) and descriptors that don't 
+// (ex: world->camera and camera->window) are split up. The constant parts are premultiplied on the 
+// CPU into a single view-projection matrix and bound once per frame in set 0. The per-object 
+// model transform doesn't go through a descriptor at all; it arrives via push constants, which 
+// are recorded straight into the command buffer.
+layout(set = 0, binding = 0) uniform PerFrameUniforms {
+    mat4 viewProj;
+} perFrame;
+
+// Note: Only 128 bytes of push constants are guaranteed to be available (maxPushConstantsSize), 
+// so keep this small. A mat4 is 64 bytes.
+layout(push_constant) uniform PerObjectPushConstants {
     mat4 model;
-    mat4 view;
-    mat4 proj;
-} ubo;
+} perObject;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -20,8 +25,12 @@ layout(location = 2) in vec2 inTexCoord;
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
+// Note: Must match depth_prepass.vert bit for bit (the main pass tests depth with EQUAL after 
+// a depth pre-pass).
+invariant gl_Position;
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0f);
+    gl_Position = perFrame.viewProj * (perObject.model * vec4(inPosition, 1.0f));
     fragColor = inColor;
     fragTexCoord = inTexCoord;
 }
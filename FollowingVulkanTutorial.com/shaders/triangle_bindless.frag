@@ -0,0 +1,52 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// needed for unsized arrays of descriptors and for nonuniformEXT(...)
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Note: "Bindless" variant of triangle.frag. Instead of one texture per material set that has to 
+// be rebound for every material change, every texture lives in one big (partially bound) array 
+// in set 1 and each draw says which one it wants via a push constant. Only used if the device 
+// supports VK_EXT_descriptor_indexing. Otherwise the app falls back to triangle.frag.
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+// Note: The vertex shader owns bytes 0-63 (the model transform). The material ID comes after it.
+layout(push_constant) uniform PerObjectPushConstants {
+    layout(offset = 64) uint materialId;
+} perObject;
+
+// Note: Same features as triangle.frag (see there).
+layout(constant_id = 0) const uint FEATURE_MASK = 1u;
+const uint FEATURE_TEXTURED = 1u;
+const uint FEATURE_VERTEX_COLOR = 2u;
+const uint FEATURE_ALPHA_TEST = 4u;
+const uint FEATURE_DEBUG_UV = 8u;
+const uint FEATURE_DEBUG_DEPTH = 16u;
+
+layout(location = 0) in vec3 fragColorGoober;
+layout(location = 1) in vec2 texCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 color = vec4(1.0f);
+    if ((FEATURE_MASK & FEATURE_TEXTURED) != 0u) {
+        // Note: A push constant is the same for the whole draw (dynamically uniform), so 
+        // nonuniformEXT(...) isn't strictly necessary, but it costs nothing on hardware that 
+        // doesn't need it and keeps this correct if the index ever comes from per-vertex data.
+        color = texture(textures[nonuniformEXT(perObject.materialId)], texCoord);
+    }
+    if ((FEATURE_MASK & FEATURE_VERTEX_COLOR) != 0u) {
+        color.rgb *= fragColorGoober;
+    }
+    if ((FEATURE_MASK & FEATURE_ALPHA_TEST) != 0u && color.a < 0.5f) {
+        discard;
+    }
+    if ((FEATURE_MASK & FEATURE_DEBUG_UV) != 0u) {
+        color = vec4(texCoord, 0.0f, 1.0f);
+    }
+    if ((FEATURE_MASK & FEATURE_DEBUG_DEPTH) != 0u) {
+        color = vec4(vec3(gl_FragCoord.z), 1.0f);
+    }
+    outColor = color;
+}